@@ -0,0 +1,60 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace vast::bench {
+
+/// Prevents the compiler from optimizing away the computation of a value.
+template <class T>
+void do_not_optimize(const T& x) {
+  asm volatile("" : : "g"(&x) : "memory");
+}
+
+/// Runs a function repeatedly and prints the distribution of its runtime.
+/// @param name The name of the benchmark.
+/// @param iterations The number of measured runs.
+/// @param f The function to measure.
+/// @pre `iterations > 0`
+template <class F>
+void measure(std::string_view name, size_t iterations, F f) {
+  using clock = std::chrono::steady_clock;
+  using microseconds = std::chrono::duration<double, std::micro>;
+  // Warm up caches before measuring.
+  f();
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  for (size_t i = 0; i < iterations; ++i) {
+    auto start = clock::now();
+    f();
+    samples.push_back(microseconds{clock::now() - start}.count());
+  }
+  std::sort(samples.begin(), samples.end());
+  auto mean = std::accumulate(samples.begin(), samples.end(), 0.0)
+              / samples.size();
+  fmt::print("{:<48} {:>6} runs  min {:>12.2f}us  median {:>12.2f}us  mean "
+             "{:>12.2f}us\n",
+             name, iterations, samples.front(), samples[samples.size() / 2],
+             mean);
+}
+
+} // namespace vast::bench
@@ -0,0 +1,138 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/address.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/expression.hpp"
+#include "vast/factory.hpp"
+#include "vast/ids.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/system/continuous_query_engine.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/type.hpp"
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace vast;
+
+namespace {
+
+constexpr size_t num_rows = 65'536;
+
+address make_address(uint32_t x) {
+  return address::v4(&x);
+}
+
+table_slice make_slice(const record_type& layout) {
+  auto builder = msgpack_table_slice_builder::make(layout);
+  for (size_t i = 0; i < num_rows; ++i) {
+    auto ok = builder->add(make_address(i * 7919 % 100'000),
+                           make_address(i * 104'729 % 100'000),
+                           count{i % 65'536},
+                           fmt::format("host-{}.example.com", i % 4096));
+    if (!ok) {
+      fmt::print(stderr, "failed to add row {}\n", i);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  auto result = builder->finish();
+  result.offset(0);
+  return result;
+}
+
+/// Creates standing IoC queries: single indicators on any address field, lists
+/// of indicators, indicators on a specific field combined with a port, and
+/// domain names.
+std::vector<expression> make_queries(size_t n) {
+  auto result = std::vector<expression>{};
+  auto addr = [](uint32_t x) { return data{make_address(x * 31 % 100'000)}; };
+  auto any_addr = type_extractor{address_type{}};
+  for (size_t i = 0; i < n; ++i) {
+    auto x = detail::narrow_cast<uint32_t>(i);
+    switch (i % 4) {
+      case 0:
+        result.emplace_back(
+          predicate{any_addr, relational_operator::equal, addr(x)});
+        break;
+      case 1:
+        result.emplace_back(
+          predicate{any_addr, relational_operator::in,
+                    data{list{addr(x), addr(x + 1), addr(x + 2)}}});
+        break;
+      case 2:
+        result.emplace_back(conjunction{
+          predicate{field_extractor{"src"}, relational_operator::equal,
+                    addr(x)},
+          predicate{field_extractor{"port"}, relational_operator::less,
+                    data{count{1024}}}});
+        break;
+      case 3:
+        result.emplace_back(
+          predicate{field_extractor{"host"}, relational_operator::equal,
+                    data{fmt::format("host-{}.example.com", i)}});
+        break;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5;
+  factory<table_slice_builder>::initialize();
+  auto layout = record_type{
+    {"src", address_type{}},
+    {"dst", address_type{}},
+    {"port", count_type{}},
+    {"host", string_type{}},
+  }.name("bench");
+  auto slice = make_slice(layout);
+  for (auto n : {10, 100, 500}) {
+    auto queries = make_queries(n);
+    // Every continuous exporter tailors its query once and evaluates it on
+    // every table slice.
+    auto tailored = std::vector<expression>{};
+    for (auto& expr : queries)
+      tailored.push_back(*tailor(normalize(expr), type{layout}));
+    auto hits = size_t{0};
+    for (auto& expr : tailored)
+      hits += rank(evaluate(expr, slice));
+    bench::measure(fmt::format("per-query evaluation ({} queries, {} hits)",
+                               n, hits),
+                   iterations, [&] {
+                     for (auto& expr : tailored)
+                       bench::do_not_optimize(evaluate(expr, slice));
+                   });
+    auto engine = system::continuous_query_engine{};
+    for (size_t i = 0; i < queries.size(); ++i)
+      engine.add(i, queries[i]);
+    hits = 0;
+    for (auto& match : engine.evaluate(slice))
+      hits += rank(match.selection);
+    bench::measure(fmt::format("shared evaluation ({} queries, {} hits)", n,
+                               hits),
+                   iterations, [&] {
+                     auto xs = engine.evaluate(slice);
+                     bench::do_not_optimize(xs);
+                   });
+  }
+  return EXIT_SUCCESS;
+}
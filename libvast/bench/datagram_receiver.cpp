@@ -0,0 +1,102 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/detail/datagram_receiver.hpp"
+
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <netinet/in.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+using namespace vast;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Reads all buffered messages and returns their number.
+size_t drain(detail::datagram_receiver& receiver) {
+  receiver.rearm();
+  std::istream in{&receiver};
+  size_t result = 0;
+  std::string line;
+  while (std::getline(in, line))
+    if (!line.empty())
+      ++result;
+  return result;
+}
+
+} // namespace
+
+// Floods a receiver on the loopback interface with syslog-sized datagrams
+// while a consumer thread parses them, and reports how many datagrams made it
+// through. The drop rate depends on the machine load and the kernel buffer
+// sizes, so this is no pass/fail check.
+int main(int argc, char** argv) {
+  size_t num_datagrams
+    = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+  auto receiver = detail::datagram_receiver::make(0, 1024, 9216,
+                                                  8 * 1024 * 1024, [] {});
+  if (!receiver) {
+    fmt::print(stderr, "failed to create the datagram receiver\n");
+    return EXIT_FAILURE;
+  }
+  auto& rx = **receiver;
+  auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return EXIT_FAILURE;
+  ::sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(rx.port());
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  std::atomic<bool> done = false;
+  size_t lines = 0;
+  auto consumer = std::thread{[&] {
+    while (!done)
+      if (rx.available() > 0)
+        lines += drain(rx);
+      else
+        std::this_thread::yield();
+  }};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_datagrams; ++i) {
+    auto msg = "<34>1 2003-10-11T22:14:15.003Z mymachine.example.com su - "
+               "ID47 - message "
+               + std::to_string(i);
+    ::sendto(fd, msg.data(), msg.size(), 0,
+             reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  // Give the receiver a moment to pick up the tail of the datagrams.
+  std::this_thread::sleep_for(100ms);
+  done = true;
+  consumer.join();
+  lines += drain(rx);
+  ::close(fd);
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  auto stats = rx.stats();
+  fmt::print("sent {} datagrams in {:.3f}s ({:.0f}/s), parsed {} lines, "
+             "received {}, dropped {}\n",
+             num_datagrams, seconds, num_datagrams / seconds, lines,
+             stats.received, stats.dropped);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/meta_index.hpp"
+
+#include "vast/bool_synopsis.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/expression.hpp"
+#include "vast/time_synopsis.hpp"
+#include "vast/uuid.hpp"
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace vast;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t num_partitions = 100'000;
+
+// Every partition covers one minute of events.
+constexpr auto partition_duration = std::chrono::minutes{1};
+
+meta_index make_meta_index() {
+  meta_index result;
+  auto ts = record_field{"ts", time_type{}.attributes({{"timestamp"}})};
+  auto flag = record_field{"flag", bool_type{}};
+  for (size_t i = 0; i < num_partitions; ++i) {
+    auto first = time{} + i * partition_duration;
+    auto last = first + partition_duration - 1s;
+    partition_synopsis ps;
+    ps.field_synopses_[qualified_record_field{"bench", ts}]
+      = std::make_unique<time_synopsis>(first, last);
+    ps.field_synopses_[qualified_record_field{"bench", flag}]
+      = std::make_unique<bool_synopsis>(i % 2 == 0, i % 2 == 1);
+    result.merge(uuid::random(), std::move(ps));
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+  fmt::print("building meta index with {} partitions\n", num_partitions);
+  auto meta_idx = make_meta_index();
+  auto run = [&](std::string_view name, std::string_view query) {
+    auto expr = to<expression>(query);
+    if (!expr) {
+      fmt::print(stderr, "failed to parse query: {}\n", query);
+      std::exit(EXIT_FAILURE);
+    }
+    auto candidates = meta_idx.lookup(*expr);
+    bench::measure(fmt::format("{} ({} candidates)", name, candidates.size()),
+                   iterations, [&] {
+                     auto result = meta_idx.lookup(*expr);
+                     bench::do_not_optimize(result);
+                   });
+  };
+  run("point in time", "#timestamp == 1970-02-01+00:00:00.0");
+  run("one hour", "#timestamp >= 1970-02-01+00:00:00.0"
+                  " && #timestamp < 1970-02-01+01:00:00.0");
+  run("one hour with predicate", "#timestamp >= 1970-02-01+00:00:00.0"
+                                 " && #timestamp < 1970-02-01+01:00:00.0"
+                                 " && flag == T");
+  run("one day", "#timestamp >= 1970-02-01+00:00:00.0"
+                 " && #timestamp < 1970-02-02+00:00:00.0");
+  run("open-ended", "#timestamp >= 1970-03-01+00:00:00.0");
+  run("no time range", "flag == T");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/config.hpp"
+#include "vast/factory.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/type.hpp"
+
+#if VAST_ENABLE_ARROW
+#  include "vast/arrow_table_slice_builder.hpp"
+
+#  include <arrow/record_batch.h>
+#endif // VAST_ENABLE_ARROW
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+
+using namespace vast;
+
+int main(int argc, char** argv) {
+#if VAST_ENABLE_ARROW
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20;
+  size_t num_rows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 65'536;
+  factory<table_slice_builder>::initialize();
+  auto layout = record_type{
+    {"c", count_type{}},
+    {"i", integer_type{}},
+    {"s", string_type{}},
+    {"r", real_type{}},
+    {"xs", list_type{count_type{}}},
+  }.name("bench");
+  auto builder = msgpack_table_slice_builder::make(layout);
+  for (size_t i = 0; i < num_rows; ++i) {
+    auto ok = builder->add(count{i}, -static_cast<integer>(i),
+                           fmt::format("host-{}", i % 1024), real{i * 0.5},
+                           list{count{i}, count{i + 1}});
+    if (!ok) {
+      fmt::print(stderr, "failed to add row {}\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+  auto slice = builder->finish();
+  auto flat_layout = flatten(layout);
+  // The previous approach: access every cell individually, which decodes the
+  // row from its beginning up to the requested column for every cell.
+  bench::measure("per-cell rebuild", iterations, [&] {
+    auto arrow_builder = arrow_table_slice_builder::make(layout);
+    for (size_t row = 0; row < slice.rows(); ++row)
+      for (size_t column = 0; column < flat_layout.fields.size(); ++column)
+        if (!arrow_builder->add(
+              slice.at(row, column, flat_layout.fields[column].type)))
+          std::exit(EXIT_FAILURE);
+    auto result = arrow_builder->finish();
+    bench::do_not_optimize(result);
+  });
+  bench::measure("transcode", iterations, [&] {
+    auto batch = as_record_batch(slice);
+    bench::do_not_optimize(batch);
+  });
+  bench::measure("transcode + rebuild", iterations, [&] {
+    auto result = rebuild(slice, table_slice_encoding::arrow);
+    bench::do_not_optimize(result);
+  });
+#else
+  static_cast<void>(argc);
+  static_cast<void>(argv);
+  fmt::print(stderr, "benchmark requires Arrow support\n");
+#endif // VAST_ENABLE_ARROW
+  return EXIT_SUCCESS;
+}
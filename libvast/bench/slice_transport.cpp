@@ -0,0 +1,167 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/config.hpp"
+#include "vast/detail/deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/error.hpp"
+#include "vast/factory.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/system/slice_transport.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/type.hpp"
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <sys/socket.h>
+
+using namespace vast;
+
+namespace {
+
+constexpr size_t num_slices = 64;
+
+table_slice make_slice(size_t rows) {
+  auto layout = record_type{
+    {"c", count_type{}},
+    {"s", string_type{}},
+    {"r", real_type{}},
+  }.name("bench");
+  auto builder = msgpack_table_slice_builder::make(layout);
+  for (size_t i = 0; i < rows; ++i) {
+    auto ok = builder->add(count{i}, fmt::format("host-{}.example.com", i),
+                           real{i * 0.5});
+    if (!ok) {
+      fmt::print(stderr, "failed to add row {}\n", i);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return builder->finish();
+}
+
+void write_all(int fd, const void* data, size_t size) {
+  auto ptr = reinterpret_cast<const char*>(data);
+  while (size > 0) {
+    auto n = ::write(fd, ptr, size);
+    if (n <= 0)
+      std::exit(EXIT_FAILURE);
+    ptr += n;
+    size -= n;
+  }
+}
+
+void read_all(int fd, void* data, size_t size) {
+  auto ptr = reinterpret_cast<char*>(data);
+  while (size > 0) {
+    auto n = ::read(fd, ptr, size);
+    if (n <= 0)
+      std::exit(EXIT_FAILURE);
+    ptr += n;
+    size -= n;
+  }
+}
+
+// The network transport: CAF serializes the table slice, writes the bytes to
+// a stream socket, and the receiver deserializes them into a new chunk.
+void serialize_over_socket(const table_slice& slice) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    std::exit(EXIT_FAILURE);
+  auto sender = std::thread{[&] {
+    std::vector<char> buf;
+    for (size_t i = 0; i < num_slices; ++i) {
+      buf.clear();
+      if (detail::serialize(buf, slice))
+        std::exit(EXIT_FAILURE);
+      uint64_t size = buf.size();
+      write_all(fds[0], &size, sizeof(size));
+      write_all(fds[0], buf.data(), buf.size());
+    }
+  }};
+  std::vector<char> buf;
+  for (size_t i = 0; i < num_slices; ++i) {
+    uint64_t size = 0;
+    read_all(fds[1], &size, sizeof(size));
+    buf.resize(size);
+    read_all(fds[1], buf.data(), size);
+    auto result = table_slice{};
+    if (detail::deserialize(buf, result))
+      std::exit(EXIT_FAILURE);
+    bench::do_not_optimize(result);
+  }
+  sender.join();
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+#if VAST_LINUX
+
+// The local transport: the table slice travels as a sealed memory file
+// descriptor, which the receiver maps.
+void send_memfd(const table_slice& slice) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0)
+    std::exit(EXIT_FAILURE);
+  auto sender = std::thread{[&] {
+    for (size_t i = 0; i < num_slices; ++i)
+      if (system::send_slice(fds[0], slice))
+        std::exit(EXIT_FAILURE);
+  }};
+  for (size_t i = 0; i < num_slices;) {
+    auto result = system::receive_slice(fds[1]);
+    if (!result) {
+      if (result.error() != ec::stalled)
+        std::exit(EXIT_FAILURE);
+      ::pollfd pfd = {fds[1], POLLIN, 0};
+      ::poll(&pfd, 1, -1);
+      continue;
+    }
+    bench::do_not_optimize(*result);
+    ++i;
+  }
+  sender.join();
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+#endif // VAST_LINUX
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20;
+  factory<table_slice_builder>::initialize();
+  for (auto rows : {size_t{1'000}, size_t{65'536}}) {
+    auto slice = make_slice(rows);
+    auto bytes = as_bytes(slice).size();
+    bench::measure(fmt::format("serialization ({} x {} bytes)", num_slices,
+                               bytes),
+                   iterations, [&] { serialize_over_socket(slice); });
+#if VAST_LINUX
+    bench::measure(fmt::format("memfd ({} x {} bytes)", num_slices, bytes),
+                   iterations, [&] { send_memfd(slice); });
+#endif
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/config.hpp"
+#include "vast/factory.hpp"
+#include "vast/ids.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/type.hpp"
+
+#if VAST_ENABLE_ARROW
+#  include "vast/arrow_table_slice_builder.hpp"
+#endif // VAST_ENABLE_ARROW
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace vast;
+
+namespace {
+
+constexpr size_t num_rows = 65'536;
+
+table_slice make_slice(table_slice_builder& builder) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    auto ok = builder.add(count{i}, -static_cast<integer>(i),
+                          fmt::format("host-{}", i % 1024), real{i * 0.5});
+    if (!ok) {
+      fmt::print(stderr, "failed to add row {}\n", i);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  auto result = builder.finish();
+  result.offset(0);
+  return result;
+}
+
+/// Selects every row but one in 1024.
+ids make_dense_selection() {
+  ids result;
+  for (size_t i = 0; i < num_rows; ++i)
+    result.append_bit(i % 1024 != 0);
+  return result;
+}
+
+/// Selects one row in 128.
+ids make_sparse_selection() {
+  ids result;
+  for (size_t i = 0; i < num_rows; ++i)
+    result.append_bit(i % 128 == 0);
+  return result;
+}
+
+/// Selects runs of 256 rows with gaps of 256 rows.
+ids make_run_selection() {
+  ids result;
+  for (size_t i = 0; i < num_rows; i += 256)
+    result.append_bits((i / 256) % 2 == 0, 256);
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20;
+  factory<table_slice_builder>::initialize();
+  auto layout = record_type{
+    {"c", count_type{}},
+    {"i", integer_type{}},
+    {"s", string_type{}},
+    {"r", real_type{}},
+  }.name("bench");
+  auto selections = std::vector<std::pair<std::string_view, ids>>{
+    {"dense", make_dense_selection()},
+    {"sparse", make_sparse_selection()},
+    {"runs", make_run_selection()},
+  };
+  auto run = [&](std::string_view encoding, table_slice_builder& builder) {
+    auto slice = make_slice(builder);
+    for (auto& [name, selection] : selections) {
+      auto result = select(slice, selection);
+      bench::measure(fmt::format("{} {} ({} slices, {} rows)", encoding, name,
+                                 result.size(), rows(result)),
+                     iterations, [&] {
+                       auto xs = select(slice, selection);
+                       bench::do_not_optimize(xs);
+                     });
+    }
+  };
+  run("msgpack", *msgpack_table_slice_builder::make(layout));
+#if VAST_ENABLE_ARROW
+  run("arrow", *arrow_table_slice_builder::make(layout));
+#endif // VAST_ENABLE_ARROW
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/address.hpp"
+#include "vast/config.hpp"
+#include "vast/factory.hpp"
+#include "vast/format/ascii.hpp"
+#include "vast/format/csv.hpp"
+#include "vast/format/json.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/time.hpp"
+#include "vast/type.hpp"
+
+#include "bench.hpp"
+
+#include <caf/settings.hpp>
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+using namespace vast;
+
+namespace {
+
+/// Discards all output and counts the number of written bytes.
+class counting_buf : public std::streambuf {
+public:
+  size_t bytes = 0;
+
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    bytes += n;
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    ++bytes;
+    return traits_type::not_eof(c);
+  }
+};
+
+table_slice make_slice(const record_type& layout, size_t num_rows) {
+  auto builder = msgpack_table_slice_builder::make(layout);
+  auto ts = time{} + std::chrono::hours{24 * 365 * 50};
+  for (size_t i = 0; i < num_rows; ++i) {
+    auto host = static_cast<uint32_t>(0x0a000000 + i);
+    auto addr = address::v4(&host);
+    auto ok = builder->add(ts + std::chrono::microseconds{i},
+                           fmt::format("C{}", i), addr,
+                           count{i % 65'536}, -static_cast<integer>(i),
+                           real{i * 0.25}, list{count{i}, count{i + 1}});
+    if (!ok) {
+      fmt::print(stderr, "failed to add row {}\n", i);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  auto result = builder->finish();
+  result.offset(0);
+  return result;
+}
+
+template <class Writer>
+void run(std::string_view name, const table_slice& slice, size_t iterations) {
+  auto sb = counting_buf{};
+  auto options = caf::settings{};
+  auto writer = Writer{std::make_unique<std::ostream>(&sb), options};
+  if (auto err = writer.write(slice)) {
+    fmt::print(stderr, "{} failed to write: {}\n", writer.name(),
+               render(err));
+    std::exit(EXIT_FAILURE);
+  }
+  auto bytes_per_run = sb.bytes;
+  bench::measure(fmt::format("{} {} ({} rows, {} bytes)", writer.name(), name,
+                             slice.rows(), bytes_per_run),
+                 iterations, [&] {
+                   auto err = writer.write(slice);
+                   bench::do_not_optimize(err);
+                 });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10;
+  size_t num_rows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 65'536;
+  factory<table_slice_builder>::initialize();
+  auto layout = record_type{
+    {"ts", time_type{}},
+    {"uid", string_type{}},
+    {"id", record_type{{"orig_h", address_type{}}, {"orig_p", count_type{}}}},
+    {"delta", integer_type{}},
+    {"ratio", real_type{}},
+    {"xs", list_type{count_type{}}},
+  }.name("bench");
+  auto slices = std::vector<std::pair<std::string_view, table_slice>>{};
+  slices.emplace_back("msgpack", make_slice(layout, num_rows));
+#if VAST_ENABLE_ARROW
+  auto arrow_slice
+    = rebuild(slices.front().second, table_slice_encoding::arrow);
+  slices.emplace_back("arrow", std::move(arrow_slice));
+#endif // VAST_ENABLE_ARROW
+  for (auto& [name, slice] : slices) {
+    run<format::json::writer>(name, slice, iterations);
+    run<format::csv::writer>(name, slice, iterations);
+    run<format::ascii::writer>(name, slice, iterations);
+  }
+  return EXIT_SUCCESS;
+}
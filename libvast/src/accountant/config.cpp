@@ -15,7 +15,10 @@
 
 #include "vast/component_config.hpp"
 #include "vast/concept/parseable/detail/posix.hpp"
+#include "vast/concept/parseable/to.hpp"
 #include "vast/concept/parseable/vast/table_slice_encoding.hpp"
+#include "vast/concept/parseable/vast/time.hpp"
+#include "vast/error.hpp"
 
 namespace vast::system {
 
@@ -32,6 +35,25 @@ to_accountant_config(const caf::settings& opts) {
   extract_settings(result.uds_sink.path, opts, "uds-sink.path");
   extract_settings(result.uds_sink.real_time, opts, "uds-sink.real-time");
   extract_settings(result.uds_sink.type, opts, "uds-sink.type");
+  auto format = std::string{"json"};
+  extract_settings(format, opts, "uds-sink.format");
+  if (format == "binary")
+    result.uds_sink.binary = true;
+  else if (format != "json")
+    return caf::make_error(ec::invalid_configuration,
+                           "invalid metrics uds-sink format:", format);
+  extract_settings(result.prometheus_sink.enable, opts,
+                   "prometheus-sink.enable");
+  extract_settings(result.prometheus_sink.path, opts, "prometheus-sink.path");
+  if (auto str = caf::get_if<std::string>(&opts, "sample-interval")) {
+    auto interval = to<duration>(*str);
+    if (!interval)
+      return interval.error();
+    if (*interval <= duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             "metrics sample-interval must be positive:", *str);
+    result.sample_interval = *interval;
+  }
   return result;
 }
 
@@ -25,6 +25,7 @@
 #  include "vast/error.hpp"
 #  include "vast/fbs/table_slice.hpp"
 #  include "vast/fbs/utils.hpp"
+#  include "vast/layout_interner.hpp"
 #  include "vast/logger.hpp"
 #  include "vast/value_index.hpp"
 
@@ -430,10 +431,12 @@ data_view value_at(const type& t, const Array& arr, size_t row) {
 
 // -- access to entire column --------------------------------------------------
 
-class index_applier {
+/// Invokes a function with the row and the value of every non-null element
+/// in a column.
+template <class F>
+class column_applier {
 public:
-  index_applier(size_t offset, value_index& idx)
-    : offset_(detail::narrow_cast<int64_t>(offset)), idx_(idx) {
+  explicit column_applier(F f) : f_(std::move(f)) {
     // nop
   }
 
@@ -441,7 +444,7 @@ public:
   void apply(const Array& arr, Getter f) {
     for (int64_t row = 0; row < arr.length(); ++row)
       if (!arr.IsNull(row))
-        idx_.append(f(arr, row), detail::narrow_cast<size_t>(offset_ + row));
+        f_(row, f(arr, row));
   }
 
   void operator()(const arrow::BooleanArray& arr, const bool_type&) {
@@ -510,8 +513,7 @@ public:
   }
 
 private:
-  int64_t offset_;
-  value_index& idx_;
+  F f_;
 };
 
 // -- utility for converting Buffer to RecordBatch -----------------------------
@@ -588,8 +590,14 @@ template <class FlatBuffer>
 arrow_table_slice<FlatBuffer>::arrow_table_slice(
   const FlatBuffer& slice) noexcept
   : slice_{slice}, state_{} {
-  if (auto err = fbs::deserialize_bytes(slice_.layout(), state_.layout))
-    die("failed to deserialize layout: " + render(err));
+  const auto* bytes = slice_.layout();
+  if (!bytes)
+    die("failed to deserialize layout: no input");
+  auto layout = layout_interner::instance().intern(
+    span{reinterpret_cast<const std::byte*>(bytes->data()), bytes->size()});
+  if (!layout)
+    die("failed to deserialize layout: " + render(layout.error()));
+  state_.layout = *layout;
   auto decoder = record_batch_decoder{};
   state_.record_batch = decoder.decode(slice.schema(), slice.record_batch());
 }
@@ -598,7 +606,15 @@ template <class FlatBuffer>
 arrow_table_slice<FlatBuffer>::arrow_table_slice(const FlatBuffer& slice,
                                                  record_type layout) noexcept
   : slice_{slice}, state_{} {
-  state_.layout = std::move(layout);
+  // Look up the layout by the serialized form that the slice carries anyway,
+  // which avoids hashing the deep layout for every table slice.
+  auto& interner = layout_interner::instance();
+  if (const auto* bytes = slice_.layout())
+    state_.layout = &interner.intern(
+      span{reinterpret_cast<const std::byte*>(bytes->data()), bytes->size()},
+      layout);
+  else
+    state_.layout = &interner.intern(layout);
   auto decoder = record_batch_decoder{};
   state_.record_batch = decoder.decode(slice.schema(), slice.record_batch());
 }
@@ -612,7 +628,13 @@ arrow_table_slice<FlatBuffer>::~arrow_table_slice() noexcept {
 
 template <class FlatBuffer>
 const record_type& arrow_table_slice<FlatBuffer>::layout() const noexcept {
-  return state_.layout;
+  return state_.layout->layout;
+}
+
+template <class FlatBuffer>
+const interned_layout&
+arrow_table_slice<FlatBuffer>::interned() const noexcept {
+  return *state_.layout;
 }
 
 template <class FlatBuffer>
@@ -635,11 +657,31 @@ template <class FlatBuffer>
 void arrow_table_slice<FlatBuffer>::append_column_to_index(
   id offset, table_slice::size_type column, value_index& index) const {
   if (auto&& batch = record_batch()) {
-    auto f = index_applier{offset, index};
+    auto f = column_applier{[&, offset](int64_t row, data_view x) {
+      index.append(std::move(x), offset + detail::narrow_cast<size_t>(row));
+    }};
+    auto array = batch->column(detail::narrow_cast<int>(column));
+    decode(state_.layout->flat_layout.fields[column].type, *array, f);
+  }
+}
+
+template <class FlatBuffer>
+void arrow_table_slice<FlatBuffer>::decode_columns(
+  std::vector<std::vector<data_view>>& result) const {
+  result.resize(columns());
+  auto&& batch = record_batch();
+  if (!batch)
+    return;
+  for (size_t column = 0; column < result.size(); ++column) {
+    // Null values remain default-constructed.
+    auto& xs = result[column];
+    xs.clear();
+    xs.resize(rows());
+    auto f = column_applier{[&](int64_t row, data_view x) {
+      xs[detail::narrow_cast<size_t>(row)] = std::move(x);
+    }};
     auto array = batch->column(detail::narrow_cast<int>(column));
-    auto offset = state_.layout.offset_from_index(column);
-    VAST_ASSERT(offset);
-    decode(state_.layout.at(*offset)->type, *array, f);
+    decode(state_.layout->flat_layout.fields[column].type, *array, f);
   }
 }
 
@@ -650,17 +692,14 @@ arrow_table_slice<FlatBuffer>::at(table_slice::size_type row,
   auto&& batch = record_batch();
   VAST_ASSERT(batch);
   auto array = batch->column(detail::narrow_cast<int>(column));
-  auto offset = state_.layout.offset_from_index(column);
-  VAST_ASSERT(offset);
-  return value_at(state_.layout.at(*offset)->type, *array, row);
+  return value_at(state_.layout->flat_layout.fields[column].type, *array, row);
 }
 
 template <class FlatBuffer>
 data_view arrow_table_slice<FlatBuffer>::at(table_slice::size_type row,
                                             table_slice::size_type column,
                                             const type& t) const {
-  VAST_ASSERT(state_.layout.at(*state_.layout.offset_from_index(column))->type
-              == t);
+  VAST_ASSERT(state_.layout->flat_layout.fields[column].type == t);
   auto&& batch = record_batch();
   VAST_ASSERT(batch);
   auto array = batch->column(detail::narrow_cast<int>(column));
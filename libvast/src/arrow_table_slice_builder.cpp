@@ -388,6 +388,49 @@ private:
   std::unique_ptr<column_builder> val_builder_;
 };
 
+/// Serializes a record batch into an Arrow-encoded table slice.
+table_slice make_arrow_table_slice(flatbuffers::FlatBufferBuilder& builder,
+                                   const arrow::RecordBatch& record_batch,
+                                   const record_type& layout,
+                                   span<const std::byte> serialized_layout) {
+  // Pack layout.
+  auto layout_buffer
+    = serialized_layout.empty()
+        ? *fbs::serialize_bytes(builder, layout)
+        : builder.CreateVector(
+          reinterpret_cast<const unsigned char*>(serialized_layout.data()),
+          serialized_layout.size());
+  // Pack schema.
+#  if ARROW_VERSION_MAJOR >= 2
+  auto flat_schema
+    = arrow::ipc::SerializeSchema(*record_batch.schema()).ValueOrDie();
+#  else
+  auto flat_schema
+    = arrow::ipc::SerializeSchema(*record_batch.schema(), nullptr).ValueOrDie();
+#  endif
+  auto schema_buffer
+    = builder.CreateVector(flat_schema->data(), flat_schema->size());
+  // Pack record batch. Note that serializing a sliced record batch only
+  // writes the sliced range of its buffers.
+  auto flat_record_batch
+    = arrow::ipc::SerializeRecordBatch(record_batch,
+                                       arrow::ipc::IpcWriteOptions::Defaults())
+        .ValueOrDie();
+  auto record_batch_buffer = builder.CreateVector(flat_record_batch->data(),
+                                                  flat_record_batch->size());
+  // Create Arrow-encoded table slices.
+  auto arrow_table_slice_buffer = fbs::table_slice::arrow::Createv0(
+    builder, layout_buffer, schema_buffer, record_batch_buffer);
+  // Create and finish table slice.
+  auto table_slice_buffer
+    = fbs::CreateTableSlice(builder, fbs::table_slice::TableSlice::arrow_v0,
+                            arrow_table_slice_buffer.Union());
+  fbs::FinishTableSliceBuffer(builder, table_slice_buffer);
+  // Create the table slice from the chunk.
+  auto chunk = fbs::release(builder);
+  return table_slice{std::move(chunk), table_slice::verify::no, layout};
+}
+
 } // namespace
 
 // -- member types -------------------------------------------------------------
@@ -454,48 +497,26 @@ table_slice arrow_table_slice_builder::finish(
   // Sanity check: If this triggers, the calls to add() did not match the number
   // of fields in the layout.
   VAST_ASSERT(column_ == 0);
-  // Pack layout.
-  auto layout_buffer
-    = serialized_layout.empty()
-        ? *fbs::serialize_bytes(builder_, layout())
-        : builder_.CreateVector(
-          reinterpret_cast<const unsigned char*>(serialized_layout.data()),
-          serialized_layout.size());
-  // Pack schema.
-#if ARROW_VERSION_MAJOR >= 2
-  auto flat_schema = arrow::ipc::SerializeSchema(*schema_).ValueOrDie();
-#else
-  auto flat_schema
-    = arrow::ipc::SerializeSchema(*schema_, nullptr).ValueOrDie();
-#endif
-  auto schema_buffer
-    = builder_.CreateVector(flat_schema->data(), flat_schema->size());
-  // Pack record batch.
   auto columns = std::vector<std::shared_ptr<arrow::Array>>{};
   columns.reserve(column_builders_.size());
   for (auto&& builder : column_builders_)
     columns.emplace_back(builder->finish());
   auto record_batch
     = arrow::RecordBatch::Make(schema_, rows_, std::move(columns));
-  auto flat_record_batch
-    = arrow::ipc::SerializeRecordBatch(*record_batch,
-                                       arrow::ipc::IpcWriteOptions::Defaults())
-        .ValueOrDie();
-  auto record_batch_buffer = builder_.CreateVector(flat_record_batch->data(),
-                                                   flat_record_batch->size());
-  // Create Arrow-encoded table slices.
-  auto arrow_table_slice_buffer = fbs::table_slice::arrow::Createv0(
-    builder_, layout_buffer, schema_buffer, record_batch_buffer);
-  // Create and finish table slice.
-  auto table_slice_buffer
-    = fbs::CreateTableSlice(builder_, fbs::table_slice::TableSlice::arrow_v0,
-                            arrow_table_slice_buffer.Union());
-  fbs::FinishTableSliceBuffer(builder_, table_slice_buffer);
   // Reset the builder state.
   rows_ = {};
-  // Create the table slice from the chunk.
-  auto chunk = fbs::release(builder_);
-  return table_slice{std::move(chunk), table_slice::verify::no, layout()};
+  return make_arrow_table_slice(builder_, *record_batch, layout(),
+                                serialized_layout);
+}
+
+table_slice
+arrow_table_slice_builder::create(const arrow::RecordBatch& record_batch,
+                                  const record_type& layout,
+                                  span<const std::byte> serialized_layout,
+                                  size_t initial_buffer_size) {
+  auto builder = flatbuffers::FlatBufferBuilder{initial_buffer_size};
+  return make_arrow_table_slice(builder, record_batch, layout,
+                                serialized_layout);
 }
 
 size_t arrow_table_slice_builder::rows() const noexcept {
@@ -42,11 +42,17 @@ size_t bool_synopsis::memusage() const {
 
 caf::optional<bool> bool_synopsis::lookup(relational_operator op,
                                           data_view rhs) const {
+  return lookup(true_, false_, op, rhs);
+}
+
+caf::optional<bool> bool_synopsis::lookup(bool any_true, bool any_false,
+                                          relational_operator op,
+                                          data_view rhs) {
   if (auto b = caf::get_if<view<bool>>(&rhs)) {
     if (op == relational_operator::equal)
-      return *b ? true_ : false_;
+      return *b ? any_true : any_false;
     if (op == relational_operator::not_equal)
-      return *b ? false_ : true_;
+      return *b ? any_false : any_true;
   }
   return caf::none;
 }
@@ -0,0 +1,180 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/community_id_enricher.hpp"
+
+#include "vast/community_id.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/view.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string_view>
+
+namespace vast {
+
+namespace {
+
+/// The fields that make up the flow tuple of a well-known flow layout.
+struct flow_fields {
+  std::string_view layout;
+  std::array<std::string_view, 5> keys;
+};
+
+constexpr auto flow_layouts = std::array{
+  flow_fields{"zeek.conn",
+              {"id.orig_h", "id.orig_p", "id.resp_h", "id.resp_p", "proto"}},
+  flow_fields{"suricata.flow",
+              {"src_ip", "src_port", "dest_ip", "dest_port", "proto"}},
+};
+
+/// Parses the protocol names of Zeek and Suricata, e.g., `tcp` and `TCP`.
+caf::optional<port_type> to_port_type(std::string_view proto) {
+  auto is = [&](std::string_view x) {
+    auto eq = [](char c, char lower) {
+      return std::tolower(static_cast<unsigned char>(c)) == lower;
+    };
+    return std::equal(proto.begin(), proto.end(), x.begin(), x.end(), eq);
+  };
+  if (is("tcp"))
+    return port_type::tcp;
+  if (is("udp"))
+    return port_type::udp;
+  if (is("icmp"))
+    return port_type::icmp;
+  if (is("icmp6") || is("ipv6-icmp"))
+    return port_type::icmp6;
+  if (is("sctp"))
+    return port_type::sctp;
+  return caf::none;
+}
+
+caf::optional<uint16_t> to_port_number(data_view x) {
+  if (auto p = caf::get_if<view<port>>(&x))
+    return p->number();
+  if (auto n = caf::get_if<view<count>>(&x); n && *n <= 0xffff)
+    return static_cast<uint16_t>(*n);
+  return caf::none;
+}
+
+} // namespace
+
+community_id_enricher::layout_plan
+community_id_enricher::make_plan(const record_type& layout) {
+  layout_plan result;
+  auto i = std::find_if(flow_layouts.begin(), flow_layouts.end(),
+                        [&](auto& x) { return x.layout == layout.name(); });
+  if (i == flow_layouts.end())
+    return result;
+  for (auto key : i->keys) {
+    auto index = caf::optional<size_t>{};
+    if (auto o = layout.resolve(key))
+      index = layout.flat_index_at(*o);
+    if (!index) {
+      VAST_DEBUG("community-id-enricher skips layout {} without field {}",
+                 layout.name(), key);
+      result.flow_columns.clear();
+      return result;
+    }
+    result.flow_columns.push_back(*index);
+  }
+  result.layout = layout;
+  if (auto o = layout.resolve("community_id"))
+    result.community_id_column = layout.flat_index_at(*o);
+  else
+    result.layout.fields.emplace_back(
+      "community_id", string_type{}.attributes({{"index", "hash"}}));
+  return result;
+}
+
+table_slice community_id_enricher::operator()(table_slice slice) {
+  const auto& layout = slice.interned();
+  auto* plan = plans_.find(layout.id);
+  if (!plan)
+    plan = &plans_.insert(layout.id, make_plan(layout.layout));
+  if (plan->flow_columns.empty())
+    return slice;
+  const auto& types = layout.flat_layout.fields;
+  auto column = [&](size_t row, size_t col) {
+    return slice.at(row, col, types[col].type);
+  };
+  // Collect the flow tuples of all events that lack a Community ID.
+  flows_.clear();
+  rows_.assign(slice.rows(), caf::none);
+  for (size_t row = 0; row < slice.rows(); ++row) {
+    if (plan->community_id_column
+        && !caf::holds_alternative<caf::none_t>(
+          column(row, *plan->community_id_column)))
+      continue;
+    auto& cols = plan->flow_columns;
+    auto src_addr = column(row, cols[0]);
+    auto src_port = to_port_number(column(row, cols[1]));
+    auto dst_addr = column(row, cols[2]);
+    auto dst_port = to_port_number(column(row, cols[3]));
+    auto proto = column(row, cols[4]);
+    auto src = caf::get_if<view<address>>(&src_addr);
+    auto dst = caf::get_if<view<address>>(&dst_addr);
+    auto name = caf::get_if<view<std::string>>(&proto);
+    if (!src || !src_port || !dst || !dst_port || !name)
+      continue;
+    auto type = to_port_type(*name);
+    if (!type)
+      continue;
+    rows_[row] = flows_.size();
+    flows_.push_back(make_flow(*src, *dst, *src_port, *dst_port, *type));
+  }
+  if (flows_.empty() && plan->community_id_column)
+    return slice;
+  arena_.clear();
+  community_id::compute<policy::base64>(span{flows_.data(), flows_.size()},
+                                        arena_);
+  constexpr auto n = community_id::length<policy::base64>();
+  auto id_of = [&](size_t row) -> data_view {
+    if (!rows_[row])
+      return caf::none;
+    return std::string_view{arena_}.substr(*rows_[row] * n, n);
+  };
+  // Copy the table slice and add the Community IDs.
+  auto builder
+    = factory<table_slice_builder>::make(slice.encoding(), plan->layout);
+  if (!builder) {
+    VAST_WARN("community-id-enricher failed to create a builder for {}",
+              plan->layout.name());
+    return slice;
+  }
+  for (size_t row = 0; row < slice.rows(); ++row) {
+    for (size_t col = 0; col < slice.columns(); ++col) {
+      auto x = plan->community_id_column && col == *plan->community_id_column
+                   && rows_[row]
+                 ? id_of(row)
+                 : column(row, col);
+      if (!builder->add(x)) {
+        VAST_WARN("community-id-enricher failed to add a value to {}",
+                  plan->layout.name());
+        return slice;
+      }
+    }
+    if (!plan->community_id_column && !builder->add(id_of(row))) {
+      VAST_WARN("community-id-enricher failed to add a value to {}",
+                plan->layout.name());
+      return slice;
+    }
+  }
+  auto result = builder->finish();
+  result.offset(slice.offset());
+  return result;
+}
+
+} // namespace vast
@@ -23,8 +23,10 @@
 
 #include "vast/concept/hashable/sha1.hpp"
 
+#include <algorithm>
 #include <cstring>
 
+#include "vast/detail/assert.hpp"
 #include "vast/detail/byte_swap.hpp"
 
 namespace vast {
@@ -160,4 +162,76 @@ void sha1::transform(const unsigned char* data, size_t num_blks) {
   }
 }
 
+namespace {
+
+/// Runs 20 rounds of the SHA-1 compression function on all lanes.
+template <size_t Lanes, class F>
+void rounds(size_t first, uint32_t k, F f, uint32_t (&w)[16][Lanes],
+            uint32_t (&h)[5][Lanes]) {
+  for (auto t = first; t < first + 20; ++t) {
+    for (size_t l = 0; l < Lanes; ++l) {
+      auto& x = w[t % 16][l];
+      if (t >= 16)
+        x = rotate_left(w[(t - 3) % 16][l] ^ w[(t - 8) % 16][l]
+                          ^ w[(t - 14) % 16][l] ^ x,
+                        1);
+      auto T = rotate_left(h[0][l], 5) + f(h[1][l], h[2][l], h[3][l])
+               + h[4][l] + k + x;
+      h[4][l] = h[3][l];
+      h[3][l] = h[2][l];
+      h[2][l] = rotate_left(h[1][l], 30);
+      h[1][l] = h[0][l];
+      h[0][l] = T;
+    }
+  }
+}
+
+} // namespace
+
+void sha1_batch::operator()(const void* xs, size_t n) noexcept {
+  VAST_ASSERT(pos_ + n <= max_message_size);
+  std::memcpy(current_.data() + pos_, xs, n);
+  pos_ += n;
+}
+
+void sha1_batch::finish_message() noexcept {
+  // A single block holds the message, the padding, and the message length.
+  current_[pos_] = 0x80;
+  std::memset(current_.data() + pos_ + 1, 0, 56 - pos_ - 1);
+  uint64_t mlen = detail::byte_swap(uint64_t{pos_ * 8});
+  std::memcpy(current_.data() + 56, &mlen, 8);
+  blocks_.push_back(current_);
+  pos_ = 0;
+}
+
+size_t sha1_batch::size() const noexcept {
+  return blocks_.size();
+}
+
+void sha1_batch::digest(result_type* digests) noexcept {
+  static constexpr uint32_t init[5]
+    = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+  for (size_t first = 0; first < blocks_.size(); first += lanes) {
+    auto n = std::min(lanes, blocks_.size() - first);
+    // Transpose the blocks such that every word holds one value per lane.
+    uint32_t w[16][lanes] = {};
+    for (size_t l = 0; l < n; ++l) {
+      auto xs = reinterpret_cast<const uint32_t*>(blocks_[first + l].data());
+      for (size_t i = 0; i < 16; ++i)
+        w[i][l] = detail::byte_swap(xs[i]);
+    }
+    uint32_t h[5][lanes];
+    for (size_t i = 0; i < 5; ++i)
+      std::fill_n(h[i], lanes, init[i]);
+    rounds(0, K[0], choice, w, h);
+    rounds(20, K[1], parity, w, h);
+    rounds(40, K[2], majority, w, h);
+    rounds(60, K[3], parity, w, h);
+    for (size_t l = 0; l < n; ++l)
+      for (size_t i = 0; i < 5; ++i)
+        digests[first + l][i] = detail::byte_swap(init[i] + h[i][l]);
+  }
+  blocks_.clear();
+}
+
 } // namespace vast
@@ -33,6 +33,7 @@
 #include "vast/system/actors.hpp"
 #include "vast/system/component_registry.hpp"
 #include "vast/system/query_status.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/type_registry.hpp"
 #include "vast/table_slice.hpp"
@@ -0,0 +1,303 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/detail/datagram_receiver.hpp"
+
+#include "vast/config.hpp"
+
+#if VAST_LINUX
+#  ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#  endif // _GNU_SOURCE
+#endif   // VAST_LINUX
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace vast::detail {
+
+namespace {
+
+// The maximum number of datagrams per system call.
+constexpr size_t max_batch_size = 256;
+
+// The space for the ancillary data of a single datagram, which carries the
+// drop counter of the socket.
+constexpr size_t control_size = CMSG_SPACE(sizeof(uint32_t));
+
+} // namespace
+
+struct datagram_receiver::headers {
+#if VAST_LINUX
+  std::vector<::mmsghdr> messages;
+
+  ::msghdr& get(size_t i) {
+    return messages[i].msg_hdr;
+  }
+#else  // VAST_LINUX
+  std::vector<::msghdr> messages;
+
+  ::msghdr& get(size_t i) {
+    return messages[i];
+  }
+#endif // VAST_LINUX
+  std::vector<::iovec> iovecs;
+  std::vector<char> control;
+  // The last observed value of the 32-bit drop counter of the socket.
+  uint32_t overflow = 0;
+};
+
+caf::expected<std::unique_ptr<datagram_receiver>>
+datagram_receiver::make(uint16_t port, size_t capacity, size_t max_size,
+                        int receive_buffer, std::function<void()> notify) {
+  if (capacity == 0 || max_size == 0)
+    return caf::make_error(ec::invalid_argument, "datagram receiver requires "
+                                                 "a non-empty buffer");
+  auto fail = [](int fd, const char* what) {
+    auto err = caf::make_error(ec::system_error, what, std::strerror(errno));
+    if (fd >= 0)
+      ::close(fd);
+    return err;
+  };
+  // Prefer a dual-stack socket, and fall back to IPv4 if the system does not
+  // support IPv6.
+  auto fd = ::socket(AF_INET6, SOCK_DGRAM, 0);
+  if (fd >= 0) {
+    int off = 0;
+    ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    ::sockaddr_in6 addr = {};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(port);
+    if (::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) != 0)
+      return fail(fd, "failed to bind UDP socket:");
+  } else if (errno == EAFNOSUPPORT) {
+    fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+      return fail(fd, "failed to create UDP socket:");
+    ::sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) != 0)
+      return fail(fd, "failed to bind UDP socket:");
+  } else {
+    return fail(fd, "failed to create UDP socket:");
+  }
+  // The kernel silently caps the receive buffer at net.core.rmem_max.
+  if (::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer,
+                   sizeof(receive_buffer))
+      != 0)
+    VAST_DEBUG("datagram receiver failed to set the receive buffer size: {}",
+               std::strerror(errno));
+#ifdef SO_RXQ_OVFL
+  int on = 1;
+  if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) != 0)
+    VAST_DEBUG("datagram receiver cannot count dropped datagrams: {}",
+               std::strerror(errno));
+#endif // SO_RXQ_OVFL
+  return std::unique_ptr<datagram_receiver>{
+    new datagram_receiver{fd, capacity, max_size, std::move(notify)}};
+}
+
+datagram_receiver::datagram_receiver(int fd, size_t capacity, size_t max_size,
+                                     std::function<void()> notify)
+  : fd_{fd},
+    capacity_{capacity},
+    // Each slot has room for a trailing newline that separates datagrams.
+    slot_size_{max_size + 1},
+    notify_{std::move(notify)},
+    buffer_(capacity * slot_size_),
+    lengths_(capacity),
+    headers_{std::make_unique<headers>()} {
+  headers_->messages.resize(capacity);
+  headers_->iovecs.resize(capacity);
+  headers_->control.resize(capacity * control_size);
+  for (size_t i = 0; i < capacity; ++i) {
+    auto& iov = headers_->iovecs[i];
+    iov.iov_base = buffer_.data() + i * slot_size_;
+    iov.iov_len = max_size;
+    auto& msg = headers_->get(i);
+    msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = headers_->control.data() + i * control_size;
+  }
+  thread_ = std::thread{[this] { run(); }};
+}
+
+datagram_receiver::~datagram_receiver() {
+  stop_ = true;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    space_.notify_all();
+  }
+  thread_.join();
+  ::close(fd_);
+}
+
+uint16_t datagram_receiver::port() const {
+  ::sockaddr_storage addr = {};
+  ::socklen_t len = sizeof(addr);
+  if (::getsockname(fd_, reinterpret_cast<::sockaddr*>(&addr), &len) != 0)
+    return 0;
+  if (addr.ss_family == AF_INET6)
+    return ntohs(reinterpret_cast<::sockaddr_in6*>(&addr)->sin6_port);
+  return ntohs(reinterpret_cast<::sockaddr_in*>(&addr)->sin_port);
+}
+
+size_t datagram_receiver::available() const {
+  return head_ - tail_;
+}
+
+datagram_receiver::statistics datagram_receiver::stats() const {
+  return {received_, dropped_, truncated_};
+}
+
+void datagram_receiver::rearm() {
+  notified_ = false;
+}
+
+datagram_receiver::int_type datagram_receiver::underflow() {
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  // Hand the slot of the exhausted datagram back to the receiver thread.
+  auto tail = tail_.load();
+  if (mapped_) {
+    tail_ = ++tail;
+    mapped_ = false;
+    if (waiting_) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      space_.notify_one();
+    }
+  }
+  if (tail == head_) {
+    setg(nullptr, nullptr, nullptr);
+    return traits_type::eof();
+  }
+  auto slot = tail % capacity_;
+  auto first = buffer_.data() + slot * slot_size_;
+  setg(first, first, first + lengths_[slot]);
+  mapped_ = true;
+  return traits_type::to_int_type(*gptr());
+}
+
+int datagram_receiver::receive(size_t first, size_t n) {
+  for (auto i = first; i < first + n; ++i) {
+    auto& msg = headers_->get(i);
+    msg.msg_controllen = control_size;
+    msg.msg_flags = 0;
+  }
+#if VAST_LINUX
+  int result;
+  do {
+    result = ::recvmmsg(fd_, &headers_->messages[first], n, MSG_DONTWAIT,
+                        nullptr);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+  for (auto i = first; i < first + static_cast<size_t>(result); ++i)
+    lengths_[i] = headers_->messages[i].msg_len;
+  return result;
+#else  // VAST_LINUX
+  int result = 0;
+  for (auto i = first; i < first + n; ++i) {
+    auto bytes = ::recvmsg(fd_, &headers_->get(i), MSG_DONTWAIT);
+    if (bytes < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK || result > 0)
+        break;
+      return -1;
+    }
+    lengths_[i] = static_cast<size_t>(bytes);
+    ++result;
+  }
+  return result;
+#endif // VAST_LINUX
+}
+
+void datagram_receiver::run() {
+  auto max_size = slot_size_ - 1;
+  while (!stop_) {
+    auto head = head_.load();
+    auto tail = tail_.load();
+    auto space = capacity_ - (head - tail);
+    if (space == 0) {
+      // The consumer fell behind; the kernel buffers or drops datagrams until
+      // it frees a slot.
+      std::unique_lock<std::mutex> lock{mutex_};
+      waiting_ = true;
+      space_.wait_for(lock, std::chrono::milliseconds{100},
+                      [&] { return stop_ || tail_ != tail; });
+      waiting_ = false;
+      continue;
+    }
+    ::pollfd pfd = {fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, 100) <= 0)
+      continue;
+    auto first = head % capacity_;
+    auto n = std::min({space, capacity_ - first, max_batch_size});
+    auto received = receive(first, n);
+    if (received < 0) {
+      VAST_WARN("datagram receiver failed to receive datagrams: {}",
+                std::strerror(errno));
+      continue;
+    }
+    if (received == 0)
+      continue;
+    for (auto i = first; i < first + static_cast<size_t>(received); ++i) {
+      auto& msg = headers_->get(i);
+      if (msg.msg_flags & MSG_TRUNC)
+        ++truncated_;
+#ifdef SO_RXQ_OVFL
+      for (auto c = CMSG_FIRSTHDR(&msg); c != nullptr;
+           c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+          uint32_t overflow;
+          std::memcpy(&overflow, CMSG_DATA(c), sizeof(overflow));
+          // The kernel counter wraps around at 2^32.
+          dropped_ += static_cast<uint32_t>(overflow - headers_->overflow);
+          headers_->overflow = overflow;
+        }
+      }
+#endif // SO_RXQ_OVFL
+      // Terminate every datagram with a newline, such that line-based readers
+      // parse the datagrams of a batch as separate messages.
+      auto& length = lengths_[i];
+      length = std::min(length, max_size);
+      auto data = buffer_.data() + i * slot_size_;
+      if (length == 0 || data[length - 1] != '\n')
+        data[length++] = '\n';
+    }
+    head_ = head + received;
+    received_ += received;
+    if (!notified_.exchange(true))
+      notify_();
+  }
+}
+
+} // namespace vast::detail
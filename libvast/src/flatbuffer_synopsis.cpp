@@ -0,0 +1,150 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/flatbuffer_synopsis.hpp"
+
+#include "vast/bool_synopsis.hpp"
+#include "vast/chunk.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
+#include "vast/error.hpp"
+#include "vast/hasher.hpp"
+#include "vast/min_max_synopsis.hpp"
+#include "vast/word.hpp"
+
+#include <caf/deserializer.hpp>
+#include <caf/serializer.hpp>
+
+namespace vast {
+
+namespace {
+
+/// Probes a Bloom filter in its FlatBuffer representation. This must be kept
+/// in sync with `bloom_filter::lookup` for the `no_partitioning` policy.
+template <class T>
+caf::optional<bool>
+bloom_filter_lookup(const fbs::bloom_filter_synopsis::v0& bf,
+                    relational_operator op, data_view rhs) {
+  using word_type = word<uint64_t>;
+  auto size = bf.size();
+  auto bits = bf.bits();
+  auto seeds = bf.seeds();
+  if (size == 0 || bf.num_hash_functions() == 0 || !bits || !seeds
+      || seeds->size() != 2 || bits->size() * word_type::width < size)
+    return caf::none;
+  auto hasher = double_hasher<xxhash64>{
+    bf.num_hash_functions(), {seeds->Get(0), seeds->Get(1)}};
+  auto test = [&](const view<T>& x) {
+    for (auto digest : hasher(x)) {
+      auto i = digest % size;
+      auto block = bits->Get(i / word_type::width);
+      if ((block & word_type::mask(i % word_type::width)) == 0)
+        return false;
+    }
+    return true;
+  };
+  switch (op) {
+    default:
+      return caf::none;
+    case relational_operator::equal:
+      if (auto x = caf::get_if<view<T>>(&rhs))
+        return test(*x);
+      return caf::none;
+    case relational_operator::in:
+      if (auto xs = caf::get_if<view<list>>(&rhs)) {
+        for (auto x : **xs) {
+          auto y = caf::get_if<view<T>>(&x);
+          if (!y)
+            return caf::none;
+          if (test(*y))
+            return true;
+        }
+        return false;
+      }
+      return caf::none;
+  }
+}
+
+} // namespace
+
+flatbuffer_synopsis::flatbuffer_synopsis(vast::type x, chunk_ptr chunk,
+                                         const fbs::synopsis::v0& fb)
+  : synopsis{std::move(x)}, chunk_{std::move(chunk)}, fb_{&fb} {
+  VAST_ASSERT(is_lazily_evaluable(fb));
+}
+
+void flatbuffer_synopsis::add(data_view) {
+  VAST_ASSERT(!"flatbuffer synopses are immutable");
+}
+
+caf::optional<bool>
+flatbuffer_synopsis::lookup(relational_operator op, data_view rhs) const {
+  if (auto ts = fb_->time_synopsis())
+    return min_max_synopsis<time>::lookup(time{} + duration{ts->start()},
+                                          time{} + duration{ts->end()}, op,
+                                          rhs);
+  if (auto bs = fb_->bool_synopsis())
+    return bool_synopsis::lookup(bs->any_true(), bs->any_false(), op, rhs);
+  if (auto bf = fb_->bloom_filter_synopsis()) {
+    if (caf::holds_alternative<address_type>(type()))
+      return bloom_filter_lookup<address>(*bf, op, rhs);
+    if (caf::holds_alternative<string_type>(type()))
+      return bloom_filter_lookup<std::string>(*bf, op, rhs);
+  }
+  // We cannot rule out anything we don't understand.
+  return caf::none;
+}
+
+size_t flatbuffer_synopsis::memusage() const {
+  return sizeof(flatbuffer_synopsis);
+}
+
+bool flatbuffer_synopsis::equals(const synopsis& other) const noexcept {
+  auto self = materialize();
+  if (!self || !*self)
+    return false;
+  if (auto fb = dynamic_cast<const flatbuffer_synopsis*>(&other)) {
+    auto rhs = fb->materialize();
+    return rhs && *rhs && (*self)->equals(**rhs);
+  }
+  return (*self)->equals(other);
+}
+
+caf::error flatbuffer_synopsis::serialize(caf::serializer& sink) const {
+  auto x = materialize();
+  if (!x)
+    return x.error();
+  return (*x)->serialize(sink);
+}
+
+caf::error flatbuffer_synopsis::deserialize(caf::deserializer&) {
+  return caf::make_error(ec::logic_error, "attempted to deserialize a "
+                                          "flatbuffer_synopsis");
+}
+
+caf::expected<synopsis_ptr> flatbuffer_synopsis::materialize() const {
+  synopsis_ptr result;
+  if (auto error = unpack(*fb_, result))
+    return error;
+  return result;
+}
+
+const fbs::synopsis::v0& flatbuffer_synopsis::flatbuffer() const noexcept {
+  return *fb_;
+}
+
+bool is_lazily_evaluable(const fbs::synopsis::v0& fb) {
+  return fb.time_synopsis() || fb.bool_synopsis()
+         || fb.bloom_filter_synopsis();
+}
+
+} // namespace vast
@@ -23,45 +23,133 @@
 #  include "vast/detail/string.hpp"
 #  include "vast/error.hpp"
 #  include "vast/format/arrow.hpp"
+#  include "vast/logger.hpp"
 #  include "vast/table_slice_builder.hpp"
 #  include "vast/type.hpp"
 
 #  include <caf/none.hpp>
+#  include <caf/settings.hpp>
 
+#  include <arrow/api.h>
+#  include <arrow/array/concatenate.h>
+#  include <arrow/io/file.h>
 #  include <arrow/util/config.h>
 #  include <arrow/util/io_util.h>
 
+#  include <algorithm>
+#  include <cerrno>
+#  include <cstring>
 #  include <stdexcept>
+#  include <string>
+
+#  include <fcntl.h>
+#  include <unistd.h>
 
 namespace vast::format::arrow {
 
+namespace {
+
+/// Concatenates the record batches of table slices with the same layout.
+caf::expected<std::shared_ptr<::arrow::RecordBatch>>
+concatenate(const std::vector<table_slice>& slices) {
+  VAST_ASSERT(!slices.empty());
+  if (slices.size() == 1)
+    return as_record_batch(slices[0]);
+  auto batches = std::vector<std::shared_ptr<::arrow::RecordBatch>>{};
+  batches.reserve(slices.size());
+  int64_t rows = 0;
+  for (const auto& slice : slices) {
+    batches.push_back(as_record_batch(slice));
+    rows += batches.back()->num_rows();
+  }
+  auto schema = batches[0]->schema();
+  auto columns = ::arrow::ArrayVector{};
+  columns.reserve(schema->num_fields());
+  for (int column = 0; column < schema->num_fields(); ++column) {
+    auto arrays = ::arrow::ArrayVector{};
+    arrays.reserve(batches.size());
+    for (const auto& batch : batches)
+      arrays.push_back(batch->column(column));
+    auto concatenated = ::arrow::Concatenate(arrays);
+    if (!concatenated.ok())
+      return caf::make_error(ec::unspecified,
+                             "failed to concatenate record batches",
+                             concatenated.status().ToString());
+    columns.push_back(std::move(*concatenated));
+  }
+  return ::arrow::RecordBatch::Make(std::move(schema), rows,
+                                    std::move(columns));
+}
+
+} // namespace
+
 writer::writer() {
   out_ = std::make_shared<::arrow::io::StdoutStream>();
 }
 
-writer::writer(const caf::settings&) {
+writer::writer(const caf::settings& options) {
   out_ = std::make_shared<::arrow::io::StdoutStream>();
+  dir_ = get_or(options, "vast.export.arrow.directory", "");
+  batch_size_ = get_or(options, "vast.export.arrow.batch-size",
+                       defaults::export_::arrow::batch_size);
+  max_buffered_bytes_
+    = get_or(options, "vast.export.arrow.max-buffered-bytes",
+             defaults::export_::arrow::max_buffered_bytes);
 }
 
 writer::~writer() {
-  // nop
+  for (auto& state : layouts_)
+    if (auto err = write_buffered(state))
+      VAST_WARN("{} failed to write buffered events: {}", name(), render(err));
+  // Closing the stream writer appends the end-of-stream marker.
+  if (!layout(record_type{}))
+    VAST_WARN("{} failed to close the output stream", name());
+  if (auto err = close_files())
+    VAST_WARN("{} failed to close output files: {}", name(), render(err));
 }
 
 caf::error writer::write(const table_slice& slice) {
-  if (out_ == nullptr)
+  if (dir_.empty() && out_ == nullptr)
     return caf::make_error(ec::logic_error, "invalid arrow output stream");
-  if (!layout(slice.layout()))
-    return caf::make_error(ec::logic_error, "failed to update layout");
-  // Get the Record Batch and print it.
-  auto batch = as_record_batch(slice);
-  VAST_ASSERT(batch != nullptr);
-  if (auto status = current_batch_writer_->WriteRecordBatch(*batch);
-      !status.ok())
-    return caf::make_error(ec::unspecified, "failed to write record batch",
-                           status.ToString());
+  auto layout = flatten(slice.layout());
+  auto state = std::find_if(layouts_.begin(), layouts_.end(),
+                            [&](const auto& x) { return x.layout == layout; });
+  if (state == layouts_.end()) {
+    layouts_.push_back({std::move(layout)});
+    state = std::prev(layouts_.end());
+  }
+  auto bytes = as_bytes(slice).size();
+  state->buffered.push_back(slice);
+  state->buffered_rows += slice.rows();
+  state->buffered_bytes += bytes;
+  buffered_bytes_ += bytes;
+  if (state->buffered_rows >= batch_size_)
+    if (auto err = write_buffered(*state))
+      return err;
+  // Many layouts with few rows each would otherwise buffer up to the batch
+  // size per layout, so we write the largest batches early.
+  while (max_buffered_bytes_ > 0 && buffered_bytes_ > max_buffered_bytes_) {
+    auto largest = std::max_element(
+      layouts_.begin(), layouts_.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.buffered_bytes < rhs.buffered_bytes;
+      });
+    if (auto err = write_buffered(*largest))
+      return err;
+  }
   return caf::none;
 }
 
+caf::expected<void> writer::flush() {
+  for (auto& state : layouts_)
+    if (auto err = write_buffered(state))
+      return err;
+  if (dir_.empty() && out_ != nullptr)
+    if (auto status = out_->Flush(); !status.ok())
+      return caf::make_error(ec::unspecified, "failed to flush output stream",
+                             status.ToString());
+  return caf::unit;
+}
+
 const char* writer::name() const {
   return "arrow-writer";
 }
@@ -74,12 +162,12 @@ bool writer::layout(const record_type& x) {
     if (!current_batch_writer_->Close().ok())
       return false;
     current_batch_writer_ = nullptr;
+    current_layout_ = {};
   }
   if (layout.fields.empty())
     return true;
   current_layout_ = layout;
   auto schema = make_arrow_schema(layout);
-  current_builder_ = arrow_table_slice_builder::make(layout);
 #  if ARROW_VERSION_MAJOR >= 2
   auto writer_result = ::arrow::ipc::MakeStreamWriter(out_.get(), schema);
 #  else
@@ -92,6 +180,92 @@ bool writer::layout(const record_type& x) {
   return false;
 }
 
+caf::error writer::write_buffered(layout_state& state) {
+  if (state.buffered.empty())
+    return caf::none;
+  auto batch = concatenate(state.buffered);
+  if (!batch)
+    return batch.error();
+  state.buffered.clear();
+  state.buffered_rows = 0;
+  buffered_bytes_ -= state.buffered_bytes;
+  state.buffered_bytes = 0;
+  auto* batch_writer = current_batch_writer_.get();
+  if (dir_.empty()) {
+    if (!layout(state.layout))
+      return caf::make_error(ec::logic_error, "failed to update layout");
+    batch_writer = current_batch_writer_.get();
+  } else {
+    if (state.file_writer == nullptr) {
+      if (!exists(dir_)) {
+        if (auto err = mkdir(dir_))
+          return err;
+      } else if (!dir_.is_directory()) {
+        return caf::make_error(ec::format_error,
+                               "got existing non-directory path", dir_);
+      }
+      // Layouts with the same name but different fields go to separate files.
+      auto index = std::count_if(
+        layouts_.begin(), layouts_.end(), [&](const layout_state& x) {
+          return x.file != nullptr && x.layout.name() == state.layout.name();
+        });
+      auto filename = state.layout.name();
+      if (index > 0)
+        filename += "-" + std::to_string(index);
+      auto file = dir_ / (filename + ".arrow");
+      // Opening the file by name would truncate an existing file, e.g., from
+      // a previous export into the same directory.
+      auto fd = ::open(file.str().c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+      if (fd < 0)
+        return caf::make_error(ec::filesystem_error,
+                               "failed to create output file", file.str(),
+                               std::strerror(errno));
+      auto file_result = ::arrow::io::FileOutputStream::Open(fd);
+      if (!file_result.ok()) {
+        ::close(fd);
+        return caf::make_error(ec::filesystem_error,
+                               "failed to open output file", file.str(),
+                               file_result.status().ToString());
+      }
+      state.file = std::move(*file_result);
+      auto schema = make_arrow_schema(state.layout);
+#  if ARROW_VERSION_MAJOR >= 2
+      auto writer_result = ::arrow::ipc::MakeFileWriter(state.file, schema);
+#  else
+      auto writer_result = ::arrow::ipc::NewFileWriter(state.file.get(),
+                                                       schema);
+#  endif
+      if (!writer_result.ok())
+        return caf::make_error(ec::format_error,
+                               "failed to create Arrow file writer",
+                               writer_result.status().ToString());
+      state.file_writer = std::move(*writer_result);
+    }
+    batch_writer = state.file_writer.get();
+  }
+  VAST_ASSERT(batch_writer != nullptr);
+  if (auto status = batch_writer->WriteRecordBatch(**batch); !status.ok())
+    return caf::make_error(ec::unspecified, "failed to write record batch",
+                           status.ToString());
+  return caf::none;
+}
+
+caf::error writer::close_files() {
+  for (auto& state : layouts_) {
+    if (state.file_writer == nullptr)
+      continue;
+    auto status = state.file_writer->Close();
+    if (status.ok())
+      status = state.file->Close();
+    state.file_writer = nullptr;
+    state.file = nullptr;
+    if (!status.ok())
+      return caf::make_error(ec::filesystem_error,
+                             "failed to close output file", status.ToString());
+  }
+  return caf::none;
+}
+
 } // namespace vast::format::arrow
 
 #endif // VAST_ENABLE_ARROW
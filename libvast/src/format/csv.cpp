@@ -118,20 +118,21 @@ caf::error writer::write(const table_slice& x) {
     append('\n');
     write_buf();
   }
-  auto flat_layout = flatten(layout);
   // Print the cell contents.
+  x.decode_columns(columns_);
   auto iter = std::back_inserter(buf_);
   for (size_t row = 0; row < x.rows(); ++row) {
     append(last_layout_);
-    for (size_t column = 0; column < x.columns(); ++column) {
+    for (auto& column : columns_) {
       append(separator);
-      if (auto err
-          = render(iter, x.at(row, column, flat_layout.fields[column].type)))
+      if (auto err = render(iter, column[row]))
         return err;
     }
     append('\n');
-    write_buf();
+    if (buf_.size() >= vast::defaults::export_::write_buffer_size)
+      write_buf();
   }
+  write_buf();
   return caf::none;
 }
 
@@ -469,7 +470,7 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
     }
     ++produced;
     ++batch_events_;
-    if (builder_->rows() == max_slice_size)
+    if (builder_->rows() >= max_slice_size)
       if (auto err = finish(callback))
         return err;
   }
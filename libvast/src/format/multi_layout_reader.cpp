@@ -75,8 +75,8 @@ table_slice_builder_ptr multi_layout_reader::builder(const type& t) {
     // printed only once.
     return builders_[t];
   }
-  auto ptr = factory<table_slice_builder>::make(table_slice_type_,
-                                                caf::get<record_type>(t));
+  const auto& layout = caf::get<record_type>(t);
+  auto ptr = factory<table_slice_builder>::make(encoding(layout), layout);
   builders_.emplace(t, ptr);
   return ptr;
 }
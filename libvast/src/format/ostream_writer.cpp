@@ -28,6 +28,8 @@ ostream_writer::~ostream_writer() {
 caf::expected<void> ostream_writer::flush() {
   if (out_ == nullptr)
     return caf::make_error(ec::format_error, "no output stream available");
+  if (!buf_.empty())
+    write_buf();
   out_->flush();
   if (!*out_)
     return caf::make_error(ec::format_error, "failed to flush");
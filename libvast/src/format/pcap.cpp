@@ -23,18 +23,27 @@
 #  include "vast/detail/byte_swap.hpp"
 #  include "vast/error.hpp"
 #  include "vast/ether_type.hpp"
+#  include "vast/factory.hpp"
 #  include "vast/logger.hpp"
 #  include "vast/path.hpp"
 #  include "vast/span.hpp"
 #  include "vast/table_slice.hpp"
 #  include "vast/table_slice_builder.hpp"
+#  include "vast/table_slice_builder_factory.hpp"
 
 #  include <caf/config_value.hpp>
 #  include <caf/settings.hpp>
 
+#  include <algorithm>
+#  include <atomic>
+#  include <condition_variable>
 #  include <cstddef>
+#  include <deque>
+#  include <limits>
+#  include <mutex>
 #  include <string>
 #  include <thread>
+#  include <tuple>
 #  include <utility>
 
 #  include <netinet/in.h>
@@ -65,8 +74,501 @@ inline const auto pcap_packet_type = make_packet_type();
 inline const auto pcap_packet_type_community_id = make_packet_type(
   record_field{"community_id", string_type{}.attributes({{"index", "hash"}})});
 
+/// Creates the state of a new flow.
+flow_table::flow_state make_flow_state(std::string_view community_id) {
+  auto result = flow_table::flow_state{0, 0, {}};
+  VAST_ASSERT(community_id.size() == result.community_id.size());
+  std::copy(community_id.begin(), community_id.end(),
+            result.community_id.begin());
+  return result;
+}
+
 } // namespace <anonymous>
 
+// -- flow table ---------------------------------------------------------------
+
+flow_table::flow_table(uint64_t cutoff, size_t max_flows, uint64_t max_age,
+                       uint64_t expire_interval)
+  : cutoff_{cutoff},
+    max_flows_{max_flows},
+    max_age_{max_age},
+    expire_interval_{expire_interval} {
+  // nop
+}
+
+flow_table::flow_state& flow_table::state(const flow& x) {
+  auto make = [&](const flow& x) {
+    scratch_.clear();
+    community_id::compute<policy::base64>(span{&x, 1}, scratch_);
+    return make_flow_state(scratch_);
+  };
+  return flows_.touch(x, make).first;
+}
+
+flow_table::flow_state& flow_table::state(const flow& x, size_t position) {
+  // The flow may have been evicted after prefetching, in which case its
+  // Community ID is not in the arena.
+  if (position >= prefetched_.size() || prefetched_[position].empty())
+    return state(x);
+  auto make = [&](const flow&) {
+    return make_flow_state(prefetched_[position]);
+  };
+  return flows_.touch(x, make).first;
+}
+
+void flow_table::prefetch_community_ids(span<const flow> xs) {
+  constexpr auto n = community_id::length<policy::base64>();
+  constexpr auto tracked = std::numeric_limits<size_t>::max();
+  missing_index_.clear();
+  missing_.clear();
+  // Assign every untracked flow a slot in the arena. We can only create the
+  // views once the arena stopped growing, so we remember the slots first.
+  prefetched_.assign(xs.size(), std::string_view{});
+  slots_.assign(xs.size(), tracked);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    if (flows_.find(xs[i]))
+      continue;
+    auto [j, inserted] = missing_index_.emplace(xs[i], missing_.size());
+    if (inserted)
+      missing_.push_back(xs[i]);
+    slots_[i] = j->second;
+  }
+  if (missing_.empty())
+    return;
+  arena_.clear();
+  community_id::compute<policy::base64>(span{missing_.data(), missing_.size()},
+                                        arena_);
+  for (size_t i = 0; i < xs.size(); ++i)
+    if (slots_[i] != tracked)
+      prefetched_[i] = std::string_view{arena_}.substr(slots_[i] * n, n);
+}
+
+bool flow_table::update(const flow& x, uint64_t packet_time,
+                        uint64_t payload_size) {
+  auto& st = state(x);
+  st.last = packet_time;
+  auto& flow_size = st.bytes;
+  if (flow_size == cutoff_)
+    return false;
+  VAST_ASSERT(flow_size < cutoff_);
+  // Trim the packet if needed.
+  flow_size += std::min(payload_size, cutoff_ - flow_size);
+  return true;
+}
+
+void flow_table::evict_inactive(uint64_t packet_time) {
+  if (last_expire_ == 0)
+    last_expire_ = packet_time;
+  if (packet_time - last_expire_ <= expire_interval_)
+    return;
+  last_expire_ = packet_time;
+  // The flow table orders flows by their most recent packet, so we only need
+  // to look at the inactive flows. For traces with non-monotonic timestamps
+  // this may keep some inactive flows until the next expiration.
+  while (!flows_.empty()
+         && packet_time - flows_.oldest().second.last > max_age_) {
+    flows_.pop_oldest();
+    ++evicted_inactive;
+  }
+}
+
+void flow_table::shrink_to_max_size() {
+  while (!flows_.empty() && flows_.size() >= max_flows_) {
+    flows_.pop_oldest();
+    ++evicted_lru;
+  }
+}
+
+void flow_table::clear() {
+  flows_.clear();
+  arena_.clear();
+  prefetched_.clear();
+  last_expire_ = 0;
+}
+
+size_t flow_table::size() const {
+  return flows_.size();
+}
+
+float flow_table::load_factor() const {
+  return flows_.load_factor();
+}
+
+namespace {
+
+enum class frame_type : char {
+  chap_none = '\x00',
+  chap_challenge = '\x01',
+  chap_response = '\x02',
+  chap_both = '\x03',
+  ethernet = '\x01',
+  vlan = '\x02',
+  mpls = '\x03',
+  pppoe = '\x04',
+  ppp = '\x05',
+  chap = '\x06',
+  ipv4 = '\x07',
+  udp = '\x08',
+  radius = '\x09',
+  radavp = '\x0a',
+  l2tp = '\x0b',
+  l2avp = '\x0c',
+  ospfv2 = '\x0d',
+  ospf_md5 = '\x0e',
+  tcp = '\x0f',
+  ip_md5 = '\x10',
+  unknown = '\x11',
+  gre = '\x12',
+  gtp = '\x13',
+  vxlan = '\x14'
+};
+
+// Strips all data from a frame until the IP layer is reached. The frame type
+// distinguisher exists for future recursive stripping.
+span<const std::byte> decapsulate(span<const std::byte> frame, frame_type type) {
+  switch (type) {
+    default:
+      return {};
+    case frame_type::ethernet: {
+      constexpr size_t ethernet_header_size = 14;
+      if (frame.size() < ethernet_header_size)
+        return {}; // need at least 2 MAC addresses and the 2-byte EtherType.
+      switch (as_ether_type(frame.subspan<12, 2>())) {
+        default:
+          return frame;
+        case ether_type::ieee_802_1aq:
+          return frame.subspan<4>(); // One 32-bit VLAN tag
+        case ether_type::ieee_802_1q_db:
+          return frame.subspan<2 * 4>(); // Two 32-bit VLAN tags
+      }
+    }
+  }
+}
+
+/// The connection and the layer 3 data of a parsed frame.
+struct parsed_frame {
+  flow conn;
+  span<const std::byte> layer3;
+  uint64_t payload_size = 0;
+};
+
+/// Parses a frame up to layer 4.
+/// @returns `false` if the frame does not contain an IP packet.
+caf::expected<bool>
+parse_frame(const pcap_pkthdr& header, const u_char* data,
+            parsed_frame& result) {
+  span<const std::byte> frame{reinterpret_cast<const std::byte*>(data),
+                              header.len};
+  frame = decapsulate(frame, frame_type::ethernet);
+  if (frame.empty())
+    return caf::make_error(ec::format_error, "failed to decapsulate frame");
+  constexpr size_t ethernet_header_size = 14;
+  auto layer3 = frame.subspan<ethernet_header_size>();
+  span<const std::byte> layer4;
+  uint8_t layer4_proto = 0;
+  auto& conn = result.conn;
+  // Parse layer 3.
+  switch (as_ether_type(frame.subspan<12, 2>())) {
+    default:
+      return false;
+    case ether_type::ipv4: {
+      constexpr size_t ipv4_header_size = 20;
+      if (header.len < ethernet_header_size + ipv4_header_size)
+        return caf::make_error(ec::format_error, "IPv4 header too short");
+      size_t header_size = (std::to_integer<uint8_t>(layer3[0]) & 0x0f) * 4;
+      if (header_size < ipv4_header_size)
+        return caf::make_error(ec::format_error,
+                               "IPv4 header too short: ", header_size, " bytes");
+      auto orig_h
+        = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 12));
+      auto resp_h
+        = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 16));
+      conn.src_addr = {orig_h, address::ipv4, address::network};
+      conn.dst_addr = {resp_h, address::ipv4, address::network};
+      layer4_proto = std::to_integer<uint8_t>(layer3[9]);
+      layer4 = layer3.subspan(header_size);
+      break;
+    }
+    case ether_type::ipv6: {
+      if (header.len < ethernet_header_size + 40)
+        return caf::make_error(ec::format_error, "IPv6 header too short");
+      auto orig_h
+        = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 8));
+      auto resp_h
+        = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 24));
+      conn.src_addr = {orig_h, address::ipv4, address::network};
+      conn.dst_addr = {resp_h, address::ipv4, address::network};
+      layer4_proto = std::to_integer<uint8_t>(layer3[6]);
+      layer4 = layer3.subspan(40);
+      break;
+    }
+  }
+  // Parse layer 4.
+  auto payload_size = layer4.size();
+  if (layer4_proto == IPPROTO_TCP) {
+    VAST_ASSERT(!layer4.empty());
+    auto orig_p
+      = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data()));
+    auto resp_p
+      = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data() + 2));
+    orig_p = detail::to_host_order(orig_p);
+    resp_p = detail::to_host_order(resp_p);
+    conn.src_port = {orig_p, port_type::tcp};
+    conn.dst_port = {resp_p, port_type::tcp};
+    auto data_offset
+      = *reinterpret_cast<const uint8_t*>(std::launder(layer4.data() + 12))
+        >> 4;
+    payload_size -= data_offset * 4;
+  } else if (layer4_proto == IPPROTO_UDP) {
+    VAST_ASSERT(!layer4.empty());
+    auto orig_p
+      = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data()));
+    auto resp_p
+      = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data() + 2));
+    orig_p = detail::to_host_order(orig_p);
+    resp_p = detail::to_host_order(resp_p);
+    conn.src_port = {orig_p, port_type::udp};
+    conn.dst_port = {resp_p, port_type::udp};
+    payload_size -= 8;
+  } else if (layer4_proto == IPPROTO_ICMP) {
+    VAST_ASSERT(!layer4.empty());
+    auto message_type = std::to_integer<uint8_t>(layer4[0]);
+    auto message_code = std::to_integer<uint8_t>(layer4[1]);
+    conn.src_port = {message_type, port_type::icmp};
+    conn.dst_port = {message_code, port_type::icmp};
+    payload_size -= 8; // TODO: account for variable-size data.
+  }
+  result.layer3 = layer3;
+  result.payload_size = payload_size;
+  return true;
+}
+
+/// Extracts the timestamp of a packet.
+time timestamp(const pcap_pkthdr& header) {
+  using namespace std::chrono;
+  auto secs = seconds(header.ts.tv_sec);
+  auto ts = time{duration_cast<duration>(secs)};
+#ifdef PCAP_TSTAMP_PRECISION_NANO
+  ts += nanoseconds(header.ts.tv_usec);
+#else
+  ts += microseconds(header.ts.tv_usec);
+#endif
+  return ts;
+}
+
+/// Appends a packet as row to a table slice builder.
+/// @param community_id The Community ID of the flow, or an empty view if the
+///        layout does not contain the Community ID.
+bool add_packet(table_slice_builder& builder, time ts, const flow& conn,
+                std::string_view community_id, std::string_view packet) {
+  return builder.add(ts) && builder.add(conn.src_addr)
+         && builder.add(conn.dst_addr) && builder.add(conn.src_port.number())
+         && builder.add(conn.dst_port.number())
+         && (community_id.empty() || builder.add(community_id))
+         && builder.add(packet);
+}
+
+/// Computes a hash of a flow that is identical for both of its directions.
+size_t symmetric_hash(const flow& x) {
+  if (std::tie(x.src_addr, x.src_port) < std::tie(x.dst_addr, x.dst_port))
+    return vast::hash(x);
+  auto y = x;
+  std::swap(y.src_addr, y.dst_addr);
+  std::swap(y.src_port, y.dst_port);
+  return vast::hash(y);
+}
+
+/// A packet that the reader copied out of the libpcap buffer.
+struct shard_packet {
+  time ts;
+  flow conn;
+  uint64_t packet_time;
+  uint64_t payload_size;
+  size_t offset; ///< The offset of the layer 3 data in the batch buffer.
+  size_t size;   ///< The size of the layer 3 data.
+};
+
+/// A batch of packets that the reader hands to a shard at once.
+struct packet_batch {
+  std::vector<shard_packet> packets;
+  std::vector<std::byte> data;
+  /// Whether the shard emits its partially filled table slice after the
+  /// packets of this batch.
+  bool flush = false;
+};
+
+/// The number of packets the reader collects per shard before dispatching.
+constexpr size_t packet_batch_size = 1024;
+
+/// The maximum number of batches waiting per shard until the reader blocks.
+constexpr size_t max_pending_batches = 16;
+
+} // namespace
+
+// -- sharding -----------------------------------------------------------------
+
+struct reader::shard_output {
+  std::mutex mutex;
+  std::vector<table_slice> slices;
+};
+
+struct reader::shard {
+  shard(flow_table flows, table_slice_builder_ptr builder, bool community_id,
+        size_t max_slice_size, shard_output& output)
+    : flows{std::move(flows)},
+      builder{std::move(builder)},
+      community_id{community_id},
+      max_slice_size{max_slice_size},
+      output{output} {
+    // nop
+  }
+
+  /// Hands a batch of packets to the shard, blocking while the shard lags
+  /// behind.
+  void enqueue(packet_batch batch) {
+    std::unique_lock lock{mutex};
+    space_available.wait(lock,
+                         [&] { return inbox.size() < max_pending_batches; });
+    if (batch.flush)
+      ++flush_requests;
+    inbox.push_back(std::move(batch));
+    lock.unlock();
+    batch_available.notify_one();
+  }
+
+  /// Waits until the shard emitted its table slices for all enqueued batches
+  /// with the flush flag.
+  void wait_flushed() {
+    std::unique_lock lock{mutex};
+    flushed.wait(lock, [&] { return flushes == flush_requests; });
+  }
+
+  /// Signals the shard to exit after processing all pending batches.
+  void stop() {
+    {
+      std::lock_guard lock{mutex};
+      done = true;
+    }
+    batch_available.notify_one();
+  }
+
+  /// The main loop of the shard thread.
+  void run() {
+    while (true) {
+      std::unique_lock lock{mutex};
+      batch_available.wait(lock, [&] { return !inbox.empty() || done; });
+      if (inbox.empty())
+        break;
+      auto batch = std::move(inbox.front());
+      inbox.pop_front();
+      lock.unlock();
+      space_available.notify_one();
+      process(batch);
+      if (batch.flush) {
+        emit();
+        lock.lock();
+        ++flushes;
+        lock.unlock();
+        flushed.notify_one();
+      }
+    }
+    emit();
+  }
+
+  void process(const packet_batch& batch) {
+    if (failed.load(std::memory_order_relaxed))
+      return;
+    uint64_t num_packets = 0;
+    uint64_t num_bytes = 0;
+    uint64_t num_discarded = 0;
+    if (community_id) {
+      conns.clear();
+      for (auto& p : batch.packets)
+        conns.push_back(p.conn);
+      flows.prefetch_community_ids(span{conns.data(), conns.size()});
+    }
+    for (size_t i = 0; i < batch.packets.size(); ++i) {
+      auto& p = batch.packets[i];
+      // Create the states of new flows from the prefetched Community IDs.
+      if (community_id)
+        flows.state(p.conn, i);
+      if (!flows.update(p.conn, p.packet_time, p.payload_size)) {
+        ++num_discarded;
+        continue;
+      }
+      flows.evict_inactive(p.packet_time);
+      flows.shrink_to_max_size();
+      auto ptr = reinterpret_cast<const char*>(batch.data.data() + p.offset);
+      auto packet = std::string_view{ptr, p.size};
+      auto& cid = flows.state(p.conn).community_id;
+      auto cid_view = community_id ? std::string_view{cid.data(), cid.size()}
+                                   : std::string_view{};
+      if (!add_packet(*builder, p.ts, p.conn, cid_view, packet)) {
+        failed.store(true, std::memory_order_relaxed);
+        return;
+      }
+      ++num_packets;
+      num_bytes += p.size;
+      if (builder->rows() >= max_slice_size)
+        emit();
+    }
+    packets.fetch_add(num_packets, std::memory_order_relaxed);
+    bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+    discarded.fetch_add(num_discarded, std::memory_order_relaxed);
+    num_flows.store(flows.size(), std::memory_order_relaxed);
+    evicted_inactive.store(flows.evicted_inactive, std::memory_order_relaxed);
+    evicted_lru.store(flows.evicted_lru, std::memory_order_relaxed);
+  }
+
+  /// Moves the current table slice to the output.
+  void emit() {
+    if (builder->rows() == 0)
+      return;
+    auto slice = builder->finish();
+    if (slice.encoding() == table_slice_encoding::none) {
+      failed.store(true, std::memory_order_relaxed);
+      return;
+    }
+    std::lock_guard lock{output.mutex};
+    output.slices.push_back(std::move(slice));
+  }
+
+  // State owned by the shard thread.
+  flow_table flows;
+  table_slice_builder_ptr builder;
+  bool community_id;
+  size_t max_slice_size;
+  shard_output& output;
+  std::thread thread;
+  std::vector<flow> conns; ///< The flows of the current batch.
+
+  // State shared with the reader.
+  std::mutex mutex;
+  std::condition_variable batch_available;
+  std::condition_variable space_available;
+  std::condition_variable flushed;
+  std::deque<packet_batch> inbox;
+  bool done = false;
+  uint64_t flush_requests = 0;
+  uint64_t flushes = 0;
+
+  // Statistics, written by the shard thread and read by the reader.
+  std::atomic<uint64_t> packets{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> discarded{0};
+  std::atomic<uint64_t> num_flows{0};
+  std::atomic<uint64_t> evicted_inactive{0};
+  std::atomic<uint64_t> evicted_lru{0};
+  std::atomic<bool> failed{false};
+
+  // The statistics at the time of the last status report.
+  uint64_t reported_packets = 0;
+  uint64_t reported_bytes = 0;
+  uint64_t reported_discarded = 0;
+};
+
+// -- reader -------------------------------------------------------------------
+
 reader::reader(const caf::settings& options, std::unique_ptr<std::istream>)
   : super(options) {
   using defaults_t = vast::defaults::import::pcap;
@@ -81,6 +583,7 @@ reader::reader(const caf::settings& options, std::unique_ptr<std::istream>)
     = get_or(options, category + ".max-flow-age", defaults_t::max_flow_age);
   expire_interval_
     = get_or(options, category + ".flow-expiry", defaults_t::flow_expiry);
+  flows_ = flow_table{cutoff_, max_flows_, max_age_, expire_interval_};
   pseudo_realtime_ = get_or(options, category + ".pseudo-realtime-factor",
                             defaults_t::pseudo_realtime_factor);
   snaplen_ = get_or(options, category + ".snaplen", defaults_t::snaplen);
@@ -89,6 +592,7 @@ reader::reader(const caf::settings& options, std::unique_ptr<std::istream>)
   community_id_ = !get_or(options, category + ".disable-community-id", false);
   packet_type_
     = community_id_ ? pcap_packet_type_community_id : pcap_packet_type;
+  num_shards_ = get_or(options, category + ".shards", defaults_t::shards);
   last_stats_ = {};
   discard_count_ = 0;
 }
@@ -100,6 +604,7 @@ void reader::reset(std::unique_ptr<std::istream>) {
 }
 
 reader::~reader() {
+  stop_shards();
   if (pcap_)
     ::pcap_close(pcap_);
 }
@@ -120,100 +625,86 @@ const char* reader::name() const {
 
 vast::system::report reader::status() const {
   using namespace std::string_literals;
+  auto result = vast::system::report{};
+  auto now = reader_clock::now();
+  auto elapsed = std::chrono::duration<double>(now - last_status_).count();
+  last_status_ = now;
+  uint64_t flows = flows_.size();
+  size_t evicted_inactive_total = flows_.evicted_inactive;
+  size_t evicted_lru_total = flows_.evicted_lru;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    auto& s = *shards_[i];
+    auto packets = s.packets.load(std::memory_order_relaxed);
+    auto bytes = s.bytes.load(std::memory_order_relaxed);
+    auto discarded = s.discarded.load(std::memory_order_relaxed);
+    auto packets_delta = packets - s.reported_packets;
+    auto bytes_delta = bytes - s.reported_bytes;
+    discard_count_ += discarded - s.reported_discarded;
+    s.reported_packets = packets;
+    s.reported_bytes = bytes;
+    s.reported_discarded = discarded;
+    flows += s.num_flows.load(std::memory_order_relaxed);
+    evicted_inactive_total += s.evicted_inactive.load(std::memory_order_relaxed);
+    evicted_lru_total += s.evicted_lru.load(std::memory_order_relaxed);
+    auto prefix = name() + ".shard-"s + std::to_string(i);
+    result.push_back({prefix + ".packets", packets_delta});
+    result.push_back({prefix + ".bytes", bytes_delta});
+    if (elapsed > 0) {
+      result.push_back({prefix + ".packet-rate", packets_delta / elapsed});
+      result.push_back({prefix + ".byte-rate", bytes_delta / elapsed});
+    }
+  }
   if (!pcap_)
-    return {};
+    return result;
   auto stats = pcap_stat{};
   if (auto res = pcap_stats(pcap_, &stats); res != 0)
-    return {};
+    return result;
   uint64_t recv = stats.ps_recv - last_stats_.ps_recv;
   if (recv == 0)
-    return {};
+    return result;
   uint64_t drop = stats.ps_drop - last_stats_.ps_drop;
   uint64_t ifdrop = stats.ps_ifdrop - last_stats_.ps_ifdrop;
   double drop_rate = static_cast<double>(drop + ifdrop) / recv;
   uint64_t discard = discard_count_;
   double discard_rate = static_cast<double>(discard) / recv;
+  uint64_t evicted_inactive = evicted_inactive_total - last_evicted_inactive_;
+  uint64_t evicted_lru = evicted_lru_total - last_evicted_lru_;
+  double flow_table_load = flows_.load_factor();
   // Clean up for next delta.
   last_stats_ = std::move(stats);
   discard_count_ = 0;
+  last_evicted_inactive_ = evicted_inactive_total;
+  last_evicted_lru_ = evicted_lru_total;
   if (drop_rate >= drop_rate_threshold_)
     VAST_WARN("{} has dropped {} of {} recent packets",
               detail::pretty_type_name(this), drop + ifdrop, recv);
   if (discard > 0)
     VAST_WARN("{} has discarded {} of {} recent packets",
               detail::pretty_type_name(this), discard, recv);
-  return {
-    {name() + ".recv"s, recv},       {name() + ".drop"s, drop},
-    {name() + ".ifdrop"s, ifdrop},   {name() + ".drop-rate"s, drop_rate},
-    {name() + ".discard"s, discard}, {name() + ".discard-rate"s, discard_rate},
-  };
-}
-
-namespace {
-
-enum class frame_type : char {
-  chap_none = '\x00',
-  chap_challenge = '\x01',
-  chap_response = '\x02',
-  chap_both = '\x03',
-  ethernet = '\x01',
-  vlan = '\x02',
-  mpls = '\x03',
-  pppoe = '\x04',
-  ppp = '\x05',
-  chap = '\x06',
-  ipv4 = '\x07',
-  udp = '\x08',
-  radius = '\x09',
-  radavp = '\x0a',
-  l2tp = '\x0b',
-  l2avp = '\x0c',
-  ospfv2 = '\x0d',
-  ospf_md5 = '\x0e',
-  tcp = '\x0f',
-  ip_md5 = '\x10',
-  unknown = '\x11',
-  gre = '\x12',
-  gtp = '\x13',
-  vxlan = '\x14'
-};
-
-// Strips all data from a frame until the IP layer is reached. The frame type
-// distinguisher exists for future recursive stripping.
-span<const std::byte> decapsulate(span<const std::byte> frame, frame_type type) {
-  switch (type) {
-    default:
-      return {};
-    case frame_type::ethernet: {
-      constexpr size_t ethernet_header_size = 14;
-      if (frame.size() < ethernet_header_size)
-        return {}; // need at least 2 MAC addresses and the 2-byte EtherType.
-      switch (as_ether_type(frame.subspan<12, 2>())) {
-        default:
-          return frame;
-        case ether_type::ieee_802_1aq:
-          return frame.subspan<4>(); // One 32-bit VLAN tag
-        case ether_type::ieee_802_1q_db:
-          return frame.subspan<2 * 4>(); // Two 32-bit VLAN tags
-      }
-    }
-  }
+  result.insert(
+    result.end(),
+    {
+      {name() + ".recv"s, recv},
+      {name() + ".drop"s, drop},
+      {name() + ".ifdrop"s, ifdrop},
+      {name() + ".drop-rate"s, drop_rate},
+      {name() + ".discard"s, discard},
+      {name() + ".discard-rate"s, discard_rate},
+      {name() + ".flows"s, flows},
+      {name() + ".flow-table-load"s, flow_table_load},
+      {name() + ".evicted-inactive"s, evicted_inactive},
+      {name() + ".evicted-lru"s, evicted_lru},
+    });
+  return result;
 }
 
-} // namespace
-
 caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
                              consumer& f) {
   // Sanity checks.
   VAST_ASSERT(max_events > 0);
   VAST_ASSERT(max_slice_size > 0);
-  if (builder_ == nullptr) {
-    if (!caf::holds_alternative<record_type>(packet_type_))
-      return caf::make_error(ec::parse_error, "illegal packet type");
-    if (!reset_builder(caf::get<record_type>(packet_type_)))
-      return caf::make_error(ec::parse_error, "unable to create builder for "
-                                              "packet type");
-  }
+  if (!caf::holds_alternative<record_type>(packet_type_))
+    return caf::make_error(ec::parse_error, "illegal packet type");
   // Local buffer for storing error messages.
   char buf[PCAP_ERRBUF_SIZE];
   // Initialize PCAP if needed.
@@ -230,6 +721,11 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
         VAST_WARN("{} ignores pseudo-realtime in live mode",
                   detail::pretty_type_name(this));
       }
+      if (num_shards_ > 1) {
+        num_shards_ = 0;
+        VAST_WARN("{} ignores shards in live mode",
+                  detail::pretty_type_name(this));
+      }
       VAST_INFO("{} listens on interface {}", detail::pretty_type_name(this),
                 *interface_);
     } else if (input_ != "-" && !exists(input_)) {
@@ -250,9 +746,15 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
       }
       VAST_INFO("{} reads trace from {}", detail::pretty_type_name(this),
                 input_);
-      if (pseudo_realtime_ > 0)
+      if (pseudo_realtime_ > 0) {
         VAST_VERBOSE("{} uses pseudo-realtime factor 1 / {}",
                      detail::pretty_type_name(this), pseudo_realtime_);
+        if (num_shards_ > 1) {
+          num_shards_ = 0;
+          VAST_WARN("{} ignores shards in pseudo-realtime mode",
+                    detail::pretty_type_name(this));
+        }
+      }
     }
     VAST_VERBOSE("{} cuts off flows after {} bytes in each direction",
                  detail::pretty_type_name(this), cutoff_);
@@ -263,6 +765,14 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
     VAST_VERBOSE("{} expires flow table every {} s",
                  detail::pretty_type_name(this), expire_interval_);
   }
+  if (num_shards_ > 1)
+    return read_sharded(max_events, max_slice_size, f);
+  // The shards have their own builders, so only the single-threaded reader
+  // needs one.
+  if (builder_ == nullptr
+      && !reset_builder(caf::get<record_type>(packet_type_)))
+    return caf::make_error(ec::parse_error, "unable to create builder for "
+                                            "packet type");
   auto produced = size_t{0};
   while (produced < max_events) {
     if (batch_events_ > 0 && batch_timeout_ > reader_clock::duration::zero()
@@ -289,121 +799,34 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
                                        "failed to get next packet: ", err));
     }
     // Parse frame.
-    span<const std::byte> frame{reinterpret_cast<const std::byte*>(data), header->len};
-    frame = decapsulate(frame, frame_type::ethernet);
-    if (frame.empty())
-      return caf::make_error(ec::format_error, "failed to decapsulate frame");
-    constexpr size_t ethernet_header_size = 14;
-    auto layer3 = frame.subspan<ethernet_header_size>();
-    span<const std::byte> layer4;
-    uint8_t layer4_proto = 0;
-    flow conn;
-    // Parse layer 3.
-    switch (as_ether_type(frame.subspan<12, 2>())) {
-      default: {
-        ++discard_count_;
-        VAST_DEBUG("{} skips non-IP packet", detail::pretty_type_name(this));
-        continue;
-      }
-      case ether_type::ipv4: {
-        constexpr size_t ipv4_header_size = 20;
-        if (header->len < ethernet_header_size + ipv4_header_size)
-          return caf::make_error(ec::format_error, "IPv4 header too short");
-        size_t header_size = (std::to_integer<uint8_t>(layer3[0]) & 0x0f) * 4;
-        if (header_size < ipv4_header_size)
-          return caf::make_error(
-            ec::format_error, "IPv4 header too short: ", header_size, " bytes");
-        auto orig_h
-          = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 12));
-        auto resp_h
-          = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 16));
-        conn.src_addr = {orig_h, address::ipv4, address::network};
-        conn.dst_addr = {resp_h, address::ipv4, address::network};
-        layer4_proto = std::to_integer<uint8_t>(layer3[9]);
-        layer4 = layer3.subspan(header_size);
-        break;
-      }
-      case ether_type::ipv6: {
-        if (header->len < ethernet_header_size + 40)
-          return caf::make_error(ec::format_error, "IPv6 header too short");
-        auto orig_h
-          = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 8));
-        auto resp_h
-          = reinterpret_cast<const uint32_t*>(std::launder(layer3.data() + 24));
-        conn.src_addr = {orig_h, address::ipv4, address::network};
-        conn.dst_addr = {resp_h, address::ipv4, address::network};
-        layer4_proto = std::to_integer<uint8_t>(layer3[6]);
-        layer4 = layer3.subspan(40);
-        break;
-      }
-    }
-    // Parse layer 4.
-    auto payload_size = layer4.size();
-    if (layer4_proto == IPPROTO_TCP) {
-      VAST_ASSERT(!layer4.empty());
-      auto orig_p
-        = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data()));
-      auto resp_p
-        = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data() + 2));
-      orig_p = detail::to_host_order(orig_p);
-      resp_p = detail::to_host_order(resp_p);
-      conn.src_port = {orig_p, port_type::tcp};
-      conn.dst_port = {resp_p, port_type::tcp};
-      auto data_offset
-        = *reinterpret_cast<const uint8_t*>(std::launder(layer4.data() + 12))
-          >> 4;
-      payload_size -= data_offset * 4;
-    } else if (layer4_proto == IPPROTO_UDP) {
-      VAST_ASSERT(!layer4.empty());
-      auto orig_p
-        = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data()));
-      auto resp_p
-        = *reinterpret_cast<const uint16_t*>(std::launder(layer4.data() + 2));
-      orig_p = detail::to_host_order(orig_p);
-      resp_p = detail::to_host_order(resp_p);
-      conn.src_port = {orig_p, port_type::udp};
-      conn.dst_port = {resp_p, port_type::udp};
-      payload_size -= 8;
-    } else if (layer4_proto == IPPROTO_ICMP) {
-      VAST_ASSERT(!layer4.empty());
-      auto message_type = std::to_integer<uint8_t>(layer4[0]);
-      auto message_code = std::to_integer<uint8_t>(layer4[1]);
-      conn.src_port = {message_type, port_type::icmp};
-      conn.dst_port = {message_code, port_type::icmp};
-      payload_size -= 8; // TODO: account for variable-size data.
+    auto frame = parsed_frame{};
+    auto parsed = parse_frame(*header, data, frame);
+    if (!parsed)
+      return std::move(parsed.error());
+    if (!*parsed) {
+      ++discard_count_;
+      VAST_DEBUG("{} skips non-IP packet", detail::pretty_type_name(this));
+      continue;
     }
     // Parse packet timestamp
     uint64_t packet_time = header->ts.tv_sec;
-    if (last_expire_ == 0)
-      last_expire_ = packet_time;
-    if (!update_flow(conn, packet_time, payload_size)) {
+    if (!flows_.update(frame.conn, packet_time, frame.payload_size)) {
       ++discard_count_;
       VAST_DEBUG("{} skips cut off packet", detail::pretty_type_name(this));
       continue;
     }
-    evict_inactive(packet_time);
-    shrink_to_max_size();
-    // Extract timestamp.
-    using namespace std::chrono;
-    auto secs = seconds(header->ts.tv_sec);
-    auto ts = time{duration_cast<duration>(secs)};
-#ifdef PCAP_TSTAMP_PRECISION_NANO
-    ts += nanoseconds(header->ts.tv_usec);
-#else
-    ts += microseconds(header->ts.tv_usec);
-#endif
+    flows_.evict_inactive(packet_time);
+    flows_.shrink_to_max_size();
+    auto ts = timestamp(*header);
     // Assemble packet.
-    auto layer3_ptr = reinterpret_cast<const char*>(layer3.data());
-    auto packet = std::string_view{std::launder(layer3_ptr), layer3.size()};
-    auto& cid = state(conn).community_id;
-    if (!(builder_->add(ts) && builder_->add(conn.src_addr)
-          && builder_->add(conn.dst_addr)
-          && builder_->add(conn.src_port.number())
-          && builder_->add(conn.dst_port.number())
-          && (!community_id_ || builder_->add(std::string_view{cid}))
-          && builder_->add(packet))) {
+    auto layer3_ptr = reinterpret_cast<const char*>(frame.layer3.data());
+    auto packet
+      = std::string_view{std::launder(layer3_ptr), frame.layer3.size()};
+    auto& cid = flows_.state(frame.conn).community_id;
+    auto cid_view = community_id_ ? std::string_view{cid.data(), cid.size()}
+                                  : std::string_view{};
+    if (!add_packet(*builder_, ts, frame.conn, cid_view, packet))
       return caf::make_error(ec::parse_error, "unable to fill row");
-    }
     ++produced;
     ++batch_events_;
     if (pseudo_realtime_ > 0) {
@@ -418,65 +841,160 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
       }
       last_timestamp_ = ts;
     }
-    if (builder_->rows() == max_slice_size)
+    if (builder_->rows() >= max_slice_size)
       if (auto err = finish(f, caf::none))
         return err;
   }
   return finish(f, caf::none);
 }
 
-reader::flow_state& reader::state(const flow& x) {
-  auto i = flows_.find(x);
-  if (i == flows_.end()) {
-    auto id = community_id::compute<policy::base64>(x);
-    i = flows_.emplace(x, flow_state{0, 0, std::move(id)}).first;
+caf::error reader::read_sharded(size_t max_events, size_t max_slice_size,
+                                consumer& f) {
+  if (shards_.empty()) {
+    const auto& layout = caf::get<record_type>(packet_type_);
+    shard_output_ = std::make_unique<shard_output>();
+    // Every shard sees only its share of the flows.
+    auto max_flows = std::max(max_flows_ / num_shards_, size_t{1});
+    for (size_t i = 0; i < num_shards_; ++i) {
+      auto builder
+        = factory<table_slice_builder>::make(encoding(layout), layout);
+      if (!builder)
+        return caf::make_error(ec::parse_error, "unable to create builder for "
+                                                "packet type");
+      shards_.push_back(std::make_unique<shard>(
+        flow_table{cutoff_, max_flows, max_age_, expire_interval_},
+        std::move(builder), community_id_, max_slice_size, *shard_output_));
+    }
+    for (auto& s : shards_)
+      s->thread = std::thread{[s = s.get()] { s->run(); }};
+    VAST_VERBOSE("{} processes packets on {} shards",
+                 detail::pretty_type_name(this), num_shards_);
   }
-  return i->second;
-}
-
-bool reader::update_flow(const flow& x, uint64_t packet_time,
-                         uint64_t payload_size) {
-  auto& st = state(x);
-  st.last = packet_time;
-  auto& flow_size = st.bytes;
-  if (flow_size == cutoff_)
-    return false;
-  VAST_ASSERT(flow_size < cutoff_);
-  // Trim the packet if needed.
-  flow_size += std::min(payload_size, cutoff_ - flow_size);
-  return true;
-}
-
-void reader::evict_inactive(uint64_t packet_time) {
-  if (packet_time - last_expire_ <= expire_interval_)
-    return;
-  last_expire_ = packet_time;
-  auto i = flows_.begin();
-  while (i != flows_.end())
-    if (packet_time - i->second.last > max_age_)
-      i = flows_.erase(i);
-    else
-      ++i;
-}
-
-void reader::shrink_to_max_size() {
-  while (flows_.size() >= max_flows_) {
-    auto buckets = flows_.bucket_count();
-    auto unif1 = std::uniform_int_distribution<size_t>{0, buckets - 1};
-    auto bucket = unif1(generator_);
-    auto bucket_size = flows_.bucket_size(bucket);
-    while (bucket_size == 0) {
-      ++bucket;
-      bucket %= buckets;
-      bucket_size = flows_.bucket_size(bucket);
+  auto produced = size_t{0};
+  auto batches = std::vector<packet_batch>(shards_.size());
+  // Hands the collected packets to the shards. With `flush`, every shard
+  // also emits its partially filled table slice.
+  auto dispatch = [&](bool flush = false) {
+    for (size_t i = 0; i < batches.size(); ++i) {
+      if (!flush && batches[i].packets.empty())
+        continue;
+      auto batch = std::exchange(batches[i], {});
+      batch.flush = flush;
+      shards_[i]->enqueue(std::move(batch));
+    }
+  };
+  // Forwards the table slices of the shards up to `max_events` and keeps the
+  // rest for the next call.
+  auto deliver = [&] {
+    {
+      std::lock_guard lock{shard_output_->mutex};
+      for (auto& slice : shard_output_->slices)
+        pending_slices_.push_back(std::move(slice));
+      shard_output_->slices.clear();
+    }
+    auto delivered = false;
+    while (produced < max_events && !pending_slices_.empty()) {
+      auto slice = std::move(pending_slices_.front());
+      pending_slices_.pop_front();
+      if (produced + slice.rows() > max_events) {
+        auto [head, tail] = split(slice, max_events - produced);
+        pending_slices_.push_front(std::move(tail));
+        slice = std::move(head);
+      }
+      produced += slice.rows();
+      f(std::move(slice));
+      delivered = true;
+    }
+    if (delivered)
+      last_batch_sent_ = reader_clock::now();
+  };
+  // Delivers the packets that wait in the shards, such that low-rate input
+  // does not linger in partially filled table slices.
+  auto flush = [&] {
+    // Stopped shards have emitted all their table slices already.
+    if (shards_.front()->thread.joinable()) {
+      dispatch(true);
+      for (auto& s : shards_)
+        s->wait_flushed();
+    }
+    deliver();
+    last_batch_sent_ = reader_clock::now();
+  };
+  // Finishes reading after the last packet or a fatal error.
+  auto finish_sharded = [&](caf::error err) {
+    dispatch();
+    stop_shards();
+    deliver();
+    // Report the end of the input only after handing out all table slices.
+    if (err == ec::end_of_input && !pending_slices_.empty())
+      return caf::error{};
+    return err;
+  };
+  // Hand out the table slices that exceeded the previous call first.
+  deliver();
+  while (produced < max_events) {
+    if (batch_timeout_ > reader_clock::duration::zero()
+        && last_batch_sent_ + batch_timeout_ < reader_clock::now()) {
+      VAST_DEBUG("{} reached batch timeout", detail::pretty_type_name(this));
+      flush();
+      return ec::timeout;
+    }
+    // Attempt to fetch next packet.
+    const u_char* data;
+    pcap_pkthdr* header;
+    auto r = ::pcap_next_ex(pcap_, &header, &data);
+    if (r == -2)
+      return finish_sharded(
+        caf::make_error(ec::end_of_input, "reached end of trace"));
+    if (r == -1) {
+      auto err = std::string{::pcap_geterr(pcap_)};
+      ::pcap_close(pcap_);
+      pcap_ = nullptr;
+      return finish_sharded(
+        caf::make_error(ec::format_error, "failed to get next packet: ", err));
+    }
+    if (r == 0) {
+      flush();
+      return ec::timeout;
+    }
+    auto frame = parsed_frame{};
+    auto parsed = parse_frame(*header, data, frame);
+    if (!parsed) {
+      dispatch();
+      return std::move(parsed.error());
+    }
+    if (!*parsed) {
+      ++discard_count_;
+      VAST_DEBUG("{} skips non-IP packet", detail::pretty_type_name(this));
+      continue;
+    }
+    // Copy the packet into the batch of the shard that owns its flow.
+    auto i = symmetric_hash(frame.conn) % shards_.size();
+    auto& batch = batches[i];
+    auto offset = batch.data.size();
+    batch.data.insert(batch.data.end(), frame.layer3.begin(),
+                      frame.layer3.end());
+    batch.packets.push_back({timestamp(*header), frame.conn,
+                             static_cast<uint64_t>(header->ts.tv_sec),
+                             frame.payload_size, offset, frame.layer3.size()});
+    if (batch.packets.size() == packet_batch_size) {
+      shards_[i]->enqueue(std::exchange(batch, {}));
+      deliver();
+      if (shards_[i]->failed.load(std::memory_order_relaxed))
+        return finish_sharded(
+          caf::make_error(ec::parse_error, "unable to fill row"));
     }
-    auto unif2 = std::uniform_int_distribution<size_t>{0, bucket_size - 1};
-    auto offset = unif2(generator_);
-    VAST_ASSERT(offset < bucket_size);
-    auto begin = flows_.begin(bucket);
-    std::advance(begin, offset);
-    flows_.erase(begin->first);
   }
+  dispatch();
+  return caf::none;
+}
+
+void reader::stop_shards() {
+  for (auto& s : shards_)
+    s->stop();
+  for (auto& s : shards_)
+    if (s->thread.joinable())
+      s->thread.join();
 }
 
 writer::writer(const caf::settings& options) {
@@ -17,6 +17,7 @@
 #include "vast/concept/parseable/vast/table_slice_encoding.hpp"
 #include "vast/concept/parseable/vast/time.hpp"
 #include "vast/logger.hpp"
+#include "vast/type.hpp"
 
 #include <caf/settings.hpp>
 
@@ -28,7 +29,10 @@ reader::consumer::~consumer() {
 reader::reader(const caf::settings& options) {
   if (auto batch_encoding_arg
       = caf::get_if<std::string>(&options, "vast.import.batch-encoding")) {
-    if (auto batch_encoding = to<table_slice_encoding>(*batch_encoding_arg))
+    if (*batch_encoding_arg == "auto")
+      adaptive_encoding_ = true;
+    else if (auto batch_encoding
+             = to<table_slice_encoding>(*batch_encoding_arg))
       table_slice_type_ = *batch_encoding;
     else
       VAST_WARN("{} cannot set vast.import.batch-encoding to {} as it "
@@ -53,6 +57,10 @@ reader::reader(const caf::settings& options) {
                 "not a valid duration",
                 detail::pretty_type_name(this), *read_timeout_arg);
   }
+  adaptive_batch_size_
+    = caf::get_or(options, "vast.import.adaptive-batch-size", false);
+  if (caf::get_or(options, "vast.import.community-id", false))
+    community_id_enricher_.emplace();
   last_batch_sent_ = reader_clock::now();
 }
 
@@ -64,4 +72,27 @@ vast::system::report reader::status() const {
   return {};
 }
 
+bool reader::adaptive_encoding() const noexcept {
+  return adaptive_encoding_;
+}
+
+bool reader::adaptive_batch_size() const noexcept {
+  return adaptive_batch_size_;
+}
+
+const std::unordered_map<std::string, table_slice_encoding>&
+reader::layout_encodings() const noexcept {
+  return layout_encodings_;
+}
+
+table_slice_encoding reader::encoding(const record_type& layout) {
+  if (!adaptive_encoding_)
+    return table_slice_type_;
+  auto result = preferred_encoding(layout);
+  if (layout_encodings_.emplace(layout.name(), result).second)
+    VAST_VERBOSE("{} encodes {} events as {} table slices",
+                 detail::pretty_type_name(this), layout.name(), result);
+  return result;
+}
+
 } // namespace vast::format
@@ -47,8 +47,8 @@ caf::error single_layout_reader::finish(consumer& f, caf::error result) {
 
 bool single_layout_reader::reset_builder(record_type layout) {
   VAST_TRACE_SCOPE("{} {}", VAST_ARG(table_slice_type_), VAST_ARG(layout));
-  builder_ = factory<table_slice_builder>::make(table_slice_type_,
-                                                std::move(layout));
+  auto type = encoding(layout);
+  builder_ = factory<table_slice_builder>::make(type, std::move(layout));
   last_batch_sent_ = reader_clock::now();
   batch_events_ = 0;
   return builder_ != nullptr;
@@ -351,7 +351,7 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
                                            lines_->line_number(),
                                            std::string{fields[i]}));
       }
-      if (builder_->rows() == max_slice_size)
+      if (builder_->rows() >= max_slice_size)
         if (auto err = finish(f))
           return err;
       ++produced;
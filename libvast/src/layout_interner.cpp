@@ -0,0 +1,111 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/layout_interner.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <caf/binary_deserializer.hpp>
+
+#include <mutex>
+
+namespace vast {
+
+layout_interner& layout_interner::instance() {
+  static layout_interner interner;
+  return interner;
+}
+
+layout_interner::layout_interner() {
+  insert(record_type{});
+}
+
+caf::expected<const interned_layout*>
+layout_interner::intern(span<const std::byte> serialized) {
+  auto key = std::string_view{reinterpret_cast<const char*>(serialized.data()),
+                              serialized.size()};
+  {
+    auto lock = std::shared_lock{mutex_};
+    if (auto it = by_serialized_.find(key); it != by_serialized_.end())
+      return it->second;
+  }
+  // Deserialize outside of the critical section; another thread may intern
+  // the same layout concurrently, in which case we lose the race below.
+  record_type layout;
+  caf::binary_deserializer source(nullptr, key.data(), key.size());
+  if (auto err = source(layout))
+    return err;
+  auto lock = std::unique_lock{mutex_};
+  return &insert(key, std::move(layout));
+}
+
+const interned_layout&
+layout_interner::intern(span<const std::byte> serialized,
+                        const record_type& layout) {
+  auto key = std::string_view{reinterpret_cast<const char*>(serialized.data()),
+                              serialized.size()};
+  {
+    auto lock = std::shared_lock{mutex_};
+    if (auto it = by_serialized_.find(key); it != by_serialized_.end())
+      return *it->second;
+  }
+  auto lock = std::unique_lock{mutex_};
+  return insert(key, layout);
+}
+
+const interned_layout& layout_interner::intern(const record_type& layout) {
+  {
+    auto lock = std::shared_lock{mutex_};
+    if (auto it = by_layout_.find(layout); it != by_layout_.end())
+      return *it->second;
+  }
+  auto lock = std::unique_lock{mutex_};
+  return insert(layout);
+}
+
+const interned_layout& layout_interner::at(layout_id id) const {
+  auto lock = std::shared_lock{mutex_};
+  VAST_ASSERT(id < layouts_.size());
+  return *layouts_[id];
+}
+
+size_t layout_interner::size() const {
+  auto lock = std::shared_lock{mutex_};
+  return layouts_.size();
+}
+
+const interned_layout& layout_interner::insert(record_type layout) {
+  if (auto it = by_layout_.find(layout); it != by_layout_.end())
+    return *it->second;
+  auto id = static_cast<layout_id>(layouts_.size());
+  auto flat_layout = flatten(layout);
+  auto layout_type = type{layout};
+  auto& result = *layouts_.emplace_back(std::make_unique<interned_layout>(
+    interned_layout{id, std::move(layout), std::move(flat_layout),
+                    std::move(layout_type)}));
+  by_layout_.emplace(result.layout, &result);
+  return result;
+}
+
+const interned_layout&
+layout_interner::insert(std::string_view serialized, record_type layout) {
+  if (auto it = by_serialized_.find(serialized); it != by_serialized_.end())
+    return *it->second;
+  const auto& result = insert(std::move(layout));
+  const auto& owned = serialized_.emplace_back(serialized);
+  by_serialized_.emplace(owned, &result);
+  return result;
+}
+
+} // namespace vast
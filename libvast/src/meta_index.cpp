@@ -15,6 +15,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/chunk.hpp"
 #include "vast/data.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/detail/set_operations.hpp"
@@ -22,6 +23,7 @@
 #include "vast/detail/tracepoint.hpp"
 #include "vast/expression.hpp"
 #include "vast/fbs/utils.hpp"
+#include "vast/flatbuffer_synopsis.hpp"
 #include "vast/logger.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/system/instrumentation.hpp"
@@ -31,25 +33,247 @@
 #include <caf/binary_deserializer.hpp>
 #include <caf/binary_serializer.hpp>
 
+#include <algorithm>
 #include <type_traits>
 
 namespace vast {
 
+namespace {
+
+using time_range = std::pair<time, time>;
+
+/// Extracts the bounds from the synopsis of a field with the `#timestamp`
+/// attribute.
+caf::optional<time_range> time_bounds(const synopsis_ptr& syn) {
+  if (auto ts = dynamic_cast<const time_synopsis*>(syn.get()))
+    return time_range{ts->min(), ts->max()};
+  if (auto fs = dynamic_cast<const flatbuffer_synopsis*>(syn.get()))
+    if (auto ts = fs->flatbuffer().time_synopsis())
+      return time_range{time{} + duration{ts->start()},
+                        time{} + duration{ts->end()}};
+  return caf::none;
+}
+
+/// Determines a closed time interval that contains the `#timestamp` of all
+/// events matching an expression.
+/// @returns The time interval, or `caf::none` if the expression does not
+///          restrict the `#timestamp` attribute.
+caf::optional<time_range> extract_time_range(const expression& expr) {
+  auto f = detail::overload{
+    [](const conjunction& xs) -> caf::optional<time_range> {
+      caf::optional<time_range> result;
+      for (auto& x : xs) {
+        auto range = extract_time_range(x);
+        if (!range)
+          continue;
+        if (!result) {
+          result = range;
+        } else {
+          result->first = std::max(result->first, range->first);
+          result->second = std::min(result->second, range->second);
+        }
+      }
+      return result;
+    },
+    [](const disjunction& xs) -> caf::optional<time_range> {
+      auto result = time_range{time::max(), time::min()};
+      for (auto& x : xs) {
+        auto range = extract_time_range(x);
+        if (!range)
+          return caf::none;
+        if (range->second < range->first)
+          continue;
+        result.first = std::min(result.first, range->first);
+        result.second = std::max(result.second, range->second);
+      }
+      return result;
+    },
+    [](const negation&) -> caf::optional<time_range> {
+      return caf::none;
+    },
+    [](const predicate& x) -> caf::optional<time_range> {
+      auto lhs = caf::get_if<attribute_extractor>(&x.lhs);
+      if (!lhs || lhs->attr != atom::timestamp_v)
+        return caf::none;
+      auto rhs = caf::get_if<data>(&x.rhs);
+      if (!rhs)
+        return caf::none;
+      auto t = caf::get_if<time>(rhs);
+      if (!t)
+        return caf::none;
+      switch (x.op) {
+        default:
+          return caf::none;
+        case relational_operator::equal:
+          return time_range{*t, *t};
+        case relational_operator::less:
+        case relational_operator::less_equal:
+          return time_range{time::min(), *t};
+        case relational_operator::greater:
+        case relational_operator::greater_equal:
+          return time_range{*t, time::max()};
+      }
+    },
+    [](caf::none_t) -> caf::optional<time_range> {
+      return caf::none;
+    },
+  };
+  return caf::visit(f, expr);
+}
+
+/// Checks whether the events of a layout in a partition may match an
+/// expression, considering only the names and types of the layout's fields.
+bool may_match_layout(const expression& expr, const partition_synopsis& ps,
+                      const std::string& layout) {
+  auto any_field = [&](auto pred) {
+    for (auto& [field, _] : ps.field_synopses_)
+      if (field.layout_name == layout && pred(field))
+        return true;
+    return false;
+  };
+  auto f = detail::overload{
+    [&](const conjunction& xs) {
+      return std::all_of(xs.begin(), xs.end(), [&](const expression& x) {
+        return may_match_layout(x, ps, layout);
+      });
+    },
+    [&](const disjunction& xs) {
+      return std::any_of(xs.begin(), xs.end(), [&](const expression& x) {
+        return may_match_layout(x, ps, layout);
+      });
+    },
+    [&](const negation&) {
+      return true;
+    },
+    [&](const predicate& x) {
+      auto g = detail::overload{
+        [&](const attribute_extractor& lhs, const data& d) {
+          if (lhs.attr == atom::type_v)
+            return evaluate(data{layout}, x.op, d);
+          if (lhs.attr == atom::timestamp_v)
+            return any_field([](const qualified_record_field& field) {
+              return has_attribute(field.type, "timestamp");
+            });
+          if (lhs.attr == atom::field_v)
+            if (auto s = caf::get_if<std::string>(&d))
+              return !is_negated(x.op)
+                     == any_field([&](const qualified_record_field& field) {
+                          return detail::ends_with(field.fqn(), *s);
+                        });
+          return true;
+        },
+        [&](const field_extractor& lhs, const data&) {
+          return any_field([&](const qualified_record_field& field) {
+            return detail::ends_with(field.fqn(), lhs.field);
+          });
+        },
+        [&](const type_extractor& lhs, const data&) {
+          return any_field([&](const qualified_record_field& field) {
+            return field.type == lhs.type;
+          });
+        },
+        [&](const auto&, const auto&) {
+          return true;
+        },
+      };
+      return caf::visit(g, x.lhs, x.rhs);
+    },
+    [&](caf::none_t) {
+      return true;
+    },
+  };
+  return caf::visit(f, expr);
+}
+
+/// Unpacks the event counts and cardinality sketches of a partition synopsis.
+/// Both are missing for partitions written by older versions of VAST.
+caf::error
+unpack_estimates(const fbs::partition_synopsis::v0& x, partition_synopsis& ps) {
+  if (auto layout_counts = x.layout_counts()) {
+    for (auto layout_count : *layout_counts) {
+      if (!layout_count || !layout_count->name())
+        return caf::make_error(ec::format_error, "layout count is null");
+      ps.layout_counts_[layout_count->name()->str()] = layout_count->count();
+    }
+  }
+  if (auto sketches = x.cardinality_sketches()) {
+    for (auto sketch : *sketches) {
+      if (!sketch || !sketch->registers())
+        return caf::make_error(ec::format_error, "sketch is null");
+      auto precision = sketch->precision();
+      if (precision < detail::hyperloglog::min_precision
+          || precision > detail::hyperloglog::max_precision
+          || sketch->registers()->size() != size_t{1} << precision)
+        return caf::make_error(ec::format_error, "invalid sketch precision");
+      qualified_record_field qf;
+      if (auto error
+          = fbs::deserialize_bytes(sketch->qualified_record_field(), qf))
+        return error;
+      auto registers = std::vector<uint8_t>(sketch->registers()->begin(),
+                                            sketch->registers()->end());
+      ps.field_sketches_.insert_or_assign(
+        std::move(qf), detail::hyperloglog{precision, std::move(registers)});
+    }
+  }
+  return caf::none;
+}
+
+} // namespace
+
 size_t meta_index::memusage() const {
   size_t result = 0;
   for (auto& [id, partition_synopsis] : synopses_)
     result += partition_synopsis.memusage();
+  result += time_index_.memusage();
   return result;
 }
 
 void meta_index::erase(const uuid& partition) {
   synopses_.erase(partition);
+  unindex_time_range(partition);
 }
 
 void meta_index::merge(const uuid& partition, partition_synopsis&& ps) {
+  index_time_range(partition, ps);
   synopses_[partition] = std::move(ps);
 }
 
+void meta_index::unindex_time_range(const uuid& partition) {
+  if (auto it = time_ranges_.find(partition); it != time_ranges_.end()) {
+    time_index_.erase(it->second.first, partition);
+    time_ranges_.erase(it);
+  }
+  unbounded_time_ranges_.erase(partition);
+}
+
+void meta_index::index_time_range(const uuid& partition,
+                                  const partition_synopsis& ps) {
+  unindex_time_range(partition);
+  caf::optional<time_range> result;
+  for (auto& [field, syn] : ps.field_synopses_) {
+    if (!has_attribute(field.type, "timestamp"))
+      continue;
+    auto bounds = time_bounds(syn);
+    if (!bounds) {
+      unbounded_time_ranges_.insert(partition);
+      return;
+    }
+    // An empty synopsis never matches.
+    if (bounds->second < bounds->first)
+      continue;
+    if (!result) {
+      result = bounds;
+    } else {
+      result->first = std::min(result->first, bounds->first);
+      result->second = std::max(result->second, bounds->second);
+    }
+  }
+  if (result) {
+    time_ranges_.emplace(partition, *result);
+    time_index_.insert(result->first, result->second, partition);
+  }
+}
+
 partition_synopsis& meta_index::at(const uuid& partition) {
   return synopses_.at(partition);
 }
@@ -57,6 +281,76 @@ partition_synopsis& meta_index::at(const uuid& partition) {
 std::vector<uuid> meta_index::lookup(const expression& expr) const {
   VAST_ASSERT(!caf::holds_alternative<caf::none_t>(expr));
   auto start = system::stopwatch::now();
+  // For time-bounded queries we only consider the partitions whose time range
+  // overlaps with the query, which we find via the time index.
+  candidate_list candidates;
+  if (auto range = extract_time_range(expr)) {
+    time_index_.overlap(range->first, range->second, [&](const auto& x) {
+      auto it = synopses_.find(x.value);
+      VAST_ASSERT(it != synopses_.end());
+      candidates.push_back(&*it);
+    });
+    for (auto& id : unbounded_time_ranges_)
+      candidates.push_back(&*synopses_.find(id));
+    VAST_DEBUG("{} selects {} of {} partitions by time range",
+               detail::pretty_type_name(this), candidates.size(),
+               synopses_.size());
+  } else {
+    candidates.reserve(synopses_.size());
+    for (auto& x : synopses_)
+      candidates.push_back(&x);
+  }
+  auto result = lookup_impl(expr, candidates);
+  auto delta = std::chrono::duration_cast<std::chrono::microseconds>(
+    system::stopwatch::now() - start);
+  VAST_DEBUG("meta index lookup found {} candidates in {} microseconds",
+             result.size(), delta.count());
+  VAST_TRACEPOINT(meta_index_lookup, delta.count(), result.size());
+  return result;
+}
+
+uint64_t meta_index::count_upper_bound(const expression& expr) const {
+  uint64_t result = 0;
+  for (auto& id : lookup(expr)) {
+    auto& ps = synopses_.find(id)->second;
+    for (auto& [layout, n] : ps.layout_counts_)
+      if (may_match_layout(expr, ps, layout))
+        result += n;
+  }
+  return result;
+}
+
+caf::optional<double>
+meta_index::distinct_upper_bound(const expression& expr,
+                                 std::string_view field) const {
+  caf::optional<detail::hyperloglog> result;
+  for (auto& id : lookup(expr)) {
+    auto& ps = synopses_.find(id)->second;
+    for (auto& [qf, sketch] : ps.field_sketches_) {
+      if (!detail::ends_with(qf.fqn(), field)
+          || !may_match_layout(expr, ps, qf.layout_name))
+        continue;
+      if (!result) {
+        result = sketch;
+        continue;
+      }
+      // Sketches of different precision combine at the lower precision.
+      if (result->precision() > sketch.precision())
+        result = result->fold(sketch.precision());
+      if (result->precision() < sketch.precision())
+        result->merge(sketch.fold(result->precision()));
+      else
+        result->merge(sketch);
+    }
+  }
+  if (!result)
+    return caf::none;
+  return result->estimate();
+}
+
+std::vector<uuid>
+meta_index::lookup_impl(const expression& expr,
+                        const candidate_list& candidates) const {
   // TODO: we could consider a flat_set<uuid> here, which would then have
   // overloads for inplace intersection/union and simplify the implementation
   // of this function a bit. This would also simplify the maintainance of a
@@ -69,12 +363,12 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
   using result_type = std::vector<uuid>;
   result_type memoized_partitions;
   auto all_partitions = [&] {
-    if (!memoized_partitions.empty() || synopses_.empty())
+    if (!memoized_partitions.empty() || candidates.empty())
       return memoized_partitions;
-    memoized_partitions.reserve(synopses_.size());
-    std::transform(synopses_.begin(), synopses_.end(),
+    memoized_partitions.reserve(candidates.size());
+    std::transform(candidates.begin(), candidates.end(),
                    std::back_inserter(memoized_partitions),
-                   [](auto& x) { return x.first; });
+                   [](auto x) { return x->first; });
     std::sort(memoized_partitions.begin(), memoized_partitions.end());
     return memoized_partitions;
   };
@@ -82,10 +376,10 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
     [&](const conjunction& x) -> result_type {
       VAST_ASSERT(!x.empty());
       auto i = x.begin();
-      auto result = lookup(*i);
+      auto result = lookup_impl(*i, candidates);
       if (!result.empty())
         for (++i; i != x.end(); ++i) {
-          auto xs = lookup(*i);
+          auto xs = lookup_impl(*i, candidates);
           if (xs.empty())
             return xs; // short-circuit
           detail::inplace_intersect(result, xs);
@@ -96,9 +390,9 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
     [&](const disjunction& x) -> result_type {
       result_type result;
       for (auto& op : x) {
-        auto xs = lookup(op);
+        auto xs = lookup_impl(op, candidates);
         VAST_ASSERT(std::is_sorted(xs.begin(), xs.end()));
-        if (xs.size() == synopses_.size())
+        if (xs.size() == candidates.size())
           return xs; // short-circuit
         detail::inplace_unify(result, xs);
         VAST_ASSERT(std::is_sorted(result.begin(), result.end()));
@@ -122,7 +416,8 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
         VAST_ASSERT(caf::holds_alternative<data>(x.rhs));
         auto& rhs = caf::get<data>(x.rhs);
         result_type result;
-        for (auto& [part_id, part_syn] : synopses_) {
+        for (auto candidate : candidates) {
+          auto& [part_id, part_syn] = *candidate;
           for (auto& [field, syn] : part_syn.field_synopses_) {
             if (match(field)) {
               auto cleaned_type = vast::type{field.type}.attributes({});
@@ -158,7 +453,7 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
         }
         VAST_DEBUG(
           "{} checked {} partitions for predicate {} and got {} results",
-          detail::pretty_type_name(this), synopses_.size(), x, result.size());
+          detail::pretty_type_name(this), candidates.size(), x, result.size());
         // Some calling paths require the result to be sorted.
         std::sort(result.begin(), result.end());
         return result;
@@ -174,7 +469,8 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
             // We don't have to look into the synopses for type queries, just
             // at the layout names.
             result_type result;
-            for (auto& [part_id, part_syn] : synopses_) {
+            for (auto candidate : candidates) {
+              auto& [part_id, part_syn] = *candidate;
               for (auto& pair : part_syn.field_synopses_) {
                 // TODO: provide an overload for view of evaluate() so that
                 // we can use string_view here. Fortunately type names are
@@ -199,11 +495,11 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
               VAST_WARN("#field meta queries only support string "
                         "comparisons");
             } else {
-              for (const auto& synopsis : synopses_) {
+              for (auto synopsis : candidates) {
                 // Compare the desired field name with each field in the
                 // partition.
                 auto matching = [&] {
-                  for (const auto& pair : synopsis.second.field_synopses_) {
+                  for (const auto& pair : synopsis->second.field_synopses_) {
                     auto fqn = pair.first.fqn();
                     if (detail::ends_with(fqn, *s))
                       return true;
@@ -214,7 +510,7 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
                 // operator is "positive" and matching is true, or both are
                 // negative.
                 if (!is_negated(x.op) == matching)
-                  result.push_back(synopsis.first);
+                  result.push_back(synopsis->first);
               }
             }
             // Re-establish potentially violated invariant.
@@ -250,20 +546,15 @@ std::vector<uuid> meta_index::lookup(const expression& expr) const {
       return all_partitions();
     },
   };
-  auto result = caf::visit(f, expr);
-  auto delta = std::chrono::duration_cast<std::chrono::microseconds>(
-    system::stopwatch::now() - start);
-  VAST_DEBUG("meta index lookup found {} candidates in {} microseconds",
-             result.size(), delta.count());
-  VAST_TRACEPOINT(meta_index_lookup, delta.count(), result.size());
-  return result;
+  return caf::visit(f, expr);
 }
 
 caf::expected<flatbuffers::Offset<fbs::partition_synopsis::v0>>
 pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
   std::vector<flatbuffers::Offset<fbs::synopsis::v0>> synopses;
   for (auto& [fqf, synopsis] : x.field_synopses_) {
-    auto maybe_synopsis = pack(builder, synopsis, fqf);
+    auto maybe_synopsis
+      = pack(builder, synopsis, fqf, x.native_bloom_filters_);
     if (!maybe_synopsis)
       return maybe_synopsis.error();
     synopses.push_back(*maybe_synopsis);
@@ -271,14 +562,32 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
   for (auto& [type, synopsis] : x.type_synopses_) {
     qualified_record_field fqf;
     fqf.type = type;
-    auto maybe_synopsis = pack(builder, synopsis, fqf);
+    auto maybe_synopsis
+      = pack(builder, synopsis, fqf, x.native_bloom_filters_);
     if (!maybe_synopsis)
       return maybe_synopsis.error();
     synopses.push_back(*maybe_synopsis);
   }
+  std::vector<flatbuffers::Offset<fbs::layout_count::v0>> layout_counts;
+  for (auto& [name, n] : x.layout_counts_)
+    layout_counts.push_back(
+      fbs::layout_count::Createv0Direct(builder, name.c_str(), n));
+  std::vector<flatbuffers::Offset<fbs::cardinality_sketch::v0>> sketches;
+  for (auto& [fqf, sketch] : x.field_sketches_) {
+    auto field = fbs::serialize_bytes(builder, fqf);
+    if (!field)
+      return field.error();
+    auto registers = builder.CreateVector(sketch.registers());
+    sketches.push_back(fbs::cardinality_sketch::Createv0(
+      builder, *field, sketch.precision(), registers));
+  }
   auto synopses_vector = builder.CreateVector(synopses);
+  auto layout_counts_vector = builder.CreateVector(layout_counts);
+  auto sketches_vector = builder.CreateVector(sketches);
   fbs::partition_synopsis::v0Builder ps_builder(builder);
   ps_builder.add_synopses(synopses_vector);
+  ps_builder.add_layout_counts(layout_counts_vector);
+  ps_builder.add_cardinality_sketches(sketches_vector);
   return ps_builder.Finish();
 }
 
@@ -301,7 +610,38 @@ unpack(const fbs::partition_synopsis::v0& x, partition_synopsis& ps) {
     else
       ps.type_synopses_[qf.type] = std::move(ptr);
   }
-  return caf::none;
+  return unpack_estimates(x, ps);
+}
+
+caf::error unpack_lazily(chunk_ptr chunk, partition_synopsis& ps) {
+  if (!chunk)
+    return caf::make_error(ec::invalid_argument, "chunk must not be null");
+  auto ps_flatbuffer = fbs::GetPartitionSynopsis(chunk->data());
+  if (ps_flatbuffer->partition_synopsis_type()
+      != fbs::partition_synopsis::PartitionSynopsis::v0)
+    return caf::make_error(ec::format_error, "invalid partition synopsis "
+                                             "version");
+  auto& x = *ps_flatbuffer->partition_synopsis_as_v0();
+  if (!x.synopses())
+    return caf::make_error(ec::format_error, "missing synopses");
+  for (auto synopsis : *x.synopses()) {
+    if (!synopsis)
+      return caf::make_error(ec::format_error, "synopsis is null");
+    qualified_record_field qf;
+    if (auto error
+        = fbs::deserialize_bytes(synopsis->qualified_record_field(), qf))
+      return error;
+    synopsis_ptr ptr;
+    if (is_lazily_evaluable(*synopsis))
+      ptr = std::make_unique<flatbuffer_synopsis>(qf.type, chunk, *synopsis);
+    else if (auto error = unpack(*synopsis, ptr))
+      return error;
+    if (!qf.field_name.empty())
+      ps.field_synopses_[qf] = std::move(ptr);
+    else
+      ps.type_synopses_[qf.type] = std::move(ptr);
+  }
+  return unpack_estimates(x, ps);
 }
 
 } // namespace vast
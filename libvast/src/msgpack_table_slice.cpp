@@ -19,12 +19,19 @@
 #include "vast/die.hpp"
 #include "vast/fbs/table_slice.hpp"
 #include "vast/fbs/utils.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/logger.hpp"
 #include "vast/msgpack.hpp"
 #include "vast/value_index.hpp"
 
 #include <type_traits>
 
+#if VAST_ENABLE_ARROW
+#  include "vast/arrow_table_slice_builder.hpp"
+
+#  include <arrow/api.h>
+#endif // VAST_ENABLE_ARROW
+
 namespace vast {
 
 // -- utility functions --------------------------------------------------------
@@ -250,17 +257,31 @@ template <class FlatBuffer>
 msgpack_table_slice<FlatBuffer>::msgpack_table_slice(
   const FlatBuffer& slice) noexcept
   : slice_{slice}, state_{} {
-  if (auto err = fbs::deserialize_bytes(slice_.layout(), state_.layout))
-    die("failed to deserialize layout: " + render(err));
-  state_.columns = state_.layout.num_leaves();
+  const auto* bytes = slice_.layout();
+  if (!bytes)
+    die("failed to deserialize layout: no input");
+  auto layout = layout_interner::instance().intern(
+    span{reinterpret_cast<const std::byte*>(bytes->data()), bytes->size()});
+  if (!layout)
+    die("failed to deserialize layout: " + render(layout.error()));
+  state_.layout = *layout;
+  state_.columns = state_.layout->flat_layout.fields.size();
 }
 
 template <class FlatBuffer>
 msgpack_table_slice<FlatBuffer>::msgpack_table_slice(
   const FlatBuffer& slice, record_type layout) noexcept
   : slice_{slice}, state_{} {
-  state_.layout = std::move(layout);
-  state_.columns = state_.layout.num_leaves();
+  // Look up the layout by the serialized form that the slice carries anyway,
+  // which avoids hashing the deep layout for every table slice.
+  auto& interner = layout_interner::instance();
+  if (const auto* bytes = slice_.layout())
+    state_.layout = &interner.intern(
+      span{reinterpret_cast<const std::byte*>(bytes->data()), bytes->size()},
+      layout);
+  else
+    state_.layout = &interner.intern(layout);
+  state_.columns = state_.layout->flat_layout.fields.size();
 }
 
 template <class FlatBuffer>
@@ -272,7 +293,13 @@ msgpack_table_slice<FlatBuffer>::~msgpack_table_slice() noexcept {
 
 template <class FlatBuffer>
 const record_type& msgpack_table_slice<FlatBuffer>::layout() const noexcept {
-  return state_.layout;
+  return state_.layout->layout;
+}
+
+template <class FlatBuffer>
+const interned_layout&
+msgpack_table_slice<FlatBuffer>::interned() const noexcept {
+  return *state_.layout;
 }
 
 template <class FlatBuffer>
@@ -293,9 +320,8 @@ void msgpack_table_slice<FlatBuffer>::append_column_to_index(
   id offset, table_slice::size_type column, value_index& index) const {
   const auto& offset_table = *slice_.offset_table();
   auto view = as_bytes(*slice_.data());
-  auto layout_offset = state_.layout.offset_from_index(column);
-  VAST_ASSERT(layout_offset);
-  auto type = state_.layout.at(*layout_offset)->type;
+  VAST_ASSERT(column < state_.columns);
+  const auto& type = state_.layout->flat_layout.fields[column].type;
   for (size_t row = 0; row < rows(); ++row) {
     auto row_offset = offset_table[row];
     auto xs = msgpack::overlay{view.subspan(row_offset)};
@@ -318,9 +344,8 @@ msgpack_table_slice<FlatBuffer>::at(table_slice::size_type row,
   auto xs = msgpack::overlay{view.subspan(offset)};
   // ...then skip (decode) up to the desired column.
   xs.next(column);
-  auto layout_offset = state_.layout.offset_from_index(column);
-  VAST_ASSERT(layout_offset);
-  return decode(xs, state_.layout.at(*layout_offset)->type);
+  VAST_ASSERT(column < state_.columns);
+  return decode(xs, state_.layout->flat_layout.fields[column].type);
 }
 
 template <class FlatBuffer>
@@ -331,8 +356,7 @@ data_view msgpack_table_slice<FlatBuffer>::at(table_slice::size_type row,
   auto view = as_bytes(*slice_.data());
   // First find the desired row...
   VAST_ASSERT(row < offset_table.size());
-  VAST_ASSERT(state_.layout.at(*state_.layout.offset_from_index(column))->type
-              == t);
+  VAST_ASSERT(state_.layout->flat_layout.fields[column].type == t);
   auto offset = offset_table[row];
   VAST_ASSERT(offset < static_cast<size_t>(view.size()));
   auto xs = msgpack::overlay{view.subspan(offset)};
@@ -341,6 +365,66 @@ data_view msgpack_table_slice<FlatBuffer>::at(table_slice::size_type row,
   return decode(xs, t);
 }
 
+template <class FlatBuffer>
+void msgpack_table_slice<FlatBuffer>::decode_columns(
+  std::vector<std::vector<data_view>>& result) const {
+  const auto& offset_table = *slice_.offset_table();
+  auto view = as_bytes(*slice_.data());
+  const auto& flat_layout = state_.layout->flat_layout;
+  result.resize(flat_layout.fields.size());
+  for (auto& xs : result) {
+    xs.clear();
+    xs.reserve(rows());
+  }
+  // Unlike `at`, we walk every row only once.
+  for (size_t row = 0; row < rows(); ++row) {
+    auto xs = msgpack::overlay{view.subspan(offset_table[row])};
+    for (size_t column = 0; column < result.size(); ++column) {
+      if (column > 0)
+        xs.next();
+      result[column].push_back(decode(xs, flat_layout.fields[column].type));
+    }
+  }
+}
+
+#if VAST_ENABLE_ARROW
+
+template <class FlatBuffer>
+std::shared_ptr<arrow::RecordBatch>
+msgpack_table_slice<FlatBuffer>::to_record_batch() const {
+  const auto& offset_table = *slice_.offset_table();
+  auto view = as_bytes(*slice_.data());
+  const auto& flat_layout = state_.layout->flat_layout;
+  auto* pool = arrow::default_memory_pool();
+  auto builders = std::vector<
+    std::unique_ptr<arrow_table_slice_builder::column_builder>>{};
+  builders.reserve(flat_layout.fields.size());
+  for (auto& field : flat_layout.fields) {
+    builders.push_back(
+      arrow_table_slice_builder::column_builder::make(field.type, pool));
+    if (!builders.back()->arrow_builder()->Reserve(rows()).ok())
+      return nullptr;
+  }
+  for (size_t row = 0; row < rows(); ++row) {
+    auto xs = msgpack::overlay{view.subspan(offset_table[row])};
+    for (size_t column = 0; column < builders.size(); ++column) {
+      if (column > 0)
+        xs.next();
+      if (!builders[column]->add(
+            decode(xs, flat_layout.fields[column].type)))
+        return nullptr;
+    }
+  }
+  auto columns = std::vector<std::shared_ptr<arrow::Array>>{};
+  columns.reserve(builders.size());
+  for (auto& builder : builders)
+    columns.push_back(builder->finish());
+  return arrow::RecordBatch::Make(make_arrow_schema(flat_layout), rows(),
+                                  std::move(columns));
+}
+
+#endif // VAST_ENABLE_ARROW
+
 // -- template machinery -------------------------------------------------------
 
 /// Explicit template instantiations for all MessagePack encoding versions.
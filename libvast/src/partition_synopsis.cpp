@@ -13,6 +13,8 @@
 
 #include "vast/partition_synopsis.hpp"
 
+#include "vast/concept/hashable/uhash.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
 #include "vast/synopsis_factory.hpp"
 
 namespace vast {
@@ -43,19 +45,21 @@ void partition_synopsis::add(const table_slice& slice,
     return has_skip_attribute(t) ? nullptr
                                  : factory<synopsis>::make(t, synopsis_options);
   };
+  auto sketch_precision = caf::get_or(
+    synopsis_options, "cardinality-sketch-precision", size_t{0});
   auto& layout = slice.layout();
+  layout_counts_[layout.name()] += slice.rows();
   auto each = record_type::each(layout);
   auto field_it = each.begin();
   for (size_t col = 0; col < slice.columns(); ++col, ++field_it) {
     auto& type = field_it->type();
-    auto add_column = [&](const synopsis_ptr& syn) {
-      for (size_t row = 0; row < slice.rows(); ++row) {
-        auto view = slice.at(row, col, type);
-        if (!caf::holds_alternative<caf::none_t>(view))
-          syn->add(std::move(view));
-      }
-    };
     auto key = qualified_record_field{layout.name(), *field_it};
+    detail::hyperloglog* sketch = nullptr;
+    if (sketch_precision > 0 && !has_skip_attribute(type))
+      sketch = &field_sketches_
+                  .try_emplace(key, static_cast<uint8_t>(sketch_precision))
+                  .first->second;
+    synopsis* syn = nullptr;
     if (!caf::holds_alternative<string_type>(type)) {
       // Locate the relevant synopsis.
       auto it = field_synopses_.find(key);
@@ -63,17 +67,27 @@ void partition_synopsis::add(const table_slice& slice,
         // Attempt to create a synopsis if we have never seen this key before.
         it = field_synopses_.emplace(std::move(key), make_synopsis(type)).first;
       }
-      // If there exists a synopsis for a field, add the entire column.
-      if (auto& syn = it->second)
-        add_column(syn);
+      syn = it->second.get();
     } else { // type == string
       field_synopses_[key] = nullptr;
       auto cleaned_type = vast::type{field_it->type()}.attributes({});
       auto tt = type_synopses_.find(cleaned_type);
       if (tt == type_synopses_.end())
         tt = type_synopses_.emplace(cleaned_type, make_synopsis(type)).first;
-      if (auto& syn = tt->second)
-        add_column(syn);
+      syn = tt->second.get();
+    }
+    // If there exists a synopsis or a sketch for a field, add the entire
+    // column.
+    if (!syn && !sketch)
+      continue;
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      auto view = slice.at(row, col, type);
+      if (caf::holds_alternative<caf::none_t>(view))
+        continue;
+      if (sketch)
+        sketch->add(uhash<xxhash64>{}(view));
+      if (syn)
+        syn->add(std::move(view));
     }
   }
 }
@@ -82,6 +96,8 @@ size_t partition_synopsis::memusage() const {
   size_t result = 0;
   for (auto& [field, synopsis] : field_synopses_)
     result += synopsis ? synopsis->memusage() : 0ull;
+  for (auto& [field, sketch] : field_sketches_)
+    result += sketch.memusage();
   return result;
 }
 
@@ -0,0 +1,214 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/rule_pack.hpp"
+
+#include "vast/detail/overload.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/none.hpp>
+
+#include <unordered_set>
+
+namespace vast {
+
+namespace {
+
+/// Visits all predicates of an expression.
+template <class F>
+void for_each_predicate(const expression& expr, F& f) {
+  auto g = detail::overload{
+    [&](caf::none_t) {},
+    [&](const conjunction& xs) {
+      for (auto& x : xs)
+        for_each_predicate(x, f);
+    },
+    [&](const disjunction& xs) {
+      for (auto& x : xs)
+        for_each_predicate(x, f);
+    },
+    [&](const negation& n) { for_each_predicate(n.expr(), f); },
+    [&](const predicate& pred) { f(pred); },
+  };
+  caf::visit(g, expr);
+}
+
+/// Evaluates a rule on the selected rows of a table slice from the hits of
+/// its predicates. Just like `tailor`, the evaluator distinguishes between
+/// subexpressions without hits and subexpressions that do not apply to the
+/// layout of the slice.
+class rule_evaluator {
+public:
+  rule_evaluator(const table_slice& slice,
+                 const std::vector<std::optional<expression>>& plan,
+                 const std::unordered_map<predicate, size_t>& index,
+                 const ids& selection)
+    : slice_{slice}, plan_{plan}, index_{index}, hits_(plan.size()) {
+    all_.append(false, slice.offset());
+    all_.append(true, slice.rows());
+    all_ &= selection;
+  }
+
+  std::optional<ids> operator()(caf::none_t) {
+    return std::nullopt;
+  }
+
+  std::optional<ids> operator()(const conjunction& xs) {
+    std::optional<ids> result;
+    for (auto& x : xs) {
+      auto hits = caf::visit(*this, x);
+      if (!hits)
+        return std::nullopt;
+      if (result)
+        *result &= *hits;
+      else
+        result = std::move(hits);
+    }
+    return result;
+  }
+
+  std::optional<ids> operator()(const disjunction& xs) {
+    std::optional<ids> result;
+    for (auto& x : xs) {
+      auto hits = caf::visit(*this, x);
+      if (!hits)
+        continue;
+      if (result)
+        *result |= *hits;
+      else
+        result = std::move(hits);
+    }
+    return result;
+  }
+
+  std::optional<ids> operator()(const negation& n) {
+    auto hits = caf::visit(*this, n.expr());
+    if (!hits)
+      return std::nullopt;
+    return all_ - *hits;
+  }
+
+  std::optional<ids> operator()(const predicate& pred) {
+    auto i = index_.find(pred);
+    VAST_ASSERT(i != index_.end());
+    auto& tailored = plan_[i->second];
+    if (!tailored)
+      return std::nullopt;
+    // Every distinct predicate gets evaluated at most once per slice.
+    auto& hits = hits_[i->second];
+    if (!hits)
+      hits = vast::evaluate(*tailored, slice_, all_);
+    return hits;
+  }
+
+private:
+  const table_slice& slice_;
+  const std::vector<std::optional<expression>>& plan_;
+  const std::unordered_map<predicate, size_t>& index_;
+  std::vector<std::optional<ids>> hits_;
+  ids all_;
+};
+
+} // namespace
+
+caf::expected<rule_pack> rule_pack::make(std::vector<rule> rules) {
+  if (rules.empty())
+    return caf::make_error(ec::invalid_argument, "rule pack has no rules");
+  rule_pack result;
+  std::unordered_set<std::string> names;
+  disjunction combined;
+  combined.reserve(rules.size());
+  for (auto& [name, expr] : rules) {
+    if (!names.insert(name).second)
+      return caf::make_error(ec::invalid_argument, "duplicate rule", name);
+    auto normalized = normalize_and_validate(expr);
+    if (!normalized)
+      return caf::make_error(ec::invalid_query, "invalid rule", name,
+                             std::move(normalized.error()));
+    auto add = [&](const predicate& pred) {
+      ++result.num_predicate_occurrences_;
+      auto [_, inserted]
+        = result.predicate_index_.emplace(pred, result.predicates_.size());
+      if (inserted)
+        result.predicates_.push_back(pred);
+    };
+    for_each_predicate(*normalized, add);
+    combined.push_back(*normalized);
+    result.rules_.emplace_back(std::move(name), std::move(*normalized));
+  }
+  result.combined_ = normalize(expression{std::move(combined)});
+  return result;
+}
+
+const expression& rule_pack::combined() const {
+  return combined_;
+}
+
+size_t rule_pack::size() const {
+  return rules_.size();
+}
+
+const std::string& rule_pack::name(size_t index) const {
+  VAST_ASSERT(index < rules_.size());
+  return rules_[index].first;
+}
+
+size_t rule_pack::num_predicates() const {
+  return predicates_.size();
+}
+
+size_t rule_pack::num_predicate_occurrences() const {
+  return num_predicate_occurrences_;
+}
+
+std::vector<ids> rule_pack::evaluate(const table_slice& slice) {
+  auto selection
+    = make_ids({{slice.offset(), slice.offset() + slice.rows()}});
+  return evaluate(slice, selection);
+}
+
+std::vector<ids>
+rule_pack::evaluate(const table_slice& slice, const ids& selection) {
+  // Tailor the distinct predicates if we don't have a plan for this layout.
+  const auto& layout = slice.interned();
+  auto* plan = plans_.find(layout.id);
+  if (!plan) {
+    layout_plan fresh;
+    fresh.reserve(predicates_.size());
+    for (auto& pred : predicates_) {
+      auto tailored = tailor(expression{pred}, layout.layout_type);
+      if (!tailored) {
+        VAST_DEBUG("rule pack failed to tailor {} to layout {}: {}", pred,
+                   layout.layout.name(), tailored.error());
+        fresh.emplace_back(std::nullopt);
+      } else if (caf::holds_alternative<caf::none_t>(*tailored)) {
+        fresh.emplace_back(std::nullopt);
+      } else {
+        fresh.emplace_back(std::move(*tailored));
+      }
+    }
+    plan = &plans_.insert(layout.id, std::move(fresh));
+  }
+  auto f = rule_evaluator{slice, *plan, predicate_index_, selection};
+  std::vector<ids> result;
+  result.reserve(rules_.size());
+  for (auto& [_, expr] : rules_) {
+    auto hits = caf::visit(f, expr);
+    result.push_back(hits ? std::move(*hits) : ids{});
+  }
+  return result;
+}
+
+} // namespace vast
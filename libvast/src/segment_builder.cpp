@@ -27,6 +27,8 @@
 
 #include <caf/binary_serializer.hpp>
 
+#include <iterator>
+
 namespace vast {
 
 segment_builder::segment_builder(size_t initial_buffer_size)
@@ -35,14 +37,23 @@ segment_builder::segment_builder(size_t initial_buffer_size)
 }
 
 caf::error segment_builder::add(table_slice x) {
-  if (x.offset() < min_table_slice_offset_)
-    return caf::make_error(ec::unspecified, "slice offsets not increasing");
+  auto first = x.offset();
+  auto last = first + x.rows();
+  // Slices mostly arrive in order, so we search for the insertion point from
+  // the back.
+  auto i = intervals_.end();
+  while (i != intervals_.begin() && std::prev(i)->begin() > first)
+    --i;
+  if ((i != intervals_.end() && i->begin() < last)
+      || (i != intervals_.begin() && std::prev(i)->end() > first))
+    return caf::make_error(ec::unspecified, "slice offsets overlap");
+  auto position = i - intervals_.begin();
   auto bytes = fbs::pack_bytes(builder_, x);
   auto slice = fbs::CreateFlatTableSlice(builder_, bytes);
-  flat_slices_.push_back(slice);
-  intervals_.emplace_back(x.offset(), x.offset() + x.rows());
+  flat_slices_.insert(flat_slices_.begin() + position, slice);
+  intervals_.emplace(i, first, last);
   num_events_ += x.rows();
-  slices_.push_back(x);
+  slices_.insert(slices_.begin() + position, std::move(x));
   return caf::none;
 }
 
@@ -104,7 +115,6 @@ const std::vector<table_slice>& segment_builder::table_slices() const {
 
 void segment_builder::reset() {
   id_ = uuid::random();
-  min_table_slice_offset_ = 0;
   num_events_ = 0;
   builder_.Clear();
   flat_slices_.clear();
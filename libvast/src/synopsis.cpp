@@ -13,12 +13,16 @@
 
 #include "vast/synopsis.hpp"
 
+#include "vast/address_synopsis.hpp"
 #include "vast/bool_synopsis.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/error.hpp"
 #include "vast/fbs/utils.hpp"
+#include "vast/flatbuffer_synopsis.hpp"
 #include "vast/logger.hpp"
 #include "vast/qualified_record_field.hpp"
+#include "vast/string_synopsis.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/time_synopsis.hpp"
 
@@ -51,6 +55,14 @@ caf::error inspect(caf::serializer& sink, synopsis_ptr& ptr) {
     static type dummy;
     return sink(dummy);
   }
+  // Synopses that reference a FlatBuffer must be materialized first, because
+  // their type lacks the information required for deserialization.
+  if (auto fb = dynamic_cast<const flatbuffer_synopsis*>(ptr.get())) {
+    auto materialized = fb->materialize();
+    if (!materialized)
+      return materialized.error();
+    return inspect(sink, *materialized);
+  }
   return caf::error::eval(
     [&] { return sink(ptr->type()); },
     [&] { return ptr->serialize(sink); });
@@ -78,13 +90,79 @@ caf::error inspect(caf::deserializer& source, synopsis_ptr& ptr) {
   return caf::none;
 }
 
+namespace {
+
+template <class T>
+caf::expected<flatbuffers::Offset<fbs::synopsis::v0>>
+pack(flatbuffers::FlatBufferBuilder& builder,
+     const bloom_filter_synopsis<T, xxhash64>& synopsis,
+     flatbuffers::Offset<flatbuffers::Vector<uint8_t>> column_name) {
+  auto type = fbs::serialize_bytes(builder, synopsis.type());
+  if (!type)
+    return type.error();
+  auto& filter = synopsis.filter();
+  auto hasher_seeds = filter.hasher().seeds();
+  auto seeds = builder.CreateVector(
+    std::vector<uint64_t>(hasher_seeds.begin(), hasher_seeds.end()));
+  auto bits = builder.CreateVector(filter.bits().blocks());
+  fbs::bloom_filter_synopsis::v0Builder bloom_filter_builder(builder);
+  bloom_filter_builder.add_type(*type);
+  bloom_filter_builder.add_num_hash_functions(filter.num_hash_functions());
+  bloom_filter_builder.add_seeds(seeds);
+  bloom_filter_builder.add_size(filter.size());
+  bloom_filter_builder.add_bits(bits);
+  auto bloom_filter_synopsis = bloom_filter_builder.Finish();
+  fbs::synopsis::v0Builder synopsis_builder(builder);
+  synopsis_builder.add_qualified_record_field(column_name);
+  synopsis_builder.add_bloom_filter_synopsis(bloom_filter_synopsis);
+  return synopsis_builder.Finish();
+}
+
+caf::error
+unpack(const fbs::bloom_filter_synopsis::v0& synopsis, synopsis_ptr& ptr) {
+  type t;
+  if (auto error = fbs::deserialize_bytes(synopsis.type(), t))
+    return error;
+  if (!synopsis.seeds() || synopsis.seeds()->size() != 2)
+    return caf::make_error(ec::format_error, "invalid Bloom filter seeds");
+  if (!synopsis.bits() || synopsis.num_hash_functions() == 0)
+    return caf::make_error(ec::format_error, "invalid Bloom filter");
+  auto seeds = std::vector<size_t>(synopsis.seeds()->begin(),
+                                   synopsis.seeds()->end());
+  auto hasher = double_hasher<xxhash64>{synopsis.num_hash_functions(), seeds};
+  auto bits = bitvector<uint64_t>{};
+  bits.append_blocks(synopsis.bits()->begin(), synopsis.bits()->end());
+  if (bits.size() < synopsis.size())
+    return caf::make_error(ec::format_error, "truncated Bloom filter");
+  bits.resize(synopsis.size());
+  auto filter = bloom_filter<xxhash64>{std::move(hasher), std::move(bits)};
+  if (caf::holds_alternative<address_type>(t))
+    ptr = std::make_unique<address_synopsis<xxhash64>>(std::move(t),
+                                                       std::move(filter));
+  else if (caf::holds_alternative<string_type>(t))
+    ptr = std::make_unique<string_synopsis<xxhash64>>(std::move(t),
+                                                      std::move(filter));
+  else
+    return caf::make_error(ec::format_error, "unsupported Bloom filter "
+                                             "synopsis type");
+  return caf::none;
+}
+
+} // namespace
+
 caf::expected<flatbuffers::Offset<fbs::synopsis::v0>>
 pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
-     const qualified_record_field& fqf) {
+     const qualified_record_field& fqf, bool native_bloom_filters) {
   auto column_name = fbs::serialize_bytes(builder, fqf);
   if (!column_name)
     return column_name.error();
   auto ptr = synopsis.get();
+  if (auto fptr = dynamic_cast<flatbuffer_synopsis*>(ptr)) {
+    auto materialized = fptr->materialize();
+    if (!materialized)
+      return materialized.error();
+    return pack(builder, *materialized, fqf, native_bloom_filters);
+  }
   if (auto tptr = dynamic_cast<time_synopsis*>(ptr)) {
     auto min = tptr->min().time_since_epoch().count();
     auto max = tptr->max().time_since_epoch().count();
@@ -99,6 +177,14 @@ pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
     synopsis_builder.add_qualified_record_field(*column_name);
     synopsis_builder.add_bool_synopsis(&bool_synopsis);
     return synopsis_builder.Finish();
+  } else if (auto aptr
+             = dynamic_cast<bloom_filter_synopsis<address, xxhash64>*>(ptr);
+             aptr && native_bloom_filters) {
+    return pack(builder, *aptr, *column_name);
+  } else if (auto sptr = dynamic_cast<
+               bloom_filter_synopsis<std::string, xxhash64>*>(ptr);
+             sptr && native_bloom_filters) {
+    return pack(builder, *sptr, *column_name);
   } else {
     auto data = fbs::serialize_bytes(builder, synopsis);
     if (!data)
@@ -128,6 +214,9 @@ caf::error unpack(const fbs::synopsis::v0& synopsis, synopsis_ptr& ptr) {
       os->data()->size());
     if (auto error = sink(ptr))
       return error;
+  } else if (auto bs = synopsis.bloom_filter_synopsis()) {
+    if (auto error = unpack(*bs, ptr))
+      return error;
   } else {
     return caf::make_error(ec::format_error, "no synopsis type");
   }
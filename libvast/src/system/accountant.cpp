@@ -24,6 +24,7 @@
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/path.hpp"
+#include "vast/system/metrics_registry.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -35,9 +36,14 @@
 
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <ios>
 #include <limits>
 #include <queue>
+#include <string_view>
+#include <type_traits>
 
 namespace vast::system {
 
@@ -45,6 +51,37 @@ namespace {
 
 constexpr std::chrono::seconds overview_delay(3);
 
+/// The name of the actor column for metrics sampled from the registry.
+constexpr const char* registry_actor_name = "registry";
+
+/// The magic number at the beginning of a binary metrics record: "VMET".
+constexpr uint32_t binary_metrics_magic = 0x544d4556;
+
+/// The version of the binary metrics record format.
+constexpr uint8_t binary_metrics_version = 1;
+
+template <class T>
+void append_binary(std::vector<char>& buf, T x) {
+  static_assert(std::is_arithmetic_v<T>);
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &x, sizeof(T));
+  buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+
+void append_binary(std::vector<char>& buf, std::string_view x) {
+  auto size = static_cast<uint16_t>(
+    std::min(x.size(), size_t{std::numeric_limits<uint16_t>::max()}));
+  append_binary(buf, size);
+  buf.insert(buf.end(), x.begin(), x.begin() + size);
+}
+
+/// A single metric value on its way to the sinks.
+struct metric {
+  std::string_view actor;
+  std::string_view key;
+  real value;
+};
+
 } // namespace
 
 struct accountant_state_impl {
@@ -89,6 +126,13 @@ struct accountant_state_impl {
   /// The configuration.
   accountant_config cfg;
 
+  /// Scratch space for rendering metrics.
+  std::vector<char> buf;
+
+  /// The time of the last command line heartbeat.
+  std::chrono::steady_clock::time_point last_heartbeat
+    = std::chrono::steady_clock::now();
+
   // -- utility functions ------------------------------------------------------
 
   void finish_slice() {
@@ -102,15 +146,12 @@ struct accountant_state_impl {
     mgr->advance();
   }
 
-  void record_internally(const std::string& key, real x, time ts) {
-    // This is a workaround to a bug that is somewhere else -- the index cannot
-    // handle NaN, and a bug that we were unable to reproduce reliably caused
-    // the accountant to forward NaN to the index here.
-    if (!std::isfinite(x)) {
-      VAST_DEBUG("{} cannot record a non-finite metric", self);
-      return;
-    }
-    auto actor_id = self->current_sender()->id();
+  const std::string& sender_name() {
+    return actor_map[self->current_sender()->id()];
+  }
+
+  void record_internally(std::string_view actor, std::string_view key, real x,
+                         time ts) {
     if (!builder) {
       auto layout = record_type{
       {"ts", time_type{}.attributes({{"timestamp"}})},
@@ -122,43 +163,89 @@ struct accountant_state_impl {
         = factory<table_slice_builder>::make(cfg.self_sink.slice_type, layout);
       VAST_DEBUG("{} obtained a table slice builder", self);
     }
-    VAST_ASSERT(builder->add(ts, actor_map[actor_id], key, x));
+    VAST_ASSERT(builder->add(ts, actor, key, x));
     if (builder->rows() == static_cast<size_t>(cfg.self_sink.slice_size))
       finish_slice();
   }
 
-  std::ostream& record_to_output(const std::string& key, real x, time ts,
-                                 std::ostream& os, bool real_time) {
+  /// Renders metrics as JSON lines, one line per metric.
+  static void render_json(std::vector<char>& buf, const metric* first,
+                          const metric* last, time ts) {
     using namespace std::string_view_literals;
-    auto actor_id = self->current_sender()->id();
     json_printer<policy::oneline> printer;
-    std::vector<char> buf;
     auto iter = std::back_inserter(buf);
-    *iter++ = '{';
-    printer.print(iter, std::pair{"ts"sv, make_data_view(ts)});
-    *iter++ = ',';
-    printer.print(iter,
-                  std::pair{"actor"sv, make_data_view(actor_map[actor_id])});
-    *iter++ = ',';
-    printer.print(iter, std::pair{"key"sv, make_data_view(key)});
-    *iter++ = ',';
-    printer.print(iter, std::pair{"value"sv, make_data_view(x)});
-    *iter++ = '}';
-    *iter++ = '\n';
-    os.write(buf.data(), buf.size());
-    if (real_time)
-      os << std::flush;
-    return os;
+    for (; first != last; ++first) {
+      *iter++ = '{';
+      printer.print(iter, std::pair{"ts"sv, make_data_view(ts)});
+      *iter++ = ',';
+      printer.print(iter, std::pair{"actor"sv, make_data_view(first->actor)});
+      *iter++ = ',';
+      printer.print(iter, std::pair{"key"sv, make_data_view(first->key)});
+      *iter++ = ',';
+      printer.print(iter, std::pair{"value"sv, make_data_view(first->value)});
+      *iter++ = '}';
+      *iter++ = '\n';
+    }
+  }
+
+  /// Renders metrics as a single binary record in host byte order:
+  /// a 4-byte magic number, a 1-byte version, a 2-byte number of metrics, and
+  /// an 8-byte timestamp in nanoseconds since the epoch, followed by the
+  /// metrics. Every metric consists of the actor name and the key, each
+  /// prefixed with its 2-byte length, and an 8-byte IEEE 754 value.
+  static void render_binary(std::vector<char>& buf, const metric* first,
+                            const metric* last, time ts) {
+    // Records contain at most 65535 metrics, so we split larger batches.
+    constexpr auto max_metrics = size_t{std::numeric_limits<uint16_t>::max()};
+    while (first != last) {
+      auto n = std::min(static_cast<size_t>(last - first), max_metrics);
+      append_binary(buf, binary_metrics_magic);
+      append_binary(buf, binary_metrics_version);
+      append_binary(buf, static_cast<uint16_t>(n));
+      append_binary(buf, ts.time_since_epoch().count());
+      for (auto end = first + n; first != end; ++first) {
+        append_binary(buf, first->actor);
+        append_binary(buf, first->key);
+        append_binary(buf, first->value);
+      }
+    }
+  }
+
+  /// Writes metrics to all enabled sinks.
+  void record(const metric* first, const metric* last, time ts) {
+    if (cfg.self_sink.enable)
+      for (auto x = first; x != last; ++x)
+        record_internally(x->actor, x->key, x->value, ts);
+    if (file_sink) {
+      buf.clear();
+      render_json(buf, first, last, ts);
+      file_sink->write(buf.data(), buf.size());
+      if (cfg.file_sink.real_time)
+        *file_sink << std::flush;
+    }
+    if (uds_sink) {
+      buf.clear();
+      if (cfg.uds_sink.binary)
+        render_binary(buf, first, last, ts);
+      else
+        render_json(buf, first, last, ts);
+      uds_sink->write(buf.data(), buf.size());
+      if (cfg.uds_sink.real_time)
+        *uds_sink << std::flush;
+    }
   }
 
   void record(const std::string& key, real x,
               time ts = std::chrono::system_clock::now()) {
-    if (cfg.self_sink.enable)
-      record_internally(key, x, ts);
-    if (file_sink)
-      record_to_output(key, x, ts, *file_sink, cfg.file_sink.real_time);
-    if (uds_sink)
-      record_to_output(key, x, ts, *uds_sink, cfg.uds_sink.real_time);
+    // This is a workaround to a bug that is somewhere else -- the index cannot
+    // handle NaN, and a bug that we were unable to reproduce reliably caused
+    // the accountant to forward NaN to the index here.
+    if (!std::isfinite(x)) {
+      VAST_DEBUG("{} cannot record a non-finite metric", self);
+      return;
+    }
+    auto x_metric = metric{sender_name(), key, x};
+    record(&x_metric, &x_metric + 1, ts);
   }
 
   void record(const std::string& key, duration x,
@@ -172,6 +259,63 @@ struct accountant_state_impl {
     record(key, x.time_since_epoch(), ts);
   }
 
+  /// Emits the values of all metrics in the registry in a single batch.
+  void sample_registry() {
+    auto snapshot = metrics_registry::instance().sample();
+    if (cfg.prometheus_sink.enable)
+      write_prometheus(snapshot);
+    auto keys = std::vector<std::string>{};
+    auto values = std::vector<real>{};
+    for (auto& [name, value] : snapshot.counters) {
+      keys.push_back(name);
+      values.push_back(static_cast<real>(value));
+    }
+    for (auto& [name, value] : snapshot.gauges) {
+      keys.push_back(name);
+      values.push_back(static_cast<real>(value));
+    }
+    for (auto& [name, histogram] : snapshot.histograms) {
+      if (histogram.count == 0)
+        continue;
+      auto add = [&](const char* suffix, uint64_t x) {
+        keys.push_back(name + suffix);
+        values.push_back(static_cast<real>(x));
+      };
+      add(".count", histogram.count);
+      add(".sum", histogram.sum);
+      add(".p50", histogram.quantile(0.5));
+      add(".p90", histogram.quantile(0.9));
+      add(".p99", histogram.quantile(0.99));
+      add(".max", histogram.max);
+    }
+    if (keys.empty())
+      return;
+    auto metrics = std::vector<metric>{};
+    metrics.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+      metrics.push_back({registry_actor_name, keys[i], values[i]});
+    record(metrics.data(), metrics.data() + metrics.size(),
+           std::chrono::system_clock::now());
+  }
+
+  /// Replaces the Prometheus exposition file atomically, such that scrapers
+  /// never observe a partially written file.
+  void write_prometheus(const metrics_snapshot& snapshot) {
+    auto text = to_prometheus(snapshot);
+    auto tmp = cfg.prometheus_sink.path + ".tmp";
+    {
+      std::ofstream out{tmp, std::ios::trunc};
+      out << text;
+      if (!out) {
+        VAST_WARN("{} failed to write Prometheus metrics to {}", self, tmp);
+        return;
+      }
+    }
+    if (std::rename(tmp.c_str(), cfg.prometheus_sink.path.c_str()) != 0)
+      VAST_WARN("{} failed to move Prometheus metrics to {}", self,
+                cfg.prometheus_sink.path);
+  }
+
   void command_line_heartbeat() {
 #if VAST_LOG_LEVEL >= VAST_LOG_LEVEL_DEBUG
     if (accumulator.events > 0)
@@ -262,7 +406,8 @@ accountant(accountant_actor::stateful_pointer<accountant_state> self,
     // done?
     [](const bool&) { return false; });
   VAST_DEBUG("{} animates heartbeat loop", self);
-  self->delayed_send(self, overview_delay, atom::telemetry_v);
+  self->delayed_send(self, self->state->cfg.sample_interval,
+                     atom::telemetry_v);
   return {
     [self](atom::announce, const std::string& name) {
       auto& st = *self->state;
@@ -342,8 +487,14 @@ accountant(accountant_actor::stateful_pointer<accountant_state> self,
       return result;
     },
     [self](atom::telemetry) {
-      self->state->command_line_heartbeat();
-      self->delayed_send(self, overview_delay, atom::telemetry_v);
+      auto& st = *self->state;
+      auto now = std::chrono::steady_clock::now();
+      if (now - st.last_heartbeat >= overview_delay) {
+        st.command_line_heartbeat();
+        st.last_heartbeat = now;
+      }
+      st.sample_registry();
+      self->delayed_send(self, st.cfg.sample_interval, atom::telemetry_v);
     },
     [self](atom::config, accountant_config cfg) {
       self->state->apply_config(std::move(cfg));
@@ -0,0 +1,121 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/aggregate_command.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/data.hpp"
+#include "vast/defaults.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/scope_linked.hpp"
+#include "vast/system/estimate.hpp"
+#include "vast/system/read_query.hpp"
+#include "vast/system/signal_monitor.hpp"
+#include "vast/system/spawn_or_connect_to_node.hpp"
+#include "vast/system/value_counts.hpp"
+
+#include <caf/actor.hpp>
+#include <caf/scoped_actor.hpp>
+#include <caf/settings.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace vast::system {
+
+caf::message
+aggregate_command(const invocation& inv, caf::actor_system& sys) {
+  VAST_DEBUG("{}", inv);
+  const auto& options = inv.options;
+  if (caf::get_or(options, "vast.aggregate.by", "").empty())
+    return caf::make_message(caf::make_error(
+      ec::invalid_configuration, "aggregate requires --by=<field>"));
+  // Read query from input file, STDIN or CLI arguments.
+  auto query = read_query(inv, "vast.aggregate.read");
+  if (!query)
+    return caf::make_message(std::move(query.error()));
+  // Get a convenient and blocking way to interact with actors.
+  caf::scoped_actor self{sys};
+  // Get VAST node.
+  auto node_opt
+    = system::spawn_or_connect_to_node(self, options, content(sys.config()));
+  if (auto err = caf::get_if<caf::error>(&node_opt))
+    return caf::make_message(std::move(*err));
+  auto& node = caf::holds_alternative<node_actor>(node_opt)
+                 ? caf::get<node_actor>(node_opt)
+                 : caf::get<scope_linked<node_actor>>(node_opt).get();
+  VAST_ASSERT(node != nullptr);
+  // Answer from the META INDEX alone if an upper bound over the persisted
+  // events suffices.
+  if (caf::get_or(options, "vast.aggregate.approximate", false)) {
+    if (!caf::get_or(options, "vast.aggregate.distinct", false))
+      return caf::make_message(caf::make_error(
+        ec::invalid_configuration, "approximate aggregation requires "
+                                   "--distinct"));
+    auto result = distinct_upper_bound(
+      self, node, *query, caf::get_or(options, "vast.aggregate.by", ""),
+      !caf::get_or(options, "vast.aggregate.disable-taxonomies", false));
+    if (!result)
+      return caf::make_message(std::move(result.error()));
+    std::cout << std::llround(*result)
+              << " (upper bound over persisted events)" << std::endl;
+    return caf::none;
+  }
+  // Start signal monitor.
+  std::thread sig_mon_thread;
+  auto guard = system::signal_monitor::run_guarded(
+    sig_mon_thread, sys, defaults::system::signal_monitoring_interval, self);
+  // Spawn AGGREGATOR at the node.
+  caf::actor agg;
+  auto args = invocation{options, "spawn aggregator", {*query}};
+  VAST_DEBUG("{} spawns aggregator with parameters: {}",
+             detail::pretty_type_name(inv.full_name), query);
+  caf::error err;
+  self->request(node, caf::infinite, atom::spawn_v, std::move(args))
+    .receive(
+      [&](caf::actor actor) {
+        agg = std::move(actor);
+        if (!agg)
+          err = caf::make_error(ec::invalid_result, //
+                                "remote spawn returned nullptr");
+      },
+      [&](caf::error e) { //
+        err = std::move(e);
+      });
+  if (err)
+    return caf::make_message(std::move(err));
+  self->send(agg, atom::run_v, self);
+  bool aggregating = true;
+  value_counts result;
+  self->receive_while
+    // Loop until false.
+    (aggregating)
+    // Message handlers.
+    ([&](value_counts& x) { result.merge(x); },
+     [&](atom::done) { aggregating = false; });
+  if (caf::get_or(options, "vast.aggregate.distinct", false)) {
+    std::cout << result.distinct() << std::endl;
+    return caf::none;
+  }
+  auto k = caf::get_or(options, "vast.aggregate.top", size_t{0});
+  for (auto& [value, n] : result.top(k))
+    std::cout << to_string(value) << '\t' << n << '\n';
+  std::cout << std::flush;
+  return caf::none;
+}
+
+} // namespace vast::system
@@ -0,0 +1,108 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/aggregator.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/defaults.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/view.hpp"
+
+#include <caf/event_based_actor.hpp>
+
+namespace vast::system {
+
+void aggregation_worker_state::add(const table_slice& slice) {
+  // Construct an aggregation plan if we don't have one for this layout.
+  const auto& layout = slice.interned();
+  auto* plan = plans.find(layout.id);
+  if (!plan) {
+    layout_plan fresh;
+    if (auto x = tailor(expr, layout.layout_type)) {
+      fresh.checker = std::move(*x);
+      auto offsets = layout.layout.find_suffix(field);
+      if (!offsets.empty())
+        fresh.column = layout.layout.flat_index_at(offsets.front());
+      if (fresh.column)
+        fresh.column_type = layout.flat_layout.fields[*fresh.column].type;
+      else
+        VAST_DEBUG("{} found no field {} in layout {}", self, field,
+                   layout.layout.name());
+    } else {
+      VAST_ERROR("{} failed to tailor expression: {}", self,
+                 self->system().render(x.error()));
+    }
+    plan = &plans.insert(layout.id, std::move(fresh));
+  }
+  if (!plan->column)
+    return;
+  // Perform the candidate check on our hits only, because the slices from the
+  // ARCHIVE may contain other events, and only decode the grouping column of
+  // the matching rows.
+  auto offset = slice.offset();
+  for (auto id : select(evaluate(plan->checker, slice, hits)))
+    result.add(
+      materialize(slice.at(id - offset, *plan->column, plan->column_type)));
+}
+
+caf::behavior aggregation_worker(
+  caf::stateful_actor<aggregation_worker_state>* self, expression expr,
+  std::string field, ids hits, archive_actor archive, caf::actor parent) {
+  self->state.self = self;
+  self->state.expr = std::move(expr);
+  self->state.field = std::move(field);
+  self->state.hits = hits;
+  self->send(archive, atom::exporter_v, caf::actor_cast<caf::actor>(self));
+  self->send(archive, std::move(hits),
+             caf::actor_cast<archive_client_actor>(self));
+  return {
+    [self](table_slice slice) { self->state.add(slice); },
+    [self, parent](atom::done, const caf::error& err) {
+      if (err && err != ec::no_error)
+        VAST_WARN("{} failed to fetch candidates from the archive: {}", self,
+                  self->system().render(err));
+      self->send(parent, std::move(self->state.result));
+      self->quit();
+    },
+  };
+}
+
+aggregator_state::aggregator_state(caf::event_based_actor* self)
+  : super(self) {
+  // nop
+}
+
+void aggregator_state::init(expression expr, std::string field,
+                            index_actor index, archive_actor archive) {
+  expr_ = expr;
+  field_ = std::move(field);
+  super::init(std::move(expr), std::move(index), std::move(archive),
+              defaults::system::max_query_workers);
+}
+
+void aggregator_state::spawn_worker(ids hits) {
+  self_->spawn<caf::linked>(aggregation_worker, expr_, field_, std::move(hits),
+                            archive_, caf::actor_cast<caf::actor>(self_));
+}
+
+caf::behavior
+aggregator(caf::stateful_actor<aggregator_state>* self, expression expr,
+           std::string field, index_actor index, archive_actor archive) {
+  self->state.init(std::move(expr), std::move(field), std::move(index),
+                   std::move(archive));
+  return self->state.behavior();
+}
+
+} // namespace vast::system
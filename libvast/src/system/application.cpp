@@ -29,10 +29,12 @@
 #include "vast/format/test.hpp"
 #include "vast/format/zeek.hpp"
 #include "vast/plugin.hpp"
+#include "vast/system/aggregate_command.hpp"
 #include "vast/system/configuration.hpp"
 #include "vast/system/count_command.hpp"
 #include "vast/system/explore_command.hpp"
 #include "vast/system/get_command.hpp"
+#include "vast/system/hunt_command.hpp"
 #include "vast/system/import_command.hpp"
 #include "vast/system/infer_command.hpp"
 #include "vast/system/pivot_command.hpp"
@@ -68,7 +70,12 @@ command::opts_builder add_index_opts(command::opts_builder ob) {
                                             "partitions")
     .add<size_t>("max-taste-partitions", "maximum number of immediately "
                                          "scheduled partitions")
-    .add<size_t>("max-queries,q", "maximum number of concurrent queries");
+    .add<size_t>("max-queries,q", "maximum number of concurrent queries")
+    .add<size_t>("result-cache-size", "maximum size of cached query results "
+                                      "in bytes")
+    .add<size_t>("cardinality-sketch-precision",
+                 "precision of the per-field cardinality sketches in the "
+                 "meta index (4-18, 0 to disable)");
 }
 
 command::opts_builder add_archive_opts(command::opts_builder ob) {
@@ -77,6 +84,21 @@ command::opts_builder add_archive_opts(command::opts_builder ob) {
     .add<size_t>("max-segment-size,m", "maximum segment size in MB");
 }
 
+auto make_aggregate_command() {
+  return std::make_unique<command>(
+    "aggregate", "count hits for a query grouped by the values of a field",
+    documentation::vast_aggregate,
+    opts("?vast.aggregate")
+      .add<std::string>("by,b", "field (suffix) to group by")
+      .add<size_t>("top,k", "print only the k most frequent values")
+      .add<bool>("distinct,d", "print only the number of distinct values")
+      .add<bool>("approximate,a", "estimate an upper bound for the distinct "
+                                  "values of all persisted events in the "
+                                  "candidate partitions")
+      .add<bool>("disable-taxonomies", "don't substitute taxonomy "
+                                       "identifiers"));
+}
+
 auto make_count_command() {
   return std::make_unique<command>(
     "count", "count hits for a query without exporting data",
@@ -84,7 +106,9 @@ auto make_count_command() {
     opts("?vast.count")
       .add<bool>("disable-taxonomies", "don't substitute taxonomy identifiers")
       .add<bool>("estimate,e", "estimate an upper bound by "
-                               "skipping candidate checks"));
+                               "skipping candidate checks")
+      .add<bool>("approximate,a", "count all persisted events in the "
+                                  "candidate partitions as an upper bound"));
 }
 
 auto make_dump_command() {
@@ -151,9 +175,15 @@ auto make_export_command() {
 #if VAST_ENABLE_ARROW
   // The Arrow export does not support --write or --uds, so we don't use the
   // sink_opts here intentionally.
-  export_->add_subcommand("arrow", "exports query results in Arrow format",
-                          documentation::vast_export_arrow,
-                          opts("?vast.export.arrow"));
+  export_->add_subcommand(
+    "arrow", "exports query results in Arrow format",
+    documentation::vast_export_arrow,
+    opts("?vast.export.arrow")
+      .add<std::string>("directory", "write one Arrow IPC file per layout "
+                                     "into this directory")
+      .add<size_t>("batch-size", "minimum number of rows per record batch")
+      .add<size_t>("max-buffered-bytes", "maximum number of bytes to buffer "
+                                         "across all layouts"));
 
 #endif
 #if VAST_ENABLE_PCAP
@@ -171,6 +201,15 @@ auto make_get_command() {
       .add<std::string>("format", "output format (default: JSON)"));
 }
 
+auto make_hunt_command() {
+  return std::make_unique<command>(
+    "hunt", "count the matches of a set of Sigma rules in a single query",
+    documentation::vast_hunt,
+    opts("?vast.hunt")
+      .add<bool>("disable-taxonomies", "don't substitute taxonomy "
+                                       "identifiers"));
+}
+
 auto make_infer_command() {
   return std::make_unique<command>(
     "infer", "infers the schema from data", documentation::vast_infer,
@@ -183,19 +222,29 @@ auto make_import_command() {
   auto import_ = std::make_unique<command>(
     "import", "imports data from STDIN or file", documentation::vast_import,
     opts("?vast.import")
+      .add<bool>("adaptive-batch-size", "adapt the size of table slices to "
+                                        "the input rate")
       .add<std::string>("batch-encoding", "encoding type of table slices "
-                                          "(arrow or msgpack)")
+                                          "(arrow, msgpack, or auto)")
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
       .add<bool>("blocking,b", "block until the IMPORTER forwarded all data")
+      .add<bool>("community-id", "add Community IDs to Zeek conn and "
+                                 "Suricata flow events that lack them")
+      .add<std::string>("importer", "label of the IMPORTER that assigns "
+                                    "IDs to the events")
       .add<std::string>("listen,l", "the endpoint to listen on "
                                     "([host]:port/type)")
+      .add<size_t>("listen-buffer", "number of datagrams to buffer when "
+                                    "listening on UDP (0 disables batching)")
       .add<size_t>("max-events,n", "the maximum number of events to import")
       .add<std::string>("read,r", "path to input where to read events from")
       .add<std::string>("read-timeout", "timeout for waiting for incoming data")
       .add<std::string>("schema,S", "alternate schema as string")
       .add<std::string>("schema-file,s", "path to alternate schema")
+      .add<bool>("shared-memory", "send table slices to a node on the same "
+                                  "host via shared memory")
       .add<std::string>("type,t", "filter event type based on prefix matching")
       .add<bool>("uds,d", "treat -r as listening UNIX domain socket"));
   // NOTICE: The `source_opts` are relocated in `command.cpp:fixup_options()`,
@@ -239,7 +288,9 @@ auto make_import_command() {
       .add<double>("drop-rate-threshold", "drop rate that must be exceeded for "
                                           "warnings to occur")
       .add<bool>("disable-community-id", "disable computation of community id "
-                                         "for every packet"));
+                                         "for every packet")
+      .add<size_t>("shards", "number of threads processing packets of a "
+                             "trace file"));
 #endif
   return import_;
 }
@@ -276,13 +327,19 @@ auto make_spawn_source_command() {
     "source", "creates a new source inside the node",
     documentation::vast_spawn_source,
     opts("?vast.spawn.source")
+      .add<bool>("adaptive-batch-size", "adapt the size of table slices to "
+                                        "the input rate")
       .add<std::string>("batch-encoding", "encoding type of table slices "
-                                          "(arrow or msgpack)")
+                                          "(arrow, msgpack, or auto)")
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
+      .add<std::string>("importer", "label of the IMPORTER that assigns "
+                                    "IDs to the events")
       .add<std::string>("listen,l", "the endpoint to listen on "
                                     "([host]:port/type)")
+      .add<size_t>("listen-buffer", "number of datagrams to buffer when "
+                                    "listening on UDP (0 disables batching)")
       .add<size_t>("max-events,n", "the maximum number of events to import")
       .add<std::string>("read,r", "path to input where to read events from")
       .add<std::string>("read-timeout", "timeout for waiting for incoming data")
@@ -314,7 +371,9 @@ auto make_spawn_source_command() {
       .add<double>("drop-rate-threshold", "drop rate that must be exceeded for "
                                           "warnings to occur")
       .add<bool>("disable-community-id", "disable computation of community id "
-                                         "for every packet"));
+                                         "for every packet")
+      .add<size_t>("shards", "number of threads processing packets of a "
+                             "trace file"));
 #endif
   spawn_source->add_subcommand("suricata",
                                "creates a new Suricata source inside the node",
@@ -358,9 +417,10 @@ auto make_spawn_sink_command() {
 }
 
 auto make_spawn_command() {
-  auto spawn
-    = std::make_unique<command>("spawn", "creates a new component",
-                                documentation::vast_spawn, opts("?vast.spawn"));
+  auto spawn = std::make_unique<command>(
+    "spawn", "creates a new component", documentation::vast_spawn,
+    opts("?vast.spawn")
+      .add<std::string>("label", "unique label of the new component"));
   spawn->add_subcommand("accountant", "spawns the accountant", "",
                         opts("?vast.spawn.accountant"), false);
   spawn->add_subcommand("archive", "creates a new archive", "",
@@ -404,7 +464,14 @@ auto make_start_command() {
       .add<size_t>("disk-budget-check-interval", "time between two disk size "
                                                  "scans")
       .add<std::string>("disk-budget-high", "high-water mark for disk budget")
-      .add<std::string>("disk-budget-low", "low-water mark for disk budget"));
+      .add<std::string>("disk-budget-low", "low-water mark for disk budget")
+      .add<size_t>("compaction-target-size", "merge partitions with fewer "
+                                             "events into partitions of up "
+                                             "to this size")
+      .add<size_t>("compaction-max-concurrency", "maximum number of "
+                                                 "concurrent compactions")
+      .add<size_t>("compaction-interval", "time between two scans for "
+                                          "small partitions"));
 }
 
 auto make_stop_command() {
@@ -423,6 +490,7 @@ auto make_command_factory() {
   // well iff necessary
   // clang-format off
   return command::factory{
+    {"aggregate", aggregate_command},
     {"count", count_command},
     {"dump", remote_command},
     {"dump concepts", remote_command},
@@ -440,6 +508,7 @@ auto make_command_factory() {
 #endif
     {"export zeek", make_writer_command("zeek")},
     {"get", get_command},
+    {"hunt", hunt_command},
     {"infer", infer_command},
     {"import csv", import_command<format::csv::reader>},
     {"import json", import_command<
@@ -526,16 +595,21 @@ auto make_root_command(std::string_view path) {
         .add<std::string>("aging-query", "query for aging out obsolete data")
         .add<std::string>("shutdown-grace-period",
                           "time to wait until component shutdown "
-                          "finishes cleanly before inducing a hard kill");
+                          "finishes cleanly before inducing a hard kill")
+        .add<size_t>("filesystem-workers", "number of threads that read "
+                                           "files (0 for a single thread "
+                                           "for all operations)");
   ob = add_index_opts(std::move(ob));
   ob = add_archive_opts(std::move(ob));
   auto root
     = std::make_unique<command>(path, "", documentation::vast, std::move(ob));
+  root->add_subcommand(make_aggregate_command());
   root->add_subcommand(make_count_command());
   root->add_subcommand(make_dump_command());
   root->add_subcommand(make_export_command());
   root->add_subcommand(make_explore_command());
   root->add_subcommand(make_get_command());
+  root->add_subcommand(make_hunt_command());
   root->add_subcommand(make_infer_command());
   root->add_subcommand(make_import_command());
   root->add_subcommand(make_kill_command());
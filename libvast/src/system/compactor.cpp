@@ -0,0 +1,308 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/compactor.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/error.hpp"
+#include "vast/concept/printable/vast/uuid.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/partition.hpp"
+#include "vast/fbs/utils.hpp"
+#include "vast/ids.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <algorithm>
+#include <memory>
+
+namespace vast::system {
+
+namespace {
+
+struct partition_info {
+  uuid id;
+  vast::id offset;
+  uint64_t events;
+
+  /// The memory-mapped partition, which the partition info points into.
+  chunk_ptr chunk;
+  const fbs::partition::v0* partition;
+};
+
+struct compaction_worker_state {
+  /// The table slices of the partitions to merge.
+  std::vector<table_slice> slices;
+
+  /// The number of received events.
+  uint64_t events = 0;
+
+  constexpr static const char* name = "compaction-worker";
+};
+
+/// Reads all events of a group of partitions from the ARCHIVE and asks the
+/// INDEX to replace the partitions with a single one that holds the events.
+archive_client_actor::behavior_type compaction_worker(
+  archive_client_actor::stateful_pointer<compaction_worker_state> self,
+  std::vector<uuid> partitions, ids xs, archive_actor archive,
+  index_actor index) {
+  auto expected_events = rank(xs);
+  self->send(archive, atom::exporter_v, caf::actor_cast<caf::actor>(self));
+  self->send(archive, std::move(xs),
+             caf::actor_cast<archive_client_actor>(self));
+  return {
+    [self](table_slice& slice) {
+      self->state.events += slice.rows();
+      self->state.slices.push_back(std::move(slice));
+    },
+    [=](atom::done, const caf::error& err) {
+      if (err && err != caf::make_error(ec::no_error)) {
+        self->quit(err);
+        return;
+      }
+      // The ARCHIVE may be missing events, e.g., when it was erased partially.
+      // Replacing the partitions would then lose the ids of the missing
+      // events in the INDEX, so we rather leave them alone.
+      if (self->state.events != expected_events) {
+        self->quit(caf::make_error(ec::lookup_error,
+                                   "archive returned an unexpected number of "
+                                   "events",
+                                   self->state.events, expected_events));
+        return;
+      }
+      self
+        ->request(index, caf::infinite, atom::replace_v, partitions,
+                  std::move(self->state.slices))
+        .then([self](atom::done) { self->quit(); },
+              [self](caf::error& err) { self->quit(std::move(err)); });
+    },
+  };
+}
+
+/// Verifies a memory-mapped partition and reads its id range.
+caf::expected<partition_info>
+read_partition_info(const uuid& id, chunk_ptr chunk) {
+  if (!chunk)
+    return caf::make_error(ec::filesystem_error, "could not mmap partition");
+  // FlatBuffers <= 1.11 does not correctly use '::flatbuffers::soffset_t'
+  // over 'soffset_t' in FLATBUFFERS_MAX_BUFFER_SIZE.
+  using ::flatbuffers::soffset_t;
+  if (chunk->size() >= FLATBUFFERS_MAX_BUFFER_SIZE)
+    return caf::make_error(ec::format_error, "partition exceeds the maximum "
+                                             "flatbuffer size");
+  auto partition = fbs::as_flatbuffer<fbs::Partition>(as_bytes(chunk));
+  if (!partition)
+    return caf::make_error(ec::format_error, "partition failed to verify");
+  if (partition->partition_type() != fbs::partition::Partition::v0)
+    return caf::make_error(ec::format_error, "unsupported partition version");
+  auto partition_v0 = partition->partition_as_v0();
+  return partition_info{id, partition_v0->offset(), partition_v0->events(),
+                        std::move(chunk), partition_v0};
+}
+
+/// Reads the ids of all events in a verified partition.
+caf::expected<ids> read_partition_ids(const partition_info& info) {
+  auto result = ids{};
+  for (auto type_ids : *info.partition->type_ids()) {
+    auto xs = ids{};
+    if (auto err = fbs::deserialize_bytes(type_ids->ids(), xs))
+      return err;
+    result |= xs;
+  }
+  return result;
+}
+
+/// Groups runs of small partitions that are adjacent in the id space, such
+/// that each group fits into a single partition, and spawns a compaction
+/// worker per group.
+void compact(compactor_actor::stateful_pointer<compactor_state> self,
+             std::vector<partition_info> partitions) {
+  auto& st = self->state;
+  std::sort(partitions.begin(), partitions.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.offset < rhs.offset;
+            });
+  std::vector<std::vector<const partition_info*>> groups;
+  std::vector<const partition_info*> group;
+  uint64_t group_events = 0;
+  auto close_group = [&] {
+    if (group.size() > 1)
+      groups.push_back(std::move(group));
+    group.clear();
+    group_events = 0;
+  };
+  for (auto& x : partitions) {
+    if (x.events >= st.target_size) {
+      close_group();
+      continue;
+    }
+    if (group_events + x.events > st.target_size)
+      close_group();
+    group.push_back(&x);
+    group_events += x.events;
+  }
+  close_group();
+  VAST_VERBOSE("{} found {} groups of small partitions to compact", self,
+               groups.size());
+  for (auto& group : groups) {
+    if (st.running.size() >= st.max_concurrency)
+      break;
+    auto ids = std::vector<uuid>{};
+    auto xs = vast::ids{};
+    auto failed = false;
+    for (auto info : group) {
+      auto ys = read_partition_ids(*info);
+      if (!ys) {
+        VAST_WARN("{} failed to read ids of partition {}: {}", self, info->id,
+                  render(ys.error()));
+        failed = true;
+        break;
+      }
+      ids.push_back(info->id);
+      xs |= *ys;
+    }
+    if (failed)
+      continue;
+    auto worker = self->spawn(compaction_worker, ids, std::move(xs),
+                              st.archive, st.index);
+    self->monitor(worker);
+    st.running.emplace(worker->address(), std::move(ids));
+  }
+}
+
+} // namespace
+
+compactor_actor::behavior_type
+compactor(compactor_actor::stateful_pointer<compactor_state> self,
+          size_t target_size, size_t max_concurrency,
+          std::chrono::seconds scan_interval, const path& index_dir,
+          filesystem_actor filesystem, archive_actor archive,
+          index_actor index) {
+  VAST_TRACE_SCOPE("{} {} {}", VAST_ARG(target_size),
+                   VAST_ARG(max_concurrency), VAST_ARG(index_dir));
+  self->state.index_dir = index_dir;
+  self->state.target_size = target_size;
+  self->state.max_concurrency = max_concurrency;
+  self->state.scan_interval = scan_interval;
+  self->state.filesystem = std::move(filesystem);
+  self->state.archive = std::move(archive);
+  self->state.index = std::move(index);
+  self->set_down_handler([self](const caf::down_msg& msg) {
+    auto i = self->state.running.find(msg.source);
+    if (i == self->state.running.end())
+      return;
+    if (msg.reason && msg.reason != caf::exit_reason::normal) {
+      VAST_WARN("{} failed to compact {} partitions: {}", self,
+                i->second.size(), render(msg.reason));
+      ++self->state.num_failed_compactions;
+    } else {
+      VAST_VERBOSE("{} compacted {} partitions", self, i->second.size());
+      self->state.num_compacted_partitions += i->second.size();
+    }
+    self->state.running.erase(i);
+  });
+  self->delayed_send(self, self->state.scan_interval, atom::ping_v);
+  return {
+    [self](atom::ping) {
+      self->delayed_send(self, self->state.scan_interval, atom::ping_v);
+      auto& st = self->state;
+      if (st.scanning) {
+        VAST_DEBUG("{} ignores ping because the previous scan is in progress",
+                   self);
+        return;
+      }
+      if (st.running.size() >= st.max_concurrency) {
+        VAST_DEBUG("{} ignores ping because {} compactions are in progress",
+                   self, st.running.size());
+        return;
+      }
+      st.scanning = true;
+      self->request(st.index, caf::infinite, atom::list_v)
+        .then(
+          [self](std::vector<uuid>& ids) {
+            auto& st = self->state;
+            auto in_flight = [&](const uuid& id) {
+              for (auto& [_, group] : st.running)
+                if (std::find(group.begin(), group.end(), id) != group.end())
+                  return true;
+              return false;
+            };
+            ids.erase(std::remove_if(ids.begin(), ids.end(), in_flight),
+                      ids.end());
+            if (ids.empty()) {
+              st.scanning = false;
+              return;
+            }
+            // Memory-map all candidates through the filesystem actor and
+            // group them once the last one arrived.
+            struct scan_state {
+              std::vector<partition_info> partitions;
+              size_t remaining;
+            };
+            auto scan = std::make_shared<scan_state>();
+            scan->partitions.reserve(ids.size());
+            scan->remaining = ids.size();
+            auto finish = [self, scan] {
+              if (--scan->remaining > 0)
+                return;
+              self->state.scanning = false;
+              compact(self, std::move(scan->partitions));
+            };
+            for (auto& id : ids) {
+              auto filename = st.index_dir / to_string(id);
+              self
+                ->request(st.filesystem, caf::infinite, atom::mmap_v,
+                          filename)
+                .then(
+                  [self, scan, finish, id](chunk_ptr chunk) {
+                    auto info = read_partition_info(id, std::move(chunk));
+                    if (info)
+                      scan->partitions.push_back(std::move(*info));
+                    else
+                      VAST_DEBUG("{} skips partition {}: {}", self, id,
+                                 render(info.error()));
+                    finish();
+                  },
+                  [self, finish, id](caf::error& err) {
+                    VAST_DEBUG("{} skips partition {}: {}", self, id,
+                               render(err));
+                    finish();
+                  });
+            }
+          },
+          [self](caf::error& err) {
+            self->state.scanning = false;
+            VAST_WARN("{} failed to list partitions: {}", self, render(err));
+          });
+    },
+    [self](atom::status, status_verbosity) {
+      auto result = caf::settings{};
+      auto& compactor_status = put_dictionary(result, "compactor");
+      put(compactor_status, "running-compactions", self->state.running.size());
+      put(compactor_status, "compacted-partitions",
+          self->state.num_compacted_partitions);
+      put(compactor_status, "failed-compactions",
+          self->state.num_failed_compactions);
+      return result;
+    },
+  };
+}
+
+} // namespace vast::system
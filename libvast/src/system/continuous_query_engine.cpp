@@ -0,0 +1,364 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/continuous_query_engine.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/error.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/data.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/view.hpp"
+
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vast::system {
+
+namespace {
+
+/// A value that a row must have in a column to match an expression.
+struct anchor {
+  size_t column;
+  type column_type;
+  data value;
+};
+
+/// The values that an expression requires, one of which every matching row
+/// must have.
+struct anchor_set {
+  std::vector<anchor> anchors;
+
+  /// Whether every row with an anchor value matches the expression.
+  bool exact;
+};
+
+/// @returns Whether a cell of type *t* evaluates equal to *x* if and only if
+///          both are equal as data, so a hash table lookup can replace the
+///          comparison.
+bool is_indexable(const type& t, const data& x) {
+  auto f = detail::overload{
+    [&](const address_type&) { return caf::holds_alternative<address>(x); },
+    [&](const string_type&) { return caf::holds_alternative<std::string>(x); },
+    [&](const count_type&) { return caf::holds_alternative<count>(x); },
+    [&](const integer_type&) { return caf::holds_alternative<integer>(x); },
+    [&](const alias_type& u) { return is_indexable(u.value_type, x); },
+    [](const auto&) { return false; },
+  };
+  return caf::visit(f, t);
+}
+
+/// Finds the anchors of an expression that is tailored to a layout.
+struct anchor_finder {
+  std::optional<anchor_set> operator()(caf::none_t) const {
+    return std::nullopt;
+  }
+
+  std::optional<anchor_set> operator()(const conjunction& xs) const {
+    // A conjunction can only match rows that match any one of its operands,
+    // so the operand with the fewest anchors is the most selective choice.
+    auto result = std::optional<anchor_set>{};
+    for (auto& x : xs)
+      if (auto ys = caf::visit(*this, x))
+        if (!result || ys->anchors.size() < result->anchors.size())
+          result = std::move(ys);
+    if (result && xs.size() > 1)
+      result->exact = false;
+    return result;
+  }
+
+  std::optional<anchor_set> operator()(const disjunction& xs) const {
+    auto result = anchor_set{{}, true};
+    for (auto& x : xs) {
+      auto ys = caf::visit(*this, x);
+      if (!ys)
+        return std::nullopt;
+      std::move(ys->anchors.begin(), ys->anchors.end(),
+                std::back_inserter(result.anchors));
+      result.exact = result.exact && ys->exact;
+    }
+    return result;
+  }
+
+  std::optional<anchor_set> operator()(const negation&) const {
+    return std::nullopt;
+  }
+
+  std::optional<anchor_set> operator()(const predicate& x) const {
+    auto dx = caf::get_if<data_extractor>(&x.lhs);
+    auto d = caf::get_if<data>(&x.rhs);
+    if (!dx || !d)
+      return std::nullopt;
+    auto column = layout.flat_index_at(dx->offset);
+    if (!column)
+      return std::nullopt;
+    if (x.op == relational_operator::equal && is_indexable(dx->type, *d))
+      return anchor_set{{{*column, dx->type, *d}}, true};
+    if (x.op == relational_operator::in)
+      if (auto xs = caf::get_if<list>(d)) {
+        auto result = anchor_set{{}, true};
+        for (auto& element : *xs) {
+          if (!is_indexable(dx->type, element))
+            return std::nullopt;
+          result.anchors.push_back({*column, dx->type, element});
+        }
+        return result;
+      }
+    return std::nullopt;
+  }
+
+  const record_type& layout;
+};
+
+} // namespace
+
+struct continuous_query_engine::plan {
+  /// A query tailored to the layout of the plan.
+  struct compiled_query {
+    subscriber_id subscriber;
+    expression expr;
+    bool exact;
+  };
+
+  /// Maps the values of a column to the queries that require them. Only the
+  /// map for the type of the column is in use, which allows for probing with
+  /// the views of the cells instead of materializing them.
+  struct column_index {
+    /// Hashes strings and string views alike.
+    struct string_hash {
+      using is_transparent = void;
+
+      size_t operator()(std::string_view x) const {
+        return std::hash<std::string_view>{}(x);
+      }
+    };
+
+    template <class T, class Hash = std::hash<T>,
+              class Equal = std::equal_to<T>>
+    using map = tsl::robin_map<T, std::vector<uint32_t>, Hash, Equal>;
+
+    /// Adds a query that requires a value.
+    void add(data value, uint32_t query) {
+      auto insert = [&](auto& xs, auto&& key) {
+        auto& queries = xs[std::forward<decltype(key)>(key)];
+        if (queries.empty() || queries.back() != query)
+          queries.push_back(query);
+      };
+      auto f = detail::overload{
+        [&](count x) { insert(counts, x); },
+        [&](integer x) { insert(integers, x); },
+        [&](address& x) { insert(addresses, x); },
+        [&](std::string& x) { insert(strings, std::move(x)); },
+        [](auto&) { VAST_ASSERT(!"value is not indexable"); },
+      };
+      caf::visit(f, value);
+    }
+
+    /// @returns The queries that require the value of a cell, if any.
+    const std::vector<uint32_t>* find(const data_view& x) const {
+      auto lookup = [](const auto& xs,
+                       const auto& key) -> const std::vector<uint32_t>* {
+        auto i = xs.find(key);
+        return i != xs.end() ? &i->second : nullptr;
+      };
+      auto f = detail::overload{
+        [&](view<count> y) { return lookup(counts, y); },
+        [&](view<integer> y) { return lookup(integers, y); },
+        [&](view<address> y) { return lookup(addresses, y); },
+        [&](view<std::string> y) { return lookup(strings, y); },
+        [](const auto&) -> const std::vector<uint32_t>* { return nullptr; },
+      };
+      return caf::visit(f, x);
+    }
+
+    size_t column;
+    type column_type;
+    map<count> counts;
+    map<integer> integers;
+    map<address> addresses;
+    map<std::string, string_hash, std::equal_to<>> strings;
+  };
+
+  /// @returns The index for *column*, creating it if necessary.
+  column_index& index_for(size_t column, const type& column_type) {
+    for (auto& x : columns)
+      if (x.column == column)
+        return x;
+    auto& result = columns.emplace_back();
+    result.column = column;
+    result.column_type = column_type;
+    return result;
+  }
+
+  std::vector<compiled_query> queries;
+  std::vector<column_index> columns;
+
+  /// The queries that require row-wise evaluation.
+  std::vector<uint32_t> fallback;
+
+  /// Scratch space for the candidate rows of each query, which we keep
+  /// between evaluations to avoid allocations.
+  std::vector<std::vector<uint32_t>> candidates;
+
+  /// Scratch space for the queries with candidate rows.
+  std::vector<uint32_t> touched;
+};
+
+continuous_query_engine::continuous_query_engine() = default;
+
+continuous_query_engine::~continuous_query_engine() noexcept = default;
+
+continuous_query_engine::continuous_query_engine(
+  continuous_query_engine&&) noexcept = default;
+
+continuous_query_engine&
+continuous_query_engine::operator=(continuous_query_engine&&) noexcept
+  = default;
+
+void continuous_query_engine::add(subscriber_id subscriber, expression expr) {
+  erase(subscriber);
+  queries_.push_back({subscriber, normalize(expr)});
+  plans_.clear();
+}
+
+bool continuous_query_engine::erase(subscriber_id subscriber) {
+  auto pred = [&](const query& x) { return x.subscriber == subscriber; };
+  auto i = std::find_if(queries_.begin(), queries_.end(), pred);
+  if (i == queries_.end())
+    return false;
+  queries_.erase(i);
+  plans_.clear();
+  return true;
+}
+
+size_t continuous_query_engine::size() const {
+  return queries_.size();
+}
+
+bool continuous_query_engine::empty() const {
+  return queries_.empty();
+}
+
+std::vector<continuous_query_engine::match>
+continuous_query_engine::evaluate(const table_slice& slice) {
+  VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
+  auto result = std::vector<match>{};
+  if (queries_.empty())
+    return result;
+  auto& p = plan_for(slice.interned());
+  ++stats_.slices;
+  stats_.rows += slice.rows();
+  // Scan every indexed column once and collect the candidate rows of all
+  // queries that require the value of a cell.
+  for (auto& column : p.columns) {
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      auto x = slice.at(row, column.column, column.column_type);
+      ++stats_.probes;
+      auto queries = column.find(x);
+      if (!queries)
+        continue;
+      for (auto query : *queries) {
+        auto& rows = p.candidates[query];
+        if (rows.empty())
+          p.touched.push_back(query);
+        rows.push_back(detail::narrow_cast<uint32_t>(row));
+      }
+    }
+  }
+  // Turn the candidate rows into ID sets, and check the full expression for
+  // queries whose anchors are necessary but not sufficient.
+  std::sort(p.touched.begin(), p.touched.end());
+  for (auto query : p.touched) {
+    auto& rows = p.candidates[query];
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    stats_.candidates += rows.size();
+    auto selection = ids{};
+    for (auto row : rows) {
+      selection.append_bits(false, slice.offset() + row - selection.size());
+      selection.append_bit(true);
+    }
+    rows.clear();
+    auto& compiled = p.queries[query];
+    if (!compiled.exact)
+      selection = vast::evaluate(compiled.expr, slice, selection);
+    if (any<1>(selection))
+      result.push_back({compiled.subscriber, std::move(selection)});
+  }
+  p.touched.clear();
+  for (auto query : p.fallback) {
+    ++stats_.fallbacks;
+    auto& compiled = p.queries[query];
+    auto selection = vast::evaluate(compiled.expr, slice);
+    if (any<1>(selection))
+      result.push_back({compiled.subscriber, std::move(selection)});
+  }
+  return result;
+}
+
+const continuous_query_engine::statistics&
+continuous_query_engine::stats() const {
+  return stats_;
+}
+
+size_t continuous_query_engine::indexed(const record_type& layout) {
+  auto& p = plan_for(layout_interner::instance().intern(layout));
+  return p.queries.size() - p.fallback.size();
+}
+
+continuous_query_engine::plan&
+continuous_query_engine::plan_for(const interned_layout& layout) {
+  if (auto* p = plans_.find(layout.id))
+    return **p;
+  auto result = std::make_unique<plan>();
+  for (auto& [subscriber, expr] : queries_) {
+    auto tailored = tailor(expr, layout.layout_type);
+    if (!tailored) {
+      VAST_DEBUG("continuous query engine failed to tailor {} to {}: {}",
+                 to_string(expr), layout.layout.name(),
+                 render(tailored.error()));
+      continue;
+    }
+    // The query cannot match any events of this layout.
+    if (caf::holds_alternative<caf::none_t>(*tailored))
+      continue;
+    auto anchors = caf::visit(anchor_finder{layout.layout}, *tailored);
+    auto position = detail::narrow_cast<uint32_t>(result->queries.size());
+    result->queries.push_back(
+      {subscriber, std::move(*tailored), anchors && anchors->exact});
+    if (!anchors) {
+      result->fallback.push_back(position);
+      continue;
+    }
+    for (auto& [column, column_type, value] : anchors->anchors) {
+      result->index_for(column, column_type).add(std::move(value), position);
+    }
+  }
+  result->candidates.resize(result->queries.size());
+  VAST_DEBUG("continuous query engine compiled {} queries for {} with {} "
+             "indexed columns and {} row-wise evaluations",
+             result->queries.size(), layout.layout.name(),
+             result->columns.size(), result->fallback.size());
+  return *plans_.insert(layout.id, std::move(result));
+}
+
+} // namespace vast::system
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/continuous_query_matcher.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/fill_status_map.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/attach_stream_sink.hpp>
+#include <caf/settings.hpp>
+
+#include <utility>
+
+namespace vast::system {
+
+void continuous_query_matcher_state::evaluate(const table_slice& slice) {
+  if (engine.empty())
+    return;
+  auto matches = engine.evaluate(slice);
+  auto rows = engine.stats().rows;
+  for (auto& [id, selection] : matches) {
+    auto i = subscribers.find(id);
+    VAST_ASSERT(i != subscribers.end());
+    auto& [exporter, reported_rows] = i->second;
+    // Attribute all rows since the last matches to the first slice, such that
+    // the EXPORTER can account for the events it never sees.
+    auto processed = rows - std::exchange(reported_rows, rows);
+    for (auto& x : select(slice, selection))
+      self->send(exporter, std::move(x), std::exchange(processed, 0));
+  }
+}
+
+caf::settings
+continuous_query_matcher_state::status(status_verbosity v) const {
+  auto result = caf::settings{};
+  if (v >= status_verbosity::detailed) {
+    auto& stats = engine.stats();
+    caf::put(result, "queries", engine.size());
+    caf::put(result, "rows", stats.rows);
+    caf::put(result, "probes", stats.probes);
+    caf::put(result, "candidates", stats.candidates);
+    caf::put(result, "fallbacks", stats.fallbacks);
+  }
+  if (v >= status_verbosity::debug)
+    detail::fill_status_map(result, self);
+  return result;
+}
+
+continuous_query_matcher_actor::behavior_type continuous_query_matcher(
+  continuous_query_matcher_actor::stateful_pointer<
+    continuous_query_matcher_state>
+    self) {
+  self->state.self = self;
+  self->set_down_handler([=](const caf::down_msg& msg) {
+    auto id = msg.source.id();
+    if (self->state.subscribers.erase(id) > 0) {
+      VAST_DEBUG("{} removes continuous query of {}", self, msg.source);
+      self->state.engine.erase(id);
+    }
+  });
+  return {
+    [self](atom::subscribe, const expression& expr,
+           exporter_actor exporter) -> atom::ok {
+      VAST_DEBUG("{} adds continuous query {} of {}", self, to_string(expr),
+                 exporter);
+      auto id = exporter->id();
+      self->monitor(exporter);
+      self->state.engine.add(id, expr);
+      self->state.subscribers.insert_or_assign(
+        id, continuous_query_matcher_state::subscriber{
+              std::move(exporter), self->state.engine.stats().rows});
+      return atom::ok_v;
+    },
+    // -- stream_sink_actor<table_slice> ---------------------------------------
+    [self](
+      caf::stream<table_slice> in) -> caf::inbound_stream_slot<table_slice> {
+      VAST_DEBUG("{} attaches to the stream of the IMPORTER", self);
+      auto result = caf::attach_stream_sink(
+        self, in,
+        [=](caf::unit_t&) {
+          // nop
+        },
+        [=](caf::unit_t&, const table_slice& x) {
+          self->state.evaluate(x);
+        });
+      return result.inbound_slot();
+    },
+    // -- status_client_actor --------------------------------------------------
+    [self](atom::status, status_verbosity v) { //
+      return self->state.status(v);
+    },
+  };
+}
+
+} // namespace vast::system
@@ -21,6 +21,7 @@
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/scope_linked.hpp"
+#include "vast/system/estimate.hpp"
 #include "vast/system/read_query.hpp"
 #include "vast/system/signal_monitor.hpp"
 #include "vast/system/spawn_or_connect_to_node.hpp"
@@ -58,6 +59,18 @@ caf::message count_command(const invocation& inv, caf::actor_system& sys) {
                  ? caf::get<node_actor>(node_opt)
                  : caf::get<scope_linked<node_actor>>(node_opt).get();
   VAST_ASSERT(node != nullptr);
+  // Answer from the META INDEX alone if an upper bound over the persisted
+  // events suffices.
+  if (caf::get_or(options, "vast.count.approximate", false)) {
+    auto result = count_upper_bound(
+      self, node, *query,
+      !caf::get_or(options, "vast.count.disable-taxonomies", false));
+    if (!result)
+      return caf::make_message(std::move(result.error()));
+    std::cout << *result << " (upper bound over persisted events)"
+              << std::endl;
+    return caf::none;
+  }
   // Start signal monitor.
   std::thread sig_mon_thread;
   auto guard = system::signal_monitor::run_guarded(
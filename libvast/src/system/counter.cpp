@@ -48,12 +48,12 @@ void counter_state::init(expression expr, index_actor index,
   caf::message_handler base{behaviors_[collect_hits].as_behavior_impl()};
   behaviors_[collect_hits] = base.or_else(
     [this](table_slice slice) {
-      // Construct a candidate checker if we don't have one for this type.
-      auto it = checkers_.find(slice.layout());
-      if (it == checkers_.end()) {
-        if (auto x = tailor(expr_, slice.layout())) {
-          std::tie(it, std::ignore) = checkers_.emplace(
-            vast::record_type{slice.layout()}, std::move(*x));
+      // Construct a candidate checker if we don't have one for this layout.
+      const auto& layout = slice.interned();
+      auto* checker = checkers_.find(layout.id);
+      if (!checker) {
+        if (auto x = tailor(expr_, layout.layout_type)) {
+          checker = &checkers_.insert(layout.id, std::move(*x));
         } else {
           VAST_ERROR("{} failed to tailor expression: {}", self_,
                      self_->system().render(x.error()));
@@ -61,7 +61,7 @@ void counter_state::init(expression expr, index_actor index,
         }
       }
       // Perform the candidate check and count results.
-      auto num_results = rank(evaluate(it->second, slice));
+      auto num_results = rank(evaluate(*checker, slice));
       if (num_results > 0)
         self_->send(client_, num_results);
     },
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/estimate.hpp"
+
+#include "vast/error.hpp"
+#include "vast/expression.hpp"
+#include "vast/system/node_control.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/scoped_actor.hpp>
+
+#include <utility>
+
+namespace vast::system {
+
+namespace {
+
+/// Parses a query and looks up the INDEX that computes the estimate.
+caf::expected<std::pair<index_actor, expression>>
+prepare(caf::scoped_actor& self, const node_actor& node,
+        const std::string& query, bool resolve_taxonomies) {
+  auto expr = normalized_and_validated(std::vector<std::string>{query});
+  if (!expr)
+    return expr.error();
+  auto components
+    = get_node_components<index_actor, type_registry_actor>(self, node);
+  if (!components)
+    return components.error();
+  auto& [index, type_registry] = *components;
+  if (!index)
+    return caf::make_error(ec::missing_component, "index");
+  if (!resolve_taxonomies || !type_registry)
+    return std::pair{index, std::move(*expr)};
+  caf::error err;
+  self->request(type_registry, caf::infinite, atom::resolve_v, *expr)
+    .receive([&](expression& resolved) { *expr = std::move(resolved); },
+             [&](caf::error& e) { err = std::move(e); });
+  if (err)
+    return err;
+  return std::pair{index, std::move(*expr)};
+}
+
+} // namespace
+
+caf::expected<uint64_t>
+count_upper_bound(caf::scoped_actor& self, const node_actor& node,
+                  const std::string& query, bool resolve_taxonomies) {
+  auto prepared = prepare(self, node, query, resolve_taxonomies);
+  if (!prepared)
+    return prepared.error();
+  auto& [index, expr] = *prepared;
+  caf::expected<uint64_t> result{uint64_t{0}};
+  self->request(index, caf::infinite, atom::estimate_v, std::move(expr))
+    .receive([&](uint64_t n) { result = n; },
+             [&](caf::error& e) { result = std::move(e); });
+  return result;
+}
+
+caf::expected<double>
+distinct_upper_bound(caf::scoped_actor& self, const node_actor& node,
+                     const std::string& query, const std::string& field,
+                     bool resolve_taxonomies) {
+  auto prepared = prepare(self, node, query, resolve_taxonomies);
+  if (!prepared)
+    return prepared.error();
+  auto& [index, expr] = *prepared;
+  caf::expected<double> result{0.0};
+  self->request(index, caf::infinite, atom::estimate_v, std::move(expr), field)
+    .receive([&](double n) { result = n; },
+             [&](caf::error& e) { result = std::move(e); });
+  return result;
+}
+
+} // namespace vast::system
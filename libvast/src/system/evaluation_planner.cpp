@@ -0,0 +1,194 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/evaluation_planner.hpp"
+
+#include "vast/data.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/type.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+namespace {
+
+/// Strips the negation from a relational operator, e.g., turns `!=` into `==`.
+relational_operator positive(relational_operator op) {
+  switch (op) {
+    case relational_operator::not_match:
+      return relational_operator::match;
+    case relational_operator::not_in:
+      return relational_operator::in;
+    case relational_operator::not_ni:
+      return relational_operator::ni;
+    case relational_operator::not_equal:
+      return relational_operator::equal;
+    default:
+      return op;
+  }
+}
+
+/// Estimates the selectivity of a non-negated operator.
+double selectivity(const type& index_type, relational_operator op,
+                   const data& rhs) {
+  // The fraction of events that we expect to hold a specific value.
+  auto point = 0.01;
+  if (caf::holds_alternative<bool_type>(index_type))
+    point = 0.5;
+  else if (caf::holds_alternative<enumeration_type>(index_type))
+    point = 0.1;
+  switch (op) {
+    case relational_operator::equal:
+      return point;
+    case relational_operator::in:
+      if (auto xs = caf::get_if<list>(&rhs))
+        return std::min(1.0, point * xs->size());
+      return 0.1;
+    case relational_operator::less:
+    case relational_operator::less_equal:
+    case relational_operator::greater:
+    case relational_operator::greater_equal:
+      return 1.0 / 3;
+    default:
+      return 0.1;
+  }
+}
+
+/// Estimates the cost of a lookup relative to an equality lookup in an
+/// arithmetic index.
+double cost(const type& index_type, relational_operator op, const data& rhs) {
+  auto range = positive(op) != relational_operator::equal
+               && positive(op) != relational_operator::in;
+  auto f = detail::overload{
+    [&](const alias_type& x) { return cost(x.value_type, op, rhs); },
+    [](const bool_type&) { return 0.5; },
+    [](const enumeration_type&) { return 0.5; },
+    [&](const integer_type&) { return range ? 2.0 : 1.0; },
+    [&](const count_type&) { return range ? 2.0 : 1.0; },
+    [&](const real_type&) { return range ? 2.0 : 1.0; },
+    [&](const duration_type&) { return range ? 2.0 : 1.0; },
+    [&](const time_type&) { return range ? 2.0 : 1.0; },
+    [](const address_type&) { return 2.0; },
+    [](const subnet_type&) { return 4.0; },
+    [&](const string_type& x) {
+      // A hash index scans one digest per value, while a string index
+      // combines a bitmap per character of the operand.
+      if (has_attribute(x, "index"))
+        return 2.0;
+      if (positive(op) == relational_operator::match)
+        return 32.0;
+      if (auto str = caf::get_if<std::string>(&rhs))
+        return 1.0 + str->size();
+      return 8.0;
+    },
+    [](const list_type&) { return 16.0; },
+    [](const map_type&) { return 16.0; },
+    [](const auto&) { return 4.0; },
+  };
+  return caf::visit(f, index_type);
+}
+
+/// The expected cost of evaluating a conjunction operand per unit of work it
+/// saves for later operands. Sorting conjunction operands by ascending rank
+/// minimizes the expected cost of evaluating the conjunction.
+double rank(const lookup_estimate& x) {
+  if (x.selectivity >= 1.0)
+    return std::numeric_limits<double>::infinity();
+  return x.cost / (1.0 - x.selectivity);
+}
+
+/// Recursively reorders conjunctions and estimates the resulting expression.
+struct planner {
+  using result_type = std::pair<expression, lookup_estimate>;
+
+  result_type operator()(caf::none_t) const {
+    return {expression{}, lookup_estimate{0.0, 0.0}};
+  }
+
+  result_type operator()(const conjunction& xs) const {
+    auto operands = std::vector<result_type>{};
+    operands.reserve(xs.size());
+    for (auto& x : xs)
+      operands.push_back(caf::visit(*this, x));
+    std::stable_sort(operands.begin(), operands.end(),
+                     [](const result_type& x, const result_type& y) {
+                       return rank(x.second) < rank(y.second);
+                     });
+    auto result = conjunction{};
+    result.reserve(operands.size());
+    auto estimate = lookup_estimate{0.0, 1.0};
+    for (auto& [x, operand] : operands) {
+      // An operand is only looked up for the hits of all previous operands.
+      estimate.cost += estimate.selectivity * operand.cost;
+      estimate.selectivity *= operand.selectivity;
+      result.push_back(std::move(x));
+    }
+    return {expression{std::move(result)}, estimate};
+  }
+
+  result_type operator()(const disjunction& xs) const {
+    auto result = disjunction{};
+    result.reserve(xs.size());
+    auto estimate = lookup_estimate{0.0, 0.0};
+    for (auto& x : xs) {
+      auto [operand, operand_estimate] = caf::visit(*this, x);
+      estimate.cost += operand_estimate.cost;
+      estimate.selectivity += operand_estimate.selectivity
+                              - estimate.selectivity
+                                  * operand_estimate.selectivity;
+      result.push_back(std::move(operand));
+    }
+    return {expression{std::move(result)}, estimate};
+  }
+
+  result_type operator()(const negation& x) const {
+    auto [operand, estimate] = caf::visit(*this, x.expr());
+    estimate.selectivity = 1.0 - estimate.selectivity;
+    return {expression{negation{std::move(operand)}}, estimate};
+  }
+
+  result_type operator()(const predicate& x) const {
+    return {expression{x}, estimator(x)};
+  }
+
+  const lookup_estimator& estimator;
+};
+
+} // namespace
+
+lookup_estimate estimate_lookup(const type& index_type, relational_operator op,
+                                const data& rhs) {
+  auto result = lookup_estimate{};
+  result.cost = cost(index_type, op, rhs);
+  const auto* t = &index_type;
+  while (auto alias = caf::get_if<alias_type>(t))
+    t = &alias->value_type;
+  result.selectivity = selectivity(*t, positive(op), rhs);
+  if (is_negated(op))
+    result.selectivity = 1.0 - result.selectivity;
+  return result;
+}
+
+expression
+order_by_cost(const expression& expr, const lookup_estimator& estimator) {
+  VAST_ASSERT(estimator);
+  return caf::visit(planner{estimator}, expr).first;
+}
+
+} // namespace vast::system
@@ -15,13 +15,18 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/detail/overload.hpp"
 #include "vast/expression_visitors.hpp"
 #include "vast/logger.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/system/query_trace.hpp"
 
 #include <caf/behavior.hpp>
 #include <caf/event_based_actor.hpp>
 #include <caf/stateful_actor.hpp>
 
+#include <memory>
+
 namespace vast::system {
 
 namespace {
@@ -98,6 +103,7 @@ evaluator_state::evaluator_state(
 void evaluator_state::handle_result(const offset& position, const ids& result) {
   VAST_DEBUG("{} got {} new hits for predicate at position {}", self,
              rank(result), position);
+  --pending_responses;
   auto ptr = hits_for(position);
   VAST_ASSERT(ptr != nullptr);
   auto& [missing, accumulated_hits] = *ptr;
@@ -105,26 +111,30 @@ void evaluator_state::handle_result(const offset& position, const ids& result) {
   if (--missing == 0) {
     VAST_DEBUG("{} collected all results at position {}", self, position);
     evaluate();
+    resume(position);
   }
-  decrement_pending();
 }
 
 void evaluator_state::handle_missing_result(const offset& position,
                                             const caf::error& err) {
   VAST_IGNORE_UNUSED(err);
+  incomplete = true;
   VAST_WARN("{} received {} instead of a result for predicate at "
             "position {}",
             self, render(err), position);
+  --pending_responses;
   auto ptr = hits_for(position);
   VAST_ASSERT(ptr != nullptr);
   if (--ptr->first == 0) {
     VAST_DEBUG("{} collected all results at position {}", self, position);
     evaluate();
+    resume(position);
   }
-  decrement_pending();
 }
 
 void evaluator_state::evaluate() {
+  auto stage_timer
+    = query_stage_timer{trace, query_stage::evaluator_combine};
   auto expr_hits = caf::visit(ids_evaluator{predicate_hits}, expr);
   VAST_DEBUG("{} got predicate_hits: {} expr_hits: {}", self, predicate_hits,
              expr_hits);
@@ -135,12 +145,151 @@ void evaluator_state::evaluate() {
   }
 }
 
-void evaluator_state::decrement_pending() {
-  // We're done evaluating if all INDEXER actors have reported their hits.
-  if (--pending_responses == 0) {
-    VAST_DEBUG("{} completed expression evaluation", self);
-    promise.deliver(atom::done_v);
+void evaluator_state::schedule(const expression& x, const offset& position,
+                               const std::optional<ids>& restriction,
+                               continuation then) {
+  auto child = [&](size_t index) {
+    auto result = position;
+    result.push_back(index);
+    return result;
+  };
+  auto f = detail::overload{
+    [&](caf::none_t) { then(ids{}); },
+    [&](const conjunction& xs) {
+      VAST_ASSERT(!xs.empty());
+      schedule(xs[0], child(0), restriction,
+               [this, &xs, position, restriction,
+                then = std::move(then)](ids hits) mutable {
+                 if (restriction)
+                   hits &= *restriction;
+                 schedule_operand(xs, position, 1, std::move(hits),
+                                  std::move(then));
+               });
+    },
+    [&](const disjunction& xs) {
+      VAST_ASSERT(!xs.empty());
+      auto remaining
+        = std::make_shared<std::pair<size_t, ids>>(xs.size(), ids{});
+      for (size_t index = 0; index < xs.size(); ++index)
+        schedule(xs[index], child(index), restriction,
+                 [remaining, then](ids hits) {
+                   remaining->second |= hits;
+                   if (--remaining->first == 0)
+                     then(std::move(remaining->second));
+                 });
+    },
+    [&](const negation& n) {
+      schedule(n.expr(), child(0), restriction,
+               [then = std::move(then)](ids hits) {
+                 hits.flip();
+                 then(std::move(hits));
+               });
+    },
+    [&](const predicate&) {
+      auto& [missing, _] = predicate_hits[position];
+      for (auto& [pos, curried_pred, indexer] : eval) {
+        if (pos != position)
+          continue;
+        ++missing;
+        ++pending_responses;
+        auto start = stopwatch::now();
+        if (restriction) {
+          auto on_result = [this, position, start](const ids& result) {
+            trace.record(query_stage::indexer_lookup,
+                         stopwatch::now() - start);
+            handle_result(position, result);
+          };
+          auto on_error = [this, position](const caf::error& err) {
+            handle_missing_result(position, err);
+          };
+          self->request(indexer, caf::infinite, curried_pred, *restriction)
+            .then(std::move(on_result), std::move(on_error));
+          continue;
+        }
+        // Unrestricted lookups of the same predicate yield the same result,
+        // so we only send the first one and fan out its result.
+        auto key = std::tuple{indexer, curried_pred.op, curried_pred.rhs};
+        auto [i, inserted] = pending_lookups.try_emplace(key);
+        i->second.push_back(position);
+        if (!inserted) {
+          ++shared_lookups;
+          continue;
+        }
+        auto waiting = [this, key] {
+          auto entry = pending_lookups.find(key);
+          VAST_ASSERT(entry != pending_lookups.end());
+          auto result = std::move(entry->second);
+          pending_lookups.erase(entry);
+          return result;
+        };
+        auto on_result = [this, waiting, start](const ids& result) {
+          trace.record(query_stage::indexer_lookup, stopwatch::now() - start);
+          for (auto& x : waiting())
+            handle_result(x, result);
+        };
+        auto on_error = [this, waiting](const caf::error& err) {
+          for (auto& x : waiting())
+            handle_missing_result(x, err);
+        };
+        self->request(indexer, caf::infinite, curried_pred)
+          .then(std::move(on_result), std::move(on_error));
+      }
+      if (missing == 0) {
+        // The predicate does not apply to this partition.
+        predicate_hits.erase(position);
+        then(ids{});
+        return;
+      }
+      continuations.emplace(position, std::move(then));
+    },
+  };
+  caf::visit(f, x);
+}
+
+void evaluator_state::schedule_operand(const conjunction& xs,
+                                       const offset& position, size_t index,
+                                       ids running, continuation then) {
+  if (index == xs.size()) {
+    then(std::move(running));
+    return;
+  }
+  if (!any<1>(running)) {
+    VAST_DEBUG("{} skips {} operands of the conjunction at position {}", self,
+               xs.size() - index, position);
+    skipped_lookups += xs.size() - index;
+    then(std::move(running));
+    return;
   }
+  auto operand_position = position;
+  operand_position.push_back(index);
+  schedule(xs[index], operand_position, running,
+           [this, &xs, position, index, running,
+            then = std::move(then)](ids hits) mutable {
+             hits &= running;
+             schedule_operand(xs, position, index + 1, std::move(hits),
+                              std::move(then));
+           });
+}
+
+void evaluator_state::resume(const offset& position) {
+  auto i = continuations.find(position);
+  VAST_ASSERT(i != continuations.end());
+  auto then = std::move(i->second);
+  continuations.erase(i);
+  auto ptr = hits_for(position);
+  VAST_ASSERT(ptr != nullptr);
+  then(ptr->second);
+}
+
+void evaluator_state::finish() {
+  VAST_ASSERT(pending_responses == 0);
+  VAST_DEBUG("{} completed expression evaluation, skipped {} lookups, and "
+             "shared {} lookups",
+             self, skipped_lookups, shared_lookups);
+  if (on_complete && !incomplete)
+    on_complete(hits);
+  self->send(client, atom::trace_v, std::move(trace));
+  promise.deliver(atom::done_v);
 }
 
 evaluator_state::predicate_hits_map::mapped_type*
@@ -151,33 +300,19 @@ evaluator_state::hits_for(const offset& position) {
 
 evaluator_actor::behavior_type
 evaluator(evaluator_actor::stateful_pointer<evaluator_state> self,
-          expression expr, std::vector<evaluation_triple> eval) {
+          expression expr, std::vector<evaluation_triple> eval,
+          evaluator_callback on_complete) {
   VAST_TRACE_SCOPE("{} {}", VAST_ARG(expr), VAST_ARG(eval));
   VAST_ASSERT(!eval.empty());
   self->state.expr = std::move(expr);
   self->state.eval = std::move(eval);
+  self->state.on_complete = std::move(on_complete);
   return {
     [self](partition_client_actor client) {
       self->state.client = client;
       self->state.promise = self->make_response_promise<atom::done>();
-      self->state.pending_responses += self->state.eval.size();
-      for (auto& triple : self->state.eval) {
-        // No strucutured bindings available due to subsequent lambda. :-/
-        // TODO: C++20
-        auto& pos = std::get<0>(triple);
-        auto& curried_pred = std::get<1>(triple);
-        auto& indexer = std::get<2>(triple);
-        ++self->state.predicate_hits[pos].first;
-        self->request(indexer, caf::infinite, curried_pred)
-          .then([=](const ids& hits) { self->state.handle_result(pos, hits); },
-                [=](const caf::error& err) {
-                  self->state.handle_missing_result(pos, err);
-                });
-      }
-      if (self->state.pending_responses == 0) {
-        VAST_DEBUG("{} has nothing to evaluate for expression", self);
-        self->state.promise.deliver(atom::done_v);
-      }
+      self->state.schedule(self->state.expr, offset{0}, std::nullopt,
+                           [self](const ids&) { self->state.finish(); });
       // We can only deal with exactly one expression/client at the moment.
       self->unbecome();
       return self->state.promise;
@@ -27,6 +27,7 @@
 #include "vast/expression_visitors.hpp"
 #include "vast/logger.hpp"
 #include "vast/system/query_status.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -69,7 +70,9 @@ void ship_results(exporter_actor::stateful_pointer<exporter_state> self) {
     st.query.cached -= rows;
     st.query.requested -= rows;
     st.query.shipped += rows;
-    self->anon_send(st.sink, std::move(slice));
+    // We send with ourselves as sender so that the SINK can attribute its
+    // write latency to the query trace.
+    self->send(st.sink, std::move(slice));
   }
 }
 
@@ -91,6 +94,9 @@ void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
       {"exporter.selectivity", selectivity},
       {"exporter.runtime", st.query.runtime},
     };
+    auto trace_report = to_report(st.trace, "exporter.trace");
+    msg.insert(msg.end(), std::make_move_iterator(trace_report.begin()),
+               std::make_move_iterator(trace_report.end()));
     self->send(st.accountant, msg);
   }
 }
@@ -158,32 +164,39 @@ void handle_batch(exporter_actor::stateful_pointer<exporter_state> self,
                   table_slice slice) {
   VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
   VAST_DEBUG("{} got batch of {} events", self, slice.rows());
-  // Construct a candidate checker if we don't have one for this type.
-  type t = slice.layout();
-  auto it = self->state.checkers.find(t);
-  if (it == self->state.checkers.end()) {
-    auto x = tailor(self->state.expr, t);
+  // Construct a candidate checker if we don't have one for this layout.
+  const auto& layout = slice.interned();
+  auto* checker = self->state.checkers.find(layout.id);
+  if (!checker) {
+    auto x = tailor(self->state.expr, layout.layout_type);
     if (!x) {
       VAST_ERROR("{} failed to tailor expression: {}", self, render(x.error()));
       ship_results(self);
       shutdown(self);
       return;
     }
-    VAST_DEBUG("{} tailored AST to {}: {}", self, t, x);
-    std::tie(it, std::ignore)
-      = self->state.checkers.emplace(type{slice.layout()}, std::move(*x));
+    VAST_DEBUG("{} tailored AST to {}: {}", self, layout.layout_type, x);
+    checker = &self->state.checkers.insert(layout.id, std::move(*x));
   }
-  auto& checker = it->second;
   // Perform candidate check, splitting the slice into subsets if needed.
   self->state.query.processed += slice.rows();
-  auto selection = evaluate(checker, slice);
+  auto selection = ids{};
+  {
+    auto stage_timer
+      = query_stage_timer{self->state.trace, query_stage::candidate_check};
+    selection = evaluate(*checker, slice);
+  }
   auto selection_size = rank(selection);
   if (selection_size == 0) {
     // No rows qualify.
     return;
   }
   self->state.query.cached += selection_size;
-  select(self->state.results, slice, selection);
+  {
+    auto stage_timer
+      = query_stage_timer{self->state.trace, query_stage::select};
+    select(self->state.results, slice, selection);
+  }
   // Ship slices to connected SINKs.
   ship_results(self);
 }
@@ -203,6 +216,8 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
     auto& st = self->state;
     if (msg.reason != caf::exit_reason::kill)
       report_statistics(self);
+    VAST_VERBOSE("{} finished query {} with trace {}", self, st.trace.id,
+                 caf::deep_to_string(to_status(st.trace)));
     // Sending 0 to the index means dropping further results.
     self->send<caf::message_priority::high>(st.index, st.id,
                                             static_cast<uint32_t>(0));
@@ -280,6 +295,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
     [self](atom::run) {
       VAST_VERBOSE("{} executes query: {}", self, to_string(self->state.expr));
       self->state.start = std::chrono::system_clock::now();
+      self->state.trace.start = self->state.start;
       if (!has_historical_option(self->state.options))
         return;
       // TODO: The index replies to expressions by manually sending back to the
@@ -295,6 +311,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
             VAST_VERBOSE("{} got lookup handle {}, scheduled {}/{} partitions",
                          self, lookup, scheduled, partitions);
             self->state.id = lookup;
+            self->state.trace.id = lookup;
             if (partitions > 0) {
               self->state.query.expected = partitions;
               self->state.query.scheduled = scheduled;
@@ -309,6 +326,16 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
                  statistics_subscriber);
       self->state.statistics_subscriber = statistics_subscriber;
     },
+    [self](table_slice slice, uint64_t processed) {
+      // The CONTINUOUS QUERY MATCHER already selected the matching rows, so
+      // there is no need for a candidate check.
+      VAST_DEBUG("{} got {} matching events of {} processed events", self,
+                 slice.rows(), processed);
+      self->state.query.processed += processed;
+      self->state.query.cached += slice.rows();
+      self->state.results.push_back(std::move(slice));
+      ship_results(self);
+    },
     [self](
       caf::stream<table_slice> in) -> caf::inbound_stream_slot<table_slice> {
       return self
@@ -341,6 +368,8 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         put(exp, "expression", to_string(self->state.expr));
         put(exp, "hits", rank(self->state.hits));
         put(exp, "start", caf::deep_to_string(self->state.start));
+        if (v >= status_verbosity::debug)
+          put(exp, "trace", to_status(self->state.trace));
         auto& xs = put_list(result, "queries");
         xs.emplace_back(std::move(exp));
         detail::fill_status_map(exporter_status, self);
@@ -354,12 +383,22 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
     [self](atom::done, const caf::error& err) {
       VAST_ASSERT(self->current_sender() == self->state.archive);
       ++self->state.query.lookups_complete;
+      if (!self->state.archive_lookups.empty()) {
+        self->state.trace.record(query_stage::archive_load,
+                                 stopwatch::now()
+                                   - self->state.archive_lookups.front());
+        self->state.archive_lookups.pop_front();
+      }
       VAST_DEBUG("{} received done from archive: {} {}", self, VAST_ARG(err),
                  VAST_ARG("query", self->state.query));
       // We skip 'done' messages of the query supervisors until we process all
       // hits first. Hence, we can never be finished here.
       VAST_ASSERT(!finished(self->state.query));
     },
+    // -- partition_client_actor -----------------------------------------------
+    [self](atom::trace, const query_trace& trace) {
+      self->state.trace.merge(trace);
+    },
     // -- index_client_actor ---------------------------------------------------
     // The INDEX (or the EVALUATOR, to be more precise) sends us a series of
     // `ids` in response to an expression (query), terminated by 'done'.
@@ -391,6 +430,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         VAST_DEBUG("{} forwards hits to archive", self);
         // FIXME: restrict according to configured limit.
         ++self->state.query.lookups_issued;
+        self->state.archive_lookups.push_back(stopwatch::now());
         self->send(self->state.archive, std::move(hits),
                    static_cast<archive_client_actor>(self));
       }
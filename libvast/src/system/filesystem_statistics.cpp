@@ -0,0 +1,47 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/filesystem_statistics.hpp"
+
+#include <caf/config_value.hpp>
+#include <caf/dictionary.hpp>
+#include <caf/settings.hpp>
+
+#include <string>
+
+namespace vast::system {
+
+void fill_status_map(caf::settings& xs, const filesystem_statistics& stats) {
+  auto add_stats = [&](auto& name, auto& ops) {
+    auto& dict = put_dictionary(xs, name);
+    caf::put(dict, "successful", ops.successful);
+    caf::put(dict, "failed", ops.failed);
+    caf::put(dict, "bytes", ops.bytes);
+    // Only non-empty buckets, keyed by their exclusive upper bound.
+    auto& latency = put_dictionary(dict, "latency");
+    auto& buckets = ops.latency.buckets;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      if (buckets[i] == 0)
+        continue;
+      auto key = i + 1 < buckets.size()
+                   ? "<" + std::to_string(uint64_t{1} << i) + "us"
+                   : std::string{"inf"};
+      caf::put(latency, key, buckets[i]);
+    }
+  };
+  add_stats("writes", stats.writes);
+  add_stats("reads", stats.reads);
+  add_stats("mmaps", stats.mmaps);
+}
+
+} // namespace vast::system
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/hunt_command.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/data.hpp"
+#include "vast/defaults.hpp"
+#include "vast/detail/sigma.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/path.hpp"
+#include "vast/rule_pack.hpp"
+#include "vast/scope_linked.hpp"
+#include "vast/system/hunter.hpp"
+#include "vast/system/node_control.hpp"
+#include "vast/system/signal_monitor.hpp"
+#include "vast/system/spawn_or_connect_to_node.hpp"
+#include "vast/system/value_counts.hpp"
+
+#include <caf/actor.hpp>
+#include <caf/scoped_actor.hpp>
+#include <caf/settings.hpp>
+
+#include <iostream>
+#include <thread>
+
+namespace vast::system {
+
+namespace {
+
+/// Parses a Sigma rule from a file.
+/// @returns The title of the rule, or the file name if it has none, and the
+///          expression of the rule.
+caf::expected<rule_pack::rule> load_rule(const std::string& filename) {
+  auto contents = load_contents(path{filename});
+  if (!contents)
+    return contents.error();
+  auto yaml = from_yaml(*contents);
+  if (!yaml)
+    return caf::make_error(ec::parse_error, "failed to parse YAML in",
+                           filename, std::move(yaml.error()));
+  auto expr = detail::sigma::parse_rule(*yaml);
+  if (!expr)
+    return caf::make_error(ec::parse_error, "failed to parse Sigma rule in",
+                           filename, std::move(expr.error()));
+  auto normalized = normalize_and_validate(*expr);
+  if (!normalized)
+    return normalized.error();
+  auto name = filename;
+  if (auto xs = caf::get_if<record>(&*yaml))
+    if (auto i = xs->find("title"); i != xs->end())
+      if (auto title = caf::get_if<std::string>(&i->second))
+        name = *title;
+  return rule_pack::rule{std::move(name), std::move(*normalized)};
+}
+
+} // namespace
+
+caf::message hunt_command(const invocation& inv, caf::actor_system& sys) {
+  VAST_DEBUG("{}", inv);
+  const auto& options = inv.options;
+  if (inv.arguments.empty())
+    return caf::make_message(caf::make_error(
+      ec::invalid_argument, "hunt requires at least one Sigma rule"));
+  // Parse all rules before contacting the node.
+  std::vector<rule_pack::rule> rules;
+  rules.reserve(inv.arguments.size());
+  for (auto& filename : inv.arguments) {
+    auto rule = load_rule(filename);
+    if (!rule)
+      return caf::make_message(std::move(rule.error()));
+    rules.push_back(std::move(*rule));
+  }
+  // Get a convenient and blocking way to interact with actors.
+  caf::scoped_actor self{sys};
+  // Get VAST node.
+  auto node_opt
+    = system::spawn_or_connect_to_node(self, options, content(sys.config()));
+  if (auto err = caf::get_if<caf::error>(&node_opt))
+    return caf::make_message(std::move(*err));
+  auto& node = caf::holds_alternative<node_actor>(node_opt)
+                 ? caf::get<node_actor>(node_opt)
+                 : caf::get<scope_linked<node_actor>>(node_opt).get();
+  VAST_ASSERT(node != nullptr);
+  auto components
+    = get_node_components<index_actor, archive_actor, type_registry_actor>(
+      self, node);
+  if (!components)
+    return caf::make_message(std::move(components.error()));
+  auto& [index, archive, type_registry] = *components;
+  if (!index)
+    return caf::make_message(
+      caf::make_error(ec::missing_component, "index"));
+  if (!archive)
+    return caf::make_message(
+      caf::make_error(ec::missing_component, "archive"));
+  // Substitute taxonomy identifiers in every rule.
+  if (type_registry
+      && !caf::get_or(options, "vast.hunt.disable-taxonomies", false)) {
+    caf::error err;
+    for (auto& rule : rules) {
+      self->request(type_registry, caf::infinite, atom::resolve_v, rule.second)
+        .receive(
+          [&](expression& resolved) { rule.second = std::move(resolved); },
+          [&](caf::error& e) { err = std::move(e); });
+      if (err)
+        return caf::make_message(std::move(err));
+    }
+  }
+  auto pack = rule_pack::make(std::move(rules));
+  if (!pack)
+    return caf::make_message(std::move(pack.error()));
+  VAST_VERBOSE("hunt compiled {} rules with {} predicates into {} distinct "
+               "predicates",
+               pack->size(), pack->num_predicate_occurrences(),
+               pack->num_predicates());
+  // Start signal monitor.
+  std::thread sig_mon_thread;
+  auto guard = system::signal_monitor::run_guarded(
+    sig_mon_thread, sys, defaults::system::signal_monitoring_interval, self);
+  // The HUNTER runs in the client process and talks to the INDEX and the
+  // ARCHIVE of the node directly.
+  auto hunter_actor = self->spawn(hunter, std::move(*pack), index, archive);
+  self->send(hunter_actor, atom::run_v, self);
+  bool hunting = true;
+  value_counts result;
+  self->receive_while
+    // Loop until false.
+    (hunting)
+    // Message handlers.
+    ([&](value_counts& x) { result.merge(x); },
+     [&](atom::done) { hunting = false; });
+  for (auto& [name, n] : result.top(0))
+    std::cout << caf::get<std::string>(name) << '\t' << n << '\n';
+  std::cout << std::flush;
+  return caf::none;
+}
+
+} // namespace vast::system
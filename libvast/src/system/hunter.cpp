@@ -0,0 +1,76 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/hunter.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/defaults.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/event_based_actor.hpp>
+
+namespace vast::system {
+
+caf::behavior hunt_worker(caf::stateful_actor<hunt_worker_state>* self,
+                          rule_pack rules, ids hits, archive_actor archive,
+                          caf::actor parent) {
+  self->state.rules = std::move(rules);
+  self->state.hits = hits;
+  self->send(archive, atom::exporter_v, caf::actor_cast<caf::actor>(self));
+  self->send(archive, std::move(hits),
+             caf::actor_cast<archive_client_actor>(self));
+  return {
+    [self](table_slice slice) {
+      auto& st = self->state;
+      // The ARCHIVE ships whole slices, so we restrict the rules to our hits
+      // to count every event only once across all workers.
+      auto matches = st.rules.evaluate(slice, st.hits);
+      for (size_t i = 0; i < matches.size(); ++i)
+        if (auto n = rank(matches[i]); n > 0)
+          st.result.add(st.rules.name(i), n);
+    },
+    [self, parent](atom::done, const caf::error& err) {
+      if (err && err != ec::no_error)
+        VAST_WARN("{} failed to fetch candidates from the archive: {}", self,
+                  self->system().render(err));
+      self->send(parent, std::move(self->state.result));
+      self->quit();
+    },
+  };
+}
+
+hunter_state::hunter_state(caf::event_based_actor* self) : super(self) {
+  // nop
+}
+
+void hunter_state::init(rule_pack rules, index_actor index,
+                        archive_actor archive) {
+  rules_ = std::move(rules);
+  super::init(rules_.combined(), std::move(index), std::move(archive),
+              defaults::system::max_query_workers);
+}
+
+void hunter_state::spawn_worker(ids hits) {
+  self_->spawn<caf::linked>(hunt_worker, rules_, std::move(hits), archive_,
+                            caf::actor_cast<caf::actor>(self_));
+}
+
+caf::behavior hunter(caf::stateful_actor<hunter_state>* self, rule_pack rules,
+                     index_actor index, archive_actor archive) {
+  self->state.init(std::move(rules), std::move(index), std::move(archive));
+  return self->state.behavior();
+}
+
+} // namespace vast::system
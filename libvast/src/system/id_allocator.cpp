@@ -0,0 +1,213 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/id_allocator.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/error.hpp"
+#include "vast/error.hpp"
+#include "vast/file.hpp"
+#include "vast/logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace vast::system {
+
+caf::expected<std::shared_ptr<id_allocator>>
+id_allocator::make(path dir, id headroom) {
+  // We keep the file name and format of the state file of the IMPORTER that
+  // allocated IDs on its own before, such that existing databases continue
+  // where they left off.
+  auto file = dir / "current_id_block";
+  auto end = id{0};
+  auto next = id{0};
+  if (exists(file)) {
+    VAST_VERBOSE("id-allocator reads persistent state from {}", file);
+    std::ifstream state_file{to_string(file)};
+    state_file >> end;
+    if (!state_file)
+      return caf::make_error(ec::parse_error,
+                             "unable to read ID allocator state file",
+                             file.str());
+    state_file >> next;
+    if (!state_file) {
+      VAST_WARN("id-allocator did not find next ID position in state file; "
+                "irregular shutdown detected");
+      next = end;
+    }
+  } else {
+    VAST_VERBOSE("id-allocator did not find a state file at {}", file);
+  }
+  auto result
+    = std::shared_ptr<id_allocator>{new id_allocator{file, next, headroom}};
+  result->durable_ = end;
+  result->requested_ = end;
+  if (auto err = result->persist(next + headroom))
+    return err;
+  result->thread_ = std::thread{[ptr = result.get()] { ptr->run(); }};
+  return result;
+}
+
+id_allocator::id_allocator(path file, id next, id headroom)
+  : file_{std::move(file)},
+    headroom_{std::max(headroom, block_size)},
+    next_{next},
+    durable_{0},
+    requested_{0} {
+  // nop
+}
+
+id_allocator::~id_allocator() {
+  {
+    auto lock = std::lock_guard{mutex_};
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+  auto lock = std::lock_guard{write_mutex_};
+  auto next = next_.load();
+  if (auto err = write(std::max(durable_.load(), next), next))
+    VAST_ERROR("id-allocator failed to persist its state: {}", render(err));
+  else
+    VAST_VERBOSE("id-allocator persisted next available ID at {}", next);
+}
+
+caf::expected<id_range> id_allocator::reserve(uint64_t n) {
+  auto size = std::max((n + block_size - 1) / block_size, uint64_t{1})
+              * block_size;
+  auto first = id{0};
+  auto next = next_.load(std::memory_order_relaxed);
+  // Reservations start at a block boundary, because the IDs that remain in
+  // the block of a previous run may belong to a different IMPORTER.
+  do {
+    first = (next + block_size - 1) / block_size * block_size;
+  } while (!next_.compare_exchange_weak(next, first + size,
+                                        std::memory_order_relaxed));
+  auto last = first + size;
+  if (last + headroom_ / 2 > durable_.load(std::memory_order_acquire))
+    request(last + headroom_);
+  if (last > durable_.load(std::memory_order_acquire)) {
+    // The background thread fell behind, and we must not hand out IDs that a
+    // crash could hand out again.
+    VAST_DEBUG("id-allocator waits for the watermark to reach {}", last);
+    if (auto err = persist(last + headroom_)) {
+      VAST_ERROR("id-allocator failed to persist its state: {}", render(err));
+      return err;
+    }
+  }
+  return id_range{first, last};
+}
+
+id id_allocator::next() const noexcept {
+  return next_.load(std::memory_order_relaxed);
+}
+
+id id_allocator::durable() const noexcept {
+  return durable_.load(std::memory_order_acquire);
+}
+
+size_t id_allocator::writes() const noexcept {
+  return writes_.load(std::memory_order_relaxed);
+}
+
+caf::error id_allocator::persist(id target) {
+  auto lock = std::lock_guard{write_mutex_};
+  // A concurrent write may have covered the target already.
+  if (durable_.load(std::memory_order_acquire) >= target)
+    return caf::none;
+  // Cover all requests that accumulated until now with a single write.
+  target = std::max(target, requested_.load(std::memory_order_relaxed));
+  if (auto err = write(target))
+    return err;
+  durable_.store(target, std::memory_order_release);
+  writes_.fetch_add(1, std::memory_order_relaxed);
+  VAST_DEBUG("id-allocator persisted ID watermark at {}", target);
+  return caf::none;
+}
+
+caf::error id_allocator::write(id end, std::optional<id> next) {
+  auto dir = file_.parent();
+  if (!exists(dir))
+    if (auto err = mkdir(dir))
+      return err;
+  auto content = std::to_string(end);
+  if (next)
+    content += ' ' + std::to_string(*next);
+  // Write to a temporary file and rename it afterwards, so that a crash never
+  // leaves behind a truncated state file.
+  auto tmp = file_ + ".tmp";
+  {
+    auto f = file{tmp};
+    if (!f.open(file::write_only))
+      return caf::make_error(ec::filesystem_error, "failed to open file",
+                             tmp.str());
+    if (auto err = f.write(content.data(), content.size()))
+      return err;
+    if (::fsync(f.handle()) != 0)
+      return caf::make_error(ec::filesystem_error,
+                             "failed in fsync(2):", std::strerror(errno));
+  }
+  if (std::rename(tmp.str().c_str(), file_.str().c_str()) != 0) {
+    rm(tmp);
+    return caf::make_error(ec::filesystem_error,
+                           "failed in rename(2):", std::strerror(errno));
+  }
+  return caf::none;
+}
+
+void id_allocator::request(id target) {
+  auto current = requested_.load(std::memory_order_relaxed);
+  while (current < target
+         && !requested_.compare_exchange_weak(current, target,
+                                              std::memory_order_relaxed)) {
+    // nop
+  }
+  if (current >= target)
+    return;
+  // Synchronize with the background thread so that it cannot miss the
+  // notification between checking for new requests and going to sleep.
+  { auto lock = std::lock_guard{mutex_}; }
+  cv_.notify_one();
+}
+
+void id_allocator::run() {
+  auto lock = std::unique_lock{mutex_};
+  while (true) {
+    cv_.wait(lock, [&] {
+      return stop_
+             || requested_.load(std::memory_order_relaxed)
+                  > durable_.load(std::memory_order_acquire);
+    });
+    if (stop_)
+      return;
+    lock.unlock();
+    auto err = persist(requested_.load(std::memory_order_relaxed));
+    lock.lock();
+    if (err) {
+      VAST_ERROR("id-allocator failed to persist its state: {}", render(err));
+      // Back off before trying again; reservations that overtake the
+      // watermark in the meantime persist it on their own.
+      cv_.wait_for(lock, std::chrono::seconds{1}, [&] { return stop_; });
+    }
+  }
+}
+
+} // namespace vast::system
@@ -20,13 +20,16 @@
 #include "vast/concept/printable/std/chrono.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/error.hpp"
-#include "vast/concept/printable/vast/filesystem.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
 #include "vast/defaults.hpp"
+#include "vast/detail/assert.hpp"
 #include "vast/detail/fill_status_map.hpp"
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/plugin.hpp"
-#include "vast/si_literals.hpp"
+#include "vast/system/continuous_query_matcher.hpp"
+#include "vast/system/id_allocator.hpp"
+#include "vast/system/metrics_registry.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -36,8 +39,6 @@
 #include <caf/config_value.hpp>
 #include <caf/settings.hpp>
 
-#include <fstream>
-
 namespace vast::system {
 
 namespace {
@@ -54,16 +55,31 @@ public:
   void process(caf::downstream<table_slice>& out,
                std::vector<table_slice>& slices) override {
     VAST_TRACE_SCOPE("{}", VAST_ARG(slices));
+    static auto& events_counter
+      = metrics_registry::instance().counter("importer.events");
+    static auto& rows_histogram
+      = metrics_registry::instance().histogram("importer.slice-rows");
     uint64_t events = 0;
     auto t = timer::start(state.measurement_);
     for (auto&& slice : std::exchange(slices, {})) {
       VAST_ASSERT(slice.rows() <= static_cast<size_t>(state.available_ids()));
       auto rows = slice.rows();
+      auto offset = state.next_id(rows);
+      if (!offset) {
+        // Assigning IDs that are not durable could hand out the same IDs
+        // twice after a crash, so we stop importing instead.
+        VAST_ERROR("{} failed to assign IDs: {}", state.self,
+                   render(offset.error()));
+        state.self->quit(std::move(offset.error()));
+        break;
+      }
       events += rows;
-      slice.offset(state.next_id(rows));
+      rows_histogram.record(rows);
+      slice.offset(*offset);
       out.push(std::move(slice));
     }
     t.stop(events);
+    events_counter.add(events);
   }
 
   void finalize(const caf::error& err) override {
@@ -113,65 +129,19 @@ importer_state::importer_state(importer_actor::pointer self) : self{self} {
   // nop
 }
 
-importer_state::~importer_state() {
-  write_state(write_mode::with_next);
-}
-
-caf::error importer_state::read_state() {
-  auto file = dir / "current_id_block";
-  if (exists(file)) {
-    VAST_VERBOSE("{} reads persistent state from {}", self, file);
-    std::ifstream state_file{to_string(file)};
-    state_file >> current.end;
-    if (!state_file)
-      return caf::make_error(ec::parse_error,
-                             "unable to read importer state file", file.str());
-    state_file >> current.next;
-    if (!state_file) {
-      VAST_WARN("{} did not find next ID position in state file; "
-                "irregular shutdown detected",
-                self);
-      current.next = current.end;
-    }
-  } else {
-    VAST_VERBOSE("{} did not find a state file at {}", self, file);
-    current.end = 0;
-    current.next = 0;
-  }
-  return get_next_block();
-}
-
-caf::error importer_state::write_state(write_mode mode) {
-  if (!exists(dir)) {
-    if (auto err = mkdir(dir))
-      return err;
-  }
-  std::ofstream state_file{to_string(dir / "current_id_block")};
-  state_file << current.end;
-  if (mode == write_mode::with_next) {
-    state_file << " " << current.next;
-    VAST_VERBOSE("{} persisted next available ID at {}", self, current.next);
-  } else {
-    VAST_VERBOSE("{} persisted ID block boundary at {}", self, current.end);
+caf::expected<id> importer_state::next_id(uint64_t advance) {
+  if (current.next + advance > current.end) {
+    // The remainder of the current block goes unused, which keeps the IDs of
+    // a table slice contiguous.
+    auto range = ids->reserve(advance);
+    if (!range)
+      return std::move(range.error());
+    VAST_DEBUG("{} reserved IDs [{}, {})", self, range->first, range->last);
+    current = {range->first, range->last};
   }
-  return caf::none;
-}
-
-caf::error importer_state::get_next_block(uint64_t required) {
-  using namespace si_literals;
-  while (current.next + required >= current.end)
-    current.end += 8_Mi;
-  return write_state(write_mode::without_next);
-}
-
-id importer_state::next_id(uint64_t advance) {
-  id pre = current.next;
-  id post = pre + advance;
-  if (post >= current.end)
-    get_next_block(advance);
-  current.next = post;
-  VAST_ASSERT(current.next < current.end);
-  return pre;
+  auto result = current.next;
+  current.next += advance;
+  return result;
 }
 
 id importer_state::available_ids() const noexcept {
@@ -234,6 +204,31 @@ importer_state::status(status_verbosity v) const {
             rp.deliver(std::move(req_state->result));
         });
   }
+  // Gather status from the CONTINUOUS QUERY MATCHER.
+  if (continuous_queries && v >= status_verbosity::detailed) {
+    ++req_state->pending_replies;
+    self
+      ->request<caf::message_priority::high>(
+        continuous_queries, defaults::system::initial_request_timeout / 2,
+        atom::status_v, v)
+      .then(
+        [=, &importer_status](caf::settings& continuous_status) mutable {
+          caf::put(importer_status, "continuous-queries",
+                   std::move(continuous_status));
+          if (--req_state->pending_replies == 0)
+            rp.deliver(std::move(req_state->result));
+        },
+        [=, &importer_status](const caf::error& err) mutable {
+          VAST_WARN("{} failed to retrieve status from the continuous query "
+                    "matcher: {}",
+                    self, err);
+          auto& continuous_status
+            = caf::put_dictionary(importer_status, "continuous-queries");
+          caf::put(continuous_status, "error", render(err));
+          if (--req_state->pending_replies == 0)
+            rp.deliver(std::move(req_state->result));
+        });
+  }
   if (req_state->pending_replies == 0)
     rp.deliver(std::move(req_state->result));
   return rp;
@@ -266,17 +261,13 @@ void importer_state::send_report() {
 }
 
 importer_actor::behavior_type
-importer(importer_actor::stateful_pointer<importer_state> self, path dir,
-         node_actor::pointer node, const archive_actor& archive,
-         index_actor index, const type_registry_actor& type_registry) {
-  VAST_TRACE_SCOPE("{}", VAST_ARG(dir));
-  self->state.dir = std::move(dir);
-  auto err = self->state.read_state();
-  if (err) {
-    VAST_ERROR("{} failed to load state: {}", self, render(err));
-    self->quit(std::move(err));
-    return importer_actor::behavior_type::make_empty_behavior();
-  }
+importer(importer_actor::stateful_pointer<importer_state> self,
+         std::shared_ptr<id_allocator> ids, node_actor::pointer node,
+         const archive_actor& archive, index_actor index,
+         const type_registry_actor& type_registry) {
+  VAST_TRACE_SCOPE("");
+  VAST_ASSERT(ids != nullptr);
+  self->state.ids = std::move(ids);
   namespace defs = defaults::system;
   self->set_exit_handler([=](const caf::exit_msg& msg) {
     self->state.send_report();
@@ -317,6 +308,20 @@ importer(importer_actor::stateful_pointer<importer_state> self, path dir,
       self->send(self->state.index, atom::subscribe_v, atom::flush_v,
                  std::move(listener));
     },
+    // Register a continuous query of an EXPORTER actor.
+    [self](atom::subscribe, const expression& expr,
+           exporter_actor exporter) -> caf::result<atom::ok> {
+      VAST_DEBUG("{} adds continuous query {} of {}", self, to_string(expr),
+                 exporter);
+      auto& st = self->state;
+      if (!st.continuous_queries) {
+        st.continuous_queries
+          = self->spawn<caf::linked>(continuous_query_matcher);
+        st.stage->add_outbound_path(st.continuous_queries);
+      }
+      return self->delegate(st.continuous_queries, atom::subscribe_v, expr,
+                            std::move(exporter));
+    },
     // The internal telemetry loop of the IMPORTER.
     [self](atom::telemetry) {
       self->state.send_report();
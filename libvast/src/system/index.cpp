@@ -31,6 +31,7 @@
 #include "vast/detail/narrow.hpp"
 #include "vast/detail/notifying_stream_manager.hpp"
 #include "vast/detail/settings.hpp"
+#include "vast/detail/spawn_container_source.hpp"
 #include "vast/error.hpp"
 #include "vast/expression_visitors.hpp"
 #include "vast/fbs/index.hpp"
@@ -44,8 +45,11 @@
 #include "vast/meta_index.hpp"
 #include "vast/partition_synopsis.hpp"
 #include "vast/system/evaluator.hpp"
+#include "vast/system/id_allocator.hpp"
 #include "vast/system/partition.hpp"
+#include "vast/system/query_result_cache.hpp"
 #include "vast/system/query_supervisor.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -68,8 +72,8 @@ using namespace std::chrono;
 // clang-format off
 //
 // The index is implemented as a stream stage that hooks into the table slice
-// stream coming from the importer, and forwards them to the current active
-// partition
+// streams coming from the importers, and forwards them to the active
+// partition for the ID block of their events
 //
 //              table slice              table slice                      table slice column
 //   importer ----------------> index ---------------> active partition ------------------------> indexer
@@ -157,7 +161,8 @@ partition_actor partition_factory::operator()(const uuid& id) const {
               != state_.persisted_partitions.end());
   auto path = state_.partition_path(id);
   VAST_DEBUG("{} loads partition {} for path {}", state_.self, id, path);
-  return state_.self->spawn(passive_partition, id, filesystem_, path);
+  return state_.self->spawn(passive_partition, id, filesystem_, path,
+                            state_.result_cache);
 }
 
 filesystem_actor& partition_factory::filesystem() {
@@ -168,6 +173,11 @@ partition_factory::partition_factory(index_state& state) : state_{state} {
   // nop
 }
 
+bool id_block_selector::operator()(const id& block,
+                                   const table_slice& slice) const {
+  return id_allocator::block_of(slice.offset()) == block;
+}
+
 index_state::index_state(index_actor::pointer self)
   : self{self}, inmem_partitions{0, partition_factory{*this}} {
 }
@@ -200,7 +210,6 @@ caf::error index_state::load_from_disk() {
       vast::uuid partition_uuid;
       unpack(*uuid_fb, partition_uuid);
       auto partition_path = dir / to_string(partition_uuid);
-      auto partition_synopsis_path = dir / (to_string(partition_uuid) + ".mdx");
       if (!exists(partition_path)) {
         VAST_WARN("{} found partition {}"
                   "in the index state but not on disk; this may have been "
@@ -208,27 +217,15 @@ caf::error index_state::load_from_disk() {
                   self, partition_uuid);
         continue;
       }
-      // Generate external partition synopsis file if it doesn't exist.
-      if (!exists(partition_synopsis_path)) {
-        if (auto error = extract_partition_synopsis(partition_path,
-                                                    partition_synopsis_path))
-          return error;
-      }
-      auto chunk = chunk::mmap(partition_synopsis_path);
-      if (!chunk) {
-        VAST_WARN("{} could not mmap partition at {}", self, partition_path);
+      // In lazy mode we defer reading the synopsis until the index is up and
+      // running, and consider the partition for every query in the meantime.
+      if (lazy_meta_index) {
+        pending_synopses.push_back(partition_uuid);
+        persisted_partitions.insert(partition_uuid);
         continue;
       }
-      auto ps_flatbuffer = fbs::GetPartitionSynopsis(chunk->data());
-      partition_synopsis ps;
-      if (ps_flatbuffer->partition_synopsis_type()
-          != fbs::partition_synopsis::PartitionSynopsis::v0)
-        return caf::make_error(ec::format_error, "invalid partition synopsis "
-                                                 "version");
-      if (auto error = unpack(*ps_flatbuffer->partition_synopsis_as_v0(), ps))
+      if (auto error = load_partition_synopsis(partition_uuid))
         return error;
-      meta_idx.merge(partition_uuid, std::move(ps));
-      persisted_partitions.insert(partition_uuid);
     }
     auto stats = index_v0->stats();
     if (!stats)
@@ -247,6 +244,61 @@ caf::error index_state::load_from_disk() {
   return caf::none;
 }
 
+caf::error index_state::load_partition_synopsis(const uuid& id) {
+  auto partition_path = dir / to_string(id);
+  auto partition_synopsis_path = dir / (to_string(id) + ".mdx");
+  // Generate external partition synopsis file if it doesn't exist.
+  if (!exists(partition_synopsis_path)) {
+    if (auto error
+        = extract_partition_synopsis(partition_path, partition_synopsis_path))
+      return error;
+  }
+  auto chunk = chunk::mmap(partition_synopsis_path);
+  if (!chunk) {
+    // Lazily loaded partitions remain candidates for all queries when their
+    // synopsis fails to load, so we must report this case.
+    if (lazy_meta_index)
+      return caf::make_error(ec::filesystem_error, "failed to mmap",
+                             partition_synopsis_path.str());
+    VAST_WARN("{} could not mmap partition at {}", self, partition_path);
+    return caf::none;
+  }
+  partition_synopsis ps;
+  if (lazy_meta_index) {
+    if (auto error = unpack_lazily(std::move(chunk), ps))
+      return error;
+  } else {
+    auto ps_flatbuffer = fbs::GetPartitionSynopsis(chunk->data());
+    if (ps_flatbuffer->partition_synopsis_type()
+        != fbs::partition_synopsis::PartitionSynopsis::v0)
+      return caf::make_error(ec::format_error, "invalid partition synopsis "
+                                               "version");
+    if (auto error = unpack(*ps_flatbuffer->partition_synopsis_as_v0(), ps))
+      return error;
+  }
+  meta_idx.merge(id, std::move(ps));
+  persisted_partitions.insert(id);
+  return caf::none;
+}
+
+void index_state::load_pending_synopses(size_t n) {
+  while (n-- > 0 && !pending_synopses.empty()) {
+    auto id = pending_synopses.back();
+    pending_synopses.pop_back();
+    // Skip partitions that were erased in the meantime.
+    if (!persisted_partitions.count(id))
+      continue;
+    // The index already serves queries, so a single broken synopsis must not
+    // take it down.
+    if (auto error = load_partition_synopsis(id)) {
+      VAST_WARN("{} failed to load the synopsis of partition {} and "
+                "considers it for all queries: {}",
+                self, id, render(error));
+      unreadable_synopses.push_back(id);
+    }
+  }
+}
+
 bool index_state::worker_available() {
   return !idle_workers.empty();
 }
@@ -277,35 +329,48 @@ void index_state::notify_flush_listeners() {
   flush_listeners.clear();
 }
 
-void index_state::create_active_partition() {
-  auto id = uuid::random();
+active_partition_actor
+index_state::spawn_active_partition(const uuid& id, size_t capacity) {
   caf::settings index_opts;
-  index_opts["cardinality"] = partition_capacity;
+  index_opts["cardinality"] = capacity;
   // These options must be kept in sync with vast/address_synopsis.hpp and
   // vast/string_synopsis.hpp respectively.
   auto synopsis_options = caf::settings{};
-  put(synopsis_options, "max-partition-size", partition_capacity);
+  put(synopsis_options, "max-partition-size", capacity);
   put(synopsis_options, "address-synopsis-fp-rate", meta_index_fp_rate);
   put(synopsis_options, "string-synopsis-fp-rate", meta_index_fp_rate);
-  active_partition.actor
-    = self->spawn(::vast::system::active_partition, id, filesystem, index_opts,
-                  synopsis_options);
+  put(synopsis_options, "cardinality-sketch-precision",
+      cardinality_sketch_precision);
+  put(synopsis_options, "native-bloom-filters", native_bloom_filters);
+  return self->spawn(::vast::system::active_partition, id, filesystem,
+                     index_opts, synopsis_options, accountant);
+}
+
+void index_state::create_active_partition(id block) {
+  auto id = uuid::random();
+  auto& active_partition = active_partitions[block];
+  active_partition.actor = spawn_active_partition(id, partition_capacity);
   active_partition.stream_slot
     = stage->add_outbound_path(active_partition.actor);
+  stage->out().set_filter(active_partition.stream_slot, block);
   active_partition.capacity = partition_capacity;
   active_partition.id = id;
-  VAST_DEBUG("{} created new partition {}", self, id);
+  VAST_DEBUG("{} created new partition {} for ID block {}", self, id, block);
 }
 
-void index_state::decomission_active_partition() {
-  auto id = active_partition.id;
-  auto actor = std::exchange(active_partition.actor, {});
+void index_state::decomission_active_partition(id block) {
+  auto i = active_partitions.find(block);
+  VAST_ASSERT(i != active_partitions.end());
+  auto id = i->second.id;
+  auto actor = std::move(i->second.actor);
+  auto stream_slot = i->second.stream_slot;
+  active_partitions.erase(i);
   unpersisted[id] = actor;
   // Send buffered batches.
   stage->out().fan_out_flush();
   stage->out().force_emit_batches();
   // Remove active partition from the stream.
-  stage->out().close(active_partition.stream_slot);
+  stage->out().close(stream_slot);
   // Persist active partition asynchronously.
   auto part_dir = dir / to_string(id);
   auto synopsis_dir = synopsisdir / (to_string(id) + ".mdx");
@@ -329,6 +394,86 @@ void index_state::decomission_active_partition() {
       });
 }
 
+active_partition_actor
+index_state::find_active_partition(const uuid& id) const {
+  for (const auto& [_, active_partition] : active_partitions)
+    if (active_partition.id == id)
+      return active_partition.actor;
+  return {};
+}
+
+caf::error index_state::replace_partitions(const std::vector<uuid>& old_ids,
+                                           const uuid& new_id,
+                                           partition_synopsis&& ps) {
+  // The replaced partitions may have been erased in the meantime, in which
+  // case the new partition would resurrect their events.
+  for (auto& id : old_ids)
+    if (!persisted_partitions.count(id))
+      return caf::make_error(ec::lookup_error, "cannot replace unknown "
+                                               "partition",
+                             to_string(id));
+  meta_idx.merge(new_id, std::move(ps));
+  persisted_partitions.insert(new_id);
+  for (auto& id : old_ids) {
+    meta_idx.erase(id);
+    persisted_partitions.erase(id);
+    inmem_partitions.drop(id);
+    if (result_cache)
+      result_cache->erase(id);
+    pending_synopses.erase(
+      std::remove(pending_synopses.begin(), pending_synopses.end(), id),
+      pending_synopses.end());
+    unreadable_synopses.erase(
+      std::remove(unreadable_synopses.begin(), unreadable_synopses.end(), id),
+      unreadable_synopses.end());
+  }
+  // Only delete the replaced partitions after the index state no longer
+  // references them. Until then, a crash leaves behind an unreferenced new
+  // partition at worst. Queries that are already running on a replaced
+  // partition continue to work on the memory-mapped data after the files
+  // were unlinked.
+  auto paths = std::vector<path>{};
+  for (auto& id : old_ids) {
+    paths.push_back(partition_path(id));
+    paths.push_back(partition_synopsis_path(id));
+  }
+  flush_to_disk([self = self, paths = std::move(paths)] {
+    for (auto& x : paths)
+      if (exists(x) && !rm(x))
+        VAST_WARN("{} could not unlink replaced partition file {}", self, x);
+  });
+  return caf::none;
+}
+
+bool index_state::is_referenced_by_pending_query(
+  const std::vector<uuid>& ids) const {
+  for (const auto& [_, query] : pending)
+    for (const auto& id : query.partitions)
+      if (std::find(ids.begin(), ids.end(), id) != ids.end())
+        return true;
+  return false;
+}
+
+void index_state::complete_deferred_replacements() {
+  auto i = deferred_replacements.begin();
+  while (i != deferred_replacements.end()) {
+    if (is_referenced_by_pending_query(i->old_ids)) {
+      ++i;
+      continue;
+    }
+    auto x = std::move(*i);
+    i = deferred_replacements.erase(i);
+    if (auto err
+        = replace_partitions(x.old_ids, x.new_id, std::move(x.synopsis))) {
+      rm(partition_path(x.new_id));
+      rm(partition_synopsis_path(x.new_id));
+      x.rp.deliver(std::move(err));
+      continue;
+    }
+    x.rp.deliver(atom::done_v);
+  }
+}
+
 caf::typed_response_promise<caf::settings>
 index_state::status(status_verbosity v) const {
   using caf::put;
@@ -364,10 +509,24 @@ index_state::status(status_verbosity v) const {
       layout_object.insert_or_assign(name, std::move(xs));
     }
     put(index_status, "meta-index-bytes", meta_idx.memusage());
-    put(index_status, "num-active-partitions",
-        active_partition.actor == nullptr ? 0 : 1);
+    put(index_status, "num-active-partitions", active_partitions.size());
     put(index_status, "num-cached-partitions", inmem_partitions.size());
+    if (result_cache) {
+      auto cache_stats = result_cache->stats();
+      auto lookups = cache_stats.hits + cache_stats.misses;
+      auto& cache_status = put_dictionary(index_status, "result-cache");
+      put(cache_status, "hits", cache_stats.hits);
+      put(cache_status, "misses", cache_stats.misses);
+      put(cache_status, "hit-rate",
+          lookups == 0 ? 0.0
+                       : static_cast<double>(cache_stats.hits) / lookups);
+      put(cache_status, "entries", cache_stats.entries);
+      put(cache_status, "memory-usage", cache_stats.memory_usage);
+      put(cache_status, "capacity", cache_stats.capacity);
+    }
     put(index_status, "num-unpersisted-partitions", unpersisted.size());
+    put(index_status, "num-pending-synopses", pending_synopses.size());
+    put(index_status, "num-unreadable-synopses", unreadable_synopses.size());
     auto& partitions = put_dictionary(index_status, "partitions");
     auto partition_status = [&](const uuid& id, const partition_actor& pa,
                                 caf::config_value::list& xs) {
@@ -401,8 +560,8 @@ index_state::status(status_verbosity v) const {
     };
     // Resident partitions.
     auto& active = caf::put_list(partitions, "active");
-    active.reserve(1);
-    if (active_partition.actor != nullptr)
+    active.reserve(active_partitions.size());
+    for (auto& [_, active_partition] : active_partitions)
       partition_status(active_partition.id, active_partition.actor, active);
     auto& cached = put_list(partitions, "cached");
     cached.reserve(inmem_partitions.size());
@@ -422,16 +581,21 @@ index_state::status(status_verbosity v) const {
 
 std::vector<std::pair<uuid, partition_actor>>
 index_state::collect_query_actors(query_state& lookup,
-                                  uint32_t num_partitions) {
+                                  uint32_t num_partitions, ids& cached_hits,
+                                  query_trace& trace) {
   VAST_TRACE_SCOPE("{} {}", VAST_ARG(lookup), VAST_ARG(num_partitions));
   std::vector<std::pair<uuid, partition_actor>> result;
   if (num_partitions == 0 || lookup.partitions.empty())
     return result;
+  // Only passive partitions are immutable, so we must not use cached results
+  // for the active or unpersisted partitions.
+  auto is_passive = [&](const uuid& candidate) {
+    return !find_active_partition(candidate) && !unpersisted.count(candidate)
+           && persisted_partitions.count(candidate);
+  };
   // Prefer partitions that are already available in RAM.
   auto partition_is_loaded = [&](const uuid& candidate) {
-    return (active_partition.actor != nullptr
-            && active_partition.id == candidate)
-           || unpersisted.count(candidate)
+    return find_active_partition(candidate) || unpersisted.count(candidate)
            || inmem_partitions.contains(candidate);
   };
   std::partition(lookup.partitions.begin(), lookup.partitions.end(),
@@ -441,14 +605,15 @@ index_state::collect_query_actors(query_state& lookup,
     // We need to first check whether the ID is the active partition or one
     // of our unpersisted ones. Only then can we dispatch to our LRU cache.
     partition_actor part;
-    if (active_partition.actor != nullptr
-        && active_partition.id == partition_id)
-      part = active_partition.actor;
+    if (auto active_partition = find_active_partition(partition_id))
+      part = active_partition;
     else if (auto it = unpersisted.find(partition_id); it != unpersisted.end())
       part = it->second;
     else if (auto it = persisted_partitions.find(partition_id);
-             it != persisted_partitions.end())
+             it != persisted_partitions.end()) {
+      trace.record_partition(inmem_partitions.contains(partition_id));
       part = inmem_partitions.get_or_load(partition_id);
+    }
     if (!part)
       VAST_ERROR("{} could not load partition {} that was part of a "
                  "query",
@@ -459,14 +624,23 @@ index_state::collect_query_actors(query_state& lookup,
   // num_partitions partitions or run out of candidates.
   auto it = lookup.partitions.begin();
   auto last = lookup.partitions.end();
-  while (it != last && result.size() < num_partitions) {
+  size_t num_cached = 0;
+  while (it != last && result.size() + num_cached < num_partitions) {
     auto partition_id = *it++;
+    if (result_cache && is_passive(partition_id)) {
+      if (auto hits = result_cache->lookup(lookup.cache_key, partition_id)) {
+        cached_hits |= *hits;
+        ++num_cached;
+        continue;
+      }
+    }
     if (auto partition_actor = spin_up(partition_id))
       result.push_back(std::make_pair(partition_id, partition_actor));
   }
   lookup.partitions.erase(lookup.partitions.begin(), it);
-  VAST_DEBUG("{} launched {} partition actors to evaluate query", self,
-             result.size());
+  VAST_DEBUG("{} launched {} partition actors and used {} cached results to "
+             "evaluate query",
+             self, result.size(), num_cached);
   return result;
 }
 
@@ -521,7 +695,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const index_state& state) {
 }
 
 /// Persists the state to disk.
-void index_state::flush_to_disk() {
+void index_state::flush_to_disk(std::function<void()> on_success) {
   auto builder = flatbuffers::FlatBufferBuilder{};
   auto index = pack(builder, *this);
   if (!index) {
@@ -533,8 +707,10 @@ void index_state::flush_to_disk() {
     ->request(caf::actor_cast<caf::actor>(filesystem), caf::infinite,
               atom::write_v, index_filename(), chunk)
     .then(
-      [=](atom::ok) {
+      [=, on_success = std::move(on_success)](atom::ok) {
         VAST_DEBUG("{} successfully persisted index state", self);
+        if (on_success)
+          on_success();
       },
       [=](const caf::error& err) {
         VAST_WARN("{} failed to persist index state: {}", self, render(err));
@@ -545,11 +721,17 @@ index_actor::behavior_type
 index(index_actor::stateful_pointer<index_state> self,
       filesystem_actor filesystem, path dir, size_t partition_capacity,
       size_t max_inmem_partitions, size_t taste_partitions, size_t num_workers,
-      path meta_index_dir, double meta_index_fp_rate) {
-  VAST_TRACE_SCOPE("{} {} {} {} {} {} {}", VAST_ARG(filesystem), VAST_ARG(dir),
-                   VAST_ARG(partition_capacity), VAST_ARG(max_inmem_partitions),
-                   VAST_ARG(taste_partitions), VAST_ARG(num_workers),
-                   VAST_ARG(meta_index_dir), VAST_ARG(meta_index_fp_rate));
+      path meta_index_dir, double meta_index_fp_rate, bool lazy_meta_index,
+      size_t result_cache_size, size_t cardinality_sketch_precision,
+      bool native_bloom_filters) {
+  VAST_TRACE_SCOPE("{} {} {} {} {} {} {} {} {} {} {} {}", VAST_ARG(filesystem),
+                   VAST_ARG(dir), VAST_ARG(partition_capacity),
+                   VAST_ARG(max_inmem_partitions), VAST_ARG(taste_partitions),
+                   VAST_ARG(num_workers), VAST_ARG(meta_index_dir),
+                   VAST_ARG(meta_index_fp_rate), VAST_ARG(lazy_meta_index),
+                   VAST_ARG(result_cache_size),
+                   VAST_ARG(cardinality_sketch_precision),
+                   VAST_ARG(native_bloom_filters));
   VAST_VERBOSE("{} initializes index in {} with a maximum partition "
                "size of {} events and {} resident partitions",
                self, dir, partition_capacity, max_inmem_partitions);
@@ -565,6 +747,12 @@ index(index_actor::stateful_pointer<index_state> self,
   self->state.inmem_partitions.factory().filesystem() = self->state.filesystem;
   self->state.inmem_partitions.resize(max_inmem_partitions);
   self->state.meta_index_fp_rate = meta_index_fp_rate;
+  self->state.lazy_meta_index = lazy_meta_index;
+  self->state.cardinality_sketch_precision = cardinality_sketch_precision;
+  self->state.native_bloom_filters = native_bloom_filters;
+  if (result_cache_size > 0)
+    self->state.result_cache
+      = std::make_shared<query_result_cache>(result_cache_size);
   // Read persistent state.
   if (auto err = self->state.load_from_disk()) {
     VAST_ERROR("{} failed to load index state from disk: {}", self,
@@ -572,6 +760,12 @@ index(index_actor::stateful_pointer<index_state> self,
     self->quit(err);
     return index_actor::behavior_type::make_empty_behavior();
   }
+  // Load the remaining partition synopses in the background.
+  if (!self->state.pending_synopses.empty()) {
+    VAST_VERBOSE("{} loads {} partition synopses in the background", self,
+                 self->state.pending_synopses.size());
+    self->send(self, atom::internal_v, atom::load_v);
+  }
   // Setup stream manager.
   self->state.stage = detail::attach_notifying_stream_stage(
     self,
@@ -583,16 +777,32 @@ index(index_actor::stateful_pointer<index_state> self,
       VAST_ASSERT(x.encoding() != table_slice_encoding::none);
       auto&& layout = x.layout();
       self->state.stats.layouts[layout.name()].count += x.rows();
-      auto& active = self->state.active_partition;
-      if (!active.actor) {
-        self->state.create_active_partition();
-      } else if (x.rows() > active.capacity) {
+      auto& active_partitions = self->state.active_partitions;
+      auto block = id_allocator::block_of(x.offset());
+      auto upstream = caf::actor_addr{};
+      if (auto sender = self->current_sender())
+        upstream = sender->address();
+      // An IMPORTER never assigns IDs from an older block again once it moved
+      // on to a new one, so we retire its partitions for older blocks.
+      auto retired = std::vector<id>{};
+      for (const auto& [other, active] : active_partitions)
+        if (upstream && other != block && active.upstream == upstream)
+          retired.push_back(other);
+      for (auto other : retired)
+        self->state.decomission_active_partition(other);
+      if (!retired.empty())
+        self->state.flush_to_disk();
+      if (!active_partitions.count(block)) {
+        self->state.create_active_partition(block);
+      } else if (x.rows() > active_partitions[block].capacity) {
         VAST_DEBUG("{} exceeds active capacity by {} rows", self,
-                   x.rows() - active.capacity);
-        self->state.decomission_active_partition();
+                   x.rows() - active_partitions[block].capacity);
+        self->state.decomission_active_partition(block);
         self->state.flush_to_disk();
-        self->state.create_active_partition();
+        self->state.create_active_partition(block);
       }
+      auto& active = active_partitions[block];
+      active.upstream = upstream;
       out.push(x);
       if (active.capacity == self->state.partition_capacity
           && x.rows() > active.capacity) {
@@ -619,7 +829,11 @@ index(index_actor::stateful_pointer<index_state> self,
         self->send_exit(self, err);
       }
       VAST_DEBUG("index finalized streaming");
-    });
+    },
+    // Every outbound path is an active partition whose filter is the ID block
+    // of its events.
+    caf::policy::arg<caf::broadcast_downstream_manager<table_slice, id,
+                                                       id_block_selector>>{});
   self->set_exit_handler([self](const caf::exit_msg& msg) {
     VAST_DEBUG("{} received EXIT from {} with reason: {}", self, msg.source,
                msg.reason);
@@ -628,9 +842,10 @@ index(index_actor::stateful_pointer<index_state> self,
     self->state.stage->out().force_emit_batches();
     self->state.stage->out().close();
     self->state.stage->shutdown();
-    // Bring down active partition.
-    if (self->state.active_partition.actor)
-      self->state.decomission_active_partition();
+    // Bring down active partitions.
+    while (!self->state.active_partitions.empty())
+      self->state.decomission_active_partition(
+        self->state.active_partitions.begin()->first);
     // Collect partitions for termination.
     // TODO: We must actor_cast to caf::actor here because 'shutdown' operates
     // on 'std::vector<caf::actor>' only. That should probably be generalized in
@@ -699,11 +914,24 @@ index(index_actor::stateful_pointer<index_state> self,
         return {};
       }
       // Get all potentially matching partitions.
-      auto candidates = self->state.meta_idx.lookup(expr);
-      if (self->state.active_partition.actor)
-        candidates.push_back(self->state.active_partition.id);
+      auto trace = query_trace{};
+      auto candidates = [&] {
+        auto stage_timer
+          = query_stage_timer{trace, query_stage::meta_index_lookup};
+        return self->state.meta_idx.lookup(expr);
+      }();
+      self->send(client, atom::trace_v, std::move(trace));
+      for (const auto& [_, active] : self->state.active_partitions)
+        candidates.push_back(active.id);
       for (const auto& [id, _] : self->state.unpersisted)
         candidates.push_back(id);
+      // We cannot rule out partitions whose synopses are not yet loaded.
+      candidates.insert(candidates.end(),
+                        self->state.pending_synopses.begin(),
+                        self->state.pending_synopses.end());
+      candidates.insert(candidates.end(),
+                        self->state.unreadable_synopses.begin(),
+                        self->state.unreadable_synopses.end());
       if (candidates.empty()) {
         VAST_DEBUG("{} returns without result: no partitions qualify", self);
         no_result();
@@ -718,7 +946,9 @@ index(index_actor::stateful_pointer<index_state> self,
       auto total = candidates.size();
       auto scheduled = detail::narrow<uint32_t>(
         std::min(candidates.size(), self->state.taste_partitions));
-      auto lookup = query_state{query_id, expr, std::move(candidates)};
+      auto lookup = query_state{query_id, expr, std::move(candidates), {}};
+      if (self->state.result_cache)
+        lookup.cache_key = query_result_cache::key(lookup.expression);
       auto result = self->state.pending.emplace(query_id, std::move(lookup));
       VAST_ASSERT(result.second);
       respond(query_id, detail::narrow<uint32_t>(total), scheduled);
@@ -738,6 +968,7 @@ index(index_actor::stateful_pointer<index_state> self,
         VAST_DEBUG("{} drops remaining results for query id {}", self,
                    query_id);
         self->state.pending.erase(query_id);
+        self->state.complete_deferred_replacements();
         return {};
       }
       auto iter = self->state.pending.find(query_id);
@@ -750,9 +981,16 @@ index(index_actor::stateful_pointer<index_state> self,
       auto worker = self->state.next_worker();
       if (!worker)
         return caf::skip;
-      // Get partition actors, spawning new ones if needed.
-      auto actors
-        = self->state.collect_query_actors(query_state, num_partitions);
+      // Get partition actors, spawning new ones if needed, and relay the
+      // cached results directly to the client.
+      auto cached_hits = ids{};
+      auto trace = query_trace{};
+      auto actors = self->state.collect_query_actors(
+        query_state, num_partitions, cached_hits, trace);
+      if (trace.partition_cache_hits + trace.partition_cache_misses > 0)
+        self->send(client, atom::trace_v, std::move(trace));
+      if (any<1>(cached_hits))
+        self->send(client, std::move(cached_hits));
       // Delegate to query supervisor (uses up this worker) and report
       // query ID + some stats to the client.
       VAST_DEBUG("{} schedules {} more partition(s) for query id {}"
@@ -760,8 +998,10 @@ index(index_actor::stateful_pointer<index_state> self,
                  self, actors.size(), query_id, query_state.partitions.size());
       self->send(*worker, query_state.expression, std::move(actors), client);
       // Cleanup if we exhausted all candidates.
-      if (query_state.partitions.empty())
+      if (query_state.partitions.empty()) {
         self->state.pending.erase(iter);
+        self->state.complete_deferred_replacements();
+      }
       return {};
     },
     [self](atom::erase, uuid partition_id) -> caf::result<ids> {
@@ -782,6 +1022,15 @@ index(index_actor::stateful_pointer<index_state> self,
       }
       self->state.inmem_partitions.drop(partition_id);
       self->state.persisted_partitions.erase(partition_id);
+      if (self->state.result_cache)
+        self->state.result_cache->erase(partition_id);
+      auto& pending = self->state.pending_synopses;
+      pending.erase(std::remove(pending.begin(), pending.end(), partition_id),
+                    pending.end());
+      auto& unreadable = self->state.unreadable_synopses;
+      unreadable.erase(
+        std::remove(unreadable.begin(), unreadable.end(), partition_id),
+        unreadable.end());
       self->request(self->state.filesystem, caf::infinite, atom::mmap_v, path)
         .then(
           [=](chunk_ptr chunk) mutable {
@@ -823,6 +1072,96 @@ index(index_actor::stateful_pointer<index_state> self,
           [=](caf::error e) mutable { rp.deliver(e); });
       return rp;
     },
+    [self](atom::list) -> std::vector<uuid> {
+      auto& xs = self->state.persisted_partitions;
+      return {xs.begin(), xs.end()};
+    },
+    [self](atom::estimate, const expression& expr) -> caf::result<uint64_t> {
+      // Partitions that are not yet part of the META INDEX cannot contribute
+      // to the estimate.
+      if (!self->state.pending_synopses.empty())
+        VAST_WARN("{} estimates without {} partition synopses that are not "
+                  "yet loaded",
+                  self, self->state.pending_synopses.size());
+      return self->state.meta_idx.count_upper_bound(expr);
+    },
+    [self](atom::estimate, const expression& expr,
+           const std::string& field) -> caf::result<double> {
+      auto& meta_idx = self->state.meta_idx;
+      if (auto result = meta_idx.distinct_upper_bound(expr, field))
+        return *result;
+      return caf::make_error(ec::lookup_error,
+                             "no cardinality sketches for field", field);
+    },
+    [self](atom::replace, std::vector<uuid>& old_ids,
+           std::vector<table_slice>& slices) -> caf::result<atom::done> {
+      for (auto& id : old_ids)
+        if (!self->state.persisted_partitions.count(id))
+          return caf::make_error(ec::lookup_error, "cannot replace unknown "
+                                                   "partition",
+                                 to_string(id));
+      // The partitions may stem from interleaved ID ranges, but the new
+      // partition must receive its events in order.
+      std::sort(slices.begin(), slices.end(),
+                [](const table_slice& lhs, const table_slice& rhs) {
+                  return lhs.offset() < rhs.offset();
+                });
+      auto rows = size_t{0};
+      for (auto& slice : slices)
+        rows += slice.rows();
+      auto id = uuid::random();
+      VAST_VERBOSE("{} replaces {} partitions with partition {} holding {} "
+                   "events",
+                   self, old_ids.size(), id, rows);
+      auto part = self->state.spawn_active_partition(id, rows);
+      detail::spawn_container_source(self->system(), std::move(slices), part);
+      auto rp = self->make_response_promise<atom::done>();
+      auto part_path = self->state.partition_path(id);
+      auto synopsis_path = self->state.partition_synopsis_path(id);
+      self
+        ->request(part, caf::infinite, atom::persist_v, part_path,
+                  self->state.synopsisdir)
+        .then(
+          [=, old_ids = std::move(old_ids)](
+            std::shared_ptr<partition_synopsis>& ps) mutable {
+            VAST_ASSERT(ps.use_count() == 1);
+            // The clients of a pending query expect the number of partitions
+            // that the INDEX reported initially, so we must not swap
+            // partitions under them.
+            if (self->state.is_referenced_by_pending_query(old_ids)) {
+              VAST_DEBUG("{} defers replacing {} partitions until pending "
+                         "queries finish",
+                         self, old_ids.size());
+              self->state.deferred_replacements.push_back(
+                {std::move(old_ids), id, std::move(*ps), rp});
+              return;
+            }
+            if (auto err = self->state.replace_partitions(old_ids, id,
+                                                          std::move(*ps))) {
+              rm(part_path);
+              rm(synopsis_path);
+              rp.deliver(err);
+              return;
+            }
+            rp.deliver(atom::done_v);
+          },
+          [=](caf::error& err) mutable {
+            rm(part_path);
+            rm(synopsis_path);
+            rp.deliver(std::move(err));
+          });
+      return rp;
+    },
+    [self](atom::internal, atom::load) {
+      self->state.load_pending_synopses(
+        defaults::system::lazy_synopsis_batch_size);
+      if (self->state.pending_synopses.empty()) {
+        VAST_VERBOSE("{} finished loading partition synopses", self);
+        return;
+      }
+      // Yield to other messages such as queries between two batches.
+      self->send(self, atom::internal_v, atom::load_v);
+    },
     // -- query_supervisor_master_actor ----------------------------------------
     [self](atom::worker, query_supervisor_actor worker) {
       if (!self->state.worker_available())
@@ -45,6 +45,10 @@ namespace {
 
 vast::chunk_ptr chunkify(const value_index_ptr& idx) {
   std::vector<char> buf;
+  // The serialized representation of a value index is roughly as large as
+  // its in-memory representation, so we can avoid most reallocations of the
+  // buffer while serializing.
+  buf.reserve(idx->memusage());
   caf::binary_serializer sink{nullptr, buf};
   auto error = sink(idx);
   if (error)
@@ -52,6 +56,17 @@ vast::chunk_ptr chunkify(const value_index_ptr& idx) {
   return chunk::make(std::move(buf));
 }
 
+/// Looks up a predicate in a value index and intersects the result with the
+/// IDs that the EVALUATOR is interested in.
+caf::expected<ids> lookup(const value_index& idx, const curried_predicate& pred,
+                          const ids& restriction) {
+  auto rep = to_internal(idx.type(), make_view(pred.rhs));
+  auto result = idx.lookup(pred.op, rep);
+  if (result)
+    *result &= restriction;
+  return result;
+}
+
 } // namespace
 
 active_indexer_actor::behavior_type
@@ -110,6 +125,12 @@ active_indexer(active_indexer_actor::stateful_pointer<indexer_state> self,
       auto rep = to_internal(idx.type(), make_view(pred.rhs));
       return idx.lookup(pred.op, rep);
     },
+    [self](const curried_predicate& pred, const ids& restriction) {
+      VAST_DEBUG("{} got predicate {} restricted to {} ids", self, pred,
+                 rank(restriction));
+      VAST_ASSERT(self->state.idx);
+      return lookup(*self->state.idx, pred, restriction);
+    },
     [self](atom::snapshot) {
       // The partition is only allowed to send a single snapshot atom.
       VAST_ASSERT(!self->state.promise.pending());
@@ -155,6 +176,12 @@ passive_indexer(indexer_actor::stateful_pointer<indexer_state> self,
       auto rep = to_internal(idx.type(), make_view(pred.rhs));
       return idx.lookup(pred.op, rep);
     },
+    [self](const curried_predicate& pred, const ids& restriction) {
+      VAST_DEBUG("{} got predicate {} restricted to {} ids", self, pred,
+                 rank(restriction));
+      VAST_ASSERT(self->state.idx);
+      return lookup(*self->state.idx, pred, restriction);
+    },
     [self](atom::shutdown) { self->quit(caf::exit_reason::user_shutdown); },
   };
 }
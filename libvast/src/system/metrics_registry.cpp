@@ -0,0 +1,194 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/metrics_registry.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/bit.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace vast::system {
+
+namespace {
+
+/// @returns The stripe of the calling thread.
+size_t stripe_index() noexcept {
+  static std::atomic<size_t> next_index = 0;
+  thread_local auto index
+    = next_index.fetch_add(1, std::memory_order_relaxed)
+      % metrics_counter::num_stripes;
+  return index;
+}
+
+/// Replaces all characters that are invalid in Prometheus metric names.
+std::string sanitize(std::string_view prefix, std::string_view name) {
+  auto result = std::string{prefix};
+  if (!result.empty())
+    result += '_';
+  result += name;
+  for (auto& c : result)
+    if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_'))
+      c = '_';
+  return result;
+}
+
+template <class T>
+T& get_or_create(std::mutex& mutex,
+                 std::map<std::string, std::unique_ptr<T>, std::less<>>& xs,
+                 std::string_view name) {
+  std::lock_guard lock{mutex};
+  auto i = xs.find(name);
+  if (i == xs.end())
+    i = xs.emplace(std::string{name}, std::make_unique<T>()).first;
+  return *i->second;
+}
+
+} // namespace
+
+// -- metrics_counter ----------------------------------------------------------
+
+void metrics_counter::add(uint64_t n) noexcept {
+  stripes_[stripe_index()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t metrics_counter::value() const noexcept {
+  uint64_t result = 0;
+  for (auto& x : stripes_)
+    result += x.value.load(std::memory_order_relaxed);
+  return result;
+}
+
+// -- metrics_histogram --------------------------------------------------------
+
+size_t metrics_histogram::bucket(uint64_t x) noexcept {
+  if (x < sub_buckets)
+    return x;
+  auto msb = size_t{63} - detail::countl_zero(x);
+  auto shift = msb - sub_bucket_bits;
+  auto sub = (x >> shift) & (sub_buckets - 1);
+  return ((shift + 1) << sub_bucket_bits) + sub;
+}
+
+uint64_t metrics_histogram::upper_bound(size_t bucket) noexcept {
+  VAST_ASSERT(bucket < num_buckets);
+  if (bucket < sub_buckets)
+    return bucket;
+  auto shift = (bucket >> sub_bucket_bits) - 1;
+  auto sub = bucket & (sub_buckets - 1);
+  auto lower = (uint64_t{sub_buckets} + sub) << shift;
+  return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void metrics_histogram::record(uint64_t x) noexcept {
+  buckets_[bucket(x)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(x, std::memory_order_relaxed);
+  auto max = max_.load(std::memory_order_relaxed);
+  while (x > max
+         && !max_.compare_exchange_weak(max, x, std::memory_order_relaxed))
+    ; // nop
+}
+
+metrics_histogram::snapshot metrics_histogram::sample() const {
+  auto result = snapshot{};
+  result.buckets.resize(num_buckets);
+  // We derive the count from the buckets so that quantiles are consistent
+  // with the count even while other threads record values.
+  for (size_t i = 0; i < num_buckets; ++i) {
+    result.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    result.count += result.buckets[i];
+  }
+  result.sum = sum_.load(std::memory_order_relaxed);
+  result.max = max_.load(std::memory_order_relaxed);
+  return result;
+}
+
+uint64_t metrics_histogram::snapshot::quantile(double q) const {
+  VAST_ASSERT(q >= 0.0 && q <= 1.0);
+  if (count == 0)
+    return 0;
+  auto rank = std::max(uint64_t{1}, static_cast<uint64_t>(std::ceil(
+                                      q * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank)
+      return std::min(upper_bound(i), max);
+  }
+  return max;
+}
+
+// -- metrics_registry ---------------------------------------------------------
+
+metrics_registry& metrics_registry::instance() {
+  static metrics_registry registry;
+  return registry;
+}
+
+metrics_counter& metrics_registry::counter(std::string_view name) {
+  return get_or_create(mutex_, counters_, name);
+}
+
+metrics_gauge& metrics_registry::gauge(std::string_view name) {
+  return get_or_create(mutex_, gauges_, name);
+}
+
+metrics_histogram& metrics_registry::histogram(std::string_view name) {
+  return get_or_create(mutex_, histograms_, name);
+}
+
+metrics_snapshot metrics_registry::sample() const {
+  auto result = metrics_snapshot{};
+  std::lock_guard lock{mutex_};
+  result.counters.reserve(counters_.size());
+  for (auto& [name, x] : counters_)
+    result.counters.emplace_back(name, x->value());
+  result.gauges.reserve(gauges_.size());
+  for (auto& [name, x] : gauges_)
+    result.gauges.emplace_back(name, x->value());
+  result.histograms.reserve(histograms_.size());
+  for (auto& [name, x] : histograms_)
+    result.histograms.emplace_back(name, x->sample());
+  return result;
+}
+
+std::string to_prometheus(const metrics_snapshot& snapshot,
+                          std::string_view prefix) {
+  auto result = std::string{};
+  for (auto& [name, value] : snapshot.counters) {
+    auto key = sanitize(prefix, name);
+    result += "# TYPE " + key + " counter\n";
+    result += key + ' ' + std::to_string(value) + '\n';
+  }
+  for (auto& [name, value] : snapshot.gauges) {
+    auto key = sanitize(prefix, name);
+    result += "# TYPE " + key + " gauge\n";
+    result += key + ' ' + std::to_string(value) + '\n';
+  }
+  for (auto& [name, histogram] : snapshot.histograms) {
+    auto key = sanitize(prefix, name);
+    result += "# TYPE " + key + " summary\n";
+    for (auto q : {"0.5", "0.9", "0.99"}) {
+      auto value = histogram.quantile(std::stod(q));
+      result += key + "{quantile=\"" + q + "\"} " + std::to_string(value)
+                + '\n';
+    }
+    result += key + "_sum " + std::to_string(histogram.sum) + '\n';
+    result += key + "_count " + std::to_string(histogram.count) + '\n';
+  }
+  return result;
+}
+
+} // namespace vast::system
@@ -38,10 +38,13 @@
 #include "vast/logger.hpp"
 #include "vast/system/accountant.hpp"
 #include "vast/system/node.hpp"
+#include "vast/system/pooled_filesystem.hpp"
 #include "vast/system/posix_filesystem.hpp"
 #include "vast/system/shutdown.hpp"
+#include "vast/system/spawn_aggregator.hpp"
 #include "vast/system/spawn_archive.hpp"
 #include "vast/system/spawn_arguments.hpp"
+#include "vast/system/spawn_compactor.hpp"
 #include "vast/system/spawn_counter.hpp"
 #include "vast/system/spawn_disk_monitor.hpp"
 #include "vast/system/spawn_eraser.hpp"
@@ -53,6 +56,7 @@
 #include "vast/system/spawn_or_connect_to_node.hpp"
 #include "vast/system/spawn_pivoter.hpp"
 #include "vast/system/spawn_sink.hpp"
+#include "vast/system/spawn_slice_receiver.hpp"
 #include "vast/system/spawn_source.hpp"
 #include "vast/system/spawn_type_registry.hpp"
 #include "vast/system/terminate.hpp"
@@ -97,13 +101,19 @@ bool is_singleton(std::string_view type) {
   // change the node to work with type IDs over actor names everywhere. This
   // refactoring will be much easier once the NODE itself is a typed actor, so
   // let's hold off until then.
-  const char* singletons[]
-    = {"accountant", "archive", "eraser",       "filesystem",
-       "importer",   "index",   "type-registry"};
+  const char* singletons[] = {"accountant", "archive", "eraser",
+                              "filesystem", "index",   "type-registry"};
   auto pred = [&](const char* x) { return x == type; };
   return std::any_of(std::begin(singletons), std::end(singletons), pred);
 }
 
+/// Helper function to determine whether the first instance of a component
+/// that can be spawned multiple times is labeled by its type, such that other
+/// components find it without knowing its label.
+bool has_primary_instance(std::string_view type) {
+  return type == "importer";
+}
+
 // Sends an atom to a registered actor. Blocks until the actor responds.
 caf::message send_command(const invocation& inv, caf::actor_system&) {
   auto first = inv.arguments.begin();
@@ -347,9 +357,11 @@ node_state::component_factory_fun lift_component_factory() {
 auto make_component_factory() {
   return node_state::named_component_factory {
     {"spawn accountant", lift_component_factory<spawn_accountant>()},
+      {"spawn aggregator", lift_component_factory<spawn_aggregator>()},
       {"spawn archive", lift_component_factory<spawn_archive>()},
       {"spawn counter", lift_component_factory<spawn_counter>()},
       {"spawn disk_monitor", lift_component_factory<spawn_disk_monitor>()},
+      {"spawn compactor", lift_component_factory<spawn_compactor>()},
       {"spawn eraser", lift_component_factory<spawn_eraser>()},
       {"spawn exporter", lift_component_factory<spawn_exporter>()},
       {"spawn explorer", lift_component_factory<spawn_explorer>()},
@@ -357,6 +369,7 @@ auto make_component_factory() {
       {"spawn type-registry", lift_component_factory<spawn_type_registry>()},
       {"spawn index", lift_component_factory<spawn_index>()},
       {"spawn pivoter", lift_component_factory<spawn_pivoter>()},
+      {"spawn slice-receiver", lift_component_factory<spawn_slice_receiver>()},
       {"spawn source csv",
        lift_component_factory<spawn_source<format::csv::reader>>()},
       {"spawn source json",
@@ -396,9 +409,11 @@ auto make_command_factory() {
     {"kill", kill_command},
     {"send", send_command},
     {"spawn accountant", node_state::spawn_command},
+    {"spawn aggregator", node_state::spawn_command},
     {"spawn archive", node_state::spawn_command},
     {"spawn counter", node_state::spawn_command},
     {"spawn disk_monitor", node_state::spawn_command},
+    {"spawn compactor", node_state::spawn_command},
     {"spawn eraser", node_state::spawn_command},
     {"spawn explorer", node_state::spawn_command},
     {"spawn exporter", node_state::spawn_command},
@@ -406,6 +421,7 @@ auto make_command_factory() {
     {"spawn type-registry", node_state::spawn_command},
     {"spawn index", node_state::spawn_command},
     {"spawn pivoter", node_state::spawn_command},
+    {"spawn slice-receiver", node_state::spawn_command},
     {"spawn sink ascii", node_state::spawn_command},
     {"spawn sink csv", node_state::spawn_command},
     {"spawn sink json", node_state::spawn_command},
@@ -454,7 +470,9 @@ node_state::spawn_command(const invocation& inv,
     }
   } else {
     label = comp_type;
-    if (!is_singleton(comp_type)) {
+    auto primary = has_primary_instance(comp_type)
+                   && !self->state.registry.find_by_label(label);
+    if (!is_singleton(comp_type) && !primary) {
       label = generate_label(self, comp_type);
       VAST_DEBUG("{} auto-generated new label: {}", self, label);
     }
@@ -495,7 +513,8 @@ node_state::spawn_command(const invocation& inv,
   };
   // Retrieve taxonomies and delay spawning until the response arrives if we're
   // dealing with a query...
-  auto query_handlers = std::set<std::string>{"counter", "exporter"};
+  auto query_handlers = std::set<std::string>{"aggregator", "counter",
+                                               "exporter"};
   if (query_handlers.count(comp_type) > 0u
       && !caf::get_or(spawn_inv.options,
                       "vast." + comp_type + ".disable-taxonomies", false)) {
@@ -523,15 +542,19 @@ node_state::spawn_command(const invocation& inv,
 
 node_actor::behavior_type
 node(node_actor::stateful_pointer<node_state> self, std::string name, path dir,
-     std::chrono::milliseconds shutdown_grace_period) {
+     std::chrono::milliseconds shutdown_grace_period,
+     size_t filesystem_workers) {
   self->state.name = std::move(name);
   self->state.dir = std::move(dir);
   // Initialize component and command factories.
   node_state::component_factory = make_component_factory();
   node_state::command_factory = make_command_factory();
   // Initialize the file system with the node directory as root.
-  auto fs = self->spawn<caf::linked + caf::detached>(posix_filesystem,
-                                                     self->state.dir);
+  auto fs = filesystem_workers > 0
+              ? self->spawn<caf::linked>(pooled_filesystem, self->state.dir,
+                                         filesystem_workers)
+              : self->spawn<caf::linked + caf::detached>(posix_filesystem,
+                                                         self->state.dir);
   self->state.registry.add(caf::actor_cast<caf::actor>(fs), "filesystem");
   // Remove monitored components.
   self->set_down_handler([=](const caf::down_msg& msg) {
@@ -540,9 +563,10 @@ node(node_actor::stateful_pointer<node_state> self, std::string name, path dir,
     auto type = self->state.registry.find_type_for(component);
     // All monitored components are in the registry.
     VAST_ASSERT(type != nullptr);
-    if (is_singleton(*type)) {
-      auto label = self->state.registry.find_label_for(component);
-      VAST_ASSERT(label != nullptr); // Per the above assertion.
+    auto label = self->state.registry.find_label_for(component);
+    VAST_ASSERT(label != nullptr); // Per the above assertion.
+    if (is_singleton(*type)
+        || (has_primary_instance(*type) && *label == *type)) {
       VAST_ERROR("{} got DOWN from {} ; initiating shutdown", self, *label);
       self->send_exit(self, caf::exit_reason::user_shutdown);
     }
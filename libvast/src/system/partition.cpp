@@ -19,6 +19,7 @@
 #include "vast/aliases.hpp"
 #include "vast/chunk.hpp"
 #include "vast/concept/hashable/xxhash.hpp"
+#include "vast/concept/printable/std/chrono.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
 #include "vast/concept/printable/vast/table_slice.hpp"
@@ -34,7 +35,9 @@
 #include "vast/logger.hpp"
 #include "vast/qualified_record_field.hpp"
 #include "vast/synopsis.hpp"
+#include "vast/system/evaluation_planner.hpp"
 #include "vast/system/indexer.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/system/terminate.hpp"
@@ -169,6 +172,11 @@ fetch_indexer(const PartitionState& state, const attribute_extractor& ex,
   return state.self->spawn([row_ids]() -> indexer_actor::behavior_type {
     return {
       [=](const curried_predicate&) { return row_ids; },
+      [=](const curried_predicate&, const ids& restriction) {
+        auto result = row_ids;
+        result &= restriction;
+        return result;
+      },
       [](atom::shutdown) {
         VAST_DEBUG("one-shot indexer received shutdown request");
       },
@@ -213,6 +221,119 @@ evaluate(const PartitionState& state, const expression& expr) {
   return result;
 }
 
+/// Scales the estimated cost of a lookup in the INDEXER at a position.
+double lookup_scale(const active_partition_state&, size_t) {
+  // The ACTIVE INDEXERs hold their value indexes, so we weigh all lookups
+  // equally.
+  return 1.0;
+}
+
+/// Scales the estimated cost of a lookup in the INDEXER at a position.
+double lookup_scale(const passive_partition_state& state, size_t position) {
+  // The size of the serialized value index per event approximates how much
+  // work a lookup takes.
+  auto bytes
+    = state.flatbuffer->indexes()->Get(position)->index()->data()->size();
+  return static_cast<double>(bytes) / std::max(state.events, size_t{1});
+}
+
+/// Checks whether the synopsis of the column at a position rules out hits for
+/// a predicate.
+caf::optional<bool>
+synopsis_lookup(const active_partition_state& state, size_t position,
+                relational_operator op, const data& x) {
+  if (!state.synopsis)
+    return caf::none;
+  const auto& field = as_vector(state.indexers)[position].first;
+  const auto& synopses = state.synopsis->field_synopses_;
+  if (auto i = synopses.find(field); i != synopses.end() && i->second)
+    return i->second->lookup(op, make_view(x));
+  return caf::none;
+}
+
+/// Checks whether the synopsis of the column at a position rules out hits for
+/// a predicate.
+caf::optional<bool>
+synopsis_lookup(const passive_partition_state&, size_t, relational_operator,
+                const data&) {
+  // The META INDEX selected this partition based on its synopsis already, and
+  // the PASSIVE PARTITION does not keep the synopsis in memory.
+  return caf::none;
+}
+
+/// Estimates the lookup of a predicate in a partition.
+/// @relates active_partition_state
+/// @relates passive_partition_state
+template <typename PartitionState>
+lookup_estimate estimate(const PartitionState& state, const type& layout,
+                         const predicate& pred) {
+  // A predicate that does not resolve against the layout has no hits.
+  auto result = lookup_estimate{0.0, 0.0};
+  auto events = static_cast<double>(std::max(state.events, size_t{1}));
+  auto v = detail::overload{
+    [&](const attribute_extractor& ex, const data& x) {
+      // Meta queries do not require a lookup in an INDEXER.
+      auto estimate = lookup_estimate{0.0, 1.0};
+      if (ex.attr == atom::type_v) {
+        size_t hits = 0;
+        for (auto& [name, ids] : state.type_ids)
+          if (evaluate(name, pred.op, x))
+            hits += rank(ids);
+        estimate.selectivity = std::min(1.0, hits / events);
+      }
+      return estimate;
+    },
+    [&](const data_extractor& dx, const data& x) {
+      auto index = state.combined_layout.flat_index_at(dx.offset);
+      if (!index)
+        return lookup_estimate{0.0, 0.0};
+      auto estimate = estimate_lookup(dx.type, pred.op, x);
+      estimate.cost *= lookup_scale(state, *index);
+      if (auto may_match = synopsis_lookup(state, *index, pred.op, x);
+          may_match && !*may_match)
+        estimate.selectivity = 0.0;
+      return estimate;
+    },
+    [](const auto&, const auto&) {
+      return lookup_estimate{0.0, 0.0};
+    },
+  };
+  for (auto& [_, x] : resolve(expression{pred}, layout)) {
+    auto estimate = caf::visit(v, x.lhs, x.rhs);
+    // The hits of a predicate are the union of the hits of all columns it
+    // resolves to.
+    result.cost += estimate.cost;
+    result.selectivity += estimate.selectivity
+                          - result.selectivity * estimate.selectivity;
+  }
+  return result;
+}
+
+/// Orders the operands of the conjunctions in an expression by their
+/// estimated cost in the partition.
+/// @relates active_partition_state
+/// @relates passive_partition_state
+template <typename PartitionState>
+expression plan(const PartitionState& state, const expression& expr) {
+  auto layout = type{state.combined_layout};
+  return order_by_cost(expr, [&](const predicate& pred) {
+    return estimate(state, layout, pred);
+  });
+}
+
+/// Estimates the size of the partition FlatBuffer, such that the builder can
+/// allocate its buffer once instead of growing and copying it repeatedly.
+size_t estimate_packed_size(const active_partition_state& x) {
+  // The serialized value indexes dominate the size of a partition. The
+  // remaining fields grow with the number of indexers and layouts.
+  constexpr size_t overhead_per_indexer = 1024;
+  constexpr size_t overhead = 64 * 1024;
+  auto result = overhead;
+  for (auto& [_, chunk] : x.chunks)
+    result += chunk->size() + overhead_per_indexer;
+  return result;
+}
+
 } // namespace
 
 bool partition_selector::operator()(const qualified_record_field& filter,
@@ -363,15 +484,18 @@ caf::error unpack(const fbs::partition::v0& x, partition_synopsis& ps) {
 active_partition_actor::behavior_type active_partition(
   active_partition_actor::stateful_pointer<active_partition_state> self,
   uuid id, filesystem_actor filesystem, caf::settings index_opts,
-  caf::settings synopsis_opts) {
+  caf::settings synopsis_opts, accountant_actor accountant) {
   self->state.self = self;
   self->state.name = "partition-" + to_string(id);
   self->state.id = id;
   self->state.offset = invalid_id;
   self->state.events = 0;
   self->state.filesystem = std::move(filesystem);
+  self->state.accountant = std::move(accountant);
   self->state.streaming_initiated = false;
   self->state.synopsis = std::make_shared<partition_synopsis>();
+  self->state.synopsis->native_bloom_filters_
+    = caf::get_or(synopsis_opts, "native-bloom-filters", false);
   self->state.synopsis_opts = std::move(synopsis_opts);
   put(self->state.synopsis_opts, "buffer-input-data", true);
   // The active partition stage is a caf stream stage that takes
@@ -389,9 +513,30 @@ active_partition_actor::behavior_type active_partition(
       static_assert(invalid_id == std::numeric_limits<vast::id>::max());
       auto first = x.offset();
       auto last = x.offset() + x.rows();
-      auto layout = flatten(x.layout());
-      auto it = self->state.type_ids.emplace(layout.name(), ids{}).first;
-      auto& ids = it->second;
+      const auto& interned = x.interned();
+      auto* layout = self->state.layouts.find(interned.id);
+      if (!layout) {
+        const auto& flat_layout = interned.flat_layout;
+        VAST_ASSERT(!flat_layout.fields.empty());
+        auto it = self->state.type_ids.emplace(flat_layout.name(), ids{}).first;
+        auto fields = std::vector<qualified_record_field>{};
+        fields.reserve(flat_layout.fields.size());
+        for (auto& field : flat_layout.fields) {
+          auto& qf = fields.emplace_back(flat_layout.name(), field);
+          auto& idx = self->state.indexers[qf];
+          if (!idx) {
+            self->state.combined_layout.fields.push_back(as_record_field(qf));
+            idx = self->spawn(active_indexer, field.type, index_opts);
+            auto slot = self->state.stage->add_outbound_path(idx);
+            self->state.stage->out().set_filter(slot, qf);
+            VAST_DEBUG("{} spawned new indexer for field {} at slot {}", self,
+                       field.name, slot);
+          }
+        }
+        layout = &self->state.layouts.insert(
+          interned.id, {&it->second, std::move(fields)});
+      }
+      auto& ids = *layout->type_ids;
       VAST_ASSERT(first >= ids.size());
       // Mark the ids of this table slice for the current type.
       ids.append_bits(false, first - ids.size());
@@ -400,20 +545,8 @@ active_partition_actor::behavior_type active_partition(
       self->state.events += x.rows();
       self->state.synopsis->add(x, self->state.synopsis_opts);
       size_t col = 0;
-      VAST_ASSERT(!layout.fields.empty());
-      for (auto& field : layout.fields) {
-        auto qf = qualified_record_field{layout.name(), field};
-        auto& idx = self->state.indexers[qf];
-        if (!idx) {
-          self->state.combined_layout.fields.push_back(as_record_field(qf));
-          idx = self->spawn(active_indexer, field.type, index_opts);
-          auto slot = self->state.stage->add_outbound_path(idx);
-          self->state.stage->out().set_filter(slot, qf);
-          VAST_DEBUG("{} spawned new indexer for field {} at slot {}", self,
-                     field.name, slot);
-        }
+      for (const auto& qf : layout->fields)
         out.push(table_slice_column{x, col++, qf});
-      }
     },
     [=](caf::unit_t&, const caf::error& err) {
       // We get an 'unreachable' error when the stream becomes unreachable
@@ -494,6 +627,7 @@ active_partition_actor::behavior_type active_partition(
       self->state.persist_path = part_dir;
       self->state.synopsis_path = synopsis_dir;
       self->state.persisted_indexers = 0;
+      self->state.persist_start = stopwatch::now();
       self->state.persistence_promise
         = self->make_response_promise<std::shared_ptr<partition_synopsis>>();
       // We use a high message priority here because we want to start persisting
@@ -552,7 +686,8 @@ active_partition_actor::behavior_type active_partition(
               // Shrink synopses for addr fields to optimal size.
               self->state.synopsis->shrink();
               // Create the partition flatbuffer.
-              flatbuffers::FlatBufferBuilder builder;
+              flatbuffers::FlatBufferBuilder builder{
+                estimate_packed_size(self->state)};
               auto partition = pack(builder, self->state);
               if (!partition) {
                 VAST_ERROR("{} failed to serialize {} with error: {}", self,
@@ -560,6 +695,9 @@ active_partition_actor::behavior_type active_partition(
                 self->state.persistence_promise.deliver(partition.error());
                 return;
               }
+              // The builder holds a copy of all serialized indexers now, so
+              // we release them early to reduce the peak memory usage.
+              self->state.chunks.clear();
               VAST_ASSERT(self->state.persist_path);
               VAST_ASSERT(self->state.synopsis_path);
               // Note that this is a performance optimization: We used to store
@@ -602,6 +740,18 @@ active_partition_actor::behavior_type active_partition(
                           *self->state.persist_path, fbchunk)
                 .then(
                   [=](atom::ok) {
+                    auto elapsed = std::chrono::duration_cast<duration>(
+                      stopwatch::now() - self->state.persist_start);
+                    VAST_VERBOSE("{} persisted {} events in {} bytes after {}",
+                                 self, self->state.events, fbchunk->size(),
+                                 to_string(elapsed));
+                    if (self->state.accountant) {
+                      self->send(self->state.accountant,
+                                 "index.partition.persist.latency", elapsed);
+                      self->send(self->state.accountant,
+                                 "index.partition.persist.bytes",
+                                 count{fbchunk->size()});
+                    }
                     // Relinquish ownership and send the shrunken synopsis to
                     // the index.
                     self->state.persistence_promise.deliver(
@@ -626,10 +776,12 @@ active_partition_actor::behavior_type active_partition(
            partition_client_actor client) -> caf::result<atom::done> {
       // TODO: We should do a candidate check using `self->state.synopsis` and
       // return early if that doesn't yield any results.
-      auto triples = evaluate(self->state, expr);
+      auto planned = plan(self->state, expr);
+      auto triples = evaluate(self->state, planned);
       if (triples.empty())
         return atom::done_v;
-      auto eval = self->spawn(evaluator, expr, triples);
+      auto eval = self->spawn(evaluator, std::move(planned), triples,
+                              evaluator_callback{});
       return self->delegate(eval, client);
     },
     [self](atom::status,
@@ -687,8 +839,10 @@ active_partition_actor::behavior_type active_partition(
 
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
-  filesystem_actor filesystem, class path path) {
+  filesystem_actor filesystem, class path path,
+  std::shared_ptr<query_result_cache> result_cache) {
   self->state.self = self;
+  self->state.result_cache = std::move(result_cache);
   self->set_exit_handler([=](const caf::exit_msg& msg) {
     VAST_DEBUG("{} received EXIT from {} with reason: {}", self, msg.source,
                msg.reason);
@@ -723,6 +877,7 @@ partition_actor::behavior_type passive_partition(
   // We send a "read" to the fs actor and upon receiving the result deserialize
   // the flatbuffer and switch to the "normal" partition behavior for responding
   // to queries.
+  self->state.load_start = stopwatch::now();
   self->request(filesystem, caf::infinite, atom::mmap_v, path)
     .then(
       [=](chunk_ptr chunk) {
@@ -769,10 +924,15 @@ partition_actor::behavior_type passive_partition(
         // Delegate all deferred evaluations now that we have the partition chunk.
         VAST_DEBUG("{} delegates {} deferred evaluations", self,
                    self->state.deferred_evaluations.size());
+        auto load_time = stopwatch::now() - self->state.load_start;
         for (auto&& [expr, client, rp] :
-             std::exchange(self->state.deferred_evaluations, {}))
+             std::exchange(self->state.deferred_evaluations, {})) {
+          auto trace = query_trace{};
+          trace.record(query_stage::partition_load, load_time);
+          self->send(client, atom::trace_v, std::move(trace));
           rp.delegate(static_cast<partition_actor>(self), std::move(expr),
                       client);
+        }
       },
       [=](caf::error err) {
         VAST_ERROR("{} failed to load partition: {}", self, render(err));
@@ -797,10 +957,22 @@ partition_actor::behavior_type passive_partition(
       // We can safely assert that if we have the partition chunk already, all
       // deferred evaluations were taken care of.
       VAST_ASSERT(self->state.deferred_evaluations.empty());
-      auto triples = evaluate(self->state, expr);
-      if (triples.empty())
+      auto planned = plan(self->state, expr);
+      auto triples = evaluate(self->state, planned);
+      auto& cache = self->state.result_cache;
+      if (triples.empty()) {
+        if (cache)
+          cache->insert(query_result_cache::key(expr), self->state.id, ids{});
         return atom::done_v;
-      auto eval = self->spawn(evaluator, expr, triples);
+      }
+      auto on_complete = evaluator_callback{};
+      if (cache)
+        on_complete = [cache, key = query_result_cache::key(expr),
+                       id = self->state.id](const ids& hits) {
+          cache->insert(key, id, hits);
+        };
+      auto eval = self->spawn(evaluator, std::move(planned), triples,
+                              std::move(on_complete));
       return self->delegate(eval, client);
     },
     [self](atom::status,
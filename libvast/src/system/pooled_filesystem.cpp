@@ -0,0 +1,162 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/pooled_filesystem.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/system/posix_filesystem.hpp"
+#include "vast/system/status_verbosity.hpp"
+
+#include <caf/config_value.hpp>
+#include <caf/dictionary.hpp>
+#include <caf/result.hpp>
+#include <caf/settings.hpp>
+
+#include <algorithm>
+
+namespace vast::system {
+
+namespace {
+
+/// Records the outcome of an operation.
+void record(filesystem_statistics::ops& ops, stopwatch::time_point start,
+            size_t bytes, bool success) {
+  ops.latency.add(stopwatch::now() - start);
+  if (success) {
+    ++ops.successful;
+    ops.bytes += bytes;
+  } else {
+    ++ops.failed;
+  }
+}
+
+} // namespace
+
+filesystem_actor::behavior_type pooled_filesystem(
+  filesystem_actor::stateful_pointer<pooled_filesystem_state> self, path root,
+  size_t num_readers) {
+  VAST_ASSERT(num_readers > 0);
+  auto spawn_worker = [&] {
+    return pooled_filesystem_state::worker{
+      self->spawn<caf::linked + caf::detached>(posix_filesystem, root)};
+  };
+  for (size_t i = 0; i < num_readers; ++i)
+    self->state.readers.push_back(spawn_worker());
+  self->state.writer = spawn_worker();
+  // Picks the reader with the fewest pending requests.
+  auto next_reader = [self] {
+    auto& readers = self->state.readers;
+    auto i = std::min_element(readers.begin(), readers.end(),
+                              [](const auto& lhs, const auto& rhs) {
+                                return lhs.pending < rhs.pending;
+                              });
+    return static_cast<size_t>(std::distance(readers.begin(), i));
+  };
+  return {
+    [self](atom::write, path& filename,
+           chunk_ptr& chk) -> caf::result<atom::ok> {
+      VAST_ASSERT(chk != nullptr);
+      auto rp = self->make_response_promise<atom::ok>();
+      auto start = stopwatch::now();
+      auto bytes = chk->size();
+      ++self->state.writer.pending;
+      self
+        ->request(self->state.writer.handle, caf::infinite, atom::write_v,
+                  std::move(filename), std::move(chk))
+        .then(
+          [=](atom::ok) mutable {
+            --self->state.writer.pending;
+            record(self->state.stats.writes, start, bytes, true);
+            rp.deliver(atom::ok_v);
+          },
+          [=](caf::error& err) mutable {
+            --self->state.writer.pending;
+            record(self->state.stats.writes, start, 0, false);
+            rp.deliver(std::move(err));
+          });
+      return rp;
+    },
+    [self, next_reader](atom::read,
+                        path& filename) -> caf::result<chunk_ptr> {
+      auto rp = self->make_response_promise<chunk_ptr>();
+      auto start = stopwatch::now();
+      auto i = next_reader();
+      ++self->state.readers[i].pending;
+      self
+        ->request(self->state.readers[i].handle, caf::infinite, atom::read_v,
+                  std::move(filename))
+        .then(
+          [=](chunk_ptr& chk) mutable {
+            --self->state.readers[i].pending;
+            record(self->state.stats.reads, start, chk ? chk->size() : 0,
+                   true);
+            rp.deliver(std::move(chk));
+          },
+          [=](caf::error& err) mutable {
+            --self->state.readers[i].pending;
+            record(self->state.stats.reads, start, 0, false);
+            rp.deliver(std::move(err));
+          });
+      return rp;
+    },
+    [self, next_reader](atom::mmap,
+                        path& filename) -> caf::result<chunk_ptr> {
+      auto rp = self->make_response_promise<chunk_ptr>();
+      auto start = stopwatch::now();
+      auto i = next_reader();
+      ++self->state.readers[i].pending;
+      self
+        ->request(self->state.readers[i].handle, caf::infinite, atom::mmap_v,
+                  std::move(filename))
+        .then(
+          [=](chunk_ptr& chk) mutable {
+            --self->state.readers[i].pending;
+            // The POSIX filesystem signals failed memory mappings with a
+            // null chunk.
+            record(self->state.stats.mmaps, start, chk ? chk->size() : 0,
+                   chk != nullptr);
+            rp.deliver(std::move(chk));
+          },
+          [=](caf::error& err) mutable {
+            --self->state.readers[i].pending;
+            record(self->state.stats.mmaps, start, 0, false);
+            rp.deliver(std::move(err));
+          });
+      return rp;
+    },
+    [self](atom::status, status_verbosity v) {
+      auto result = caf::settings{};
+      if (v >= status_verbosity::info) {
+        caf::put(result, "filesystem.type", "POSIX");
+        caf::put(result, "filesystem.workers",
+                 self->state.readers.size() + 1);
+      }
+      if (v >= status_verbosity::debug) {
+        fill_status_map(put_dictionary(result, "filesystem.operations"),
+                        self->state.stats);
+        size_t pending_reads = 0;
+        for (auto& reader : self->state.readers)
+          pending_reads += reader.pending;
+        caf::put(result, "filesystem.pending-reads", pending_reads);
+        caf::put(result, "filesystem.pending-writes",
+                 self->state.writer.pending);
+      }
+      return result;
+    },
+  };
+}
+
+} // namespace vast::system
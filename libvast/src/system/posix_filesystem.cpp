@@ -17,6 +17,7 @@
 #include "vast/detail/assert.hpp"
 #include "vast/io/read.hpp"
 #include "vast/io/save.hpp"
+#include "vast/system/instrumentation.hpp"
 #include "vast/system/status_verbosity.hpp"
 
 #include <caf/config_value.hpp>
@@ -33,23 +34,29 @@ filesystem_actor::behavior_type posix_filesystem(
     [self](atom::write, const path& filename,
            chunk_ptr chk) -> caf::result<atom::ok> {
       VAST_ASSERT(chk != nullptr);
+      auto start = stopwatch::now();
       auto path
         = filename.is_absolute() ? filename : self->state.root / filename;
-      if (auto err = io::save(path, as_bytes(chk))) {
+      auto err = io::save(path, as_bytes(chk));
+      self->state.stats.writes.latency.add(stopwatch::now() - start);
+      if (err) {
         ++self->state.stats.writes.failed;
         return err;
       } else {
         ++self->state.stats.writes.successful;
-        ++self->state.stats.writes.bytes += chk->size();
+        self->state.stats.writes.bytes += chk->size();
         return atom::ok_v;
       }
     },
     [self](atom::read, const path& filename) -> caf::result<chunk_ptr> {
+      auto start = stopwatch::now();
       auto path
         = filename.is_absolute() ? filename : self->state.root / filename;
-      if (auto bytes = io::read(path)) {
+      auto bytes = io::read(path);
+      self->state.stats.reads.latency.add(stopwatch::now() - start);
+      if (bytes) {
         ++self->state.stats.reads.successful;
-        ++self->state.stats.reads.bytes += bytes->size();
+        self->state.stats.reads.bytes += bytes->size();
         return chunk::make(std::move(*bytes));
       } else {
         ++self->state.stats.reads.failed;
@@ -57,11 +64,14 @@ filesystem_actor::behavior_type posix_filesystem(
       }
     },
     [self](atom::mmap, const path& filename) -> caf::result<chunk_ptr> {
+      auto start = stopwatch::now();
       auto path
         = filename.is_absolute() ? filename : self->state.root / filename;
-      if (auto chk = chunk::mmap(path)) {
+      auto chk = chunk::mmap(path);
+      self->state.stats.mmaps.latency.add(stopwatch::now() - start);
+      if (chk) {
         ++self->state.stats.mmaps.successful;
-        ++self->state.stats.mmaps.bytes += chk->size();
+        self->state.stats.mmaps.bytes += chk->size();
         return chk;
       } else {
         ++self->state.stats.mmaps.failed;
@@ -72,18 +82,9 @@ filesystem_actor::behavior_type posix_filesystem(
       auto result = caf::settings{};
       if (v >= status_verbosity::info)
         caf::put(result, "filesystem.type", "POSIX");
-      if (v >= status_verbosity::debug) {
-        auto& ops = put_dictionary(result, "filesystem.operations");
-        auto add_stats = [&](auto& name, auto& stats) {
-          auto& dict = put_dictionary(ops, name);
-          caf::put(dict, "successful", stats.successful);
-          caf::put(dict, "failed", stats.failed);
-          caf::put(dict, "bytes", stats.bytes);
-        };
-        add_stats("writes", self->state.stats.writes);
-        add_stats("reads", self->state.stats.reads);
-        add_stats("mmaps", self->state.stats.mmaps);
-      }
+      if (v >= status_verbosity::debug)
+        fill_status_map(put_dictionary(result, "filesystem.operations"),
+                        self->state.stats);
       return result;
     },
   };
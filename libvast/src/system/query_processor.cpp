@@ -18,6 +18,7 @@
 #include "vast/expression.hpp"
 #include "vast/ids.hpp"
 #include "vast/logger.hpp"
+#include "vast/system/query_trace.hpp"
 
 #include <caf/event_based_actor.hpp>
 #include <caf/skip.hpp>
@@ -37,6 +38,11 @@ query_processor::query_processor(caf::event_based_actor* self)
     // Our default init state simply waits for a query to execute.
     [=](expression& expr, const index_actor& index) {
       start(std::move(expr), index);
+    },
+    // The actors on the query path report their latencies to the client,
+    // which only the EXPORTER keeps track of.
+    [](atom::trace, const query_trace&) {
+      // nop
     });
   behaviors_[await_query_id].assign(
     // Received from the INDEX after sending the query when leaving `idle`.
@@ -46,6 +52,9 @@ query_processor::query_processor(caf::event_based_actor* self)
       partitions_.scheduled = scheduled;
       partitions_.total = total;
       transition_to(collect_hits);
+    },
+    [](atom::trace, const query_trace&) {
+      // nop
     });
   behaviors_[collect_hits].assign(
     // Received from EVALUATOR actors while generating query hits.
@@ -59,6 +68,9 @@ query_processor::query_processor(caf::event_based_actor* self)
       partitions_.received += partitions_.scheduled;
       process_end_of_hits();
       return caf::unit;
+    },
+    [](atom::trace, const query_trace&) {
+      // nop
     });
 }
 
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/query_result_cache.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/detail/assert.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace vast::system {
+
+query_result_cache::query_result_cache(size_t capacity) : capacity_{capacity} {
+  // nop
+}
+
+std::string query_result_cache::key(const expression& expr) {
+  return to_string(normalize(expr));
+}
+
+std::optional<ids> query_result_cache::lookup(const std::string& expr,
+                                              const uuid& partition) {
+  auto lock = std::lock_guard{mutex_};
+  auto key = entry_key{expr, partition};
+  if (entries_.find(key) == nullptr) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  auto [hits, inserted] = entries_.touch(key, [](const entry_key&) {
+    return ids{};
+  });
+  VAST_ASSERT(!inserted);
+  return hits;
+}
+
+void query_result_cache::insert(std::string expr, const uuid& partition,
+                                ids hits) {
+  auto lock = std::lock_guard{mutex_};
+  auto key = entry_key{std::move(expr), partition};
+  auto size = entry_size(key, hits);
+  if (size > capacity_)
+    return;
+  if (auto existing = entries_.find(key)) {
+    memory_usage_ -= entry_size(key, *existing);
+    entries_.erase(key);
+  } else {
+    keys_by_partition_[partition].push_back(key.expr);
+  }
+  entries_.touch(key, [&](const entry_key&) { return std::move(hits); });
+  memory_usage_ += size;
+  while (memory_usage_ > capacity_) {
+    auto oldest = entries_.oldest().first;
+    auto& keys = keys_by_partition_[oldest.partition];
+    keys.erase(std::find(keys.begin(), keys.end(), oldest.expr));
+    if (keys.empty())
+      keys_by_partition_.erase(oldest.partition);
+    erase_entry(oldest);
+  }
+}
+
+void query_result_cache::erase(const uuid& partition) {
+  auto lock = std::lock_guard{mutex_};
+  auto i = keys_by_partition_.find(partition);
+  if (i == keys_by_partition_.end())
+    return;
+  for (auto& expr : i->second)
+    erase_entry(entry_key{std::move(expr), partition});
+  keys_by_partition_.erase(i);
+}
+
+void query_result_cache::clear() {
+  auto lock = std::lock_guard{mutex_};
+  entries_.clear();
+  keys_by_partition_.clear();
+  memory_usage_ = 0;
+}
+
+query_result_cache::statistics query_result_cache::stats() const {
+  auto lock = std::lock_guard{mutex_};
+  return {hits_, misses_, entries_.size(), memory_usage_, capacity_};
+}
+
+size_t query_result_cache::entry_key_hash::operator()(
+  const entry_key& x) const noexcept {
+  auto seed = std::hash<std::string>{}(x.expr);
+  return seed ^ (std::hash<uuid>{}(x.partition) + 0x9e3779b9 + (seed << 6)
+                 + (seed >> 2));
+}
+
+void query_result_cache::erase_entry(const entry_key& key) {
+  auto hits = entries_.find(key);
+  if (hits == nullptr)
+    return;
+  memory_usage_ -= entry_size(key, *hits);
+  entries_.erase(key);
+}
+
+size_t query_result_cache::entry_size(const entry_key& key, const ids& hits) {
+  return sizeof(entry_key) + key.expr.size() + hits.memusage();
+}
+
+} // namespace vast::system
@@ -0,0 +1,106 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/query_trace.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/uuid.hpp"
+#include "vast/detail/assert.hpp"
+
+#include <caf/deep_to_string.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace vast::system {
+
+const char* query_stage_name(query_stage x) {
+  static constexpr const char* names[] = {
+    "meta-index-lookup", "partition-load",  "indexer-lookup",
+    "evaluator-combine", "archive-load",    "candidate-check",
+    "select",            "sink-write",
+  };
+  static_assert(std::size(names) == num_query_stages);
+  auto index = static_cast<size_t>(x);
+  VAST_ASSERT(index < num_query_stages);
+  return names[index];
+}
+
+report to_report(const query_trace& x, const std::string& prefix) {
+  auto result = report{};
+  for (size_t i = 0; i < std::min(x.stages.size(), num_query_stages); ++i) {
+    auto& stage = x.stages[i];
+    if (stage.count == 0)
+      continue;
+    auto key = prefix + '.' + query_stage_name(static_cast<query_stage>(i));
+    result.push_back({key + ".count", stage.count});
+    result.push_back({key + ".total", stage.total});
+    result.push_back({key + ".max", stage.max});
+  }
+  result.push_back({prefix + ".partition-cache-hits", x.partition_cache_hits});
+  result.push_back(
+    {prefix + ".partition-cache-misses", x.partition_cache_misses});
+  return result;
+}
+
+caf::settings to_status(const query_trace& x) {
+  auto result = caf::settings{};
+  caf::put(result, "id", to_string(x.id));
+  caf::put(result, "start", caf::deep_to_string(x.start));
+  auto& stages = caf::put_dictionary(result, "stages");
+  for (size_t i = 0; i < std::min(x.stages.size(), num_query_stages); ++i) {
+    auto& stage = x.stages[i];
+    if (stage.count == 0)
+      continue;
+    auto name = query_stage_name(static_cast<query_stage>(i));
+    auto& s = caf::put_dictionary(stages, name);
+    caf::put(s, "count", stage.count);
+    caf::put(s, "total", stage.total);
+    caf::put(s, "max", stage.max);
+  }
+  caf::put(result, "partition-cache-hits", x.partition_cache_hits);
+  caf::put(result, "partition-cache-misses", x.partition_cache_misses);
+  return result;
+}
+
+void query_trace::record(query_stage stage, duration elapsed) {
+  auto index = static_cast<size_t>(stage);
+  VAST_ASSERT(index < stages.size());
+  auto& stats = stages[index];
+  ++stats.count;
+  stats.total += elapsed;
+  stats.max = std::max(stats.max, elapsed);
+}
+
+void query_trace::record_partition(bool cache_hit) {
+  if (cache_hit)
+    ++partition_cache_hits;
+  else
+    ++partition_cache_misses;
+}
+
+void query_trace::merge(const query_trace& other) {
+  // A deserialized trace may have a different number of stages.
+  auto n = std::min(stages.size(), other.stages.size());
+  for (size_t i = 0; i < n; ++i) {
+    auto& stats = stages[i];
+    auto& other_stats = other.stages[i];
+    stats.count += other_stats.count;
+    stats.total += other_stats.total;
+    stats.max = std::max(stats.max, other_stats.max);
+  }
+  partition_cache_hits += other.partition_cache_hits;
+  partition_cache_misses += other.partition_cache_misses;
+}
+
+} // namespace vast::system
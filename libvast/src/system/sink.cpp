@@ -21,6 +21,7 @@
 #include "vast/format/writer.hpp"
 #include "vast/logger.hpp"
 #include "vast/system/instrumentation.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -86,6 +87,7 @@ caf::behavior sink(caf::stateful_actor<sink_state>* self,
       if (slice.rows() > remaining)
         slice = truncate(slice, remaining);
       // Handle events.
+      auto start = stopwatch::now();
       auto t = timer::start(self->state.measurement);
       if (auto err = self->state.writer->write(slice)) {
         VAST_ERROR("{} {}", self, render(err));
@@ -93,6 +95,13 @@ caf::behavior sink(caf::stateful_actor<sink_state>* self,
         return;
       }
       t.stop(slice.rows());
+      // Attribute the write latency to the trace of the sending EXPORTER.
+      if (auto sender = self->current_sender()) {
+        auto trace = query_trace{};
+        trace.record(query_stage::sink_write, stopwatch::now() - start);
+        self->send(caf::actor_cast<caf::actor>(sender), atom::trace_v,
+                   std::move(trace));
+      }
       // Stop when reaching configured limit.
       self->state.processed += slice.rows();
       if (self->state.processed >= self->state.max_events)
@@ -0,0 +1,433 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/slice_transport.hpp"
+
+#include "vast/config.hpp"
+
+#if VAST_LINUX
+#  ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#  endif // _GNU_SOURCE
+#endif   // VAST_LINUX
+
+#include "vast/chunk.hpp"
+#include "vast/command.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/error.hpp"
+#include "vast/concept/printable/vast/uuid.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/detail/scope_guard.hpp>
+#include <caf/downstream.hpp>
+#include <caf/event_based_actor.hpp>
+#include <caf/exit_reason.hpp>
+#include <caf/scoped_actor.hpp>
+#include <caf/settings.hpp>
+#include <caf/stateful_actor.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace vast::system {
+
+#if VAST_LINUX
+
+namespace {
+
+// Identifies a frame of the local transport.
+constexpr uint64_t frame_magic = 0x56415354534c4943; // "VASTSLIC"
+
+// Precedes every table slice on the socket, which carries the memory file
+// descriptor as ancillary data.
+struct frame {
+  uint64_t magic;
+  uint64_t size;
+};
+
+// The seals that guarantee that the client can no longer modify a table slice
+// after the node verified it.
+constexpr int required_seals
+  = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+
+// The maximum time to wait for the other end during connection setup.
+constexpr int handshake_timeout_ms = 10'000;
+
+caf::error make_system_error(const char* what) {
+  return caf::make_error(ec::system_error, what, std::strerror(errno));
+}
+
+::socklen_t make_address(::sockaddr_un& addr, const std::string& name) {
+  // Abstract socket addresses start with a NUL byte and leave no trace in the
+  // filesystem.
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  auto size = std::min(name.size(), sizeof(addr.sun_path) - 1);
+  std::memcpy(addr.sun_path + 1, name.data(), size);
+  return offsetof(::sockaddr_un, sun_path) + 1 + size;
+}
+
+bool wait_readable(int fd, int timeout_ms) {
+  ::pollfd pfd = {fd, POLLIN, 0};
+  int result;
+  while ((result = ::poll(&pfd, 1, timeout_ms)) < 0)
+    if (errno != EINTR)
+      return false;
+  return result > 0;
+}
+
+} // namespace
+
+#endif // VAST_LINUX
+
+caf::error send_slice(int socket, const table_slice& slice) {
+#if VAST_LINUX
+  auto bytes = as_bytes(slice);
+  if (bytes.empty())
+    return caf::make_error(ec::invalid_argument, "cannot send an empty table "
+                                                 "slice");
+  auto fd = ::memfd_create("vast-table-slice", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0)
+    return make_system_error("failed in memfd_create(2):");
+  auto close_fd = caf::detail::make_scope_guard([=] { ::close(fd); });
+  auto data = reinterpret_cast<const char*>(bytes.data());
+  size_t written = 0;
+  while (written < bytes.size()) {
+    auto n = ::write(fd, data + written, bytes.size() - written);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return make_system_error("failed to write table slice:");
+    }
+    written += static_cast<size_t>(n);
+  }
+  if (::fcntl(fd, F_ADD_SEALS, required_seals | F_SEAL_SEAL) != 0)
+    return make_system_error("failed to seal table slice:");
+  auto header = frame{frame_magic, bytes.size()};
+  ::iovec iov = {&header, sizeof(header)};
+  alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  ::msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  while (::sendmsg(socket, &msg, MSG_NOSIGNAL) < 0)
+    if (errno != EINTR)
+      return make_system_error("failed to send table slice:");
+  return caf::none;
+#else  // VAST_LINUX
+  (void)socket;
+  (void)slice;
+  return caf::make_error(ec::unimplemented, "local transport requires Linux");
+#endif // VAST_LINUX
+}
+
+caf::expected<table_slice> receive_slice(int socket) {
+#if VAST_LINUX
+  auto header = frame{};
+  ::iovec iov = {&header, sizeof(header)};
+  alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  ::msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  while ((n = ::recvmsg(socket, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC)) < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return ec::stalled;
+    if (errno != EINTR)
+      return make_system_error("failed to receive table slice:");
+  }
+  if (n == 0)
+    return caf::make_error(ec::end_of_input, "client closed the connection");
+  auto fd = -1;
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg))
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+        && cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+      std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  auto close_fd = caf::detail::make_scope_guard([=] {
+    if (fd >= 0)
+      ::close(fd);
+  });
+  if (n != sizeof(header) || header.magic != frame_magic || fd < 0
+      || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0)
+    return caf::make_error(ec::format_error, "received a malformed frame");
+  // Without the seals, the client could change or truncate the memory after
+  // we verified it, which would crash us upon access.
+  auto seals = ::fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || (seals & required_seals) != required_seals)
+    return caf::make_error(ec::format_error, "received an unsealed table "
+                                             "slice");
+  struct ::stat st;
+  if (::fstat(fd, &st) != 0)
+    return make_system_error("failed to stat table slice:");
+  if (header.size == 0 || static_cast<uint64_t>(st.st_size) != header.size)
+    return caf::make_error(ec::format_error, "received a table slice of "
+                                             "unexpected size");
+  auto size = static_cast<size_t>(header.size);
+  auto map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+    return make_system_error("failed to map table slice:");
+  auto deleter = [=]() noexcept { ::munmap(map, size); };
+  auto result = table_slice{chunk::make(map, size, std::move(deleter)),
+                            table_slice::verify::yes};
+  if (result.encoding() == table_slice_encoding::none)
+    return caf::make_error(ec::format_error, "received an invalid table "
+                                             "slice");
+  return result;
+#else  // VAST_LINUX
+  (void)socket;
+  return caf::make_error(ec::unimplemented, "local transport requires Linux");
+#endif // VAST_LINUX
+}
+
+caf::expected<int>
+connect_slice_socket(const std::string& name, const std::string& token) {
+#if VAST_LINUX
+  auto fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return make_system_error("failed to create socket:");
+  ::sockaddr_un addr;
+  auto len = make_address(addr, name);
+  if (::connect(fd, reinterpret_cast<::sockaddr*>(&addr), len) != 0
+      || ::send(fd, token.data(), token.size(), MSG_NOSIGNAL)
+           != static_cast<ssize_t>(token.size())) {
+    auto err = make_system_error("failed to connect to client:");
+    ::close(fd);
+    return err;
+  }
+  return fd;
+#else  // VAST_LINUX
+  (void)name;
+  (void)token;
+  return caf::make_error(ec::unimplemented, "local transport requires Linux");
+#endif // VAST_LINUX
+}
+
+slice_sender_state::~slice_sender_state() {
+  if (socket >= 0)
+    ::close(socket);
+}
+
+stream_sink_actor<table_slice, std::string>::behavior_type slice_sender(
+  stream_sink_actor<table_slice, std::string>::stateful_pointer<
+    slice_sender_state>
+    self,
+  int socket) {
+  self->state.socket = socket;
+  return {
+    [self](caf::stream<table_slice> in,
+           const std::string& desc) -> caf::inbound_stream_slot<table_slice> {
+      VAST_DEBUG("{} ships {} table slices to the node", self, desc);
+      return self
+        ->make_sink(
+          in,
+          [](caf::unit_t&) {
+            // nop
+          },
+          [=](caf::unit_t&, table_slice slice) {
+            if (auto err = send_slice(self->state.socket, slice)) {
+              VAST_ERROR("{} failed to send a table slice: {}", self,
+                         render(err));
+              self->quit(std::move(err));
+              return;
+            }
+            ++self->state.slices;
+          },
+          [=](caf::unit_t&, const caf::error& err) {
+            // We cannot use `self` anymore if the stream became unreachable
+            // because the actor was destroyed.
+            if (err == caf::exit_reason::unreachable)
+              return;
+            if (err && err != caf::exit_reason::user_shutdown)
+              VAST_WARN("{} got a stream error: {}", self, render(err));
+            VAST_DEBUG("{} sent {} table slices", self, self->state.slices);
+            // Closing the socket signals the end of the input to the node.
+            self->quit(err);
+          })
+        .inbound_slot();
+    },
+  };
+}
+
+slice_receiver_state::~slice_receiver_state() {
+  if (socket >= 0)
+    ::close(socket);
+}
+
+caf::behavior
+slice_receiver(caf::stateful_actor<slice_receiver_state>* self, int socket,
+               std::string description) {
+  self->state.socket = socket;
+  self->state.description = std::move(description);
+  self->set_exit_handler([=](const caf::exit_msg& msg) {
+    VAST_VERBOSE("{} received EXIT from {}", self, msg.source);
+    self->state.done = true;
+    self->quit(msg.reason);
+  });
+  self->state.mgr = self->make_continuous_source(
+    // init
+    [](caf::unit_t&) {
+      // nop
+    },
+    // get next element
+    [self](caf::unit_t&, caf::downstream<table_slice>& out, size_t num) {
+      auto& st = self->state;
+      auto t = timer::start(st.metrics);
+      uint64_t events = 0;
+      for (size_t i = 0; i < num; ++i) {
+        auto slice = receive_slice(st.socket);
+        if (slice) {
+          events += slice->rows();
+          out.push(std::move(*slice));
+          continue;
+        }
+        t.stop(events);
+        if (slice.error() == ec::stalled) {
+          if (events > 0)
+            st.wakeup_delay = std::chrono::milliseconds::zero();
+          if (!st.waiting_for_input) {
+            st.waiting_for_input = true;
+            self->delayed_send(self, st.wakeup_delay, atom::wakeup_v);
+            // Back off exponentially while the client is idle.
+            if (st.wakeup_delay == std::chrono::milliseconds::zero())
+              st.wakeup_delay = std::chrono::milliseconds{1};
+            else if (st.wakeup_delay < std::chrono::milliseconds{256})
+              st.wakeup_delay *= 2;
+          }
+          return;
+        }
+        if (slice.error() != ec::end_of_input)
+          VAST_WARN("{} failed to receive a table slice: {}", self,
+                    render(slice.error()));
+        VAST_DEBUG("{} received {} events in total", self,
+                   st.metrics.events);
+        st.done = true;
+        self->quit();
+        return;
+      }
+      t.stop(events);
+      st.wakeup_delay = std::chrono::milliseconds::zero();
+    },
+    // done?
+    [self](const caf::unit_t&) { return self->state.done; });
+  return {
+    [self](stream_sink_actor<table_slice, std::string> sink) {
+      VAST_DEBUG("{} registers {}", self, VAST_ARG(sink));
+      self->state.mgr->add_outbound_path(
+        sink, std::make_tuple(self->state.description));
+    },
+    [self](atom::wakeup) {
+      self->state.waiting_for_input = false;
+      if (self->state.mgr->generate_messages())
+        self->state.mgr->push();
+    },
+    [self](atom::status, status_verbosity v) {
+      caf::settings result;
+      if (v >= status_verbosity::detailed) {
+        caf::settings src;
+        put(src, "format", self->state.description);
+        put(src, "transport", std::string{"memfd"});
+        put(src, "produced", self->state.metrics.events);
+        auto& xs = put_list(result, "sources");
+        xs.emplace_back(std::move(src));
+      }
+      return result;
+    },
+  };
+}
+
+caf::expected<slice_transport>
+make_slice_transport(caf::scoped_actor& self, const node_actor& node,
+                     const std::string& importer, std::string description) {
+#if VAST_LINUX
+  // The client listens and the node connects, which proves that both run on
+  // the same host. The token proves that the connecting process is the node.
+  auto name = "vast-slices-" + to_string(uuid::random());
+  auto token = to_string(uuid::random());
+  auto listener = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (listener < 0)
+    return make_system_error("failed to create socket:");
+  auto close_listener
+    = caf::detail::make_scope_guard([=] { ::close(listener); });
+  ::sockaddr_un addr;
+  auto len = make_address(addr, name);
+  if (::bind(listener, reinterpret_cast<::sockaddr*>(&addr), len) != 0
+      || ::listen(listener, 1) != 0)
+    return make_system_error("failed to listen on socket:");
+  auto inv = invocation{{}, "spawn slice-receiver", {}};
+  caf::put(inv.options, "vast.spawn.slice-receiver.socket", name);
+  caf::put(inv.options, "vast.spawn.slice-receiver.token", token);
+  caf::put(inv.options, "vast.spawn.slice-receiver.description",
+           std::move(description));
+  caf::put(inv.options, "vast.import.importer", importer);
+  auto result = slice_transport{};
+  auto err = caf::error{};
+  self->request(node, caf::infinite, atom::spawn_v, std::move(inv))
+    .receive([&](caf::actor& receiver) { result.receiver = receiver; },
+             [&](caf::error& error) { err = std::move(error); });
+  if (err)
+    return err;
+  // The node connected to the socket before it spawned the receiver, so the
+  // connection must be pending already.
+  auto fail = [&](caf::error error) {
+    self->send_exit(result.receiver, caf::exit_reason::user_shutdown);
+    return error;
+  };
+  if (!wait_readable(listener, handshake_timeout_ms))
+    return fail(caf::make_error(ec::timeout, "node did not connect"));
+  auto fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0)
+    return fail(make_system_error("failed to accept connection:"));
+  auto buf = std::string(token.size() + 1, '\0');
+  auto n = wait_readable(fd, handshake_timeout_ms)
+             ? ::recv(fd, buf.data(), buf.size(), MSG_DONTWAIT)
+             : -1;
+  if (n != static_cast<ssize_t>(token.size())
+      || buf.compare(0, token.size(), token) != 0) {
+    ::close(fd);
+    return fail(caf::make_error(ec::unspecified, "failed to authenticate "
+                                                 "the node"));
+  }
+  result.sender = self->spawn<caf::detached>(slice_sender, fd);
+  return result;
+#else  // VAST_LINUX
+  (void)self;
+  (void)node;
+  (void)importer;
+  (void)description;
+  return caf::make_error(ec::unimplemented, "local transport requires Linux");
+#endif // VAST_LINUX
+}
+
+} // namespace vast::system
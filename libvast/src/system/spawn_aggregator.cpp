@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/spawn_aggregator.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/aggregator.hpp"
+#include "vast/system/node.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/actor.hpp>
+#include <caf/expected.hpp>
+#include <caf/settings.hpp>
+
+namespace vast::system {
+
+caf::expected<caf::actor>
+spawn_aggregator(node_actor::stateful_pointer<node_state> self,
+                 spawn_arguments& args) {
+  VAST_TRACE_SCOPE("{}", VAST_ARG(args));
+  // Parse given expression.
+  auto expr = get_expression(args);
+  if (!expr)
+    return expr.error();
+  auto field = caf::get_or(args.inv.options, "vast.aggregate.by", "");
+  if (field.empty())
+    return caf::make_error(ec::invalid_configuration,
+                           "aggregation requires a field to group by");
+  auto [index, archive]
+    = self->state.registry.find<index_actor, archive_actor>();
+  if (!index)
+    return caf::make_error(ec::missing_component, "index");
+  if (!archive)
+    return caf::make_error(ec::missing_component, "archive");
+  auto handle = self->spawn(aggregator, *expr, field, index, archive);
+  VAST_VERBOSE("{} spawned an aggregator for {} by {}", self, to_string(*expr),
+               field);
+  return handle;
+}
+
+} // namespace vast::system
@@ -0,0 +1,69 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/spawn_compactor.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/logger.hpp"
+#include "vast/path.hpp"
+#include "vast/system/compactor.hpp"
+#include "vast/system/node.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+namespace vast::system {
+
+caf::expected<caf::actor>
+spawn_compactor(node_actor::stateful_pointer<node_state> self,
+                spawn_arguments& args) {
+  VAST_TRACE_SCOPE("{}", VAST_ARG(args));
+  auto [index, archive, filesystem]
+    = self->state.registry.find<index_actor, archive_actor, filesystem_actor>();
+  if (!index)
+    return caf::make_error(ec::missing_component, "index");
+  if (!archive)
+    return caf::make_error(ec::missing_component, "archive");
+  if (!filesystem)
+    return caf::make_error(ec::missing_component, "filesystem");
+  auto opts = args.inv.options;
+  auto target_size
+    = caf::get_or(opts, "vast.start.compaction-target-size", size_t{0});
+  if (target_size == 0) {
+    VAST_VERBOSE("{} not spawning compactor because no target size "
+                 "configured",
+                 self);
+    return ec::no_error;
+  }
+  auto max_concurrency
+    = caf::get_or(opts, "vast.start.compaction-max-concurrency",
+                  defaults::system::compaction_max_concurrency);
+  if (max_concurrency == 0)
+    return caf::make_error(ec::invalid_configuration,
+                           "compaction-max-concurrency must be positive");
+  auto default_seconds
+    = std::chrono::seconds{defaults::system::compaction_interval}.count();
+  auto interval = caf::get_or(opts, "vast.start.compaction-interval",
+                              default_seconds);
+  auto db_dir
+    = caf::get_or(opts, "vast.db-directory", defaults::system::db_directory);
+  auto index_dir = path{db_dir}.complete() / "index";
+  auto handle = self->spawn(compactor, target_size, max_concurrency,
+                            std::chrono::seconds{interval}, index_dir,
+                            filesystem, archive, index);
+  VAST_VERBOSE("{} spawned a compactor", self);
+  return caf::actor_cast<caf::actor>(handle);
+}
+
+} // namespace vast::system
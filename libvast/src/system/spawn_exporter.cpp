@@ -50,23 +50,24 @@ spawn_exporter(node_actor::stateful_pointer<node_state> self,
   auto handle = self->spawn(exporter, *expr, query_opts);
   VAST_VERBOSE("{} spawned an exporter for {}", self, to_string(*expr));
   // Wire the exporter to all components.
-  auto [accountant, importer, archive, index]
-    = self->state.registry
-        .find<accountant_actor, importer_actor, archive_actor, index_actor>();
+  auto [accountant, archive, index]
+    = self->state.registry.find<accountant_actor, archive_actor, index_actor>();
   if (accountant)
     self->send(handle, accountant);
-  if (importer && has_continuous_option(query_opts))
-    self
-      ->request(importer, caf::infinite,
-                static_cast<stream_sink_actor<table_slice>>(handle))
-      .then(
-        [=](caf::outbound_stream_slot<table_slice>) {
-          // nop
-        },
-        [=, importer = importer](caf::error err) {
-          VAST_ERROR("{} failed to connect to importer {}: {}", self, importer,
-                     err);
-        });
+  // Continuous queries must see the events of all IMPORTERs.
+  if (has_continuous_option(query_opts))
+    for (auto& component : self->state.registry.find_by_type("importer")) {
+      auto importer = caf::actor_cast<importer_actor>(component);
+      self->request(importer, caf::infinite, atom::subscribe_v, *expr, handle)
+        .then(
+          [=](atom::ok) {
+            // nop
+          },
+          [=](caf::error err) {
+            VAST_ERROR("{} failed to connect to importer {}: {}", self,
+                       importer, err);
+          });
+    }
   if (archive) {
     VAST_DEBUG("{} connects archive to new exporter", self);
     self->send(handle, archive);
@@ -16,6 +16,7 @@
 #include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/logger.hpp"
+#include "vast/system/id_allocator.hpp"
 #include "vast/system/importer.hpp"
 #include "vast/system/node.hpp"
 #include "vast/system/spawn_arguments.hpp"
@@ -41,9 +42,18 @@ spawn_importer(node_actor::stateful_pointer<node_state> self,
     return caf::make_error(ec::missing_component, "index");
   if (!type_registry)
     return caf::make_error(ec::missing_component, "type-registry");
-  auto handle = self->spawn(importer, args.dir / args.label, self, archive,
-                            index, type_registry);
-  VAST_VERBOSE("{} spawned the importer", self);
+  // All IMPORTERs share one allocator, whose state lives where the first
+  // IMPORTER kept its state.
+  if (!self->state.ids) {
+    auto ids = id_allocator::make(args.dir / "importer",
+                                  defaults::system::id_headroom);
+    if (!ids)
+      return ids.error();
+    self->state.ids = std::move(*ids);
+  }
+  auto handle = self->spawn(importer, self->state.ids, self, archive, index,
+                            type_registry);
+  VAST_VERBOSE("{} spawned the importer {}", self, args.label);
   if (accountant) {
     self->send(handle, atom::telemetry_v);
     self->send(handle, accountant);
@@ -53,9 +63,14 @@ spawn_importer(node_actor::stateful_pointer<node_state> self,
     // TODO: Implement live-reloading of the importer configuration.
     self->send(handle, atom::telemetry_v);
   }
-  for (auto& source : self->state.registry.find_by_type("source")) {
-    VAST_DEBUG("{} connects source to new importer", self);
-    self->anon_send(source, atom::sink_v, caf::actor_cast<caf::actor>(handle));
+  // Only the primary IMPORTER takes over existing sources; sources pick any
+  // other IMPORTER explicitly by its label.
+  if (args.label == defaults::import::importer) {
+    for (auto& source : self->state.registry.find_by_type("source")) {
+      VAST_DEBUG("{} connects source to new importer", self);
+      self->anon_send(source, atom::sink_v,
+                      caf::actor_cast<caf::actor>(handle));
+    }
   }
   return caf::actor_cast<caf::actor>(handle);
 }
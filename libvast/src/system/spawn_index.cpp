@@ -14,6 +14,7 @@
 #include "vast/system/spawn_index.hpp"
 
 #include "vast/defaults.hpp"
+#include "vast/detail/hyperloglog.hpp"
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/path.hpp"
@@ -39,6 +40,14 @@ spawn_index(node_actor::stateful_pointer<node_state> self,
     return caf::make_error(ec::lookup_error, "failed to find filesystem actor");
   auto indexdir = args.dir / args.label;
   namespace sd = vast::defaults::system;
+  auto sketch_precision = opt("vast.cardinality-sketch-precision",
+                              sd::cardinality_sketch_precision);
+  if (sketch_precision != 0
+      && (sketch_precision < detail::hyperloglog::min_precision
+          || sketch_precision > detail::hyperloglog::max_precision))
+    return caf::make_error(ec::invalid_configuration,
+                           "cardinality-sketch-precision must be 0 or "
+                           "between 4 and 18");
   auto handle = self->spawn(
     index, filesystem, indexdir,
     // TODO: Pass these options as a vast::data object instead.
@@ -47,7 +56,10 @@ spawn_index(node_actor::stateful_pointer<node_state> self,
     opt("vast.max-taste-partitions", sd::taste_partitions),
     opt("vast.max-queries", sd::num_query_supervisors),
     vast::path{opt("vast.meta-index-dir", indexdir.str())},
-    opt("vast.meta-index-fp-rate", sd::string_synopsis_fp_rate));
+    opt("vast.meta-index-fp-rate", sd::string_synopsis_fp_rate),
+    opt("vast.meta-index-lazy-loading", false),
+    opt("vast.result-cache-size", sd::result_cache_size), sketch_precision,
+    opt("vast.meta-index-native-bloom-filters", false));
   VAST_VERBOSE("{} spawned the index", self);
   if (accountant)
     self->send(handle, caf::actor_cast<accountant_actor>(accountant));
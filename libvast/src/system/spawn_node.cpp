@@ -79,7 +79,10 @@ spawn_node(caf::scoped_actor& self, const caf::settings& opts) {
       return x.error();
   }
   // Pointer to the root command to system::node.
-  auto actor = self->spawn(system::node, id, abs_dir, shutdown_grace_period);
+  auto filesystem_workers = get_or(opts, "vast.filesystem-workers",
+                                   defaults::system::filesystem_workers);
+  auto actor = self->spawn(system::node, id, abs_dir, shutdown_grace_period,
+                           filesystem_workers);
   actor->attach_functor([=, pid_file = std::move(pid_file)](const caf::error&) {
     VAST_DEBUG("node removes PID lock: {}", pid_file.str());
     rm(pid_file);
@@ -98,8 +101,9 @@ spawn_node(caf::scoped_actor& self, const caf::settings& opts) {
         });
     return result;
   };
-  std::list components = {"type-registry", "archive", "index",
-                          "importer",      "eraser",  "disk_monitor"};
+  std::list components
+    = {"type-registry", "archive",      "index",    "importer",
+       "eraser",        "disk_monitor", "compactor"};
   if (accounting)
     components.push_front("accountant");
   for (auto& c : components) {
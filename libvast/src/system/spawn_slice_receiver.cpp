@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/spawn_slice_receiver.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/node.hpp"
+#include "vast/system/slice_transport.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <string>
+
+namespace vast::system {
+
+caf::expected<caf::actor>
+spawn_slice_receiver(node_actor::stateful_pointer<node_state> self,
+                     spawn_arguments& args) {
+  if (!args.empty())
+    return unexpected_arguments(args);
+  auto& options = args.inv.options;
+  auto socket
+    = caf::get_if<std::string>(&options, "vast.spawn.slice-receiver.socket");
+  auto token
+    = caf::get_if<std::string>(&options, "vast.spawn.slice-receiver.token");
+  if (!socket || !token)
+    return caf::make_error(ec::invalid_configuration,
+                           "slice receiver requires a socket and a token");
+  auto description = caf::get_or(
+    options, "vast.spawn.slice-receiver.description", "slice-receiver");
+  auto label = caf::get_or(options, "vast.import.importer",
+                           defaults::import::importer);
+  auto importer = caf::actor_cast<importer_actor>(
+    self->state.registry.find_by_label(label));
+  if (!importer)
+    return caf::make_error(ec::missing_component, "importer", label);
+  auto fd = connect_slice_socket(*socket, *token);
+  if (!fd)
+    return fd.error();
+  auto handle = self->spawn(slice_receiver, *fd, std::move(description));
+  VAST_VERBOSE("{} spawned a slice receiver for {}", self, args.label);
+  auto sink = static_cast<stream_sink_actor<table_slice, std::string>>(
+    importer);
+  self->send(handle, std::move(sink));
+  return handle;
+}
+
+} // namespace vast::system
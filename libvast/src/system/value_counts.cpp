@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/value_counts.hpp"
+
+#include <algorithm>
+
+namespace vast::system {
+
+void value_counts::add(const data& x, count n) {
+  counts[x] += n;
+}
+
+void value_counts::merge(const value_counts& other) {
+  if (counts.empty()) {
+    counts = other.counts;
+    return;
+  }
+  for (auto& [value, n] : other.counts)
+    counts[value] += n;
+}
+
+size_t value_counts::distinct() const {
+  return counts.size();
+}
+
+count value_counts::total() const {
+  count result = 0;
+  for (auto& [_, n] : counts)
+    result += n;
+  return result;
+}
+
+std::vector<std::pair<data, count>> value_counts::top(size_t k) const {
+  std::vector<std::pair<data, count>> result(counts.begin(), counts.end());
+  auto greater = [](const auto& x, const auto& y) {
+    return x.second != y.second ? x.second > y.second : x.first < y.first;
+  };
+  if (k == 0 || k >= result.size()) {
+    std::sort(result.begin(), result.end(), greater);
+    return result;
+  }
+  // Selecting only the first k elements avoids sorting the long tail.
+  std::partial_sort(result.begin(), result.begin() + k, result.end(), greater);
+  result.resize(k);
+  return result;
+}
+
+} // namespace vast::system
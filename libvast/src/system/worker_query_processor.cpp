@@ -0,0 +1,99 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#include "vast/system/worker_query_processor.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/logger.hpp"
+
+#include <caf/event_based_actor.hpp>
+#include <caf/message_handler.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace vast::system {
+
+worker_query_processor::worker_query_processor(caf::event_based_actor* self)
+  : super(self) {
+  // nop
+}
+
+void worker_query_processor::init(expression expr, index_actor index,
+                                  archive_actor archive, size_t max_workers) {
+  expr_ = std::move(expr);
+  archive_ = std::move(archive);
+  max_workers_ = std::max(max_workers, size_t{1});
+  // Transition from idle state when receiving 'run' and client handle.
+  behaviors_[idle].assign([=](atom::run, caf::actor client) {
+    client_ = std::move(client);
+    start(expr_, index);
+    // Stop immediately when losing the client.
+    self_->monitor(client_);
+    self_->set_down_handler([this](caf::down_msg& dm) {
+      if (dm.source == client_)
+        self_->quit(dm.reason);
+    });
+  });
+  // Merge the partial results of the workers, and hand the hits that arrived
+  // in the meantime to a new worker.
+  caf::message_handler base{behaviors_[collect_hits].as_behavior_impl()};
+  behaviors_[collect_hits] = base.or_else([this](value_counts& partial) {
+    result_.merge(partial);
+    if (any<1>(unassigned_)) {
+      spawn_worker(std::exchange(unassigned_, ids{}));
+      return;
+    }
+    VAST_ASSERT(pending_workers_ > 0);
+    if (--pending_workers_ == 0)
+      block_end_of_hits(false);
+  });
+}
+
+void worker_query_processor::process_hits(const ids& hits) {
+  // Drop the hits that an earlier message already contained.
+  auto fresh = hits - seen_;
+  if (!any<1>(fresh))
+    return;
+  seen_ |= fresh;
+  if (pending_workers_ == max_workers_) {
+    VAST_DEBUG("{} defers {} hits until a worker finishes", self_,
+               rank(fresh));
+    unassigned_ |= fresh;
+    return;
+  }
+  spawn_worker(std::move(fresh));
+  // Block the FSM from advancing until all workers are done.
+  if (++pending_workers_ == 1)
+    block_end_of_hits(true);
+}
+
+void worker_query_processor::process_end_of_hits() {
+  // Fetch more hits if the INDEX has more partitions to go through.
+  if (partitions_.received < partitions_.total) {
+    auto n = std::min(partitions_.total - partitions_.received,
+                      partitions_.scheduled);
+    request_more_hits(n);
+    return;
+  }
+  // The processor runs only once. Hence, we call quit() after sending the
+  // result and a final 'done' atom to the client.
+  self_->send(client_, std::move(result_));
+  self_->send(client_, atom::done_v);
+  self_->quit();
+}
+
+} // namespace vast::system
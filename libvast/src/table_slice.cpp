@@ -23,6 +23,7 @@
 #include "vast/fbs/table_slice.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/logger.hpp"
 #include "vast/msgpack_table_slice.hpp"
 #include "vast/table_slice_builder.hpp"
@@ -33,6 +34,9 @@
 
 #if VAST_ENABLE_ARROW
 #  include "vast/arrow_table_slice.hpp"
+#  include "vast/arrow_table_slice_builder.hpp"
+
+#  include <arrow/record_batch.h>
 #endif // VAST_ENABLE_ARROW
 
 namespace vast {
@@ -237,10 +241,10 @@ bool operator==(const table_slice& lhs, const table_slice& rhs) noexcept {
     return true;
   // Check whether the slices have different sizes or layouts.
   if (lhs.rows() != rhs.rows() || lhs.columns() != rhs.columns()
-      || lhs.layout() != rhs.layout())
+      || lhs.interned().id != rhs.interned().id)
     return false;
   // Check whether the slices contain different data.
-  auto flat_layout = flatten(lhs.layout());
+  const auto& flat_layout = lhs.interned().flat_layout;
   for (size_t row = 0; row < lhs.rows(); ++row)
     for (size_t col = 0; col < flat_layout.fields.size(); ++col)
       if (lhs.at(row, col, flat_layout.fields[col].type)
@@ -266,13 +270,18 @@ enum table_slice_encoding table_slice::encoding() const noexcept {
 }
 
 const record_type& table_slice::layout() const noexcept {
+  return interned().layout;
+}
+
+const interned_layout& table_slice::interned() const noexcept {
   auto f = detail::overload{
     []() noexcept {
-      static const auto empty_layout = record_type{};
-      return &empty_layout;
+      // The interner reserves the first ID for the empty layout.
+      static const auto* empty_layout = &layout_interner::instance().at(0);
+      return empty_layout;
     },
     [&](const auto& encoded) noexcept {
-      return &state(encoded, state_)->layout();
+      return &state(encoded, state_)->interned();
     },
   };
   return *visit(f, as_flatbuffer(chunk_));
@@ -357,6 +366,19 @@ data_view table_slice::at(table_slice::size_type row,
   return visit(f, as_flatbuffer(chunk_));
 }
 
+void table_slice::decode_columns(
+  std::vector<std::vector<data_view>>& result) const {
+  auto f = detail::overload{
+    []() noexcept {
+      die("cannot decode columns of invalid table slice");
+    },
+    [&](const auto& encoded) noexcept {
+      return state(encoded, state_)->decode_columns(result);
+    },
+  };
+  return visit(f, as_flatbuffer(chunk_));
+}
+
 #if VAST_ENABLE_ARROW
 
 std::shared_ptr<arrow::RecordBatch> as_record_batch(const table_slice& slice) {
@@ -385,6 +407,12 @@ std::shared_ptr<arrow::RecordBatch> as_record_batch(const table_slice& slice) {
             static_cast<void>(slice);
           }};
         return result;
+      } else if constexpr (std::decay_t<decltype(*state(encoded,
+                                                        slice.state_))>::encoding
+                           == table_slice_encoding::msgpack) {
+        // Transcode the rows directly into Arrow arrays. The resulting record
+        // batch owns its buffers, so we do not need to capture the slice.
+        return state(encoded, slice.state_)->to_record_batch();
       } else {
         // Rebuild the slice as an Arrow-encoded table slice.
         auto copy = rebuild(slice, table_slice_encoding::arrow);
@@ -413,22 +441,35 @@ rebuild(table_slice slice, enum table_slice_encoding encoding) noexcept {
       if (encoding == state(encoded, slice.state_)->encoding
           && state(encoded, slice.state_)->is_latest_version) {
         return std::move(slice);
-      } else {
-        auto builder = factory<table_slice_builder>::make(builder_id(encoding),
-                                                          slice.layout());
-        if (!builder)
-          return table_slice{};
-        auto flat_layout = flatten(slice.layout());
-        for (table_slice::size_type row = 0; row < slice.rows(); ++row)
-          for (table_slice::size_type column = 0;
-               column < flat_layout.fields.size(); ++column)
-            if (!builder->add(
-                  slice.at(row, column, flat_layout.fields[column].type)))
-              return {};
-        auto result = builder->finish();
-        result.offset(slice.offset());
-        return result;
       }
+#if VAST_ENABLE_ARROW
+      if constexpr (std::decay_t<decltype(*state(encoded, slice.state_))>::encoding
+                    == table_slice_encoding::msgpack) {
+        if (encoding == table_slice_encoding::arrow) {
+          auto batch = state(encoded, slice.state_)->to_record_batch();
+          if (!batch)
+            return {};
+          auto result
+            = arrow_table_slice_builder::create(*batch, slice.layout());
+          result.offset(slice.offset());
+          return result;
+        }
+      }
+#endif // VAST_ENABLE_ARROW
+      auto builder = factory<table_slice_builder>::make(builder_id(encoding),
+                                                        slice.layout());
+      if (!builder)
+        return table_slice{};
+      const auto& flat_layout = slice.interned().flat_layout;
+      for (table_slice::size_type row = 0; row < slice.rows(); ++row)
+        for (table_slice::size_type column = 0;
+             column < flat_layout.fields.size(); ++column)
+          if (!builder->add(
+                slice.at(row, column, flat_layout.fields[column].type)))
+            return {};
+      auto result = builder->finish();
+      result.offset(slice.offset());
+      return result;
     },
   };
   return visit(f, as_flatbuffer(slice.chunk_));
@@ -464,6 +505,32 @@ void select(std::vector<table_slice>& result, const table_slice& slice,
   span<const std::byte> serialized_layout = {};
   std::tie(implementation_id, serialized_layout)
     = visit(f, as_flatbuffer(slice.chunk_));
+#if VAST_ENABLE_ARROW
+  // Record batches support zero-copy slicing, so we can cut out every run of
+  // consecutive ids at once instead of copying the selected rows cell by cell.
+  if (slice.encoding() == table_slice_encoding::arrow) {
+    auto record_batch = as_record_batch(slice);
+    auto push_run = [&](id first, id last) {
+      auto batch = record_batch->Slice(first - slice.offset(), last - first);
+      auto new_slice = arrow_table_slice_builder::create(
+        *batch, slice.layout(), serialized_layout);
+      new_slice.offset(first);
+      result.emplace_back(std::move(new_slice));
+    };
+    auto first = invalid_id;
+    auto last = invalid_id;
+    for (auto id : select(intersection)) {
+      if (id != last) {
+        if (first != invalid_id)
+          push_run(first, last);
+        first = id;
+      }
+      last = id + 1;
+    }
+    push_run(first, last);
+    return;
+  }
+#endif // VAST_ENABLE_ARROW
   // Start slicing and dicing.
   auto builder
     = factory<table_slice_builder>::make(implementation_id, slice.layout());
@@ -484,7 +551,7 @@ void select(std::vector<table_slice>& result, const table_slice& slice,
     new_slice.offset(last_offset);
     result.emplace_back(std::move(new_slice));
   };
-  auto flat_layout = flatten(slice.layout());
+  const auto& flat_layout = slice.interned().flat_layout;
   auto last_id = last_offset - 1;
   for (auto id : select(intersection)) {
     // Finish last slice when hitting non-consecutive IDs.
@@ -680,4 +747,22 @@ ids evaluate(const expression& expr, const table_slice& slice) {
   return result;
 }
 
+ids evaluate(const expression& expr, const table_slice& slice,
+             const ids& selection) {
+  auto first = slice.offset();
+  auto last = first + slice.rows();
+  ids result;
+  for (auto id : select(selection)) {
+    if (id < first)
+      continue;
+    if (id >= last)
+      break;
+    if (caf::visit(row_evaluator{slice, id - first}, expr)) {
+      result.append_bits(false, id - result.size());
+      result.append_bit(true);
+    }
+  }
+  return result;
+}
+
 } // namespace vast
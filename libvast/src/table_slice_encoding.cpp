@@ -13,7 +13,9 @@
 
 #include "vast/table_slice_encoding.hpp"
 
+#include "vast/config.hpp"
 #include "vast/die.hpp"
+#include "vast/type.hpp"
 
 namespace vast {
 
@@ -30,4 +32,35 @@ std::string to_string(table_slice_encoding encoding) noexcept {
   die("unhandled table slice encoding");
 }
 
+table_slice_encoding preferred_encoding(const record_type& layout) {
+#if VAST_ENABLE_ARROW
+  // MessagePack decodes a row from its beginning up to the requested column,
+  // so accessing a cell gets more expensive the wider the layout.
+  constexpr size_t wide_layout = 16;
+  size_t leaves = 0;
+  size_t fixed_width = 0;
+  for (auto& field : record_type::each{layout}) {
+    ++leaves;
+    const auto* t = &field.type();
+    while (auto alias = caf::get_if<alias_type>(t))
+      t = &alias->value_type;
+    if (caf::holds_alternative<bool_type>(*t)
+        || caf::holds_alternative<integer_type>(*t)
+        || caf::holds_alternative<count_type>(*t)
+        || caf::holds_alternative<real_type>(*t)
+        || caf::holds_alternative<duration_type>(*t)
+        || caf::holds_alternative<time_type>(*t)
+        || caf::holds_alternative<enumeration_type>(*t)
+        || caf::holds_alternative<address_type>(*t)
+        || caf::holds_alternative<subnet_type>(*t))
+      ++fixed_width;
+  }
+  if (leaves >= wide_layout || 2 * fixed_width >= leaves)
+    return table_slice_encoding::arrow;
+#else
+  (void)layout;
+#endif // VAST_ENABLE_ARROW
+  return table_slice_encoding::msgpack;
+}
+
 } // namespace vast
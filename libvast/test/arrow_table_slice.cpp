@@ -26,6 +26,8 @@
 #  include "vast/concept/parseable/to.hpp"
 #  include "vast/concept/parseable/vast/address.hpp"
 #  include "vast/concept/parseable/vast/subnet.hpp"
+#  include "vast/ids.hpp"
+#  include "vast/msgpack_table_slice_builder.hpp"
 #  include "vast/type.hpp"
 
 #  include <caf/make_copy_on_write.hpp>
@@ -310,6 +312,51 @@ TEST(single column - serialization) {
   CHECK_VARIANT_EQUAL(slice1, slice2);
 }
 
+TEST(select) {
+  auto t = count_type{};
+  auto slice = make_single_column_slice<count_type>(0_c, 1_c, caf::none, 3_c,
+                                                    4_c, 5_c);
+  slice.offset(100);
+  auto xs = select(slice, make_ids({{100, 102}, 103, {104, 106}}));
+  REQUIRE_EQUAL(xs.size(), 2u);
+  CHECK_EQUAL(xs[0].encoding(), table_slice_encoding::arrow);
+  CHECK_EQUAL(xs[0].offset(), 100u);
+  REQUIRE_EQUAL(xs[0].rows(), 2u);
+  CHECK_VARIANT_EQUAL(xs[0].at(0, 0, t), 0_c);
+  CHECK_VARIANT_EQUAL(xs[0].at(1, 0, t), 1_c);
+  CHECK_EQUAL(xs[1].offset(), 103u);
+  REQUIRE_EQUAL(xs[1].rows(), 3u);
+  CHECK_VARIANT_EQUAL(xs[1].at(0, 0, t), 3_c);
+  CHECK_VARIANT_EQUAL(xs[1].at(2, 0, t), 5_c);
+  CHECK_ROUNDTRIP(xs[1]);
+}
+
+TEST(transcode from msgpack) {
+  auto layout = record_type{
+    {"c", count_type{}},
+    {"s", string_type{}},
+    {"xs", list_type{integer_type{}}},
+    {"r", record_type{{"a", address_type{}}, {"t", time_type{}}}},
+  }.name("transcode");
+  auto builder = msgpack_table_slice_builder::make(layout);
+  auto addr = unbox(to<address>("10.0.0.1"));
+  auto ts = time{} + 42s;
+  CHECK(builder->add(0_c, "foo"sv, list{integer{1}, integer{2}}, addr, ts));
+  CHECK(builder->add(caf::none, caf::none, list{}, caf::none, ts));
+  CHECK(builder->add(2_c, "bar"sv, caf::none, addr, caf::none));
+  auto slice = builder->finish();
+  slice.offset(42);
+  auto batch = as_record_batch(slice);
+  REQUIRE(batch);
+  CHECK_EQUAL(batch->num_rows(), 3);
+  CHECK_EQUAL(batch->num_columns(), 5);
+  auto copy = rebuild(slice, table_slice_encoding::arrow);
+  CHECK_EQUAL(copy.encoding(), table_slice_encoding::arrow);
+  CHECK_EQUAL(copy.offset(), 42u);
+  CHECK_EQUAL(copy.layout(), layout);
+  CHECK_EQUAL(make_data(copy), make_data(slice));
+}
+
 FIXTURE_SCOPE(arrow_table_slice_tests, fixtures::table_slices)
 
 TEST_TABLE_SLICE(arrow_table_slice_builder, arrow)
@@ -114,3 +114,33 @@ TEST(ICMPv6 oneway) {
   CHECK_EQUAL(hex, "1:118a3bbf175529a3d55dca55c4364ec47f1c4152");
   CHECK_EQUAL(b64, "1:EYo7vxdVKaPVXcpVxDZOxH8cQVI=");
 }
+
+TEST(batch) {
+  auto xs = std::vector<flow>{
+    make_udp_flow("192.168.1.102", "192.168.1.1", 68, 67),
+    make_udp_flow("fe80::2c23:b96c:78d:e116", "ff02::c", 58544, 3702),
+    make_tcp_flow("192.168.1.102", "68.216.79.113", 1180, 37),
+    make_tcp_flow("fe80::219:e3ff:fee7:5d23", "ff02::fb", 5353, 53),
+    make_icmp_flow("1.2.3.4", "5.6.7.8", 0, 8),
+    make_icmp_flow("192.168.0.89", "192.168.0.1", 128, 129),
+    make_icmp6_flow("fe80::200:86ff:fe05:80da", "fe80::260", 135, 136),
+    make_icmp6_flow("fe80::dead", "fe80::beef", 42, 84),
+    // The last flow occupies a lane of the second group.
+    make_tcp_flow("68.216.79.113", "192.168.1.102", 37, 1180),
+  };
+  MESSAGE("Base64");
+  std::string arena = "prefix";
+  compute<policy::base64>(span{xs.data(), xs.size()}, arena);
+  constexpr auto n = length<policy::base64>();
+  REQUIRE_EQUAL(arena.size(), 6 + xs.size() * n);
+  for (size_t i = 0; i < xs.size(); ++i)
+    CHECK_EQUAL(arena.substr(6 + i * n, n), compute<policy::base64>(xs[i]));
+  CHECK_EQUAL(arena.substr(6 + 8 * n, n), arena.substr(6 + 2 * n, n));
+  MESSAGE("ASCII");
+  arena.clear();
+  compute<policy::ascii>(span{xs.data(), xs.size()}, arena);
+  constexpr auto m = length<policy::ascii>();
+  REQUIRE_EQUAL(arena.size(), xs.size() * m);
+  for (size_t i = 0; i < xs.size(); ++i)
+    CHECK_EQUAL(arena.substr(i * m, m), compute<policy::ascii>(xs[i]));
+}
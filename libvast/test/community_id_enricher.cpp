@@ -0,0 +1,56 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE community_id_enricher
+
+#include "vast/community_id_enricher.hpp"
+
+#include "vast/test/fixtures/events.hpp"
+#include "vast/test/test.hpp"
+
+#include "vast/community_id.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/view.hpp"
+
+using namespace vast;
+
+FIXTURE_SCOPE(community_id_enricher_tests, fixtures::events)
+
+TEST(zeek conn log) {
+  community_id_enricher enrich;
+  auto& slice = zeek_conn_log[0];
+  auto result = enrich(slice);
+  REQUIRE_EQUAL(result.rows(), slice.rows());
+  REQUIRE_EQUAL(result.columns(), slice.columns() + 1);
+  CHECK_EQUAL(result.layout().name(), "zeek.conn");
+  CHECK_EQUAL(result.layout().fields.back().name, "community_id");
+  // The first connection is 192.168.1.102:68 -> 192.168.1.1:67 over UDP.
+  auto community_id = [&](size_t row) {
+    return materialize(result.at(row, result.columns() - 1, string_type{}));
+  };
+  CHECK_EQUAL(community_id(0), data{"1:aWZfLIquYlCxKGuJ62fQGlgFzAI="});
+  for (size_t row = 0; row < result.rows(); ++row)
+    CHECK(caf::holds_alternative<std::string>(community_id(row)));
+  MESSAGE("events with Community IDs stay untouched");
+  auto again = enrich(result);
+  CHECK_EQUAL(again.columns(), result.columns());
+  CHECK_EQUAL(again, result);
+}
+
+TEST(other layouts) {
+  community_id_enricher enrich;
+  auto& slice = zeek_dns_log[0];
+  CHECK_EQUAL(enrich(slice), slice);
+}
+
+FIXTURE_SCOPE_END()
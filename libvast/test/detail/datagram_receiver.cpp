@@ -0,0 +1,183 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE datagram_receiver
+
+#include "vast/detail/datagram_receiver.hpp"
+
+#include "vast/test/test.hpp"
+
+#include "vast/config.hpp"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <istream>
+#include <netinet/in.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <sys/socket.h>
+
+using namespace vast;
+using namespace vast::detail;
+using namespace std::chrono_literals;
+
+namespace {
+
+// A UDP client that sends datagrams to a receiver on the loopback interface.
+struct sender {
+  explicit sender(uint16_t port) : fd{::socket(AF_INET, SOCK_DGRAM, 0)} {
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+
+  ~sender() {
+    ::close(fd);
+  }
+
+  void send(const std::string& msg) {
+    ::sendto(fd, msg.data(), msg.size(), 0,
+             reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+  }
+
+  int fd;
+  ::sockaddr_in addr = {};
+};
+
+template <class Predicate>
+bool wait_until(Predicate pred, std::chrono::milliseconds timeout = 5s) {
+  for (auto i = 0ms; i < timeout; i += 1ms) {
+    if (pred())
+      return true;
+    std::this_thread::sleep_for(1ms);
+  }
+  return pred();
+}
+
+// Reads all buffered messages and returns their number.
+size_t drain(datagram_receiver& receiver) {
+  receiver.rearm();
+  std::istream in{&receiver};
+  size_t result = 0;
+  std::string line;
+  while (std::getline(in, line))
+    if (!line.empty())
+      ++result;
+  return result;
+}
+
+// Sends sentinel datagrams until the receiver accounted for all datagrams.
+// The kernel reports drops with the next datagram that it delivers, and a
+// sentinel may itself get dropped, so we try a few times.
+size_t settle(datagram_receiver& receiver, sender& client, size_t& sent) {
+  size_t result = 0;
+  for (auto i = 0; i < 10; ++i) {
+    client.send("sentinel");
+    ++sent;
+    wait_until([&] { return receiver.available() > 0; }, 100ms);
+    result += drain(receiver);
+    auto stats = receiver.stats();
+    if (!VAST_LINUX || stats.received + stats.dropped == sent)
+      break;
+  }
+  return result;
+}
+
+struct fixture {
+  fixture() {
+    auto result = datagram_receiver::make(0, 1024, 9216, 8 * 1024 * 1024,
+                                          [this] { ++notifications; });
+    REQUIRE(result);
+    receiver = std::move(*result);
+  }
+
+  std::unique_ptr<datagram_receiver> receiver;
+  std::atomic<size_t> notifications = 0;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(datagram_receiver_tests, fixture)
+
+TEST(newline separation) {
+  sender client{receiver->port()};
+  client.send("foo");
+  client.send("bar\n");
+  client.send("");
+  client.send("baz");
+  REQUIRE(wait_until([&] { return receiver->available() == 4; }));
+  CHECK_GREATER_EQUAL(notifications.load(), 1u);
+  std::istream in{receiver.get()};
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(in, line))
+    lines.push_back(line);
+  CHECK_EQUAL(lines, (std::vector<std::string>{"foo", "bar", "", "baz"}));
+  CHECK_EQUAL(receiver->available(), 0u);
+  CHECK_EQUAL(receiver->stats().received, 4u);
+  CHECK_EQUAL(receiver->stats().dropped, 0u);
+}
+
+TEST(truncation) {
+  auto truncating = unbox(
+    datagram_receiver::make(0, 16, 8, 1024 * 1024, [] {}));
+  sender client{truncating->port()};
+  client.send("0123456789");
+  REQUIRE(wait_until([&] { return truncating->available() == 1; }));
+  std::istream in{truncating.get()};
+  std::string line;
+  REQUIRE(std::getline(in, line));
+  CHECK_EQUAL(line, "01234567");
+  CHECK_EQUAL(truncating->stats().truncated, 1u);
+}
+
+TEST(multiple batches) {
+  // Stay well below the ring capacity and the socket receive buffer, such
+  // that no datagram gets dropped.
+  constexpr size_t num_datagrams = 64;
+  sender client{receiver->port()};
+  for (size_t i = 0; i < num_datagrams; ++i)
+    client.send("message " + std::to_string(i));
+  REQUIRE(wait_until([&] { return receiver->available() == num_datagrams; }));
+  CHECK_EQUAL(drain(*receiver), num_datagrams);
+  CHECK_EQUAL(receiver->stats().received, num_datagrams);
+  CHECK_EQUAL(receiver->stats().dropped, 0u);
+}
+
+TEST(full buffer) {
+  // With a ring of 16 datagrams and the smallest socket receive buffer that
+  // the kernel allows, a few hundred datagrams overflow the receiver.
+  constexpr size_t num_datagrams = 256;
+  auto sent = num_datagrams;
+  auto small = unbox(datagram_receiver::make(0, 16, 9216, 1, [] {}));
+  sender client{small->port()};
+  for (size_t i = 0; i < num_datagrams; ++i)
+    client.send("message " + std::to_string(i));
+  REQUIRE(wait_until([&] { return small->available() == 16; }));
+  auto lines = drain(*small);
+  lines += settle(*small, client, sent);
+  auto stats = small->stats();
+  MESSAGE("received " << stats.received << ", dropped " << stats.dropped);
+  CHECK_EQUAL(lines, stats.received);
+  CHECK_LESS(stats.received, num_datagrams);
+#if VAST_LINUX
+  CHECK_GREATER(stats.dropped, 0u);
+  CHECK_EQUAL(stats.received + stats.dropped, sent);
+#endif // VAST_LINUX
+}
+
+FIXTURE_SCOPE_END()
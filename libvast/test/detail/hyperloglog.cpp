@@ -0,0 +1,84 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE hyperloglog
+
+#include "vast/detail/hyperloglog.hpp"
+
+#include "vast/test/test.hpp"
+
+#include "vast/concept/hashable/uhash.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+
+using namespace vast;
+using namespace vast::detail;
+
+namespace {
+
+uint64_t digest(uint64_t x) {
+  return uhash<xxhash64>{}(x);
+}
+
+hyperloglog make_sketch(uint64_t first, uint64_t last,
+                        uint8_t precision = hyperloglog::default_precision) {
+  hyperloglog result{precision};
+  for (auto i = first; i < last; ++i)
+    result.add(digest(i));
+  return result;
+}
+
+} // namespace
+
+TEST(empty sketch) {
+  hyperloglog sketch;
+  CHECK_EQUAL(sketch.precision(), hyperloglog::default_precision);
+  CHECK_EQUAL(sketch.registers().size(), 4096u);
+  CHECK_EQUAL(sketch.estimate(), 0.0);
+}
+
+TEST(small cardinalities) {
+  auto sketch = make_sketch(0, 10);
+  CHECK_EQUAL(std::llround(sketch.estimate()), 10);
+  MESSAGE("duplicates do not change the estimate");
+  auto before = sketch;
+  for (uint64_t i = 0; i < 10; ++i)
+    sketch.add(digest(i));
+  CHECK_EQUAL(sketch, before);
+}
+
+TEST(large cardinalities) {
+  auto sketch = make_sketch(0, 100'000);
+  auto error = std::abs(sketch.estimate() - 100'000) / 100'000;
+  // The estimate lies within three standard errors with high probability.
+  CHECK_LESS(error, 3 * sketch.standard_error());
+}
+
+TEST(merge) {
+  auto x = make_sketch(0, 30'000);
+  auto y = make_sketch(20'000, 50'000);
+  x.merge(y);
+  CHECK_EQUAL(x, make_sketch(0, 50'000));
+}
+
+TEST(fold) {
+  auto sketch = make_sketch(0, 20'000);
+  for (auto precision : std::initializer_list<uint8_t>{12, 10, 8, 4}) {
+    auto folded = sketch.fold(precision);
+    CHECK_EQUAL(folded.precision(), precision);
+    CHECK_EQUAL(folded, make_sketch(0, 20'000, precision));
+  }
+}
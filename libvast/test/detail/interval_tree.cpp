@@ -0,0 +1,116 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE interval_tree
+
+#include "vast/detail/interval_tree.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace vast;
+using namespace vast::detail;
+
+namespace {
+
+auto overlapping(const interval_tree<int, int>& tree, int left, int right) {
+  std::vector<int> result;
+  tree.overlap(left, right, [&](const auto& x) { result.push_back(x.value); });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+} // namespace
+
+TEST(empty interval tree) {
+  interval_tree<int, int> tree;
+  CHECK(tree.empty());
+  CHECK_EQUAL(overlapping(tree, 0, 100), std::vector<int>{});
+}
+
+TEST(interval tree overlap) {
+  interval_tree<int, int> tree;
+  tree.insert(10, 20, 0);
+  tree.insert(0, 5, 1);
+  tree.insert(15, 15, 2);
+  tree.insert(30, 40, 3);
+  tree.insert(18, 35, 4);
+  CHECK_EQUAL(tree.size(), 5u);
+  CHECK_EQUAL(overlapping(tree, 15, 15), (std::vector<int>{0, 2}));
+  CHECK_EQUAL(overlapping(tree, 5, 10), (std::vector<int>{0, 1}));
+  CHECK_EQUAL(overlapping(tree, 21, 29), (std::vector<int>{4}));
+  CHECK_EQUAL(overlapping(tree, 41, 50), std::vector<int>{});
+  CHECK_EQUAL(overlapping(tree, 0, 100), (std::vector<int>{0, 1, 2, 3, 4}));
+  MESSAGE("empty query intervals match nothing");
+  CHECK_EQUAL(overlapping(tree, 20, 10), std::vector<int>{});
+}
+
+TEST(interval tree against linear scan) {
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> start{0, 10'000};
+  std::uniform_int_distribution<int> length{0, 500};
+  interval_tree<int, int> tree;
+  std::vector<std::pair<int, int>> intervals;
+  for (int i = 0; i < 1'000; ++i) {
+    auto left = start(gen);
+    auto right = left + length(gen);
+    intervals.emplace_back(left, right);
+    tree.insert(left, right, i);
+  }
+  auto check_queries = [&] {
+    for (int i = 0; i < 200; ++i) {
+      auto left = start(gen);
+      auto right = left + length(gen);
+      std::vector<int> expected;
+      for (int j = 0; j < static_cast<int>(intervals.size()); ++j)
+        if (intervals[j].first <= right && left <= intervals[j].second)
+          expected.push_back(j);
+      REQUIRE_EQUAL(overlapping(tree, left, right), expected);
+    }
+  };
+  check_queries();
+  MESSAGE("erase every third interval");
+  for (int i = 0; i < static_cast<int>(intervals.size()); i += 3) {
+    REQUIRE(tree.erase(intervals[i].first, i));
+    intervals[i] = {-2, -1};
+  }
+  CHECK_EQUAL(tree.size(), 666u);
+  CHECK(!tree.erase(intervals[0].first, 0));
+  check_queries();
+  MESSAGE("reinsert intervals into the freed nodes");
+  for (int i = 0; i < static_cast<int>(intervals.size()); i += 3) {
+    auto left = start(gen);
+    auto right = left + length(gen);
+    intervals[i] = {left, right};
+    tree.insert(left, right, i);
+  }
+  CHECK_EQUAL(tree.size(), 1'000u);
+  check_queries();
+}
+
+TEST(interval tree with equal left endpoints) {
+  interval_tree<int, int> tree;
+  for (int i = 0; i < 10; ++i)
+    tree.insert(5, 5 + i, i);
+  CHECK(tree.erase(5, 7));
+  CHECK(!tree.erase(5, 7));
+  CHECK(!tree.erase(6, 8));
+  CHECK_EQUAL(overlapping(tree, 12, 20), (std::vector<int>{8, 9}));
+  CHECK_EQUAL(overlapping(tree, 11, 11), (std::vector<int>{6, 8, 9}));
+  tree.clear();
+  CHECK(tree.empty());
+  CHECK_EQUAL(overlapping(tree, 0, 100), std::vector<int>{});
+}
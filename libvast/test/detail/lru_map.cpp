@@ -0,0 +1,74 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE lru_map
+#include "vast/detail/lru_map.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <string>
+
+using vast::detail::lru_map;
+
+namespace {
+
+auto make_string = [](int x) { return std::to_string(x); };
+
+} // namespace
+
+TEST(touching) {
+  lru_map<int, std::string> xs;
+  CHECK(xs.empty());
+  CHECK(xs.touch(1, make_string).second);
+  CHECK(xs.touch(2, make_string).second);
+  CHECK(xs.touch(3, make_string).second);
+  CHECK_EQUAL(xs.size(), 3u);
+  CHECK_EQUAL(xs.oldest().first, 1);
+  // Touching an existing entry marks it as most recently used.
+  auto [value, inserted] = xs.touch(1, make_string);
+  CHECK(!inserted);
+  CHECK_EQUAL(value, "1");
+  CHECK_EQUAL(xs.oldest().first, 2);
+  // Finding an entry does not change the order.
+  REQUIRE(xs.find(2) != nullptr);
+  CHECK_EQUAL(*xs.find(2), "2");
+  CHECK_EQUAL(xs.oldest().first, 2);
+  CHECK(xs.find(4) == nullptr);
+}
+
+TEST(eviction) {
+  lru_map<int, std::string> xs;
+  for (auto i = 0; i < 10; ++i)
+    xs.touch(i, make_string);
+  xs.touch(0, make_string);
+  xs.touch(5, make_string);
+  auto evicted = std::vector<int>{};
+  while (xs.size() > 2) {
+    evicted.push_back(xs.oldest().first);
+    xs.pop_oldest();
+  }
+  CHECK_EQUAL(evicted, (std::vector<int>{1, 2, 3, 4, 6, 7, 8, 9}));
+  CHECK_EQUAL(xs.oldest().first, 0);
+  CHECK(xs.erase(0));
+  CHECK(!xs.erase(0));
+  CHECK_EQUAL(xs.oldest().first, 5);
+  CHECK_EQUAL(xs.oldest().second, "5");
+  // Erased slots get reused.
+  CHECK(xs.touch(42, make_string).second);
+  CHECK_EQUAL(xs.size(), 2u);
+  CHECK_EQUAL(*xs.find(42), "42");
+  xs.clear();
+  CHECK(xs.empty());
+  CHECK(xs.touch(7, make_string).second);
+  CHECK_EQUAL(xs.oldest().first, 7);
+}
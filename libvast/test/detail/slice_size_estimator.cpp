@@ -0,0 +1,80 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE slice_size_estimator
+
+#include "vast/detail/slice_size_estimator.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+using namespace vast;
+using namespace vast::detail;
+
+namespace {
+
+struct fixture {
+  slice_size_estimator::clock::time_point start
+    = slice_size_estimator::clock::now();
+
+  slice_size_estimator make(size_t initial = 1000,
+                            slice_size_estimator::clock::duration fill_time
+                            = 5s) {
+    return slice_size_estimator{initial, 128, 65'536, fill_time, start};
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(slice_size_estimator_tests, fixture)
+
+TEST(initial size) {
+  CHECK_EQUAL(make(1000).size(), 1000u);
+  CHECK_EQUAL(make(10).size(), 128u);
+  CHECK_EQUAL(make(1'000'000).size(), 65'536u);
+}
+
+TEST(sample interval) {
+  auto x = make();
+  CHECK_EQUAL(x.observe(5000, start + 500ms), 1000u);
+  CHECK_EQUAL(x.rate(), 0.0);
+  // 6000 events in one second fill 30000 events in five seconds.
+  CHECK_EQUAL(x.observe(1000, start + 1s), 32'768u);
+  CHECK_EQUAL(x.rate(), 6000.0);
+}
+
+TEST(bounds) {
+  auto high = make();
+  CHECK_EQUAL(high.observe(100'000, start + 1s), 65'536u);
+  auto low = make();
+  CHECK_EQUAL(low.observe(10, start + 1s), 128u);
+  auto idle = make();
+  CHECK_EQUAL(idle.observe(0, start + 1s), 128u);
+}
+
+TEST(smoothing) {
+  auto x = make();
+  CHECK_EQUAL(x.observe(1000, start + 1s), 8192u);
+  // The moving average of 1000 and 3000 events per second is 2000.
+  CHECK_EQUAL(x.observe(3000, start + 2s), 16'384u);
+  CHECK_EQUAL(x.rate(), 2000.0);
+}
+
+TEST(short fill time) {
+  auto x = make(1000, 200ms);
+  CHECK_EQUAL(x.observe(400, start + 200ms), 512u);
+}
+
+FIXTURE_SCOPE_END()
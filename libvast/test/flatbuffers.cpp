@@ -28,6 +28,7 @@
 #include "vast/system/index.hpp"
 #include "vast/system/partition.hpp"
 #include "vast/system/posix_filesystem.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/table_slice_builder_factory.hpp"
 #include "vast/type.hpp"
@@ -57,9 +58,9 @@ TEST(uuid roundtrip) {
 
 TEST(index roundtrip) {
   vast::system::index_state state(/*self = */ nullptr);
-  // The active partition is not supposed to appear in the
+  // The active partitions are not supposed to appear in the
   // created flatbuffer
-  state.active_partition.id = vast::uuid::random();
+  state.active_partitions[0].id = vast::uuid::random();
   // Both unpersisted and persisted partitions should show up in the created
   // flatbuffer.
   state.unpersisted[vast::uuid::random()] = nullptr;
@@ -185,7 +186,8 @@ TEST(full partition roundtrip) {
     directory); // `directory` is provided by the unit test fixture
   auto partition_uuid = vast::uuid::random();
   auto partition = sys.spawn(vast::system::active_partition, partition_uuid, fs,
-                             caf::settings{}, caf::settings{});
+                             caf::settings{}, caf::settings{},
+                             vast::system::accountant_actor{});
   run();
   REQUIRE(partition);
   // Add data to the partition.
@@ -214,8 +216,10 @@ TEST(full partition roundtrip) {
   self->send_exit(partition, caf::exit_reason::user_shutdown);
   // Spawn a read-only partition from this chunk and try to query the data we
   // added. We make two queries, one "#type"-query and one "normal" query
-  auto readonly_partition = sys.spawn(vast::system::passive_partition,
-                                      partition_uuid, fs, persist_path);
+  auto readonly_partition
+    = sys.spawn(vast::system::passive_partition, partition_uuid, fs,
+                persist_path,
+                std::shared_ptr<vast::system::query_result_cache>{});
   REQUIRE(readonly_partition);
   run();
   // A minimal `partition_client_actor`that stores the results in a local
@@ -224,6 +228,9 @@ TEST(full partition roundtrip) {
     -> vast::system::partition_client_actor::behavior_type {
     return {
       [ids](const vast::ids& hits) { *ids |= hits; },
+      [](vast::atom::trace, const vast::system::query_trace&) {
+        // nop
+      },
     };
   };
   auto test_expression
@@ -20,6 +20,7 @@
 #  include "vast/format/arrow.hpp"
 
 #  include "vast/test/fixtures/events.hpp"
+#  include "vast/test/fixtures/filesystem.hpp"
 #  include "vast/test/test.hpp"
 
 #  include "vast/arrow_table_slice.hpp"
@@ -32,12 +33,15 @@
 #  include "vast/detail/narrow.hpp"
 #  include "vast/table_slice.hpp"
 
+#  include <caf/settings.hpp>
 #  include <caf/sum_type.hpp>
 
 #  include <arrow/api.h>
+#  include <arrow/io/file.h>
 #  include <arrow/io/memory.h>
 #  include <arrow/ipc/reader.h>
 
+#  include <fstream>
 #  include <utility>
 
 using caf::get;
@@ -48,8 +52,15 @@ using namespace vast;
 
 #define REQUIRE_OK(expr) REQUIRE(expr.ok());
 
-// Needed to initialize the table slice builder factories.
-FIXTURE_SCOPE(arrow_tests, fixtures::events)
+namespace {
+
+// The events fixture is needed to initialize the table slice builder
+// factories.
+struct fixture : fixtures::events, fixtures::filesystem {};
+
+} // namespace
+
+FIXTURE_SCOPE(arrow_tests, fixture)
 
 TEST(arrow batch) {
   // Create a writer with a buffered output stream.
@@ -94,6 +105,79 @@ TEST(arrow batch) {
   CHECK_EQUAL(slice_id, zeek_conn_log.size());
 }
 
+TEST(arrow directory) {
+  auto dir = directory / "arrow";
+  {
+    caf::settings options;
+    caf::put(options, "vast.export.arrow.directory", dir.str());
+    caf::put(options, "vast.export.arrow.batch-size", size_t{1'000'000});
+    format::arrow::writer writer{options};
+    // Interleave the layouts to check that the writer keeps a file per layout
+    // open and coalesces all slices of a layout into a single batch.
+    for (size_t i = 0; i < std::max(zeek_conn_log.size(), zeek_dns_log.size());
+         ++i) {
+      if (i < zeek_conn_log.size())
+        REQUIRE_EQUAL(writer.write(zeek_conn_log[i]), caf::none);
+      if (i < zeek_dns_log.size())
+        REQUIRE_EQUAL(writer.write(zeek_dns_log[i]), caf::none);
+    }
+    // The destructor writes all buffered slices and closes the files.
+  }
+  auto check = [&](const std::string& filename,
+                   const std::vector<table_slice>& slices) {
+    auto file = arrow::io::ReadableFile::Open((dir / filename).str());
+    REQUIRE_OK(file);
+    auto reader = arrow::ipc::RecordBatchFileReader::Open(file->get());
+    REQUIRE_OK(reader);
+    REQUIRE_EQUAL((*reader)->num_record_batches(), 1);
+    auto batch = (*reader)->ReadRecordBatch(0);
+    REQUIRE_OK(batch);
+    CHECK_EQUAL(detail::narrow<size_t>((*batch)->num_rows()), rows(slices));
+    CHECK((*batch)->schema()->Equals(
+      *make_arrow_schema(flatten(slices[0].layout()))));
+    auto slice = arrow_table_slice_builder::create(**batch,
+                                                   flatten(slices[0].layout()));
+    CHECK_EQUAL(slice.at(0, 1), slices[0].at(0, 1));
+  };
+  check("zeek.conn.arrow", zeek_conn_log);
+  check("zeek.dns.arrow", zeek_dns_log);
+}
+
+TEST(arrow directory refuses to overwrite files) {
+  auto dir = directory / "arrow";
+  REQUIRE_EQUAL(mkdir(dir), caf::none);
+  {
+    std::ofstream existing{(dir / "zeek.conn.arrow").str()};
+    existing << "foo";
+  }
+  caf::settings options;
+  caf::put(options, "vast.export.arrow.directory", dir.str());
+  caf::put(options, "vast.export.arrow.batch-size", size_t{1});
+  format::arrow::writer writer{options};
+  CHECK_NOT_EQUAL(writer.write(zeek_conn_log[0]), caf::none);
+  CHECK_EQUAL(unbox(file_size(dir / "zeek.conn.arrow")), 3u);
+}
+
+TEST(arrow buffer limit) {
+  auto dir = directory / "arrow";
+  {
+    caf::settings options;
+    caf::put(options, "vast.export.arrow.directory", dir.str());
+    caf::put(options, "vast.export.arrow.batch-size", size_t{1'000'000});
+    caf::put(options, "vast.export.arrow.max-buffered-bytes", size_t{1});
+    format::arrow::writer writer{options};
+    for (auto& slice : zeek_conn_log)
+      REQUIRE_EQUAL(writer.write(slice), caf::none);
+  }
+  // The limit forces a record batch per slice despite the batch size.
+  auto file = arrow::io::ReadableFile::Open((dir / "zeek.conn.arrow").str());
+  REQUIRE_OK(file);
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(file->get());
+  REQUIRE_OK(reader);
+  CHECK_EQUAL(detail::narrow<size_t>((*reader)->num_record_batches()),
+              zeek_conn_log.size());
+}
+
 FIXTURE_SCOPE_END()
 
 #endif // VAST_ENABLE_ARROW
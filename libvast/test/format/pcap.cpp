@@ -30,6 +30,10 @@
 #  include "vast/table_slice.hpp"
 #  include "vast/table_slice_column.hpp"
 
+#  include <algorithm>
+#  include <string>
+#  include <vector>
+
 using namespace vast;
 
 namespace {
@@ -61,6 +65,30 @@ std::string_view community_ids[] = {
   "1:zjGM746aZkpYb2mVIlsgLrUG59k=", "1:zjGM746aZkpYb2mVIlsgLrUG59k=",
 };
 
+// Reads the whole trace and returns the Community IDs of all packets in
+// lexicographical order, which makes the result independent of the order in
+// which the shards of a multi-threaded reader deliver their table slices.
+std::vector<std::string> read_community_ids(caf::settings settings) {
+  caf::put(settings, "vast.import.read", artifacts::traces::nmap_vsn);
+  caf::put(settings, "vast.import.batch-timeout", "0s");
+  format::pcap::reader reader{std::move(settings)};
+  std::vector<std::string> result;
+  auto add_slice = [&](const table_slice& x) {
+    auto column = table_slice_column::make(x, "community_id");
+    REQUIRE(column);
+    for (size_t row = 0; row < x.rows(); ++row)
+      result.emplace_back(caf::get<view<std::string>>((*column)[row]));
+  };
+  auto [err, produced] = reader.read(std::numeric_limits<size_t>::max(), 100,
+                                     add_slice);
+  while (!err)
+    std::tie(err, produced) = reader.read(
+      std::numeric_limits<size_t>::max(), 100, add_slice);
+  CHECK_EQUAL(err, ec::end_of_input);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
 } // namespace
 
 // Technically, we don't need the actor system. However, we do need to
@@ -145,6 +173,51 @@ TEST(PCAP read/write 2) {
   REQUIRE_EQUAL(writer.write(slice), caf::none);
 }
 
+TEST(PCAP sharded read) {
+  caf::settings settings;
+  caf::put(settings, "vast.import.pcap.cutoff", static_cast<uint64_t>(-1));
+  auto sharded = settings;
+  caf::put(sharded, "vast.import.pcap.shards", size_t{4});
+  MESSAGE("read all packets with 4 shards");
+  auto expected = std::vector<std::string>(std::begin(community_ids),
+                                           std::end(community_ids));
+  std::sort(expected.begin(), expected.end());
+  CHECK_EQUAL(read_community_ids(settings), expected);
+  CHECK_EQUAL(read_community_ids(sharded), expected);
+  MESSAGE("apply the cutoff per flow with 4 shards");
+  caf::put(settings, "vast.import.pcap.cutoff", static_cast<uint64_t>(64));
+  caf::put(sharded, "vast.import.pcap.cutoff", static_cast<uint64_t>(64));
+  auto truncated = read_community_ids(settings);
+  CHECK_EQUAL(truncated.size(), 36u);
+  CHECK_EQUAL(read_community_ids(sharded), truncated);
+}
+
+TEST(PCAP sharded read with max events) {
+  caf::settings settings;
+  caf::put(settings, "vast.import.read", artifacts::traces::nmap_vsn);
+  caf::put(settings, "vast.import.pcap.cutoff", static_cast<uint64_t>(-1));
+  caf::put(settings, "vast.import.pcap.shards", size_t{4});
+  caf::put(settings, "vast.import.batch-timeout", "0s");
+  format::pcap::reader reader{std::move(settings)};
+  size_t rows = 0;
+  auto add_slice = [&](const table_slice& x) {
+    rows += x.rows();
+  };
+  // The trace has 44 packets, so we expect four full reads of 10 events and
+  // one read of the remaining 4 events that also reaches the end of the input.
+  std::vector<size_t> reads;
+  while (true) {
+    auto [err, produced] = reader.read(10, 100, add_slice);
+    CHECK_LESS_EQUAL(produced, 10u);
+    reads.push_back(produced);
+    if (err == ec::end_of_input)
+      break;
+    REQUIRE_EQUAL(err, caf::none);
+  }
+  CHECK_EQUAL(reads, (std::vector<size_t>{10, 10, 10, 10, 4}));
+  CHECK_EQUAL(rows, 44u);
+}
+
 FIXTURE_SCOPE_END()
 
 #endif // VAST_ENABLE_PCAP
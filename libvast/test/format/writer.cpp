@@ -11,11 +11,12 @@
  * contained in the LICENSE file.                                             *
  ******************************************************************************/
 
+#include "vast/config.hpp"
 #include "vast/detail/string.hpp"
-
 #include "vast/format/ascii.hpp"
 #include "vast/format/csv.hpp"
 #include "vast/format/json.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
 
 #define SUITE format
 #include "vast/test/fixtures/events.hpp"
@@ -75,4 +76,43 @@ TEST(JSON writer) {
   CHECK_EQUAL(lines.front(), first_zeek_conn_log_line);
 }
 
+TEST(JSON writer - nested records) {
+  auto layout = record_type{
+    {"a", count_type{}},
+    {"r", record_type{{"b", string_type{}}, {"c", real_type{}}}},
+    {"e", enumeration_type{{"foo", "bar"}}},
+  }.name("nested");
+  auto builder = msgpack_table_slice_builder::make(layout);
+  CHECK(builder->add(count{1}, std::string_view{"x\"y"}, real{0.5},
+                     enumeration{1}));
+  CHECK(builder->add(caf::none, caf::none, real{-2.0}, enumeration{0}));
+  auto lines = generate<format::json::writer>({builder->finish()});
+  REQUIRE_EQUAL(lines.size(), 3u);
+  CHECK_EQUAL(lines[0],
+              R"__({"a": 1, "r": {"b": "x\"y", "c": 0.5}, "e": "bar"})__");
+  CHECK_EQUAL(lines[1],
+              R"__({"a": null, "r": {"b": null, "c": -2}, "e": "foo"})__");
+}
+
+#if VAST_ENABLE_ARROW
+
+TEST(writers produce identical output for all encodings) {
+  auto to_arrow = [](const std::vector<table_slice>& xs) {
+    auto result = std::vector<table_slice>{};
+    for (const auto& x : xs)
+      result.push_back(rebuild(x, table_slice_encoding::arrow));
+    return result;
+  };
+  auto http = to_arrow(zeek_http_log);
+  auto conn = to_arrow(zeek_conn_log);
+  CHECK_EQUAL(generate<format::ascii::writer>(http),
+              generate<format::ascii::writer>(zeek_http_log));
+  CHECK_EQUAL(generate<format::csv::writer>(http),
+              generate<format::csv::writer>(zeek_http_log));
+  CHECK_EQUAL(generate<format::json::writer>(conn),
+              generate<format::json::writer>(zeek_conn_log));
+}
+
+#endif // VAST_ENABLE_ARROW
+
 FIXTURE_SCOPE_END()
@@ -0,0 +1,128 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE layout_interner
+
+#include "vast/layout_interner.hpp"
+
+#include "vast/test/test.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
+#include "vast/msgpack_table_slice_builder.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/type.hpp"
+
+#include <caf/binary_serializer.hpp>
+
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+auto make_layout(std::string name) {
+  return record_type{
+    {"x", count_type{}},
+    {"y", record_type{{"a", address_type{}}, {"b", string_type{}}}},
+  }
+    .name(std::move(name));
+}
+
+std::vector<char> serialize(const record_type& layout) {
+  auto buf = std::vector<char>{};
+  caf::binary_serializer sink{nullptr, buf};
+  REQUIRE_EQUAL(sink(layout), caf::none);
+  return buf;
+}
+
+} // namespace
+
+TEST(empty layout) {
+  auto& interner = layout_interner::instance();
+  const auto& empty = interner.intern(record_type{});
+  CHECK_EQUAL(empty.id, 0u);
+  CHECK_EQUAL(&interner.at(0), &empty);
+  CHECK_EQUAL(table_slice{}.interned().id, 0u);
+}
+
+TEST(stable ids) {
+  auto& interner = layout_interner::instance();
+  const auto& foo = interner.intern(make_layout("foo"));
+  const auto& bar = interner.intern(make_layout("bar"));
+  CHECK_NOT_EQUAL(foo.id, bar.id);
+  CHECK_EQUAL(&interner.intern(make_layout("foo")), &foo);
+  CHECK_EQUAL(&interner.at(bar.id), &bar);
+  CHECK_EQUAL(foo.layout, make_layout("foo"));
+  CHECK_EQUAL(foo.flat_layout, flatten(make_layout("foo")));
+  CHECK_EQUAL(foo.layout_type, type{make_layout("foo")});
+  CHECK_EQUAL(foo.flat_layout.fields.size(), 3u);
+}
+
+TEST(intern serialized layout) {
+  auto& interner = layout_interner::instance();
+  auto buf = serialize(make_layout("baz"));
+  auto bytes = span{reinterpret_cast<const std::byte*>(buf.data()), buf.size()};
+  auto x = unbox(interner.intern(bytes));
+  CHECK_EQUAL(x->layout, make_layout("baz"));
+  CHECK_EQUAL(unbox(interner.intern(bytes)), x);
+  CHECK_EQUAL(&interner.intern(make_layout("baz")), x);
+  auto garbage = std::vector<std::byte>(3, std::byte{0xff});
+  CHECK(!interner.intern(span{garbage.data(), garbage.size()}));
+}
+
+TEST(intern serialized layout with known layout) {
+  auto& interner = layout_interner::instance();
+  auto layout = make_layout("quux");
+  auto buf = serialize(layout);
+  auto bytes = span{reinterpret_cast<const std::byte*>(buf.data()), buf.size()};
+  const auto& x = interner.intern(bytes, layout);
+  CHECK_EQUAL(x.layout, layout);
+  CHECK_EQUAL(&interner.intern(bytes, layout), &x);
+  CHECK_EQUAL(unbox(interner.intern(bytes)), &x);
+  CHECK_EQUAL(&interner.intern(layout), &x);
+}
+
+TEST(table slices share interned layouts) {
+  auto layout = make_layout("qux");
+  auto builder = msgpack_table_slice_builder::make(layout);
+  REQUIRE(builder);
+  CHECK(builder->add(42u, unbox(to<address>("10.0.0.1")), "foo"));
+  auto slice = builder->finish();
+  auto copy
+    = table_slice{chunk::copy(as_bytes(slice)), table_slice::verify::yes};
+  const auto& interned = layout_interner::instance().intern(layout);
+  CHECK_EQUAL(&slice.interned(), &interned);
+  CHECK_EQUAL(&copy.interned(), &interned);
+  CHECK_EQUAL(copy.layout(), layout);
+}
+
+TEST(layout table) {
+  layout_table<int> table;
+  CHECK(table.empty());
+  CHECK_EQUAL(table.find(3), nullptr);
+  table.insert(3, 42);
+  table.insert(1, 7);
+  CHECK_EQUAL(table.size(), 2u);
+  CHECK_EQUAL(*table.find(3), 42);
+  CHECK_EQUAL(*table.find(1), 7);
+  CHECK_EQUAL(table.find(2), nullptr);
+  CHECK_EQUAL(table.find(100), nullptr);
+  table.insert(3, 43);
+  CHECK_EQUAL(table.size(), 2u);
+  CHECK_EQUAL(*table.find(3), 43);
+  table.clear();
+  CHECK(table.empty());
+  CHECK_EQUAL(table.find(3), nullptr);
+}
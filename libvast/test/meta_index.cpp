@@ -22,6 +22,8 @@
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/overload.hpp"
+#include "vast/fbs/utils.hpp"
+#include "vast/flatbuffer_synopsis.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/table_slice.hpp"
@@ -29,6 +31,10 @@
 #include "vast/uuid.hpp"
 #include "vast/view.hpp"
 
+#include <flatbuffers/flatbuffers.h>
+
+#include <cmath>
+
 using namespace vast;
 
 using std::literals::operator""s;
@@ -221,6 +227,41 @@ TEST(attribute extractor - type) {
   CHECK_EQUAL(lookup("#type !~ /x/"), ids);
 }
 
+TEST(time index) {
+  MESSAGE("disjunctions of time ranges");
+  auto outer = std::vector<uuid>{ids[0], ids[3]};
+  CHECK_EQUAL(lookup("#timestamp < 1970-01-01+00:00:10.0"
+                     " || #timestamp > 1970-01-01+00:01:30.0"),
+              outer);
+  MESSAGE("time ranges combined with other predicates");
+  auto expected = std::vector<uuid>{ids[2]};
+  CHECK_EQUAL(lookup("#timestamp >= 1970-01-01+00:00:30.0 && #type == \"foo\""),
+              expected);
+  CHECK_EQUAL(lookup("#timestamp >= 1970-01-01+00:00:30.0"
+                     " && #timestamp < 1970-01-01+00:00:20.0"),
+              empty());
+  MESSAGE("partitions without time bounds always qualify");
+  auto unbounded = uuid::random();
+  auto ps = partition_synopsis{};
+  auto field = record_field{"ts", time_type{}.attributes({{"timestamp"}})};
+  ps.field_synopses_[qualified_record_field{"unbounded", field}] = nullptr;
+  meta_idx.merge(unbounded, std::move(ps));
+  auto untimed = uuid::random();
+  ps = partition_synopsis{};
+  ps.field_synopses_[qualified_record_field{"untimed", {"x", bool_type{}}}]
+    = nullptr;
+  meta_idx.merge(untimed, std::move(ps));
+  expected = std::vector<uuid>{unbounded};
+  CHECK_EQUAL(attr_time_query("00:10:00"), expected);
+  expected = std::vector<uuid>{ids[1], unbounded};
+  std::sort(expected.begin(), expected.end());
+  CHECK_EQUAL(attr_time_query("00:00:30"), expected);
+  MESSAGE("erased partitions no longer qualify");
+  meta_idx.erase(unbounded);
+  CHECK_EQUAL(attr_time_query("00:10:00"), empty());
+  CHECK_EQUAL(attr_time_query("00:00:30"), slice(1));
+}
+
 TEST(meta index with bool synopsis) {
   MESSAGE("generate slice data and add it to the meta index");
   meta_index meta_idx;
@@ -270,4 +311,173 @@ TEST(meta index with bool synopsis) {
   CHECK_EQUAL(lookup("y != T"), none);
 }
 
+TEST(meta index with lazily unpacked synopses) {
+  MESSAGE("generate a partition synopsis with min-max and Bloom filters");
+  auto layout = record_type{{"ts", time_type{}.attributes({{"timestamp"}})},
+                            {"addr", address_type{}},
+                            {"flag", bool_type{}},
+                            {"s", string_type{}}}
+                  .name("lazy");
+  auto builder = factory<table_slice_builder>::make(
+    defaults::import::table_slice_type, layout);
+  REQUIRE(builder);
+  for (size_t i = 0; i < 10; ++i) {
+    CHECK(builder->add(make_data_view(epoch + std::chrono::seconds(i))));
+    auto addr = unbox(to<address>("10.0.0." + std::to_string(i)));
+    CHECK(builder->add(make_data_view(addr)));
+    CHECK(builder->add(make_data_view(true)));
+    CHECK(builder->add(make_data_view("foo" + std::to_string(i))));
+  }
+  auto slice = builder->finish();
+  REQUIRE(slice.encoding() != table_slice_encoding::none);
+  auto synopsis_opts = caf::settings{};
+  caf::put(synopsis_opts, "max-partition-size", 10);
+  auto eager = partition_synopsis{};
+  eager.add(slice, synopsis_opts);
+  MESSAGE("pack the partition synopsis with native Bloom filters");
+  eager.native_bloom_filters_ = true;
+  flatbuffers::FlatBufferBuilder fbb;
+  auto ps_offset = unbox(pack(fbb, eager));
+  fbs::PartitionSynopsisBuilder ps_builder(fbb);
+  ps_builder.add_partition_synopsis_type(
+    fbs::partition_synopsis::PartitionSynopsis::v0);
+  ps_builder.add_partition_synopsis(ps_offset.Union());
+  fbs::FinishPartitionSynopsisBuffer(fbb, ps_builder.Finish());
+  auto chunk = fbs::release(fbb);
+  MESSAGE("unpack the partition synopsis lazily");
+  auto lazy = partition_synopsis{};
+  auto error = unpack_lazily(chunk, lazy);
+  REQUIRE(!error);
+  REQUIRE_EQUAL(lazy.field_synopses_.size(), eager.field_synopses_.size());
+  for (auto& [field, syn] : lazy.field_synopses_)
+    if (syn)
+      CHECK(dynamic_cast<flatbuffer_synopsis*>(syn.get()));
+  MESSAGE("compare lookups against the eagerly unpacked synopsis");
+  auto id = uuid::random();
+  meta_index eager_idx;
+  eager_idx.merge(id, std::move(eager));
+  meta_index lazy_idx;
+  lazy_idx.merge(id, std::move(lazy));
+  auto expected = std::vector<uuid>{id};
+  auto none = std::vector<uuid>{};
+  auto check = [&](std::string_view expr, const std::vector<uuid>& xs) {
+    auto query = unbox(to<expression>(expr));
+    CHECK_EQUAL(eager_idx.lookup(query), xs);
+    CHECK_EQUAL(lazy_idx.lookup(query), xs);
+  };
+  check("#timestamp <= 1970-01-01+00:00:05.0", expected);
+  check("#timestamp > 1970-01-01+00:01:00.0", none);
+  check("flag == T", expected);
+  check("flag == F", none);
+  check("addr == 10.0.0.3", expected);
+  check("addr == 192.168.0.1", none);
+  check("s == \"foo7\"", expected);
+  check("s == \"bar\"", none);
+  check("s in [\"bar\", \"foo1\"]", expected);
+}
+
+TEST(Bloom filter synopses default to the opaque layout) {
+  auto layout = record_type{{"addr", address_type{}}, {"s", string_type{}}}
+                  .name("opaque");
+  auto builder = factory<table_slice_builder>::make(
+    defaults::import::table_slice_type, layout);
+  REQUIRE(builder);
+  CHECK(builder->add(make_data_view(unbox(to<address>("10.0.0.1")))));
+  CHECK(builder->add(make_data_view("foo")));
+  auto slice = builder->finish();
+  auto synopsis_opts = caf::settings{};
+  caf::put(synopsis_opts, "max-partition-size", 1);
+  auto ps = partition_synopsis{};
+  ps.add(slice, synopsis_opts);
+  flatbuffers::FlatBufferBuilder fbb;
+  auto ps_offset = unbox(pack(fbb, ps));
+  fbs::PartitionSynopsisBuilder ps_builder(fbb);
+  ps_builder.add_partition_synopsis_type(
+    fbs::partition_synopsis::PartitionSynopsis::v0);
+  ps_builder.add_partition_synopsis(ps_offset.Union());
+  fbs::FinishPartitionSynopsisBuffer(fbb, ps_builder.Finish());
+  auto chunk = fbs::release(fbb);
+  auto packed = fbs::GetPartitionSynopsis(chunk->data());
+  auto synopses = packed->partition_synopsis_as_v0()->synopses();
+  REQUIRE(synopses);
+  size_t opaque = 0;
+  for (auto synopsis : *synopses) {
+    CHECK(!synopsis->bloom_filter_synopsis());
+    opaque += synopsis->opaque_synopsis() != nullptr;
+  }
+  CHECK_GREATER_EQUAL(opaque, 2u);
+}
+
+TEST(meta index estimates) {
+  auto make_slice = [](std::string name, std::string field, type t,
+                       uint64_t first, uint64_t last, uint64_t modulo) {
+    auto layout = record_type{{std::move(field), std::move(t)}}.name(name);
+    auto builder = factory<table_slice_builder>::make(
+      defaults::import::table_slice_type, layout);
+    REQUIRE(builder);
+    for (auto i = first; i < last; ++i) {
+      if (caf::holds_alternative<count_type>(layout.fields[0].type))
+        CHECK(builder->add(make_data_view(count{i % modulo})));
+      else
+        CHECK(builder->add(make_data_view("x")));
+    }
+    return builder->finish();
+  };
+  auto synopsis_opts = caf::settings{};
+  caf::put(synopsis_opts, "max-partition-size", 2000);
+  caf::put(synopsis_opts, "cardinality-sketch-precision", 12);
+  MESSAGE("build partition synopses with event counts and sketches");
+  auto ps1 = partition_synopsis{};
+  ps1.add(make_slice("est.a", "key", count_type{}, 0, 1000, 100),
+          synopsis_opts);
+  ps1.add(make_slice("est.b", "other", string_type{}, 0, 50, 1),
+          synopsis_opts);
+  auto ps2 = partition_synopsis{};
+  ps2.add(make_slice("est.a", "key", count_type{}, 50, 550, 1000),
+          synopsis_opts);
+  CHECK_EQUAL(ps1.layout_counts_["est.a"], 1000u);
+  CHECK_EQUAL(ps1.layout_counts_["est.b"], 50u);
+  CHECK_EQUAL(ps1.field_sketches_.size(), 2u);
+  MESSAGE("round-trip a partition synopsis through its FlatBuffer");
+  flatbuffers::FlatBufferBuilder fbb;
+  auto ps_offset = unbox(pack(fbb, ps1));
+  fbs::PartitionSynopsisBuilder ps_builder(fbb);
+  ps_builder.add_partition_synopsis_type(
+    fbs::partition_synopsis::PartitionSynopsis::v0);
+  ps_builder.add_partition_synopsis(ps_offset.Union());
+  fbs::FinishPartitionSynopsisBuffer(fbb, ps_builder.Finish());
+  auto unpacked = partition_synopsis{};
+  REQUIRE(!unpack_lazily(fbs::release(fbb), unpacked));
+  CHECK_EQUAL(unpacked.layout_counts_, ps1.layout_counts_);
+  CHECK_EQUAL(unpacked.field_sketches_, ps1.field_sketches_);
+  MESSAGE("estimate counts and distinct counts");
+  meta_index meta_idx;
+  auto id1 = uuid::random();
+  auto id2 = uuid::random();
+  meta_idx.merge(id1, std::move(unpacked));
+  meta_idx.merge(id2, std::move(ps2));
+  auto num_events = [&](std::string_view expr) {
+    return meta_idx.count_upper_bound(unbox(to<expression>(expr)));
+  };
+  CHECK_EQUAL(num_events("#type == \"est.a\""), 1500u);
+  CHECK_EQUAL(num_events("#type == \"est.b\""), 50u);
+  CHECK_EQUAL(num_events("#type != \"est.b\""), 1500u);
+  CHECK_EQUAL(num_events("other == \"x\""), 50u);
+  CHECK_EQUAL(num_events("key == 10"), 1000u);
+  CHECK_EQUAL(num_events("key == 500"), 500u);
+  CHECK_EQUAL(num_events("key == 5000"), 0u);
+  auto distinct = [&](std::string_view expr, std::string_view field) {
+    auto x = unbox(to<expression>(expr));
+    return meta_idx.distinct_upper_bound(x, field);
+  };
+  // Both partitions together contain the keys 0 to 549.
+  auto keys = unbox(distinct("#type == \"est.a\"", "key"));
+  CHECK_LESS(std::abs(keys - 550), 550 * 0.05);
+  // Only the second partition contains keys above 200, namely 50 to 549.
+  keys = unbox(distinct("key > 200", "key"));
+  CHECK_LESS(std::abs(keys - 500), 500 * 0.05);
+  CHECK_EQUAL(std::llround(unbox(distinct("other == \"x\"", "other"))), 1);
+  CHECK(!distinct("#type == \"est.a\"", "nope"));
+}
+
 FIXTURE_SCOPE_END()
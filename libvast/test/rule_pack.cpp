@@ -0,0 +1,113 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE rule_pack
+
+#include "vast/rule_pack.hpp"
+
+#include "vast/test/fixtures/events.hpp"
+#include "vast/test/test.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/table_slice.hpp"
+
+using namespace vast;
+
+namespace {
+
+struct fixture : fixtures::events {
+  static rule_pack::rule make_rule(std::string name, std::string_view str) {
+    return {std::move(name), unbox(to<expression>(str))};
+  }
+
+  /// Evaluates a single rule on its own, as a separate query would.
+  static size_t evaluate_alone(const expression& expr,
+                               const table_slice& slice) {
+    auto tailored = unbox(tailor(normalize(expr), slice.layout()));
+    if (caf::holds_alternative<caf::none_t>(tailored))
+      return 0;
+    return rank(evaluate(tailored, slice));
+  }
+
+  std::vector<rule_pack::rule> rules = {
+    make_rule("broadcast", "resp_h == 192.168.1.255"),
+    make_rule("broadcast udp", "resp_h == 192.168.1.255 && proto == \"udp\""),
+    make_rule("no broadcast", "! (resp_h == 192.168.1.255)"),
+    make_rule("udp or icmp", "proto == \"udp\" || proto == \"icmp\""),
+    make_rule("missing field", "no_such_field == 42"),
+  };
+};
+
+} // namespace
+
+FIXTURE_SCOPE(rule_pack_tests, fixture)
+
+TEST(deduplicated predicates) {
+  auto pack = unbox(rule_pack::make(rules));
+  CHECK_EQUAL(pack.size(), 5u);
+  CHECK_EQUAL(pack.name(1), "broadcast udp");
+  CHECK_EQUAL(pack.num_predicate_occurrences(), 7u);
+  // The negation normalizes to `resp_h != 192.168.1.255`, which is distinct
+  // from the other predicates.
+  CHECK_EQUAL(pack.num_predicates(), 5u);
+}
+
+TEST(attribution) {
+  auto pack = unbox(rule_pack::make(rules));
+  std::vector<size_t> expected(rules.size());
+  std::vector<size_t> attributed(rules.size());
+  for (auto& slice : zeek_conn_log) {
+    auto hits = pack.evaluate(slice);
+    REQUIRE_EQUAL(hits.size(), rules.size());
+    for (size_t i = 0; i < rules.size(); ++i) {
+      expected[i] += evaluate_alone(rules[i].second, slice);
+      attributed[i] += rank(hits[i]);
+    }
+  }
+  for (size_t i = 0; i < rules.size(); ++i)
+    CHECK_EQUAL(attributed[i], expected[i]);
+  MESSAGE("the rules partition the events");
+  CHECK_GREATER(attributed[0], 0u);
+  CHECK_EQUAL(attributed[0] + attributed[2], rows(zeek_conn_log));
+  CHECK_EQUAL(attributed[4], 0u);
+}
+
+TEST(attribution of a selection) {
+  auto pack = unbox(rule_pack::make(rules));
+  auto& slice = zeek_conn_log[0];
+  auto first = slice.offset();
+  auto selection = make_ids({{first + 2, first + 5}});
+  auto all = pack.evaluate(slice);
+  auto hits = pack.evaluate(slice, selection);
+  REQUIRE_EQUAL(hits.size(), rules.size());
+  for (size_t i = 0; i < rules.size(); ++i) {
+    CHECK_EQUAL(rank(hits[i] - selection), 0u);
+    CHECK_EQUAL(rank(hits[i]), rank(all[i] & selection));
+  }
+  MESSAGE("the rules partition the selection");
+  CHECK_EQUAL(rank(hits[0]) + rank(hits[2]), 3u);
+}
+
+TEST(invalid packs) {
+  MESSAGE("empty pack");
+  CHECK(!rule_pack::make({}));
+  MESSAGE("duplicate rule names");
+  CHECK(!rule_pack::make({make_rule("x", "proto == \"udp\""),
+                          make_rule("x", "proto == \"tcp\"")}));
+}
+
+FIXTURE_SCOPE_END()
@@ -44,6 +44,25 @@ TEST(construction and querying) {
   CHECK_EQUAL(slices[1], zeek_conn_log[2]);
 }
 
+TEST(interleaved offsets) {
+  segment_builder builder{1024};
+  // The slices cover [0,8), [8,16), [16,20), and [20,28).
+  auto xs = zeek_conn_log;
+  xs.push_back(zeek_dns_log[0]);
+  for (auto i : {2, 0, 3, 1})
+    REQUIRE(!builder.add(xs[i]));
+  MESSAGE("reject overlapping offsets");
+  CHECK_NOT_EQUAL(builder.add(xs[2]), caf::none);
+  CHECK_EQUAL(builder.ids(), make_ids({{0, 28}}));
+  auto x = builder.finish();
+  CHECK_EQUAL(x.ids(), make_ids({{0, 28}}));
+  auto slices = unbox(x.lookup(make_ids({0, 9, 25})));
+  REQUIRE_EQUAL(slices.size(), 3u);
+  CHECK_EQUAL(slices[0], xs[0]);
+  CHECK_EQUAL(slices[1], xs[1]);
+  CHECK_EQUAL(slices[2], xs[3]);
+}
+
 TEST(serialization) {
   segment_builder builder{1024};
   auto slice = zeek_conn_log[0];
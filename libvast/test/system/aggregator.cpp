@@ -0,0 +1,203 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE aggregator
+
+#include "vast/system/aggregator.hpp"
+
+#include "vast/test/fixtures/actor_system_and_events.hpp"
+#include "vast/test/test.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/defaults.hpp"
+#include "vast/detail/spawn_container_source.hpp"
+#include "vast/ids.hpp"
+#include "vast/system/archive.hpp"
+#include "vast/system/index.hpp"
+#include "vast/system/posix_filesystem.hpp"
+#include "vast/system/value_counts.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/stateful_actor.hpp>
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+struct mock_client_state {
+  value_counts result;
+  bool received_done = false;
+  static inline constexpr const char* name = "mock-client";
+};
+
+using mock_client_actor = caf::stateful_actor<mock_client_state>;
+
+caf::behavior mock_client(mock_client_actor* self) {
+  return {[=](value_counts& x) {
+            CHECK(!self->state.received_done);
+            self->state.result.merge(x);
+          },
+          [=](atom::done) { self->state.received_done = true; }};
+}
+
+struct fixture : fixtures::deterministic_actor_system_and_events {
+  fixture() {
+    MESSAGE("spawn INDEX ingest 4 slices with 100 rows (= 1 partition) each");
+    auto fs = self->spawn(posix_filesystem, directory);
+    auto indexdir = directory / "index";
+    index = self->spawn(system::index, fs, indexdir,
+                        defaults::import::table_slice_size, 100, 3, 1, indexdir,
+                        0.01, false, 0, 0, false);
+    archive = self->spawn(system::archive, directory / "archive",
+                          defaults::system::segments,
+                          defaults::system::max_segment_size);
+    client = sys.spawn(mock_client);
+    // Fill the INDEX with 400 rows and the ARCHIVE with only 300 rows from the
+    // Zeek conn log.
+    detail::spawn_container_source(sys, take(zeek_conn_log_full, 4), index);
+    detail::spawn_container_source(sys, take(zeek_conn_log_full, 3), archive);
+    run();
+  }
+
+  ~fixture() {
+    self->send_exit(aut, caf::exit_reason::user_shutdown);
+    self->send_exit(index, caf::exit_reason::user_shutdown);
+  }
+
+  void spawn_aut(std::string_view query, std::string field) {
+    aut = sys.spawn(aggregator, unbox(to<expression>(query)), std::move(field),
+                    index, archive);
+    run();
+    anon_send(aut, atom::run_v, client);
+    sched.run_once();
+  }
+
+  index_actor index;
+  archive_actor archive;
+  caf::actor client;
+  caf::actor aut;
+};
+
+data addr(std::string_view str) {
+  return unbox(to<address>(str));
+}
+
+} // namespace
+
+TEST(value counts top k) {
+  value_counts xs;
+  xs.add(data{"foo"}, 3);
+  xs.add(data{"bar"});
+  xs.add(data{"baz"}, 3);
+  xs.add(data{"qux"}, 2);
+  CHECK_EQUAL(xs.distinct(), 4u);
+  CHECK_EQUAL(xs.total(), 9u);
+  auto top = xs.top(2);
+  REQUIRE_EQUAL(top.size(), 2u);
+  // Ties are ordered by value.
+  CHECK_EQUAL(top[0].first, data{"baz"});
+  CHECK_EQUAL(top[1].first, data{"foo"});
+  CHECK_EQUAL(top[1].second, 3u);
+  auto all = xs.top(0);
+  REQUIRE_EQUAL(all.size(), 4u);
+  CHECK_EQUAL(all[2].first, data{"qux"});
+  CHECK_EQUAL(all[3].first, data{"bar"});
+}
+
+TEST(value counts merge) {
+  value_counts xs;
+  xs.add(data{count{1}}, 2);
+  xs.add(data{count{2}});
+  value_counts ys;
+  ys.add(data{count{2}}, 4);
+  ys.add(caf::none);
+  xs.merge(ys);
+  CHECK_EQUAL(xs.distinct(), 3u);
+  CHECK_EQUAL(xs.total(), 8u);
+  CHECK_EQUAL(xs.counts[data{count{2}}], 5u);
+  CHECK_EQUAL(xs.counts[data{}], 1u);
+}
+
+FIXTURE_SCOPE(aggregator_tests, fixture)
+
+TEST(aggregate by responder address) {
+  MESSAGE("spawn the AGGREGATOR for query ':addr == 192.168.1.104'");
+  spawn_aut(":addr == 192.168.1.104", "resp_h");
+  expect((expression), from(aut).to(index));
+  run();
+  // The magic numbers were computed via:
+  // bro-cut < libvast_test/artifacts/logs/zeek/conn.log
+  //   | head -n 300
+  //   | grep 192.168.1.104
+  //   | cut -f 5 | sort | uniq -c | sort -rn
+  auto& client_state = deref<mock_client_actor>(client).state;
+  CHECK_EQUAL(client_state.received_done, true);
+  const auto& result = client_state.result;
+  CHECK_EQUAL(result.total(), 105u);
+  CHECK_EQUAL(result.distinct(), 19u);
+  auto top = result.top(2);
+  REQUIRE_EQUAL(top.size(), 2u);
+  CHECK_EQUAL(top[0].first, addr("192.168.1.255"));
+  CHECK_EQUAL(top[0].second, 49u);
+  CHECK_EQUAL(top[1].first, addr("192.168.1.1"));
+  CHECK_EQUAL(top[1].second, 21u);
+}
+
+TEST(aggregate overlapping hits) {
+  MESSAGE("spawn the AGGREGATOR with an INDEX that ignores the query");
+  auto query = unbox(to<expression>(":addr == 192.168.1.104"));
+  auto dummy_index = sys.spawn([]() -> caf::behavior {
+    return {
+      [](const expression&) {
+        // nop
+      },
+    };
+  });
+  aut = sys.spawn(aggregator, query, "resp_h",
+                  caf::actor_cast<index_actor>(dummy_index), archive);
+  run();
+  anon_send(aut, atom::run_v, client);
+  run();
+  MESSAGE("send two overlapping batches of hits for a single partition");
+  self->send(aut, uuid::random(), uint32_t{1}, uint32_t{1});
+  self->send(aut, make_ids({{0, 150}}));
+  self->send(aut, make_ids({{50, 200}}));
+  self->send(aut, atom::done_v);
+  run();
+  MESSAGE("compare with the matching events among the first 200 events");
+  auto expected = count{0};
+  for (auto& slice : take(zeek_conn_log_full, 2)) {
+    auto checker = unbox(tailor(query, type{slice.layout()}));
+    expected += rank(evaluate(checker, slice));
+  }
+  CHECK_GREATER(expected, 0u);
+  auto& client_state = deref<mock_client_actor>(client).state;
+  CHECK_EQUAL(client_state.received_done, true);
+  CHECK_EQUAL(client_state.result.total(), expected);
+  self->send_exit(dummy_index, caf::exit_reason::user_shutdown);
+}
+
+TEST(aggregate by missing field) {
+  spawn_aut(":addr == 192.168.1.104", "no_such_field");
+  expect((expression), from(aut).to(index));
+  run();
+  auto& client_state = deref<mock_client_actor>(client).state;
+  CHECK_EQUAL(client_state.received_done, true);
+  CHECK_EQUAL(client_state.result.distinct(), 0u);
+}
+
+FIXTURE_SCOPE_END()
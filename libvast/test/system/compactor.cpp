@@ -0,0 +1,180 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE compactor
+
+#include "vast/system/compactor.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/test/fixtures/actor_system_and_events.hpp"
+#include "vast/test/test.hpp"
+
+#include "vast/detail/spawn_container_source.hpp"
+#include "vast/system/archive.hpp"
+#include "vast/system/index.hpp"
+#include "vast/system/posix_filesystem.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/uuid.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+struct fixture : fixtures::deterministic_actor_system_and_events {
+  /// Small partitions hold a single slice, so at most two of them fit into
+  /// a merged partition.
+  static constexpr size_t target_size = 2 * slice_size + 4;
+
+  fixture() {
+    directory /= "compactor";
+    fs = self->spawn(system::posix_filesystem, directory);
+    index_dir = directory / "index";
+    index = self->spawn(system::index, fs, index_dir, slice_size,
+                        size_t{8}, size_t{4}, size_t{1}, index_dir, 0.01,
+                        false, 0, 0, false);
+    archive = self->spawn(system::archive, directory / "archive", 10,
+                          1024 * 1024);
+    // Lay out the partitions in the ID space as follows, where the tail
+    // stays in the active partition:
+    //   a0 a1 a2 | large | b0 b1 | tail
+    auto at = [](table_slice slice, id offset) {
+      slice.offset(offset);
+      return slice;
+    };
+    auto big = at(zeek_conn_log_full[0], 3 * slice_size);
+    REQUIRE_GREATER_EQUAL(big.rows(), target_size);
+    auto next = big.offset() + big.rows();
+    slices = {at(alternating_integers[0], 0),
+              at(alternating_integers[1], slice_size),
+              at(alternating_integers[2], 2 * slice_size),
+              big,
+              at(alternating_integers[3], next),
+              at(alternating_integers[4], next + slice_size),
+              at(alternating_integers[5], next + 2 * slice_size)};
+    for (auto& slice : slices)
+      partitions.push_back(ingest(slice));
+    MESSAGE("leave out the events of b1 in the ARCHIVE");
+    auto archived = slices;
+    archived.erase(archived.begin() + b1);
+    detail::spawn_container_source(sys, std::move(archived), archive);
+    run();
+    REQUIRE_EQUAL(list().size(), slices.size() - 1);
+  }
+
+  ~fixture() override {
+    self->send_exit(compactor, caf::exit_reason::user_shutdown);
+    self->send_exit(archive, caf::exit_reason::user_shutdown);
+    self->send_exit(index, caf::exit_reason::user_shutdown);
+  }
+
+  /// Streams a table slice into the INDEX.
+  /// @returns The ID of the partition that holds the slice.
+  uuid ingest(table_slice slice) {
+    detail::spawn_container_source(sys, std::vector{std::move(slice)}, index);
+    run();
+    auto& active = index_state().active_partitions;
+    REQUIRE_EQUAL(active.size(), 1u);
+    return active.begin()->second.id;
+  }
+
+  std::vector<uuid> list() {
+    std::vector<uuid> result;
+    auto rp = self->request(index, caf::infinite, atom::list_v);
+    run();
+    rp.receive([&](std::vector<uuid>& xs) { result = std::move(xs); },
+               [](caf::error&) { FAIL("failed to list partitions"); });
+    return result;
+  }
+
+  bool listed(size_t i) {
+    auto xs = list();
+    return std::find(xs.begin(), xs.end(), partitions[i]) != xs.end();
+  }
+
+  void spawn_compactor(size_t max_concurrency) {
+    compactor = self->spawn(system::compactor, target_size, max_concurrency,
+                            std::chrono::seconds{3600}, index_dir, fs,
+                            archive, index);
+    run();
+  }
+
+  system::index_state& index_state() {
+    return deref<caf::stateful_actor<system::index_state>>(index).state;
+  }
+
+  system::compactor_state& compactor_state() {
+    return deref<caf::stateful_actor<system::compactor_state>>(compactor)
+      .state;
+  }
+
+  // The positions of the partitions in `slices` and `partitions`.
+  enum : size_t { a0, a1, a2, large, b0, b1, tail };
+
+  path index_dir;
+  system::filesystem_actor fs;
+  system::index_actor index;
+  system::archive_actor archive;
+  system::compactor_actor compactor;
+  std::vector<table_slice> slices;
+  std::vector<uuid> partitions;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(compactor_tests, fixture)
+
+TEST(adjacent small partitions) {
+  spawn_compactor(2);
+  self->send(compactor, atom::ping_v);
+  run();
+  MESSAGE("a0 and a1 got merged");
+  CHECK(!listed(a0));
+  CHECK(!listed(a1));
+  MESSAGE("a2 does not fit into their group and large is big enough");
+  CHECK(listed(a2));
+  CHECK(listed(large));
+  MESSAGE("b0 and b1 stay untouched because the ARCHIVE lacks events");
+  CHECK(listed(b0));
+  CHECK(listed(b1));
+  CHECK_EQUAL(list().size(), 5u);
+  CHECK_EQUAL(compactor_state().num_compacted_partitions, 2u);
+  CHECK_EQUAL(compactor_state().num_failed_compactions, 1u);
+  CHECK(compactor_state().running.empty());
+}
+
+TEST(in-flight partitions and concurrency limit) {
+  spawn_compactor(2);
+  MESSAGE("pretend that a0 is part of a running compaction");
+  compactor_state().running.emplace(self->address(),
+                                    std::vector<uuid>{partitions[a0]});
+  self->send(compactor, atom::ping_v);
+  run();
+  MESSAGE("a1 and a2 got merged instead");
+  CHECK(listed(a0));
+  CHECK(!listed(a1));
+  CHECK(!listed(a2));
+  CHECK(listed(large));
+  MESSAGE("the group of b0 and b1 exceeds the concurrency limit");
+  CHECK(listed(b0));
+  CHECK(listed(b1));
+  CHECK_EQUAL(compactor_state().num_compacted_partitions, 2u);
+  CHECK_EQUAL(compactor_state().num_failed_compactions, 0u);
+  CHECK_EQUAL(compactor_state().running.size(), 1u);
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,127 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE continuous_query_engine
+#include "vast/system/continuous_query_engine.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/defaults.hpp"
+#include "vast/factory.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/table_slice_builder_factory.hpp"
+#include "vast/test/test.hpp"
+
+#include <map>
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+const auto layout = record_type{
+  {"src", address_type{}},
+  {"dst", address_type{}},
+  {"port", count_type{}},
+  {"host", string_type{}},
+}.name("flow");
+
+struct fixture {
+  fixture() {
+    factory<table_slice_builder>::initialize();
+    auto builder = factory<table_slice_builder>::make(
+      defaults::import::table_slice_type, layout);
+    REQUIRE(builder);
+    for (count i = 0; i < 64; ++i) {
+      auto src = unbox(to<address>("10.0.0." + std::to_string(i % 8)));
+      auto dst = unbox(to<address>("10.0.1." + std::to_string(i % 5)));
+      auto host = "host-" + std::to_string(i % 3);
+      REQUIRE(builder->add(src, dst, count{i * 100}, host));
+    }
+    slice = builder->finish();
+    slice.offset(1000);
+  }
+
+  /// Evaluates all queries with the engine and compares the results to
+  /// evaluating each query on its own.
+  void check_against_reference(const std::vector<std::string>& queries) {
+    continuous_query_engine engine;
+    auto expected = std::map<uint64_t, ids>{};
+    for (uint64_t i = 0; i < queries.size(); ++i) {
+      auto expr = unbox(to<expression>(queries[i]));
+      engine.add(i, expr);
+      auto tailored = unbox(tailor(expr, type{layout}));
+      auto hits = evaluate(tailored, slice);
+      if (any<1>(hits))
+        expected.emplace(i, std::move(hits));
+    }
+    auto actual = std::map<uint64_t, ids>{};
+    for (auto& [subscriber, selection] : engine.evaluate(slice))
+      actual.emplace(subscriber, std::move(selection));
+    REQUIRE_EQUAL(actual.size(), expected.size());
+    for (auto& [subscriber, selection] : expected) {
+      MESSAGE("checking " << queries[subscriber]);
+      REQUIRE(actual.count(subscriber));
+      CHECK_EQUAL(rank(actual[subscriber]), rank(selection));
+      CHECK_EQUAL(rank(actual[subscriber] & selection), rank(selection));
+    }
+  }
+
+  table_slice slice;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(continuous_query_engine_tests, fixture)
+
+TEST(equality on a single column) {
+  check_against_reference({"src == 10.0.0.1", "host == \"host-2\"",
+                           "port == 4200", "src == 192.168.0.1"});
+}
+
+TEST(equality on multiple columns) {
+  check_against_reference({":addr == 10.0.0.4", ":addr in [10.0.1.3, 10.0.0.7]",
+                           "src == 10.0.0.1 || dst == 10.0.1.1"});
+}
+
+TEST(conjunctions verify candidates) {
+  check_against_reference({"src == 10.0.0.1 && port > 1000",
+                           "src in [10.0.0.2, 10.0.0.3] && host != \"host-1\"",
+                           "! (dst == 10.0.1.2) && src == 10.0.0.5"});
+}
+
+TEST(unindexed queries) {
+  check_against_reference({"port > 5000", "src in 10.0.0.0/30",
+                           "src == 10.0.0.1 || port < 300",
+                           "host ~ /host-[01]/"});
+}
+
+TEST(plans index equality predicates) {
+  continuous_query_engine engine;
+  engine.add(1, unbox(to<expression>("src == 10.0.0.1")));
+  engine.add(2, unbox(to<expression>(":addr in [10.0.0.2, 10.0.1.3]")));
+  engine.add(3, unbox(to<expression>("port > 1000")));
+  CHECK_EQUAL(engine.size(), 3u);
+  CHECK_EQUAL(engine.indexed(layout), 2u);
+  CHECK(engine.erase(2));
+  CHECK(!engine.erase(2));
+  CHECK_EQUAL(engine.indexed(layout), 1u);
+  engine.evaluate(slice);
+  CHECK_EQUAL(engine.stats().slices, 1u);
+  CHECK_EQUAL(engine.stats().probes, slice.rows());
+  CHECK_EQUAL(engine.stats().fallbacks, 1u);
+}
+
+FIXTURE_SCOPE_END()
@@ -69,7 +69,7 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     auto indexdir = directory / "index";
     index = self->spawn(system::index, fs, indexdir,
                         defaults::import::table_slice_size, 100, 3, 1, indexdir,
-                        0.01);
+                        0.01, false, 0, 0, false);
     archive = self->spawn(system::archive, directory / "archive",
                           defaults::system::segments,
                           defaults::system::max_segment_size);
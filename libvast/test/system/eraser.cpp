@@ -102,6 +102,22 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state> self) {
       anon_self->send(hdl, atom::done_v);
     },
     [=](atom::erase, uuid) -> ids { FAIL("no mock implementation available"); },
+    [=](atom::list) -> std::vector<uuid> {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::estimate, expression&) -> uint64_t {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::estimate, expression&, std::string&) -> double {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::replace, std::vector<uuid>&,
+        std::vector<table_slice>&) -> atom::done {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::internal, atom::load) {
+      FAIL("no mock implementation available");
+    },
   };
 }
 
@@ -198,7 +214,7 @@ TEST(eraser on actual INDEX with Zeek conn logs) {
   auto fs = self->spawn(vast::system::posix_filesystem, directory);
   auto indexdir = directory / "index";
   index = self->spawn(system::index, fs, indexdir, slice_size, 100, taste_count,
-                      1, indexdir, 0.01);
+                      1, indexdir, 0.01, false, 0, 0, false);
   detail::spawn_container_source(sys, std::move(slices), index);
   run();
   // Predicate for running all actors *except* aut.
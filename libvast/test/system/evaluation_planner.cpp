@@ -0,0 +1,113 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE evaluation_planner
+
+#include "vast/system/evaluation_planner.hpp"
+
+#include "vast/test/test.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/data.hpp"
+#include "vast/expression.hpp"
+#include "vast/type.hpp"
+
+#include <map>
+#include <string>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::string_literals;
+
+namespace {
+
+/// Estimates predicates by their field name.
+struct fixture {
+  fixture() {
+    estimates["cheap"] = {1.0, 0.5};
+    estimates["selective"] = {4.0, 0.01};
+    estimates["expensive"] = {64.0, 0.01};
+    estimates["unselective"] = {1.0, 1.0};
+    estimates["empty"] = {0.0, 0.0};
+  }
+
+  expression order(std::string_view str) {
+    auto expr = unbox(to<expression>(str));
+    return order_by_cost(expr, [&](const predicate& pred) {
+      auto& fe = caf::get<field_extractor>(pred.lhs);
+      auto i = estimates.find(fe.field);
+      REQUIRE(i != estimates.end());
+      return i->second;
+    });
+  }
+
+  std::map<std::string, lookup_estimate> estimates;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(evaluation_planner_tests, fixture)
+
+TEST(estimates) {
+  auto eq
+    = estimate_lookup(count_type{}, relational_operator::equal, count{42});
+  auto ne = estimate_lookup(count_type{}, relational_operator::not_equal,
+                            count{42});
+  auto lt = estimate_lookup(count_type{}, relational_operator::less, count{42});
+  CHECK_LESS(eq.selectivity, lt.selectivity);
+  CHECK_LESS(lt.selectivity, ne.selectivity);
+  CHECK_LESS_EQUAL(eq.cost, lt.cost);
+  auto short_string
+    = estimate_lookup(string_type{}, relational_operator::equal, "foo"s);
+  auto long_string = estimate_lookup(string_type{}, relational_operator::equal,
+                                     "a much longer string"s);
+  CHECK_LESS(short_string.cost, long_string.cost);
+  auto hashed = estimate_lookup(string_type{}.attributes({{"index", "hash"}}),
+                                relational_operator::equal,
+                                "a much longer string"s);
+  CHECK_LESS(hashed.cost, long_string.cost);
+  auto aliased = estimate_lookup(alias_type{count_type{}}.name("port"),
+                                 relational_operator::equal, count{42});
+  CHECK_EQUAL(aliased.cost, eq.cost);
+  CHECK_EQUAL(aliased.selectivity, eq.selectivity);
+}
+
+TEST(conjunctions are ordered by rank) {
+  CHECK_EQUAL(order("unselective == 1 && cheap == 1 && selective == 1"),
+              unbox(to<expression>("cheap == 1 && selective == 1 && "
+                                   "unselective == 1")));
+  CHECK_EQUAL(order("expensive == 1 && empty == 1"),
+              unbox(to<expression>("empty == 1 && expensive == 1")));
+  MESSAGE("ties keep their order");
+  CHECK_EQUAL(order("cheap == 1 && cheap == 2"),
+              unbox(to<expression>("cheap == 1 && cheap == 2")));
+}
+
+TEST(nested expressions) {
+  MESSAGE("disjunctions keep their order but are ranked as a whole");
+  CHECK_EQUAL(order("(unselective == 1 || cheap == 1) && selective == 1"),
+              unbox(to<expression>("selective == 1 && "
+                                   "(unselective == 1 || cheap == 1)")));
+  MESSAGE("conjunctions within disjunctions are ordered");
+  CHECK_EQUAL(order("cheap == 1 || (expensive == 1 && selective == 1)"),
+              unbox(to<expression>("cheap == 1 || "
+                                   "(selective == 1 && expensive == 1)")));
+  MESSAGE("negations invert the selectivity");
+  CHECK_EQUAL(order("cheap == 1 && ! (unselective == 1)"),
+              unbox(to<expression>("! (unselective == 1) && cheap == 1")));
+}
+
+FIXTURE_SCOPE_END()
@@ -24,6 +24,7 @@
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/expression.hpp"
 
+#include <memory>
 #include <vector>
 
 using namespace vast;
@@ -63,9 +64,19 @@ ids select(const counts& xs, curried_predicate pred) {
 }
 
 // Dummy actor representing an INDEXER for field `x`.
-vast::system::indexer_actor::behavior_type dummy_indexer(counts xs) {
+vast::system::indexer_actor::behavior_type
+dummy_indexer(counts xs, std::shared_ptr<size_t> lookups) {
   return {
-    [xs = std::move(xs)](curried_predicate pred) { return select(xs, pred); },
+    [=](curried_predicate pred) {
+      ++*lookups;
+      return select(xs, pred);
+    },
+    [=](curried_predicate pred, const ids& restriction) {
+      ++*lookups;
+      auto result = select(xs, pred);
+      result &= restriction;
+      return result;
+    },
     [](atom::shutdown) { FAIL("received shutdown request as dummy indexer"); },
   };
 }
@@ -87,8 +98,11 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
   /// Maps predicates to a list of actors.
   std::map<std::string, std::vector<system::indexer_actor>> indexers;
 
+  /// Counts the lookups across all indexers.
+  std::shared_ptr<size_t> lookups = std::make_shared<size_t>(0);
+
   void add_indexer(std::vector<system::indexer_actor>& container, counts data) {
-    container.emplace_back(sys.spawn(dummy_indexer, std::move(data)));
+    container.emplace_back(sys.spawn(dummy_indexer, std::move(data), lookups));
   }
 
   record_type layout;
@@ -106,14 +120,18 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
       for (auto& x : xs)
         triples.emplace_back(expr_position, curried(pred), x);
     }
-    auto eval = sys.spawn(system::evaluator, expr, std::move(triples));
+    auto eval = sys.spawn(system::evaluator, expr, std::move(triples),
+                          system::evaluator_callback{});
     self->send(eval, caf::actor_cast<system::partition_client_actor>(self));
     run();
     ids result;
     bool got_done_atom = false;
     while (!self->mailbox().empty())
       self->receive([&](const ids& hits) { result |= hits; },
-                    [&](atom::done) { got_done_atom = true; });
+                    [&](atom::done) { got_done_atom = true; },
+                    [](atom::trace, const system::query_trace&) {
+                      // nop
+                    });
     if (!got_done_atom)
       FAIL("evaluator failed to send 'done'");
     return result;
@@ -159,6 +177,27 @@ TEST(conjunctions) {
   CHECK_QUERY("x == 42 && y != 10", ({1, 3, 4}));
   MESSAGE("hits on both sides without intersection");
   CHECK_QUERY("x == 75 && y == 77", ({}));
+  MESSAGE("negated operands");
+  CHECK_QUERY("x == 42 && ! (y == 10)", ({4}));
+  CHECK_QUERY("y != 10 && ! (x == 42)", ({8}));
+  MESSAGE("nested connectives");
+  CHECK_QUERY("(x == 42 || x == 13) && y == 42", ({1, 4}));
+  CHECK_QUERY("x == 42 && (y == 77 || y == 42)", ({1, 3, 4}));
+}
+
+TEST(conjunctions short-circuit) {
+  MESSAGE("the right-hand side is skipped if the left-hand side has no hits");
+  *lookups = 0;
+  CHECK_QUERY("x == 33 && y != 10", ({}));
+  CHECK_EQUAL(*lookups, 2u);
+  MESSAGE("the right-hand side is looked up if the left-hand side has hits");
+  *lookups = 0;
+  CHECK_QUERY("x == 13 && y != 10", ({1}));
+  CHECK_EQUAL(*lookups, 4u);
+  MESSAGE("nested conjunctions are skipped as a whole");
+  *lookups = 0;
+  CHECK_QUERY("x == 33 && (y == 10 || x > 10)", ({}));
+  CHECK_EQUAL(*lookups, 2u);
 }
 
 TEST(disjunctions) {
@@ -174,4 +213,15 @@ TEST(disjunctions) {
   CHECK_QUERY("x == 75 || y == 77", ({3, 5}));
 }
 
+TEST(shared lookups) {
+  MESSAGE("identical unrestricted lookups share a request per indexer");
+  *lookups = 0;
+  CHECK_QUERY("x == 42 || (x == 42 && y == 77)", ({{0, 5}}));
+  CHECK_EQUAL(*lookups, 4u);
+  MESSAGE("restricted lookups are never shared");
+  *lookups = 0;
+  CHECK_QUERY("(x == 42 && y == 77) || (x == 13 && y == 77)", ({3}));
+  CHECK_EQUAL(*lookups, 8u);
+}
+
 FIXTURE_SCOPE_END()
@@ -21,9 +21,11 @@
 
 #include "vast/concept/parseable/to.hpp"
 #include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/defaults.hpp"
 #include "vast/detail/spawn_container_source.hpp"
 #include "vast/query_options.hpp"
 #include "vast/system/archive.hpp"
+#include "vast/system/id_allocator.hpp"
 #include "vast/system/importer.hpp"
 #include "vast/system/index.hpp"
 #include "vast/system/posix_filesystem.hpp"
@@ -62,7 +64,7 @@ struct fixture : fixture_base {
     auto fs = self->spawn(system::posix_filesystem, directory);
     auto indexdir = directory / "index";
     index = self->spawn(system::index, fs, indexdir, 10000, 5, 5, 1, indexdir,
-                        0.01);
+                        0.01, false, 0, 0, false);
   }
 
   void spawn_archive() {
@@ -70,7 +72,10 @@ struct fixture : fixture_base {
   }
 
   void spawn_importer() {
-    importer = self->spawn(system::importer, directory / "importer",
+    auto ids = system::id_allocator::make(directory / "importer",
+                                          defaults::system::id_headroom);
+    REQUIRE(ids);
+    importer = self->spawn(system::importer, std::move(*ids),
                            system::node_actor::pointer{}, archive, index,
                            type_registry);
   }
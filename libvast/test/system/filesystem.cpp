@@ -19,6 +19,7 @@
 #include "vast/chunk.hpp"
 #include "vast/io/read.hpp"
 #include "vast/io/write.hpp"
+#include "vast/system/pooled_filesystem.hpp"
 #include "vast/system/posix_filesystem.hpp"
 #include "vast/system/status_verbosity.hpp"
 
@@ -112,4 +113,51 @@ TEST(status) {
       [&](const caf::error& err) { FAIL(err); });
 }
 
+TEST(pooled) {
+  auto pool = self->spawn<caf::detached>(pooled_filesystem, directory, size_t{2});
+  auto foo = "foo"s;
+  auto copy = foo;
+  auto chk = chunk::make(std::move(copy));
+  MESSAGE("write file via pool");
+  self->request(pool, caf::infinite, atom::write_v, path{foo}, chk)
+    .receive(
+      [&](atom::ok) {
+        // all good
+      },
+      [&](const caf::error& err) { FAIL(err); });
+  MESSAGE("read and mmap file via pool");
+  for (auto i = 0; i < 4; ++i) {
+    self->request(pool, caf::infinite, atom::read_v, path{foo})
+      .receive(
+        [&](const chunk_ptr& x) { CHECK_EQUAL(as_bytes(x), as_bytes(chk)); },
+        [&](const caf::error& err) { FAIL(err); });
+    self->request(pool, caf::infinite, atom::mmap_v, path{foo})
+      .receive(
+        [&](const chunk_ptr& x) { CHECK_EQUAL(as_bytes(x), as_bytes(chk)); },
+        [&](const caf::error& err) { FAIL(err); });
+  }
+  self->request(pool, caf::infinite, atom::read_v, path{"not-there"})
+    .receive(
+      [&](const chunk_ptr&) { FAIL("should not receive chunk on failure"); },
+      [&](const caf::error&) {
+        // expected
+      });
+  MESSAGE("check statistics");
+  self->request(pool, caf::infinite, atom::status_v, status_verbosity::debug)
+    .receive(
+      [&](const caf::dictionary<caf::config_value>& status) {
+        auto get = [&](const char* key) {
+          return caf::get<uint64_t>(status, key);
+        };
+        CHECK_EQUAL(get("filesystem.operations.writes.successful"), 1u);
+        CHECK_EQUAL(get("filesystem.operations.reads.successful"), 4u);
+        CHECK_EQUAL(get("filesystem.operations.reads.failed"), 1u);
+        CHECK_EQUAL(get("filesystem.operations.mmaps.successful"), 4u);
+        CHECK_EQUAL(get("filesystem.operations.mmaps.bytes"), 4 * foo.size());
+        CHECK_EQUAL(get("filesystem.pending-reads"), 0u);
+      },
+      [&](const caf::error& err) { FAIL(err); });
+  self->send_exit(pool, caf::exit_reason::user_shutdown);
+}
+
 FIXTURE_SCOPE_END()
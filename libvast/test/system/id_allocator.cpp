@@ -0,0 +1,127 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE id_allocator
+
+#include "vast/system/id_allocator.hpp"
+
+#include "vast/test/fixtures/filesystem.hpp"
+#include "vast/test/test.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+constexpr auto block_size = id_allocator::block_size;
+
+struct fixture : fixtures::filesystem {
+  std::shared_ptr<id_allocator> make(id headroom = 4 * block_size) {
+    return unbox(id_allocator::make(directory, headroom));
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(id_allocator_tests, fixture)
+
+TEST(reservations span whole blocks) {
+  auto ids = make();
+  auto x = unbox(ids->reserve(1));
+  CHECK_EQUAL(x.first, 0u);
+  CHECK_EQUAL(x.last, block_size);
+  auto y = unbox(ids->reserve(block_size + 1));
+  CHECK_EQUAL(y.first, block_size);
+  CHECK_EQUAL(y.last, 3 * block_size);
+  CHECK_EQUAL(ids->next(), 3 * block_size);
+  CHECK_GREATER_EQUAL(ids->durable(), y.last);
+}
+
+TEST(restart continues after previous reservations) {
+  auto last = id{0};
+  {
+    auto ids = make();
+    for (auto i = 0; i < 10; ++i)
+      last = unbox(ids->reserve(1)).last;
+  }
+  auto ids = make();
+  CHECK_EQUAL(ids->next(), last);
+  CHECK_EQUAL(unbox(ids->reserve(1)).first, last);
+}
+
+TEST(restart after legacy importer state) {
+  MESSAGE("the IMPORTER state file contains the block end and next ID");
+  {
+    std::ofstream state_file{(directory / "current_id_block").str()};
+    state_file << "8388708 42";
+  }
+  auto ids = make();
+  CHECK_EQUAL(ids->next(), 42u);
+  CHECK_EQUAL(unbox(ids->reserve(1)).first, block_size);
+}
+
+TEST(writes are batched) {
+  auto ids = make(64 * block_size);
+  for (auto i = 0; i < 20; ++i)
+    CHECK(ids->reserve(1));
+  // Every write persists the watermark 64 blocks ahead, so the reservations
+  // of 20 blocks need no write after the initial one.
+  CHECK_EQUAL(ids->writes(), 1u);
+}
+
+TEST(concurrent reservations are disjoint) {
+  auto ids = make();
+  constexpr auto num_threads = 4;
+  constexpr auto num_reservations = 100;
+  std::vector<std::vector<id_range>> ranges(num_threads);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < num_threads; ++i)
+    threads.emplace_back([&, i] {
+      for (auto j = 0; j < num_reservations; ++j)
+        if (auto x = ids->reserve(1))
+          ranges[i].push_back(*x);
+    });
+  for (auto& thread : threads)
+    thread.join();
+  std::vector<id> firsts;
+  for (auto& xs : ranges)
+    for (auto& x : xs) {
+      CHECK_EQUAL(x.last - x.first, block_size);
+      CHECK_GREATER_EQUAL(ids->durable(), x.last);
+      firsts.push_back(x.first);
+    }
+  std::sort(firsts.begin(), firsts.end());
+  REQUIRE_EQUAL(firsts.size(), size_t{num_threads * num_reservations});
+  for (size_t i = 0; i < firsts.size(); ++i)
+    CHECK_EQUAL(firsts[i], i * block_size);
+}
+
+TEST(failed writes do not hand out IDs) {
+  auto dir = directory / "ids";
+  auto ids = unbox(id_allocator::make(dir, block_size));
+  auto durable = ids->durable();
+  MESSAGE("replace the state directory with a file to make writes fail");
+  REQUIRE(rm(dir));
+  std::ofstream{dir.str()} << "not a directory";
+  auto x = ids->reserve(100 * block_size);
+  CHECK(!x);
+  CHECK_LESS(ids->durable(), 100 * block_size);
+  CHECK_GREATER_EQUAL(ids->durable(), durable);
+}
+
+FIXTURE_SCOPE_END()
@@ -25,6 +25,7 @@
 #include "vast/detail/spawn_container_source.hpp"
 #include "vast/format/zeek.hpp"
 #include "vast/system/archive.hpp"
+#include "vast/system/id_allocator.hpp"
 #include "vast/system/source.hpp"
 #include "vast/system/type_registry.hpp"
 #include "vast/table_slice.hpp"
@@ -65,7 +66,10 @@ struct importer_fixture : Base {
   importer_fixture(size_t table_slice_size) : slice_size(table_slice_size) {
     MESSAGE("spawn importer");
     this->directory /= "importer";
-    importer = this->self->spawn(system::importer, this->directory,
+    auto ids = system::id_allocator::make(this->directory,
+                                          defaults::system::id_headroom);
+    REQUIRE(ids);
+    importer = this->self->spawn(system::importer, std::move(*ids),
                                  system::node_actor::pointer{},
                                  system::archive_actor{}, system::index_actor{},
                                  system::type_registry_actor{});
@@ -28,7 +28,9 @@
 #include "vast/detail/spawn_generator_source.hpp"
 #include "vast/ids.hpp"
 #include "vast/query_options.hpp"
+#include "vast/system/id_allocator.hpp"
 #include "vast/system/posix_filesystem.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/table_slice_builder.hpp"
 
@@ -48,11 +50,17 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
 
   fixture() {
     directory /= "index";
+    index = spawn_index("index", slice_size);
+  }
+
+  /// Spawns an INDEX in a subdirectory of the test directory.
+  system::index_actor
+  spawn_index(const std::string& name, size_t partition_capacity) {
     auto fs = self->spawn(system::posix_filesystem, directory);
-    auto dir = directory / "index";
-    index = self->spawn(system::index, fs, dir, slice_size, in_mem_partitions,
-                        taste_count, num_query_supervisors, dir,
-                        meta_index_fp_rate);
+    auto dir = directory / name;
+    return self->spawn(system::index, fs, dir, partition_capacity,
+                       in_mem_partitions, taste_count, num_query_supervisors,
+                       dir, meta_index_fp_rate, false, 0, 0, false);
   }
 
   ~fixture() {
@@ -84,6 +92,9 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
       while (!done)
         self->receive([&](ids& sub_result) { result |= sub_result; },
                       [&](atom::done) { done = true; },
+                      [](atom::trace, const system::query_trace&) {
+                        // nop
+                      },
                       caf::others >> [](caf::message_view& msg)
                         -> caf::result<caf::message> {
                         FAIL("unexpected message: " << msg.content());
@@ -123,6 +134,13 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     return xs;
   }
 
+  /// Moves a table slice of `alternating_integers` to a different offset.
+  static table_slice alternating_integers_at(size_t i, id offset) {
+    auto result = alternating_integers[i];
+    result.offset(offset);
+    return result;
+  }
+
   // Handle to the INDEX actor.
   system::index_actor index;
 };
@@ -150,6 +168,84 @@ TEST(one-shot integer query result) {
   CHECK_EQUAL(result, expected_result);
 }
 
+TEST(partition compaction) {
+  MESSAGE("fill first " << taste_count << " partitions");
+  auto slices = rebase(first_n(alternating_integers, taste_count));
+  auto src = detail::spawn_container_source(sys, slices, index);
+  run();
+  auto list = [&] {
+    std::vector<uuid> result;
+    auto rp = self->request(index, caf::infinite, atom::list_v);
+    run();
+    rp.receive([&](std::vector<uuid>& xs) { result = std::move(xs); },
+               [](caf::error&) { FAIL("failed to list partitions"); });
+    return result;
+  };
+  auto partitions = list();
+  REQUIRE_GREATER_EQUAL(partitions.size(), 2u);
+  MESSAGE("replace the persisted partitions with a single one");
+  auto rp = self->request(index, caf::infinite, atom::replace_v, partitions,
+                          first_n(slices, partitions.size()));
+  run();
+  rp.receive([](atom::done) { /* nop */ },
+             [](caf::error&) { FAIL("failed to replace partitions"); });
+  auto compacted = list();
+  REQUIRE_EQUAL(compacted.size(), 1u);
+  CHECK(std::find(partitions.begin(), partitions.end(), compacted.front())
+        == partitions.end());
+  MESSAGE("replacing unknown partitions fails");
+  auto rp2 = self->request(index, caf::infinite, atom::replace_v, partitions,
+                           first_n(slices, 1));
+  run();
+  rp2.receive([](atom::done) { FAIL("replaced unknown partitions"); },
+              [](caf::error&) { /* nop */ });
+  MESSAGE("query half of the values");
+  auto [query_id, hits, scheduled] = query(":int == 1");
+  ids expected_result;
+  for (size_t i = 0; i < rows(slices) / 2; ++i) {
+    expected_result.append_bit(false);
+    expected_result.append_bit(true);
+  }
+  auto result = receive_result(query_id, hits, scheduled);
+  CHECK_EQUAL(result, expected_result);
+}
+
+TEST(partition compaction waits for pending queries) {
+  auto num_slices = taste_count * 2;
+  MESSAGE("fill first " << num_slices << " partitions");
+  auto slices = rebase(first_n(alternating_integers, num_slices));
+  auto src = detail::spawn_container_source(sys, slices, index);
+  run();
+  auto list = [&] {
+    std::vector<uuid> result;
+    auto rp = self->request(index, caf::infinite, atom::list_v);
+    run();
+    rp.receive([&](std::vector<uuid>& xs) { result = std::move(xs); },
+               [](caf::error&) { FAIL("failed to list partitions"); });
+    return result;
+  };
+  auto partitions = list();
+  REQUIRE_GREATER(partitions.size(), taste_count);
+  MESSAGE("start a query and only collect the first taste");
+  auto [query_id, hits, scheduled] = query(":int == 1");
+  CHECK_EQUAL(hits, partitions.size());
+  CHECK_EQUAL(scheduled, taste_count);
+  receive_result(query_id, scheduled, scheduled);
+  MESSAGE("the replacement waits for the pending query");
+  auto rp = self->request(index, caf::infinite, atom::replace_v, partitions,
+                          first_n(slices, partitions.size()));
+  run();
+  CHECK_EQUAL(state().deferred_replacements.size(), 1u);
+  CHECK_EQUAL(list().size(), partitions.size());
+  MESSAGE("dropping the query completes the replacement");
+  self->send(index, query_id, uint32_t{0});
+  run();
+  rp.receive([](atom::done) { /* nop */ },
+             [](caf::error&) { FAIL("failed to replace partitions"); });
+  CHECK(state().deferred_replacements.empty());
+  CHECK_EQUAL(list().size(), 1u);
+}
+
 TEST(iterable integer query result) {
   auto partitions = taste_count * 3;
   MESSAGE("fill first " << partitions << " partitions");
@@ -217,4 +313,58 @@ TEST(iterable zeek conn log query result) {
   }
 }
 
+TEST(interleaved importers) {
+  MESSAGE("spawn an INDEX with room for many slices per partition");
+  anon_send_exit(index, caf::exit_reason::user_shutdown);
+  run();
+  index = spawn_index("interleaved", slice_size * 16);
+  constexpr auto block_size = system::id_allocator::block_size;
+  auto at = alternating_integers_at;
+  MESSAGE("stream two importers with interleaved ID blocks");
+  // The first importer moves on from the end of block 0 to block 2 while the
+  // second importer streams into block 1.
+  auto first = std::vector<table_slice>{
+    at(0, block_size - 2 * slice_size), at(1, block_size - slice_size),
+    at(2, 2 * block_size), at(3, 2 * block_size + slice_size)};
+  auto second = std::vector<table_slice>{
+    at(4, block_size), at(5, block_size + slice_size),
+    at(6, block_size + 2 * slice_size)};
+  auto src1 = detail::spawn_container_source(sys, first, index);
+  auto src2 = detail::spawn_container_source(sys, second, index);
+  run();
+  MESSAGE("the first importer retired its partition for block 0");
+  auto& active = state().active_partitions;
+  CHECK_EQUAL(active.size(), 2u);
+  CHECK_EQUAL(active.count(0), 0u);
+  CHECK_EQUAL(active.count(1), 1u);
+  CHECK_EQUAL(active.count(2), 1u);
+  CHECK(state().unpersisted.empty());
+  CHECK_EQUAL(state().persisted_partitions.size(), 1u);
+  MESSAGE("a single importer splits partitions at block boundaries");
+  CHECK_EQUAL(active[2].capacity, slice_size * 14);
+  CHECK_EQUAL(active[1].capacity, slice_size * 13);
+  MESSAGE("query half of the values across all partitions");
+  auto [query_id, hits, scheduled] = query(":int == 1");
+  CHECK_EQUAL(hits, 3u);
+  auto offsets = std::vector<id>{};
+  for (auto& slices : {first, second})
+    for (auto& slice : slices)
+      offsets.push_back(slice.offset());
+  std::sort(offsets.begin(), offsets.end());
+  ids expected_result;
+  for (auto offset : offsets) {
+    expected_result.append_bits(false, offset - expected_result.size());
+    for (size_t i = 0; i < slice_size / 2; ++i) {
+      expected_result.append_bit(false);
+      expected_result.append_bit(true);
+    }
+  }
+  auto result = receive_result(query_id, hits, scheduled);
+  if (result.size() > expected_result.size())
+    expected_result.append_bits(false,
+                                result.size() - expected_result.size());
+  CHECK_EQUAL(rank(result), rank(expected_result));
+  CHECK_EQUAL(result, expected_result);
+}
+
 FIXTURE_SCOPE_END()
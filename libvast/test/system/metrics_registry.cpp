@@ -0,0 +1,91 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE metrics_registry
+#include "vast/system/metrics_registry.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vast::system;
+
+TEST(counters from multiple threads) {
+  metrics_registry registry;
+  auto& x = registry.counter("x");
+  CHECK(&x == &registry.counter("x"));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j)
+        x.add();
+    });
+  for (auto& thread : threads)
+    thread.join();
+  CHECK_EQUAL(x.value(), 4000u);
+}
+
+TEST(gauges) {
+  metrics_registry registry;
+  auto& x = registry.gauge("x");
+  x.set(42);
+  x.add(-50);
+  CHECK_EQUAL(x.value(), -8);
+}
+
+TEST(histogram buckets) {
+  for (uint64_t x : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 17ull, 1000ull,
+                     123456789ull, ~0ull}) {
+    auto bucket = metrics_histogram::bucket(x);
+    REQUIRE_LESS(bucket, metrics_histogram::num_buckets);
+    auto upper = metrics_histogram::upper_bound(bucket);
+    CHECK_GREATER_EQUAL(upper, x);
+    // The relative error is bounded by the number of sub-buckets.
+    CHECK_LESS_EQUAL(upper - x, x / metrics_histogram::sub_buckets);
+  }
+  // Small values have exact buckets.
+  CHECK_EQUAL(metrics_histogram::upper_bound(metrics_histogram::bucket(5)),
+              5u);
+}
+
+TEST(histogram quantiles) {
+  metrics_registry registry;
+  auto& x = registry.histogram("x");
+  for (uint64_t i = 1; i <= 100; ++i)
+    x.record(i);
+  auto snapshot = x.sample();
+  CHECK_EQUAL(snapshot.count, 100u);
+  CHECK_EQUAL(snapshot.sum, 5050u);
+  CHECK_EQUAL(snapshot.max, 100u);
+  auto p50 = snapshot.quantile(0.5);
+  CHECK_GREATER_EQUAL(p50, 50u);
+  CHECK_LESS_EQUAL(p50, 55u);
+  CHECK_EQUAL(snapshot.quantile(1.0), 100u);
+}
+
+TEST(prometheus exposition) {
+  metrics_registry registry;
+  registry.counter("importer.events").add(3);
+  registry.gauge("index.partitions").set(2);
+  registry.histogram("query.latency").record(7);
+  auto text = to_prometheus(registry.sample());
+  CHECK(text.find("# TYPE vast_importer_events counter\n"
+                  "vast_importer_events 3\n")
+        != std::string::npos);
+  CHECK(text.find("vast_index_partitions 2\n") != std::string::npos);
+  CHECK(text.find("vast_query_latency{quantile=\"0.5\"} 7\n")
+        != std::string::npos);
+  CHECK(text.find("vast_query_latency_count 1\n") != std::string::npos);
+}
@@ -68,6 +68,22 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state> self) {
     },
     [=](const uuid&, uint32_t) { FAIL("no mock implementation available"); },
     [=](atom::erase, uuid) -> ids { FAIL("no mock implementation available"); },
+    [=](atom::list) -> std::vector<uuid> {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::estimate, expression&) -> uint64_t {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::estimate, expression&, std::string&) -> double {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::replace, std::vector<uuid>&,
+        std::vector<table_slice>&) -> atom::done {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::internal, atom::load) {
+      FAIL("no mock implementation available");
+    },
   };
 }
 
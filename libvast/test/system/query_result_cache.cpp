@@ -0,0 +1,97 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE query_result_cache
+#include "vast/system/query_result_cache.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/test/test.hpp"
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    x = uuid::random();
+    y = uuid::random();
+  }
+
+  uuid x;
+  uuid y;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(query_result_cache_tests, fixture)
+
+TEST(keys of equivalent expressions) {
+  auto lhs = unbox(to<expression>("x == 42 && y > 1"));
+  auto rhs = unbox(to<expression>("42 == x && ! (y <= 1)"));
+  CHECK_EQUAL(query_result_cache::key(lhs), query_result_cache::key(rhs));
+}
+
+TEST(lookup and insert) {
+  query_result_cache cache{1024 * 1024};
+  CHECK(!cache.lookup("foo", x));
+  auto hits = make_ids({{10, 20}});
+  cache.insert("foo", x, hits);
+  cache.insert("foo", y, ids{});
+  auto cached = cache.lookup("foo", x);
+  REQUIRE(cached);
+  CHECK_EQUAL(*cached, hits);
+  cached = cache.lookup("foo", y);
+  REQUIRE(cached);
+  CHECK(cached->empty());
+  CHECK(!cache.lookup("bar", x));
+  auto stats = cache.stats();
+  CHECK_EQUAL(stats.hits, 2u);
+  CHECK_EQUAL(stats.misses, 2u);
+  CHECK_EQUAL(stats.entries, 2u);
+  CHECK_GREATER(stats.memory_usage, 0u);
+}
+
+TEST(erasing a partition) {
+  query_result_cache cache{1024 * 1024};
+  cache.insert("foo", x, make_ids({{0, 5}}));
+  cache.insert("bar", x, make_ids({{5, 10}}));
+  cache.insert("foo", y, make_ids({{10, 15}}));
+  cache.erase(x);
+  CHECK(!cache.lookup("foo", x));
+  CHECK(!cache.lookup("bar", x));
+  CHECK(cache.lookup("foo", y));
+  CHECK_EQUAL(cache.stats().entries, 1u);
+  cache.erase(y);
+  CHECK_EQUAL(cache.stats().entries, 0u);
+  CHECK_EQUAL(cache.stats().memory_usage, 0u);
+}
+
+TEST(eviction of the least recently used results) {
+  query_result_cache probe{1024 * 1024};
+  probe.insert("a", x, make_ids({{0, 5}}));
+  auto entry_size = probe.stats().memory_usage;
+  query_result_cache cache{2 * entry_size};
+  cache.insert("a", x, make_ids({{0, 5}}));
+  cache.insert("b", x, make_ids({{0, 5}}));
+  CHECK(cache.lookup("a", x));
+  cache.insert("c", x, make_ids({{0, 5}}));
+  CHECK_EQUAL(cache.stats().entries, 2u);
+  CHECK(cache.lookup("a", x));
+  CHECK(!cache.lookup("b", x));
+  CHECK(cache.lookup("c", x));
+  CHECK_LESS_EQUAL(cache.stats().memory_usage, 2 * entry_size);
+}
+
+FIXTURE_SCOPE_END()
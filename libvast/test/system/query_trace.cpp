@@ -0,0 +1,81 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE query_trace
+#include "vast/system/query_trace.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <algorithm>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::chrono_literals;
+
+namespace {
+
+const data_point* find(const report& xs, const std::string& key) {
+  auto pred = [&](const data_point& x) { return x.key == key; };
+  auto i = std::find_if(xs.begin(), xs.end(), pred);
+  return i != xs.end() ? &*i : nullptr;
+}
+
+} // namespace
+
+TEST(tracing a query) {
+  auto trace = query_trace{};
+  trace.record(query_stage::indexer_lookup, 2ms);
+  trace.record(query_stage::indexer_lookup, 5ms);
+  trace.record(query_stage::sink_write, 1ms);
+  trace.record_partition(true);
+  trace.record_partition(false);
+  trace.record_partition(false);
+  auto& lookups
+    = trace.stages[static_cast<size_t>(query_stage::indexer_lookup)];
+  CHECK_EQUAL(lookups.count, 2u);
+  CHECK_EQUAL(lookups.total, duration{7ms});
+  CHECK_EQUAL(lookups.max, duration{5ms});
+  CHECK_EQUAL(trace.partition_cache_hits, 1u);
+  CHECK_EQUAL(trace.partition_cache_misses, 2u);
+  auto r = to_report(trace, "exporter.trace");
+  auto count = find(r, "exporter.trace.indexer-lookup.count");
+  REQUIRE(count);
+  CHECK_EQUAL(caf::get<uint64_t>(count->value), 2u);
+  CHECK(find(r, "exporter.trace.sink-write.max"));
+  // Stages without measurements do not show up.
+  CHECK(!find(r, "exporter.trace.select.count"));
+}
+
+TEST(merging traces) {
+  auto trace = query_trace{};
+  trace.id = uuid::random();
+  trace.record(query_stage::indexer_lookup, 2ms);
+  trace.record_partition(true);
+  auto other = query_trace{};
+  other.record(query_stage::indexer_lookup, 5ms);
+  other.record(query_stage::partition_load, 3ms);
+  other.record_partition(false);
+  auto id = trace.id;
+  trace.merge(other);
+  CHECK_EQUAL(trace.id, id);
+  auto& lookups
+    = trace.stages[static_cast<size_t>(query_stage::indexer_lookup)];
+  CHECK_EQUAL(lookups.count, 2u);
+  CHECK_EQUAL(lookups.total, duration{7ms});
+  CHECK_EQUAL(lookups.max, duration{5ms});
+  auto& loads = trace.stages[static_cast<size_t>(query_stage::partition_load)];
+  CHECK_EQUAL(loads.count, 1u);
+  CHECK_EQUAL(loads.max, duration{3ms});
+  CHECK_EQUAL(trace.partition_cache_hits, 1u);
+  CHECK_EQUAL(trace.partition_cache_misses, 1u);
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#define SUITE slice_transport
+
+#include "vast/system/slice_transport.hpp"
+
+#include "vast/test/fixtures/events.hpp"
+#include "vast/test/test.hpp"
+
+#include "vast/config.hpp"
+#include "vast/error.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+struct fixture : fixtures::events {
+  fixture() {
+    REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+  }
+
+  ~fixture() {
+    for (auto fd : fds)
+      if (fd >= 0)
+        ::close(fd);
+  }
+
+#if VAST_LINUX
+
+  /// Writes a table slice into a new memory file descriptor.
+  static int make_memfd(const table_slice& slice, int seals) {
+    auto bytes = as_bytes(slice);
+    auto fd = ::memfd_create("test-slice", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    REQUIRE_GREATER_EQUAL(fd, 0);
+    REQUIRE_EQUAL(::write(fd, bytes.data(), bytes.size()),
+                  static_cast<ssize_t>(bytes.size()));
+    if (seals != 0)
+      REQUIRE_EQUAL(::fcntl(fd, F_ADD_SEALS, seals), 0);
+    return fd;
+  }
+
+  /// Sends a frame for a memory file descriptor like `send_slice`, but with
+  /// an arbitrary size in the header.
+  void send_frame(int memfd, uint64_t size) {
+    // Mirrors the frame layout of the local transport.
+    struct {
+      uint64_t magic = 0x56415354534c4943; // "VASTSLIC"
+      uint64_t size;
+    } header;
+    header.size = size;
+    ::iovec iov = {&header, sizeof(header)};
+    alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    ::msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+    REQUIRE_EQUAL(::sendmsg(fds[0], &msg, 0),
+                  static_cast<ssize_t>(sizeof(header)));
+    ::close(memfd);
+  }
+
+  /// Expects the next received table slice to be rejected.
+  void check_rejected() {
+    auto received = receive_slice(fds[1]);
+    REQUIRE(!received);
+    CHECK_EQUAL(received.error(), ec::format_error);
+  }
+
+  static constexpr int all_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+
+#endif // VAST_LINUX
+
+  int fds[2] = {-1, -1};
+};
+
+} // namespace
+
+FIXTURE_SCOPE(slice_transport_tests, fixture)
+
+#if VAST_LINUX
+
+TEST(roundtrip) {
+  for (auto& slice : zeek_conn_log)
+    REQUIRE_EQUAL(send_slice(fds[0], slice), caf::none);
+  for (auto& slice : zeek_conn_log) {
+    auto received = unbox(receive_slice(fds[1]));
+    CHECK_EQUAL(received, slice);
+    CHECK_EQUAL(received.layout(), slice.layout());
+    // The received table slice maps the memory of the sender.
+    CHECK(as_bytes(received).data() != as_bytes(slice).data());
+  }
+}
+
+TEST(end of input) {
+  auto stalled = receive_slice(fds[1]);
+  REQUIRE(!stalled);
+  CHECK_EQUAL(stalled.error(), ec::stalled);
+  REQUIRE_EQUAL(send_slice(fds[0], zeek_conn_log[0]), caf::none);
+  ::close(fds[0]);
+  fds[0] = -1;
+  CHECK_EQUAL(unbox(receive_slice(fds[1])), zeek_conn_log[0]);
+  auto eof = receive_slice(fds[1]);
+  REQUIRE(!eof);
+  CHECK_EQUAL(eof.error(), ec::end_of_input);
+}
+
+TEST(malformed frame) {
+  auto garbage = std::string{"not a table slice"};
+  REQUIRE(::send(fds[0], garbage.data(), garbage.size(), 0) > 0);
+  auto received = receive_slice(fds[1]);
+  REQUIRE(!received);
+  CHECK_EQUAL(received.error(), ec::format_error);
+}
+
+TEST(unsealed memfd) {
+  auto& slice = zeek_conn_log[0];
+  auto size = as_bytes(slice).size();
+  MESSAGE("the well-formed frame gets accepted");
+  send_frame(make_memfd(slice, all_seals), size);
+  CHECK_EQUAL(unbox(receive_slice(fds[1])), slice);
+  MESSAGE("a memfd without seals gets rejected");
+  send_frame(make_memfd(slice, 0), size);
+  check_rejected();
+  MESSAGE("a memfd that the client can still write gets rejected");
+  send_frame(make_memfd(slice, F_SEAL_SHRINK | F_SEAL_GROW), size);
+  check_rejected();
+  MESSAGE("a memfd that the client can still shrink gets rejected");
+  send_frame(make_memfd(slice, F_SEAL_GROW | F_SEAL_WRITE), size);
+  check_rejected();
+}
+
+TEST(size mismatch) {
+  auto& slice = zeek_conn_log[0];
+  auto size = as_bytes(slice).size();
+  MESSAGE("a frame that exceeds the memfd gets rejected");
+  send_frame(make_memfd(slice, all_seals), size + 1);
+  check_rejected();
+  MESSAGE("a frame that falls short of the memfd gets rejected");
+  send_frame(make_memfd(slice, all_seals), size - 1);
+  check_rejected();
+  MESSAGE("an empty frame gets rejected");
+  send_frame(make_memfd(slice, all_seals), 0);
+  check_rejected();
+}
+
+#endif // VAST_LINUX
+
+FIXTURE_SCOPE_END()
@@ -19,6 +19,7 @@
 #include "vast/test/test.hpp"
 
 #include "vast/concept/parseable/to.hpp"
+#include "vast/config.hpp"
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/expression.hpp"
 #include "vast/ids.hpp"
@@ -208,4 +209,27 @@ TEST(evaluate) {
   check_eval("#field != \"orig_pkts\"", {});
 }
 
+TEST(preferred encoding) {
+  auto narrow = record_type{
+    {"host", string_type{}},
+    {"message", string_type{}},
+    {"ts", time_type{}},
+  };
+  auto numeric = record_type{
+    {"ts", time_type{}},
+    {"src", address_type{}},
+    {"bytes", count_type{}},
+    {"note", string_type{}},
+  };
+#if VAST_ENABLE_ARROW
+  CHECK_EQUAL(preferred_encoding(narrow), table_slice_encoding::msgpack);
+  CHECK_EQUAL(preferred_encoding(numeric), table_slice_encoding::arrow);
+  CHECK_EQUAL(preferred_encoding(zeek_conn_log[0].layout()),
+              table_slice_encoding::arrow);
+#else
+  CHECK_EQUAL(preferred_encoding(narrow), table_slice_encoding::msgpack);
+  CHECK_EQUAL(preferred_encoding(numeric), table_slice_encoding::msgpack);
+#endif
+}
+
 FIXTURE_SCOPE_END()
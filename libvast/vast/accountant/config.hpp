@@ -15,6 +15,7 @@
 
 #include "vast/defaults.hpp"
 #include "vast/detail/posix.hpp"
+#include "vast/time.hpp"
 
 #include <caf/expected.hpp>
 
@@ -39,13 +40,24 @@ struct accountant_config {
   struct uds_sink {
     bool enable = false;
     bool real_time = false;
+    /// Write length-prefixed binary records instead of JSON lines.
+    bool binary = false;
     std::string path;
     detail::socket_type type;
   };
 
+  struct prometheus_sink {
+    bool enable = false;
+    std::string path;
+  };
+
+  /// The interval between two samples of the metrics registry.
+  duration sample_interval = defaults::system::metrics_sample_interval;
+
   self_sink self_sink;
   file_sink file_sink;
   uds_sink uds_sink;
+  prometheus_sink prometheus_sink;
 };
 
 caf::expected<accountant_config>
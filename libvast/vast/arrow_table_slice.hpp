@@ -30,8 +30,8 @@ struct arrow_table_slice_state;
 
 template <>
 struct arrow_table_slice_state<fbs::table_slice::arrow::v0> {
-  /// The deserialized table layout.
-  record_type layout;
+  /// The interned table layout.
+  const interned_layout* layout;
 
   /// The deserialized Arrow Record Batch.
   std::shared_ptr<arrow::RecordBatch> record_batch;
@@ -70,6 +70,9 @@ public:
   /// @returns The table layout.
   const record_type& layout() const noexcept;
 
+  /// @returns The interned table layout.
+  const interned_layout& interned() const noexcept;
+
   /// @returns The number of rows in the slice.
   table_slice::size_type rows() const noexcept;
 
@@ -99,6 +102,10 @@ public:
   data_view at(table_slice::size_type row, table_slice::size_type column,
                const type& t) const;
 
+  /// Decodes all values of the slice at once.
+  /// @param result The decoded values in column-major order.
+  void decode_columns(std::vector<std::vector<data_view>>& result) const;
+
   /// @returns A shared pointer to the underlying Arrow Record Batch.
   std::shared_ptr<arrow::RecordBatch> record_batch() const noexcept;
 
@@ -63,6 +63,19 @@ public:
   static table_slice_builder_ptr
   make(record_type layout, size_t initial_buffer_size = default_buffer_size);
 
+  /// Constructs an Arrow-encoded table slice from an existing Record Batch,
+  /// e.g., a zero-copy slice of the Record Batch of another table slice.
+  /// @param record_batch The Record Batch to serialize.
+  /// @param layout The layout of the slice.
+  /// @param serialized_layout The serialized *layout*, if available.
+  /// @param initial_buffer_size The buffer size the builder starts with.
+  /// @pre The schema of *record_batch* matches *layout*.
+  /// @returns The new table slice.
+  static table_slice
+  create(const arrow::RecordBatch& record_batch, const record_type& layout,
+         span<const std::byte> serialized_layout = {},
+         size_t initial_buffer_size = default_buffer_size);
+
   /// Destroys an Arrow table slice builder.
   ~arrow_table_slice_builder() noexcept override;
 
@@ -59,6 +59,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_atoms, caf::id_block::vast_types::end)
   VAST_ADD_ATOM(empty, "empty")
   VAST_ADD_ATOM(enable, "enable")
   VAST_ADD_ATOM(erase, "erase")
+  VAST_ADD_ATOM(estimate, "estimate")
   VAST_ADD_ATOM(exists, "exists")
   VAST_ADD_ATOM(extract, "extract")
   VAST_ADD_ATOM(filesystem, "filesystem")
@@ -107,6 +108,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_atoms, caf::id_block::vast_types::end)
   VAST_ADD_ATOM(submit, "submit")
   VAST_ADD_ATOM(taxonomies, "taxonomies")
   VAST_ADD_ATOM(telemetry, "telemetry")
+  VAST_ADD_ATOM(trace, "trace")
   VAST_ADD_ATOM(try_put, "tryPut")
   VAST_ADD_ATOM(unload, "unload")
   VAST_ADD_ATOM(value, "value")
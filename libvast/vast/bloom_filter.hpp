@@ -68,6 +68,14 @@ public:
     // nop
   }
 
+  /// Constructs a Bloom filter from a hasher and existing cells.
+  /// @param hasher The hasher type to generate digests.
+  /// @param bits The cells of the Bloom filter.
+  bloom_filter(hasher_type hasher, bitvector<uint64_t> bits)
+    : hasher_{std::move(hasher)}, bits_{std::move(bits)} {
+    // nop
+  }
+
   /// Adds an element to the Bloom filter.
   /// @param x The element to add.
   template <class T>
@@ -105,6 +113,16 @@ public:
     return hasher_.size();
   }
 
+  /// @returns The hasher that generates the digests.
+  const hasher_type& hasher() const {
+    return hasher_;
+  }
+
+  /// @returns The underlying bit vector.
+  const bitvector<uint64_t>& bits() const {
+    return bits_;
+  }
+
   // -- concepts --------------------------------------------------------------
 
   friend bool operator==(const bloom_filter& x, const bloom_filter& y) {
@@ -78,6 +78,11 @@ public:
     return source(bloom_filter_);
   }
 
+  /// @returns The underlying Bloom filter.
+  const bloom_filter_type& filter() const noexcept {
+    return bloom_filter_;
+  }
+
 protected:
   bloom_filter<HashFunction> bloom_filter_;
 };
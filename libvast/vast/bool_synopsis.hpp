@@ -29,6 +29,14 @@ public:
   caf::optional<bool> lookup(relational_operator op,
                              data_view rhs) const override;
 
+  /// Tests whether a predicate matches without materializing a synopsis.
+  /// @param any_true Whether the column has any "true" value.
+  /// @param any_false Whether the column has any "false" value.
+  /// @param op The operator of the predicate.
+  /// @param rhs The RHS of the predicate.
+  static caf::optional<bool> lookup(bool any_true, bool any_false,
+                                    relational_operator op, data_view rhs);
+
   bool equals(const synopsis& other) const noexcept override;
 
   size_t memusage() const override;
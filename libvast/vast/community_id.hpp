@@ -16,6 +16,7 @@
 #include <cstddef>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <caf/optional.hpp>
 
@@ -121,6 +122,20 @@ constexpr size_t max_length() {
     static_assert(detail::always_false_v<Policy>, "unsupported plicy");
 }
 
+/// Computes the exact length of the Community ID string.
+/// @see version_prefix_length
+template <class Policy>
+constexpr size_t length() {
+  constexpr size_t digest_size = 160 / 8;
+  auto prefix = version_prefix_length();
+  if constexpr (std::is_same_v<Policy, policy::base64>)
+    return prefix + detail::base64::encoded_size(digest_size);
+  else if constexpr (std::is_same_v<Policy, policy::ascii>)
+    return prefix + digest_size * 2;
+  else
+    static_assert(detail::always_false_v<Policy>, "unsupported plicy");
+}
+
 /// Calculates the Community ID for a given flow.
 /// @tparam Policy The rendering policy to select Base64 or ASCII.
 /// @param x The flow tuple.
@@ -157,5 +172,52 @@ std::string compute(const flow& x, uint16_t seed = 0) {
   return result;
 }
 
+/// Calculates the Community IDs for many flows at once. The SHA-1 hashes of
+/// the flow tuples are computed in lockstep over multiple flows, and the
+/// results are appended back-to-back to a single buffer.
+/// @tparam Policy The rendering policy to select Base64 or ASCII.
+/// @param xs The flow tuples.
+/// @param arena The buffer to append to. The Community ID for `xs[i]` occupies
+///        `length<Policy>()` bytes starting at offset `i * length<Policy>()`
+///        of the appended range.
+/// @param seed An optional seed to the SHA-1 hash.
+template <class Policy>
+void compute(span<const flow> xs, std::string& arena, uint16_t seed = 0) {
+  // The seed, two addresses, the protocol, one byte of padding, two ports.
+  constexpr auto max_tuple_size = 2 + 2 * sizeof(address) + 1 + 1 + 2 * 2;
+  static_assert(max_tuple_size <= sha1_batch::max_message_size,
+                "a flow tuple must fit into a single SHA-1 block");
+  sha1_batch hasher;
+  for (auto& x : xs) {
+    hash_append(hasher, detail::to_network_order(seed));
+    community_id_hash_append(hasher, x);
+    hasher.finish_message();
+  }
+  std::vector<sha1::result_type> digests(xs.size());
+  hasher.digest(digests.data());
+  // Perform exactly one allocator round-trip.
+  auto offset = arena.size();
+  arena.resize(offset + xs.size() * length<Policy>());
+  auto out = arena.data() + offset;
+  for (auto& digest : digests) {
+    out[0] = version;
+    out[1] = ':';
+    auto bytes = as_bytes(span{digest.data(), digest.size()});
+    auto ptr = out + version_prefix_length();
+    if constexpr (std::is_same_v<Policy, policy::base64>) {
+      detail::base64::encode(ptr, bytes.data(), bytes.size());
+    } else if constexpr (std::is_same_v<Policy, policy::ascii>) {
+      for (auto byte : bytes) {
+        auto [hi, lo] = detail::byte_to_hex<policy::lowercase>(byte);
+        *ptr++ = hi;
+        *ptr++ = lo;
+      }
+    } else {
+      static_assert(detail::always_false_v<Policy>, "unsupported plicy");
+    }
+    out += length<Policy>();
+  }
+}
+
 } // namespace community_id
 } // namespace vast
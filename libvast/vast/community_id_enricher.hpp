@@ -0,0 +1,75 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/flow.hpp"
+#include "vast/layout_interner.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/type.hpp"
+
+#include <caf/optional.hpp>
+
+#include <string>
+#include <vector>
+
+namespace vast {
+
+/// Adds Community IDs to the events of well-known flow layouts, i.e.,
+/// `zeek.conn` and `suricata.flow`. Layouts without a `community_id` field
+/// gain one as their last field, and an existing `community_id` field gets
+/// filled in where it is null. The Community IDs of a table slice are
+/// computed in a single batch.
+class community_id_enricher {
+public:
+  /// Enriches a table slice.
+  /// @param slice The table slice to enrich.
+  /// @returns The enriched table slice, or *slice* if it contains no flow
+  ///          events that lack a Community ID.
+  table_slice operator()(table_slice slice);
+
+private:
+  /// Describes how to enrich the table slices of one layout.
+  struct layout_plan {
+    /// The flat indexes of the columns that make up the flow tuple, in the
+    /// order source address, source port, destination address, destination
+    /// port, and protocol.
+    std::vector<size_t> flow_columns;
+
+    /// The flat index of the existing Community ID column, if any.
+    caf::optional<size_t> community_id_column;
+
+    /// The layout of the enriched table slices.
+    record_type layout;
+  };
+
+  /// Creates the enrichment plan for a layout, which has no flow columns if
+  /// the layout is not a known flow layout.
+  static layout_plan make_plan(const record_type& layout);
+
+  /// Caches the enrichment plans per layout.
+  layout_table<layout_plan> plans_;
+
+  /// The flows of the current table slice that lack a Community ID.
+  std::vector<flow> flows_;
+
+  /// Maps the rows of the current table slice to their index in `flows_`.
+  std::vector<caf::optional<size_t>> rows_;
+
+  /// Holds the Community IDs of the current table slice.
+  std::string arena_;
+};
+
+} // namespace vast
@@ -16,6 +16,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "vast/detail/endian.hpp"
 
@@ -51,4 +52,40 @@ private:
   uint64_t total_ = 0;
 };
 
+/// Computes the SHA-1 digests of many short messages at once. Every message
+/// must fit into a single block after padding, and the compression function
+/// runs on `lanes` messages in lockstep so that the compiler can map the lanes
+/// to SIMD registers.
+class sha1_batch {
+public:
+  using result_type = sha1::result_type;
+
+  static constexpr detail::endianness endian = detail::host_endian;
+
+  /// The maximum size of a single message in bytes.
+  static constexpr size_t max_message_size = 55;
+
+  /// The number of messages that get compressed in lockstep.
+  static constexpr size_t lanes = 8;
+
+  /// Appends bytes to the current message.
+  /// @pre The current message does not exceed `max_message_size`.
+  void operator()(const void* xs, size_t n) noexcept;
+
+  /// Completes the current message and begins the next one.
+  void finish_message() noexcept;
+
+  /// @returns The number of completed messages.
+  size_t size() const noexcept;
+
+  /// Computes the digests of all completed messages and clears the batch.
+  /// @param digests The array to write `size()` digests to.
+  void digest(result_type* digests) noexcept;
+
+private:
+  std::vector<std::array<unsigned char, 64>> blocks_;
+  std::array<unsigned char, 64> current_ = {};
+  size_t pos_ = 0;
+};
+
 } // namespace vast
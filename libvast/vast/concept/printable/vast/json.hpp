@@ -19,11 +19,20 @@
 #include "vast/concept/printable/print.hpp"
 #include "vast/concept/printable/std/chrono.hpp"
 #include "vast/concept/printable/string.hpp"
+#include "vast/concept/printable/vast/address.hpp"
+#include "vast/concept/printable/vast/subnet.hpp"
 #include "vast/data.hpp"
+#include "vast/detail/assert.hpp"
 #include "vast/detail/escapers.hpp"
 #include "vast/time.hpp"
 #include "vast/view.hpp"
 
+#include <charconv>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <string_view>
+
 namespace vast {
 
 namespace policy {
@@ -60,17 +69,26 @@ struct json_printer : printer<json_printer<TreePolicy, Indent, Padding>> {
 
     template <class T>
     bool operator()(const T& x) {
-      if constexpr (std::is_arithmetic_v<T>) {
-        auto str = std::to_string(x);
+      // The arithmetic cases produce the same output as std::to_string, but
+      // format into a buffer on the stack instead of allocating a string.
+      if constexpr (std::is_integral_v<T>) {
+        char buf[std::numeric_limits<T>::digits10 + 3];
+        auto [ptr, ec] = std::to_chars(std::begin(buf), std::end(buf), x);
+        VAST_ASSERT(ec == std::errc{});
+        return printers::str.print(
+          out_, std::string_view{buf, static_cast<size_t>(ptr - buf)});
+      } else if constexpr (std::is_floating_point_v<T>) {
+        char buf[std::numeric_limits<double>::max_exponent10 + 20];
+        auto n = std::snprintf(buf, sizeof(buf), "%f", static_cast<double>(x));
+        VAST_ASSERT(n > 0 && static_cast<size_t>(n) < sizeof(buf));
+        auto str = std::string_view{buf, static_cast<size_t>(n)};
         real i;
-        if constexpr (std::is_floating_point_v<T>) {
-          if (std::modf(x, &i) == 0.0)
-            // Do not show 0 as 0.0.
-            str.erase(str.find('.'), std::string::npos);
-          else
-            // Avoid trailing zeros.
-            str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-        }
+        if (std::modf(x, &i) == 0.0)
+          // Do not show 0 as 0.0.
+          str = str.substr(0, str.find('.'));
+        else
+          // Avoid trailing zeros.
+          str = str.substr(0, str.find_last_not_of('0') + 1);
         return printers::str.print(out_, str);
       } else {
         data y;
@@ -105,6 +123,16 @@ struct json_printer : printer<json_printer<TreePolicy, Indent, Padding>> {
       return p.print(out_, x);
     }
 
+    bool operator()(const view<address>& x) {
+      static auto p = '"' << make_printer<address>{} << '"';
+      return p.print(out_, x);
+    }
+
+    bool operator()(const view<subnet>& x) {
+      static auto p = '"' << make_printer<subnet>{} << '"';
+      return p.print(out_, x);
+    }
+
     bool operator()(const std::pair<std::string_view, view<data>>& kvp) {
       using namespace printers;
       if (!(*this)(kvp.first))
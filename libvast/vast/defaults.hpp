@@ -40,6 +40,12 @@ namespace import {
 /// Maximum size for sources that generate table slices.
 constexpr size_t table_slice_size = 1000;
 
+/// Lower bound for the size of table slices when adapting it to the input rate.
+constexpr size_t min_table_slice_size = 128;
+
+/// Upper bound for the size of table slices when adapting it to the input rate.
+constexpr size_t max_table_slice_size = 65'536;
+
 #if VAST_ENABLE_ARROW
 
 /// The default table slice type when arrow is available.
@@ -66,6 +72,19 @@ constexpr std::chrono::milliseconds read_timeout
 /// Path for reading input events or `-` for reading from STDIN.
 constexpr std::string_view read = "-";
 
+/// Label of the IMPORTER that assigns IDs to the events of a source.
+constexpr std::string_view importer = "importer";
+
+/// Number of datagrams that a UDP source buffers between the socket and the
+/// reader. A value of 0 handles one datagram at a time in the CAF broker.
+constexpr size_t listen_buffer = 4096;
+
+/// Maximum size of a datagram that a UDP source receives without truncation.
+constexpr size_t max_datagram_size = 9216;
+
+/// Requested size of the socket receive buffer of a UDP source in bytes.
+constexpr int socket_receive_buffer = 8 * 1024 * 1024;
+
 /// Contains settings for the csv subcommand.
 struct csv {
   static constexpr char separator = ',';
@@ -107,6 +126,10 @@ struct pcap {
   /// of 65535 should be sufficient, on most if not all networks, to capture all
   /// the data available from the packet.
   static constexpr size_t snaplen = 65535;
+
+  /// Number of threads that process packets of offline traces, partitioned
+  /// by flow. A value of 0 or 1 processes all packets on the reading thread.
+  static constexpr size_t shards = 0;
 };
 
 } // namespace import
@@ -146,6 +169,9 @@ constexpr size_t max_events = 0;
 /// Path for writing query results or `-` for writing to STDOUT.
 constexpr std::string_view write = "-";
 
+/// Number of bytes that writers buffer before writing to their output stream.
+constexpr size_t write_buffer_size = 256 * 1024;
+
 /// Contains settings for the csv subcommand.
 struct csv {
   static constexpr char separator = ',';
@@ -154,6 +180,15 @@ struct csv {
   static constexpr std::string_view set_separator = " | ";
 };
 
+/// Contains settings for the arrow subcommand.
+struct arrow {
+  /// Minimum number of rows per written record batch.
+  static constexpr size_t batch_size = 65'536;
+
+  /// Maximum number of bytes buffered across all layouts.
+  static constexpr size_t max_buffered_bytes = 256 * 1024 * 1024; // 256_MiB
+};
+
 /// Contains settings for the pcap subcommand.
 struct pcap {
   /// Flush to disk after that many packets.
@@ -248,6 +283,16 @@ constexpr caf::timespan aging_frequency = std::chrono::hours{24};
 /// Interval between two disk scanning cycles.
 constexpr std::chrono::seconds disk_scan_interval = std::chrono::minutes{1};
 
+/// Interval between two scans for small partitions to compact.
+constexpr std::chrono::seconds compaction_interval = std::chrono::hours{1};
+
+/// Maximum number of concurrently running compactions.
+constexpr size_t compaction_max_concurrency = 1;
+
+/// Number of threads that read and memory-map files for the node. The default
+/// of 0 performs all filesystem operations on a single thread.
+constexpr size_t filesystem_workers = 0;
+
 /// Maximum number of events per INDEX partition.
 constexpr size_t max_partition_size = 1'048'576; // 1_Mi
 
@@ -257,9 +302,24 @@ constexpr size_t max_in_mem_partitions = 10;
 /// Number of immediately scheduled INDEX partitions.
 constexpr size_t taste_partitions = 5;
 
+/// Number of partition synopses the INDEX loads per message when loading the
+/// meta index lazily.
+constexpr size_t lazy_synopsis_batch_size = 100;
+
 /// Maximum number of concurrent INDEX queries.
 constexpr size_t num_query_supervisors = 10;
 
+/// Maximum number of workers that fetch and check the candidates of a single
+/// AGGREGATOR or HUNTER concurrently.
+constexpr size_t max_query_workers = 4;
+
+/// Maximum size of the INDEX query result cache in bytes.
+constexpr size_t result_cache_size = 64 * 1024 * 1024; // 64_Mi
+
+/// Precision of the cardinality sketches in the meta index, or 0 to disable
+/// them.
+constexpr size_t cardinality_sketch_precision = 0;
+
 /// Number of cached ARCHIVE segments.
 constexpr size_t segments = 10;
 
@@ -269,10 +329,18 @@ constexpr size_t max_segment_size = 1'024;
 /// Number of initial IDs to request in the IMPORTER.
 constexpr size_t initially_requested_ids = 128;
 
+/// Number of IDs beyond the highest reserved ID that the ID allocator
+/// persists ahead of time, such that reservations rarely wait for the disk.
+constexpr uint64_t id_headroom = 64 * 1024 * 1024; // 64_Mi
+
 /// Rate at which telemetry data is sent to the ACCOUNTANT.
 constexpr std::chrono::milliseconds telemetry_rate
   = std::chrono::milliseconds{10000};
 
+/// Interval between two samples of the metrics registry in the ACCOUNTANT.
+constexpr std::chrono::milliseconds metrics_sample_interval
+  = std::chrono::seconds{3};
+
 /// Interval between checks whether a signal occured.
 constexpr std::chrono::milliseconds signal_monitoring_interval
   = std::chrono::milliseconds{750};
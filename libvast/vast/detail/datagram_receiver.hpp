@@ -0,0 +1,124 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include <caf/expected.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace vast::detail {
+
+/// Receives UDP datagrams on a dedicated thread and exposes them as a stream
+/// of newline-separated messages. The thread receives batches of datagrams
+/// with a single system call (`recvmmsg(2)` on Linux) into a ring of
+/// preallocated buffers, and the consumer parses directly from these buffers.
+/// When the consumer falls behind, the ring fills up and the kernel drops
+/// datagrams, which the receiver counts via `SO_RXQ_OVFL` where available.
+///
+/// The receiver is a single-producer single-consumer queue: exactly one
+/// thread may read from the stream buffer at a time.
+class datagram_receiver final : public std::streambuf {
+public:
+  /// Counters of the receiver.
+  struct statistics {
+    uint64_t received = 0;  ///< Datagrams received from the socket.
+    uint64_t dropped = 0;   ///< Datagrams dropped by the kernel.
+    uint64_t truncated = 0; ///< Datagrams exceeding the maximum size.
+  };
+
+  /// Binds a UDP socket and starts receiving.
+  /// @param port The port to listen on; 0 picks an ephemeral port.
+  /// @param capacity The number of datagrams in the ring.
+  /// @param max_size The maximum size of a single datagram.
+  /// @param receive_buffer The requested size of the socket receive buffer.
+  /// @param notify The function that the receiver thread invokes when new
+  ///        datagrams arrive after a call to `rearm`.
+  /// @returns The receiver or an error if the socket cannot be bound.
+  static caf::expected<std::unique_ptr<datagram_receiver>>
+  make(uint16_t port, size_t capacity, size_t max_size, int receive_buffer,
+       std::function<void()> notify);
+
+  ~datagram_receiver() override;
+
+  datagram_receiver(const datagram_receiver&) = delete;
+  datagram_receiver& operator=(const datagram_receiver&) = delete;
+
+  /// @returns The port that the socket is bound to.
+  uint16_t port() const;
+
+  /// @returns The number of datagrams that are ready to be read.
+  size_t available() const;
+
+  /// @returns The current counters of the receiver.
+  statistics stats() const;
+
+  /// Requests a notification for the next batch of datagrams. Consumers call
+  /// this before reading, such that datagrams arriving while reading trigger
+  /// another notification.
+  void rearm();
+
+protected:
+  int_type underflow() override;
+
+private:
+  datagram_receiver(int fd, size_t capacity, size_t max_size,
+                    std::function<void()> notify);
+
+  /// Receives up to `n` datagrams into the ring, starting at `first`.
+  /// @returns The number of received datagrams or -1 on error.
+  int receive(size_t first, size_t n);
+
+  /// The loop of the receiver thread.
+  void run();
+
+  const int fd_;
+  const size_t capacity_;
+  const size_t slot_size_;
+  std::function<void()> notify_;
+
+  // The ring of datagrams with one slot of `slot_size_` bytes per datagram.
+  std::vector<char> buffer_;
+  std::vector<size_t> lengths_;
+  // The platform-specific message headers, one per slot.
+  struct headers;
+  std::unique_ptr<headers> headers_;
+
+  // The sequence numbers of the next slot to write and to read.
+  std::atomic<uint64_t> head_ = 0;
+  std::atomic<uint64_t> tail_ = 0;
+  bool mapped_ = false;
+
+  std::atomic<bool> notified_ = false;
+  std::atomic<bool> waiting_ = false;
+  std::atomic<bool> stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable space_;
+
+  std::atomic<uint64_t> received_ = 0;
+  std::atomic<uint64_t> dropped_ = 0;
+  std::atomic<uint64_t> truncated_ = 0;
+
+  std::thread thread_;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,163 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/bit.hpp"
+
+#include <caf/meta/type_name.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vast::detail {
+
+/// A HyperLogLog sketch that estimates the number of distinct elements in a
+/// multiset from their 64-bit hash digests. With a precision of *p*, the
+/// sketch occupies *m = 2^p* bytes and has a relative standard error of about
+/// *1.04 / sqrt(m)*, e.g., 1.6% for the default precision of 12. Sketches
+/// with the same precision combine losslessly; a sketch of higher precision
+/// folds into one of lower precision.
+///
+/// See Flajolet et al., "HyperLogLog: the analysis of a near-optimal
+/// cardinality estimation algorithm", and Heule et al., "HyperLogLog in
+/// Practice", for the linear counting correction of small cardinalities.
+class hyperloglog {
+public:
+  static constexpr uint8_t min_precision = 4;
+  static constexpr uint8_t max_precision = 18;
+  static constexpr uint8_t default_precision = 12;
+
+  /// Constructs an empty sketch.
+  /// @param precision The number of digest bits that select a register.
+  /// @pre `min_precision <= precision && precision <= max_precision`
+  explicit hyperloglog(uint8_t precision = default_precision)
+    : precision_{precision}, registers_(size_t{1} << precision) {
+    VAST_ASSERT(min_precision <= precision && precision <= max_precision);
+  }
+
+  /// Constructs a sketch from its registers.
+  /// @param precision The number of digest bits that select a register.
+  /// @param registers The `2^precision` registers of the sketch.
+  hyperloglog(uint8_t precision, std::vector<uint8_t> registers)
+    : precision_{precision}, registers_{std::move(registers)} {
+    VAST_ASSERT(registers_.size() == size_t{1} << precision);
+  }
+
+  /// Adds an element by its hash digest.
+  void add(uint64_t digest) {
+    auto index = digest >> (64 - precision_);
+    // The sentinel bit bounds the rank by the number of remaining bits.
+    auto rest = (digest << precision_) | (uint64_t{1} << (precision_ - 1));
+    auto rank = static_cast<uint8_t>(countl_zero(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  /// Combines another sketch into this one.
+  /// @pre `other.precision() == precision()`
+  void merge(const hyperloglog& other) {
+    VAST_ASSERT(other.precision_ == precision_);
+    for (size_t i = 0; i < registers_.size(); ++i)
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+
+  /// Reduces the precision of the sketch.
+  /// @param precision The new precision.
+  /// @returns A sketch of the same elements with the given precision.
+  /// @pre `min_precision <= precision && precision <= this->precision()`
+  hyperloglog fold(uint8_t precision) const {
+    VAST_ASSERT(precision <= precision_);
+    hyperloglog result{precision};
+    auto shift = precision_ - precision;
+    auto mask = (size_t{1} << shift) - 1;
+    for (size_t i = 0; i < registers_.size(); ++i) {
+      if (registers_[i] == 0)
+        continue;
+      // The low bits of the old register index are now the leading bits of
+      // the digest part that determines the rank.
+      auto suffix = i & mask;
+      auto rank = suffix != 0
+                    ? countl_zero(suffix) - (64 - shift) + 1
+                    : shift + registers_[i];
+      auto& x = result.registers_[i >> shift];
+      x = std::max(x, static_cast<uint8_t>(rank));
+    }
+    return result;
+  }
+
+  /// @returns The estimated number of distinct elements.
+  double estimate() const {
+    auto m = static_cast<double>(registers_.size());
+    auto sum = 0.0;
+    size_t zeros = 0;
+    for (auto x : registers_) {
+      sum += std::ldexp(1.0, -x);
+      zeros += x == 0;
+    }
+    auto alpha = registers_.size() == 16   ? 0.673
+                 : registers_.size() == 32 ? 0.697
+                 : registers_.size() == 64 ? 0.709
+                                           : 0.7213 / (1.0 + 1.079 / m);
+    auto result = alpha * m * m / sum;
+    // Small cardinalities leave registers empty, for which linear counting
+    // is the better estimator.
+    if (result <= 2.5 * m && zeros > 0)
+      result = m * std::log(m / static_cast<double>(zeros));
+    return result;
+  }
+
+  /// @returns The relative standard error of the estimate.
+  double standard_error() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers_.size()));
+  }
+
+  /// @returns The number of digest bits that select a register.
+  uint8_t precision() const {
+    return precision_;
+  }
+
+  /// @returns The registers of the sketch.
+  const std::vector<uint8_t>& registers() const {
+    return registers_;
+  }
+
+  /// @returns A best-effort estimate of the memory footprint in bytes.
+  size_t memusage() const {
+    return registers_.capacity();
+  }
+
+  friend bool operator==(const hyperloglog& x, const hyperloglog& y) {
+    return x.precision_ == y.precision_ && x.registers_ == y.registers_;
+  }
+
+  friend bool operator!=(const hyperloglog& x, const hyperloglog& y) {
+    return !(x == y);
+  }
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, hyperloglog& x) {
+    return f(caf::meta::type_name("vast.detail.hyperloglog"), x.precision_,
+             x.registers_);
+  }
+
+private:
+  uint8_t precision_;
+  std::vector<uint8_t> registers_;
+};
+
+} // namespace vast::detail
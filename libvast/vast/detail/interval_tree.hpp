@@ -0,0 +1,220 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/detail/assert.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vast::detail {
+
+/// A dynamic interval tree over closed, possibly overlapping intervals. The
+/// tree is a treap ordered by the left endpoints, where every node
+/// additionally stores the maximum right endpoint of its subtree. This allows
+/// for inserting and erasing intervals in expected *O(log n)* and for finding
+/// all *k* intervals that overlap with a query interval in expected
+/// *O(log n + k)*.
+///
+/// The nodes live in a contiguous pool and refer to each other by index, such
+/// that copies of the tree are independent of each other.
+template <class Point, class Value>
+class interval_tree {
+public:
+  struct entry {
+    Point left;
+    Point right;
+    Value value;
+  };
+
+  /// Adds a closed interval `[left, right]`.
+  /// @pre `left <= right`
+  void insert(Point left, Point right, Value value) {
+    VAST_ASSERT(!(right < left));
+    auto x = allocate(entry{std::move(left), std::move(right),
+                            std::move(value)});
+    auto [lhs, rhs] = split(root_, nodes_[x].data.left);
+    root_ = merge(merge(lhs, x), rhs);
+    ++size_;
+  }
+
+  /// Removes an interval.
+  /// @param left The left endpoint of the interval.
+  /// @param value The value associated with the interval.
+  /// @returns Whether the tree contained the interval.
+  bool erase(const Point& left, const Value& value) {
+    if (!erase(root_, left, value))
+      return false;
+    --size_;
+    return true;
+  }
+
+  /// Removes all intervals.
+  void clear() {
+    nodes_.clear();
+    free_.clear();
+    root_ = nil;
+    size_ = 0;
+  }
+
+  /// @returns The number of intervals.
+  size_t size() const {
+    return size_;
+  }
+
+  /// @returns Whether the tree contains no intervals.
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /// @returns A best-effort estimate of the memory footprint in bytes.
+  size_t memusage() const {
+    return nodes_.capacity() * sizeof(node) + free_.capacity() * sizeof(index);
+  }
+
+  /// Invokes a function for every interval that overlaps with `[left, right]`
+  /// in the order of their left endpoints.
+  /// @param left The left endpoint of the query interval.
+  /// @param right The right endpoint of the query interval.
+  /// @param f The function to invoke with each overlapping `entry`.
+  template <class F>
+  void overlap(const Point& left, const Point& right, F f) const {
+    if (right < left)
+      return;
+    std::vector<index> stack;
+    stack.reserve(64);
+    auto x = root_;
+    while (x != nil || !stack.empty()) {
+      // Subtrees whose intervals all end before the query are irrelevant.
+      for (; x != nil && !(nodes_[x].max < left); x = nodes_[x].left)
+        stack.push_back(x);
+      if (stack.empty())
+        return;
+      const auto& n = nodes_[stack.back()];
+      stack.pop_back();
+      // All remaining intervals start after the query.
+      if (right < n.data.left)
+        return;
+      if (!(n.data.right < left))
+        f(n.data);
+      x = n.right;
+    }
+  }
+
+private:
+  using index = size_t;
+
+  static constexpr index nil = static_cast<index>(-1);
+
+  struct node {
+    entry data;
+    Point max; ///< The maximum right endpoint in the subtree of this node.
+    uint64_t priority;
+    index left;
+    index right;
+  };
+
+  index allocate(entry data) {
+    // A xorshift generator suffices to keep the treap balanced in
+    // expectation.
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 7;
+    seed_ ^= seed_ << 17;
+    auto max = data.right;
+    auto x = node{std::move(data), std::move(max), seed_, nil, nil};
+    if (free_.empty()) {
+      nodes_.push_back(std::move(x));
+      return nodes_.size() - 1;
+    }
+    auto result = free_.back();
+    free_.pop_back();
+    nodes_[result] = std::move(x);
+    return result;
+  }
+
+  void update(index x) {
+    auto& n = nodes_[x];
+    n.max = n.data.right;
+    if (n.left != nil && n.max < nodes_[n.left].max)
+      n.max = nodes_[n.left].max;
+    if (n.right != nil && n.max < nodes_[n.right].max)
+      n.max = nodes_[n.right].max;
+  }
+
+  /// Splits a subtree into the nodes with a left endpoint less than `key` and
+  /// the remaining nodes.
+  std::pair<index, index> split(index x, const Point& key) {
+    if (x == nil)
+      return {nil, nil};
+    if (nodes_[x].data.left < key) {
+      auto [lhs, rhs] = split(nodes_[x].right, key);
+      nodes_[x].right = lhs;
+      update(x);
+      return {x, rhs};
+    }
+    auto [lhs, rhs] = split(nodes_[x].left, key);
+    nodes_[x].left = rhs;
+    update(x);
+    return {lhs, x};
+  }
+
+  /// Merges two subtrees, where all nodes of `x` precede all nodes of `y`.
+  index merge(index x, index y) {
+    if (x == nil)
+      return y;
+    if (y == nil)
+      return x;
+    if (nodes_[y].priority < nodes_[x].priority) {
+      nodes_[x].right = merge(nodes_[x].right, y);
+      update(x);
+      return x;
+    }
+    nodes_[y].left = merge(x, nodes_[y].left);
+    update(y);
+    return y;
+  }
+
+  bool erase(index& x, const Point& key, const Value& value) {
+    if (x == nil)
+      return false;
+    auto& n = nodes_[x];
+    auto erased = false;
+    if (key < n.data.left) {
+      erased = erase(n.left, key, value);
+    } else if (n.data.left < key) {
+      erased = erase(n.right, key, value);
+    } else if (n.data.value == value) {
+      free_.push_back(x);
+      x = merge(n.left, n.right);
+      return true;
+    } else {
+      // Intervals with equal left endpoints may reside in both subtrees.
+      erased = erase(n.left, key, value) || erase(n.right, key, value);
+    }
+    if (erased)
+      update(x);
+    return erased;
+  }
+
+  std::vector<node> nodes_;
+  std::vector<index> free_;
+  index root_ = nil;
+  size_t size_ = 0;
+  uint64_t seed_ = 0x9e3779b97f4a7c15;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,174 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/detail/assert.hpp"
+
+#include <tsl/robin_map.h>
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace vast::detail {
+
+/// An associative container that keeps its entries in order of recent use.
+/// Lookups go through an open-addressing hash map that maps keys to slots in a
+/// contiguous array, and the slots form an intrusive doubly-linked list from
+/// the most to the least recently used entry. Thus, all operations including
+/// the eviction of the least recently used entry run in constant time, and
+/// removing entries never requires scanning the container.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class lru_map {
+public:
+  /// Looks up an entry without changing its position in the recency order.
+  /// @param key The key to look for.
+  /// @returns A pointer to the value of *key*, or `nullptr` if not found.
+  Value* find(const Key& key) {
+    auto i = index_.find(key);
+    if (i == index_.end())
+      return nullptr;
+    return &slots_[i->second].value;
+  }
+
+  /// Looks up an entry and marks it as the most recently used one. Creates a
+  /// new entry if *key* does not exist.
+  /// @param key The key to look for.
+  /// @param make The function to invoke with *key* to construct a missing
+  ///        value.
+  /// @returns A reference to the value of *key* and whether it was inserted.
+  template <class F>
+  std::pair<Value&, bool> touch(const Key& key, F make) {
+    if (auto i = index_.find(key); i != index_.end()) {
+      auto slot = i->second;
+      unlink(slot);
+      link_front(slot);
+      return {slots_[slot].value, false};
+    }
+    size_t slot;
+    if (free_.empty()) {
+      slot = slots_.size();
+      slots_.push_back({key, make(key)});
+    } else {
+      slot = free_.back();
+      free_.pop_back();
+      slots_[slot].key = key;
+      slots_[slot].value = make(key);
+    }
+    index_.emplace(key, slot);
+    link_front(slot);
+    return {slots_[slot].value, true};
+  }
+
+  /// @returns The key and value of the least recently used entry.
+  /// @pre `!empty()`
+  std::pair<const Key&, const Value&> oldest() const {
+    VAST_ASSERT(!empty());
+    return {slots_[tail_].key, slots_[tail_].value};
+  }
+
+  /// Removes the least recently used entry.
+  /// @pre `!empty()`
+  void pop_oldest() {
+    VAST_ASSERT(!empty());
+    erase_slot(tail_);
+  }
+
+  /// Removes an entry.
+  /// @param key The key of the entry to remove.
+  /// @returns Whether an entry was removed.
+  bool erase(const Key& key) {
+    auto i = index_.find(key);
+    if (i == index_.end())
+      return false;
+    erase_slot(i->second);
+    return true;
+  }
+
+  /// Removes all entries.
+  void clear() {
+    index_.clear();
+    slots_.clear();
+    free_.clear();
+    head_ = npos;
+    tail_ = npos;
+  }
+
+  /// @returns The number of entries.
+  size_t size() const {
+    return index_.size();
+  }
+
+  /// @returns Whether the container has no entries.
+  bool empty() const {
+    return index_.empty();
+  }
+
+  /// @returns The ratio of occupied to available buckets in the hash map.
+  float load_factor() const {
+    return index_.load_factor();
+  }
+
+private:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  struct slot {
+    Key key;
+    Value value;
+    size_t prev = npos; ///< The next more recently used slot.
+    size_t next = npos; ///< The next less recently used slot.
+  };
+
+  void link_front(size_t i) {
+    slots_[i].prev = npos;
+    slots_[i].next = head_;
+    if (head_ != npos)
+      slots_[head_].prev = i;
+    head_ = i;
+    if (tail_ == npos)
+      tail_ = i;
+  }
+
+  void unlink(size_t i) {
+    auto& x = slots_[i];
+    if (x.prev != npos)
+      slots_[x.prev].next = x.next;
+    else
+      head_ = x.next;
+    if (x.next != npos)
+      slots_[x.next].prev = x.prev;
+    else
+      tail_ = x.prev;
+    x.prev = npos;
+    x.next = npos;
+  }
+
+  void erase_slot(size_t i) {
+    index_.erase(slots_[i].key);
+    unlink(i);
+    // Release the resources held by the value eagerly.
+    slots_[i].value = Value{};
+    free_.push_back(i);
+  }
+
+  tsl::robin_map<Key, size_t, Hash> index_;
+  std::vector<slot> slots_;
+  std::vector<size_t> free_;
+  size_t head_ = npos;
+  size_t tail_ = npos;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,109 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/bit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+namespace vast::detail {
+
+/// Estimates the size of table slices from the observed input rate of a
+/// source, such that a table slice fills up within a given duration. Sources
+/// with a high input rate produce fewer but larger table slices, which reduces
+/// the per-slice overhead downstream, and sources with a low input rate
+/// produce smaller table slices, which bounds the latency of their events.
+/// The estimate is a power of two to avoid oscillating between similar sizes.
+class slice_size_estimator {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// The maximum duration over which the estimator measures the input rate.
+  static constexpr clock::duration max_sample_interval
+    = std::chrono::seconds{1};
+
+  /// Constructs an estimator.
+  /// @param initial The table slice size before the first measurement.
+  /// @param min The lower bound for the table slice size.
+  /// @param max The upper bound for the table slice size.
+  /// @param fill_time The duration in which a table slice should fill up.
+  /// @param now The start of the first measurement.
+  /// @pre `0 < min && min <= max && fill_time > clock::duration::zero()`
+  slice_size_estimator(size_t initial, size_t min, size_t max,
+                       clock::duration fill_time,
+                       clock::time_point now = clock::now())
+    : size_{std::clamp(initial, min, max)},
+      min_{min},
+      max_{max},
+      fill_time_{fill_time},
+      sample_interval_{std::min(fill_time, max_sample_interval)},
+      sample_start_{now} {
+    VAST_ASSERT(0 < min && min <= max);
+    VAST_ASSERT(fill_time > clock::duration::zero());
+  }
+
+  /// Records produced events and updates the estimate once per sample
+  /// interval.
+  /// @param events The number of events produced since the last call.
+  /// @param now The current time.
+  /// @returns The table slice size for the next events.
+  size_t observe(size_t events, clock::time_point now = clock::now()) {
+    events_ += events;
+    auto elapsed = now - sample_start_;
+    if (elapsed < sample_interval_)
+      return size_;
+    using seconds = std::chrono::duration<double>;
+    auto sample = events_ / seconds{elapsed}.count();
+    // An exponentially weighted moving average smoothes out bursts.
+    rate_ = sampled_ ? (rate_ + sample) / 2 : sample;
+    sampled_ = true;
+    events_ = 0;
+    sample_start_ = now;
+    auto target = rate_ * seconds{fill_time_}.count();
+    if (!(target < static_cast<double>(max_)))
+      size_ = max_;
+    else
+      size_ = std::clamp(ceil2(static_cast<size_t>(std::ceil(target))), min_,
+                         max_);
+    return size_;
+  }
+
+  /// @returns The current table slice size.
+  size_t size() const {
+    return size_;
+  }
+
+  /// @returns The estimated input rate in events per second, or 0 before the
+  ///          first measurement.
+  double rate() const {
+    return rate_;
+  }
+
+private:
+  size_t size_;
+  size_t min_;
+  size_t max_;
+  clock::duration fill_time_;
+  clock::duration sample_interval_;
+  clock::time_point sample_start_;
+  size_t events_ = 0;
+  double rate_ = 0.0;
+  bool sampled_ = false;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,69 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fbs/synopsis.hpp"
+#include "vast/fwd.hpp"
+#include "vast/synopsis.hpp"
+
+#include <caf/expected.hpp>
+
+namespace vast {
+
+/// A read-only synopsis that evaluates lookups directly on its FlatBuffer
+/// representation, e.g., in a memory-mapped partition synopsis file. Time and
+/// bool synopses compare against the stored bounds and flags, and Bloom filter
+/// synopses probe the stored bit array without copying it.
+class flatbuffer_synopsis final : public synopsis {
+public:
+  /// Constructs a synopsis that references a FlatBuffer.
+  /// @param x The type of the column the synopsis was built for.
+  /// @param chunk The chunk that contains *fb*.
+  /// @param fb The FlatBuffer representation of the synopsis.
+  /// @pre *fb* must not be an opaque synopsis.
+  flatbuffer_synopsis(vast::type x, chunk_ptr chunk,
+                      const fbs::synopsis::v0& fb);
+
+  /// Flatbuffer synopses are immutable; adding data is an error.
+  void add(data_view x) override;
+
+  caf::optional<bool>
+  lookup(relational_operator op, data_view rhs) const override;
+
+  /// @returns The size of the synopsis itself, excluding the referenced
+  /// chunk, which is shared and may be paged out by the operating system.
+  size_t memusage() const override;
+
+  bool equals(const synopsis& other) const noexcept override;
+
+  caf::error serialize(caf::serializer& sink) const override;
+
+  caf::error deserialize(caf::deserializer& source) override;
+
+  /// Unpacks the referenced FlatBuffer into a regular synopsis.
+  caf::expected<synopsis_ptr> materialize() const;
+
+  /// @returns The referenced FlatBuffer.
+  const fbs::synopsis::v0& flatbuffer() const noexcept;
+
+private:
+  chunk_ptr chunk_;
+  const fbs::synopsis::v0* fb_;
+};
+
+/// Checks whether a FlatBuffer synopsis supports lookups without unpacking.
+/// @relates flatbuffer_synopsis
+bool is_lazily_evaluable(const fbs::synopsis::v0& fb);
+
+} // namespace vast
@@ -16,6 +16,8 @@
 #include "vast/defaults.hpp"
 #include "vast/format/writer.hpp"
 #include "vast/fwd.hpp"
+#include "vast/path.hpp"
+#include "vast/table_slice.hpp"
 #include "vast/type.hpp"
 
 #include <caf/error.hpp>
@@ -29,7 +31,13 @@
 
 namespace vast::format::arrow {
 
-/// An Arrow writer.
+/// An Arrow writer. By default, the writer prints an Arrow IPC stream to
+/// STDOUT, starting a new stream whenever the layout changes. Alternatively,
+/// the writer creates one Arrow IPC file per layout in an output directory.
+/// In both cases, the writer coalesces table slices of the same layout into
+/// record batches of a configurable minimum size, and writes the largest
+/// buffered batches early when the buffered data of all layouts exceeds a
+/// configurable size. The writer never overwrites existing files.
 class writer : public format::writer {
 public:
   using output_stream_ptr = std::shared_ptr<::arrow::io::OutputStream>;
@@ -45,6 +53,9 @@ public:
 
   caf::error write(const table_slice& x) override;
 
+  /// Writes all buffered table slices as record batches.
+  caf::expected<void> flush() override;
+
   const char* name() const override;
 
   void out(output_stream_ptr ptr) {
@@ -54,10 +65,52 @@ public:
   bool layout(const record_type& t);
 
 private:
+  /// The buffered table slices and the output file for a single layout.
+  struct layout_state {
+    /// The flattened layout.
+    record_type layout;
+
+    /// Table slices that were not yet written.
+    std::vector<table_slice> buffered = {};
+
+    /// The number of rows in `buffered`.
+    size_t buffered_rows = 0;
+
+    /// The number of bytes in `buffered`.
+    size_t buffered_bytes = 0;
+
+    /// The output file in directory mode.
+    output_stream_ptr file = nullptr;
+
+    /// The writer for `file`.
+    batch_writer_ptr file_writer = nullptr;
+  };
+
+  /// Writes the buffered slices of a layout as a single record batch.
+  caf::error write_buffered(layout_state& state);
+
+  /// Closes all open output files.
+  caf::error close_files();
+
   output_stream_ptr out_;
   record_type current_layout_;
-  table_slice_builder_ptr current_builder_;
   batch_writer_ptr current_batch_writer_;
+
+  /// The directory for writing one Arrow IPC file per layout into, or empty
+  /// for writing a stream to `out_`.
+  path dir_;
+
+  /// The minimum number of rows per record batch.
+  size_t batch_size_ = 0;
+
+  /// The maximum number of bytes buffered across all layouts.
+  size_t max_buffered_bytes_ = 0;
+
+  /// The number of bytes buffered across all layouts.
+  size_t buffered_bytes_ = 0;
+
+  /// The state for every layout, in order of appearance.
+  std::vector<layout_state> layouts_;
 };
 
 } // namespace vast::format::arrow
@@ -223,7 +223,7 @@ caf::error reader<Selector>::read_impl(size_t max_events, size_t max_slice_size,
     }
     produced++;
     batch_events_++;
-    if (bptr->rows() == max_slice_size)
+    if (bptr->rows() >= max_slice_size)
       if (auto err = finish(cons, bptr))
         return err;
   }
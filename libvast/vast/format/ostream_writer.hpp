@@ -13,18 +13,21 @@
 
 #pragma once
 
+#include "vast/defaults.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/error.hpp"
 #include "vast/format/writer.hpp"
 #include "vast/policy/flatten_layout.hpp"
 #include "vast/policy/include_field_names.hpp"
 #include "vast/table_slice.hpp"
-#include "vast/table_slice_row.hpp"
+#include "vast/type.hpp"
+#include "vast/view.hpp"
 
 #include <caf/error.hpp>
 
 #include <iosfwd>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -74,38 +77,49 @@ protected:
     buf_.emplace_back(x);
   }
 
+  /// The constant parts of a printed line for a given layout, i.e., all
+  /// characters between the printed values.
+  struct line_template {
+    /// The layout this template was computed for.
+    record_type layout;
+
+    /// The text that precedes the value of each column.
+    std::vector<std::string> prefixes;
+
+    /// The type of each column.
+    std::vector<type> types;
+
+    /// The text that follows the value of the last column.
+    std::string suffix;
+  };
+
   template <class... Policies, class Printer>
   caf::error
-  print_record(Printer& printer, const line_elements& le,
-               const record_type& layout, table_slice_row row, size_t& pos) {
-    auto print_field = [&](auto& iter, const record_field& f, size_t column) {
-      auto rep = [&](data_view x) {
-        if constexpr (detail::is_any_v<policy::include_field_names, Policies...>)
-          return std::pair{std::string_view{f.name}, x};
-        else
-          return x;
-      };
-      auto x = to_canonical(f.type, row[column]);
-      return printer.print(iter, rep(std::move(x)));
+  make_line_template(Printer& printer, const line_elements& le,
+                     const record_type& layout, std::vector<char>& current) {
+    auto iter = std::back_inserter(current);
+    auto append = [&](std::string_view x) {
+      current.insert(current.end(), x.begin(), x.end());
     };
-    auto iter = std::back_inserter(buf_);
     append(le.begin_of_line);
     auto start = 0;
     for (const auto& f : layout.fields) {
       if (!!start++)
         append(le.separator);
+      if constexpr (detail::is_any_v<policy::include_field_names,
+                                     Policies...>) {
+        if (!printer.print(iter, std::string_view{f.name}))
+          return ec::print_error;
+        append(le.kv_separator);
+      }
       if (const auto& r = caf::get_if<record_type>(&f.type)) {
-        if constexpr (detail::is_any_v<policy::include_field_names,
-                                       Policies...>) {
-          if (!printer.print(iter, f.name))
-            return ec::print_error;
-          append(le.kv_separator);
-        }
-        if (auto err = print_record<Policies...>(printer, le, *r, row, pos))
+        if (auto err
+            = make_line_template<Policies...>(printer, le, *r, current))
           return err;
       } else {
-        if (!print_field(iter, f, pos++))
-          return ec::print_error;
+        line_template_.prefixes.emplace_back(current.begin(), current.end());
+        line_template_.types.push_back(f.type);
+        current.clear();
       }
     }
     append(le.end_of_line);
@@ -129,23 +143,50 @@ protected:
   ///        writer would end each line with a '}'.
   /// @returns `ec::print_error` if `printer` fails to generate output,
   ///          otherwise `caf::none`.
+  /// @note The text between the values only depends on the layout, so we
+  ///       compute it once per layout. This assumes that a writer always uses
+  ///       the same policies and line elements.
   template <class... Policies, class Printer>
   caf::error
   print(Printer& printer, const table_slice& xs, const line_elements& le) {
-    auto&& layout = [&]() {
-      if constexpr (detail::is_any_v<policy::flatten_layout, Policies...>)
-        return flatten(xs.layout());
-      else
-        return xs.layout();
-    }();
-    for (size_t row = 0; row < xs.rows(); ++row) {
-      size_t pos = 0;
-      if (auto err = print_record<Policies...>(printer, le, layout,
-                                               table_slice_row{xs, row}, pos))
+    if (line_template_.layout != xs.layout()) {
+      line_template_ = {};
+      auto&& layout = [&]() {
+        if constexpr (detail::is_any_v<policy::flatten_layout, Policies...>)
+          return flatten(xs.layout());
+        else
+          return xs.layout();
+      }();
+      std::vector<char> current;
+      if (auto err
+          = make_line_template<Policies...>(printer, le, layout, current)) {
+        line_template_ = {};
         return err;
+      }
+      line_template_.suffix.assign(current.begin(), current.end());
+      line_template_.layout = xs.layout();
+    }
+    const auto& prefixes = line_template_.prefixes;
+    const auto& types = line_template_.types;
+    xs.decode_columns(columns_);
+    VAST_ASSERT(columns_.size() == types.size());
+    auto iter = std::back_inserter(buf_);
+    for (size_t row = 0; row < xs.rows(); ++row) {
+      for (size_t column = 0; column < columns_.size(); ++column) {
+        append(prefixes[column]);
+        const auto& x = columns_[column][row];
+        auto printed = caf::get_if<enumeration_type>(&types[column])
+                         ? printer.print(iter, to_canonical(types[column], x))
+                         : printer.print(iter, x);
+        if (!printed)
+          return ec::print_error;
+      }
+      append(line_template_.suffix);
       append('\n');
-      write_buf();
+      if (buf_.size() >= defaults::export_::write_buffer_size)
+        write_buf();
     }
+    write_buf();
     return caf::none;
   }
 
@@ -158,6 +199,12 @@ protected:
   /// `sync_with_stdio(false)`.
   std::vector<char> buf_;
 
+  /// The decoded values of the table slice currently being printed.
+  std::vector<std::vector<data_view>> columns_;
+
+  /// The constant parts of the lines for the most recently printed layout.
+  line_template line_template_;
+
   /// Output stream for writing to STDOUT or disk.
   ostream_ptr out_;
 };
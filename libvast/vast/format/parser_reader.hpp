@@ -80,7 +80,7 @@ protected:
                            ec::parse_error,
                            "recursive_add failed to add content at line",
                            lines_->line_number(), std::string{lines_->get()}));
-      if (builder_->rows() == max_slice_size)
+      if (builder_->rows() >= max_slice_size)
         if (auto err = finish(f))
           return err;
       lines_->next();
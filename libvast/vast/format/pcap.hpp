@@ -14,9 +14,11 @@
 #pragma once
 
 #include "vast/address.hpp"
+#include "vast/community_id.hpp"
 #include "vast/concept/hashable/hash_append.hpp"
 #include "vast/concept/hashable/xxhash.hpp"
 #include "vast/defaults.hpp"
+#include "vast/detail/lru_map.hpp"
 #include "vast/detail/operators.hpp"
 #include "vast/flow.hpp"
 #include "vast/format/reader.hpp"
@@ -25,20 +27,112 @@
 #include "vast/fwd.hpp"
 #include "vast/port.hpp"
 #include "vast/schema.hpp"
+#include "vast/span.hpp"
 #include "vast/time.hpp"
 
 #include <caf/expected.hpp>
 #include <caf/optional.hpp>
 
+#include <array>
 #include <chrono>
+#include <deque>
+#include <memory>
 #include <pcap.h>
-#include <random>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace vast {
 namespace format {
 namespace pcap {
 
+/// Tracks the state of flows to cut off their packets after a configured
+/// number of bytes.
+class flow_table {
+public:
+  struct flow_state {
+    uint64_t bytes;
+    uint64_t last;
+    /// The Community ID of the flow, stored inline such that creating the
+    /// state of a new flow does not allocate.
+    std::array<char, community_id::length<policy::base64>()> community_id;
+  };
+
+  flow_table() = default;
+
+  /// Constructs a flow table.
+  /// @param cutoff The number of bytes to keep per flow.
+  /// @param max_flows The maximum number of concurrent flows.
+  /// @param max_age The number of seconds of inactivity before eviction.
+  /// @param expire_interval The number of seconds between expirations.
+  flow_table(uint64_t cutoff, size_t max_flows, uint64_t max_age,
+             uint64_t expire_interval);
+
+  /// @returns either an existing state associated to `x` or a new state for
+  ///          the flow.
+  flow_state& state(const flow& x);
+
+  /// @returns either an existing state associated to `x` or a new state for
+  ///          the flow that takes its Community ID from the last prefetched
+  ///          batch.
+  /// @param position The position of `x` in the flows of the last call to
+  ///        `prefetch_community_ids`.
+  flow_state& state(const flow& x, size_t position);
+
+  /// @returns whether `true` if the flow remains active, `false` if the flow
+  ///          reached the configured cutoff.
+  bool update(const flow& x, uint64_t packet_time, uint64_t payload_size);
+
+  /// Evict all flows that have been inactive for the maximum age.
+  void evict_inactive(uint64_t packet_time);
+
+  /// Evicts the least recently active flows when exceeding the maximum
+  /// configured flow count.
+  void shrink_to_max_size();
+
+  /// Computes the Community IDs of all flows that are not tracked yet in a
+  /// single batch, such that creating their states later with
+  /// `state(x, position)` does not compute the Community IDs one at a time.
+  /// @param xs The flows of the upcoming packets.
+  void prefetch_community_ids(span<const flow> xs);
+
+  /// Removes all flows.
+  void clear();
+
+  /// @returns The number of tracked flows.
+  size_t size() const;
+
+  /// @returns The load factor of the underlying hash table.
+  float load_factor() const;
+
+  /// The number of flows evicted due to inactivity.
+  size_t evicted_inactive = 0;
+
+  /// The number of flows evicted due to exceeding the maximum flow count.
+  size_t evicted_lru = 0;
+
+private:
+  detail::lru_map<flow, flow_state> flows_;
+  /// Scratch space for computing the Community ID of a single flow.
+  std::string scratch_;
+  /// Holds the prefetched Community IDs back to back.
+  std::string arena_;
+  /// Maps the position of a prefetched flow to its Community ID in the arena,
+  /// or to an empty view if the flow was already tracked.
+  std::vector<std::string_view> prefetched_;
+  /// Scratch space for deduplicating the untracked flows of a batch and
+  /// assigning them their slots in the arena.
+  std::unordered_map<flow, size_t> missing_index_;
+  std::vector<flow> missing_;
+  std::vector<size_t> slots_;
+  uint64_t cutoff_ = 0;
+  size_t max_flows_ = 0;
+  uint64_t max_age_ = 0;
+  uint64_t expire_interval_ = 0;
+  uint64_t last_expire_ = 0;
+};
+
 /// A PCAP reader.
 class reader : public single_layout_reader {
 public:
@@ -67,44 +161,44 @@ protected:
                        consumer& f) override;
 
 private:
-  struct flow_state {
-    uint64_t bytes;
-    uint64_t last;
-    std::string community_id;
-  };
+  /// A worker thread that processes the packets of a subset of all flows.
+  struct shard;
 
-  /// @returns either an existing state associated to `x` or a new state for
-  ///          the flow.
-  flow_state& state(const flow& x);
+  /// The table slices produced by the shards.
+  struct shard_output;
 
-  /// @returns whether `true` if the flow remains active, `false` if the flow
-  ///          reached the configured cutoff.
-  bool update_flow(const flow& x, uint64_t packet_time, uint64_t payload_size);
+  /// Reads packets on the calling thread and processes them on the shards.
+  caf::error read_sharded(size_t max_events, size_t max_slice_size,
+                          consumer& f);
 
-  /// Evict all flows that have been inactive for the maximum age.
-  void evict_inactive(uint64_t packet_time);
-
-  /// Evicts random flows when exceeding the maximum configured flow count.
-  void shrink_to_max_size();
+  /// Signals the shards to finish their current table slices and waits for
+  /// their threads to exit.
+  void stop_shards();
 
   pcap_t* pcap_ = nullptr;
-  std::unordered_map<flow, flow_state> flows_;
+  flow_table flows_;
   std::string input_;
   caf::optional<std::string> interface_;
   uint64_t cutoff_;
   size_t max_flows_;
-  std::mt19937 generator_;
   uint64_t max_age_;
   uint64_t expire_interval_;
-  uint64_t last_expire_ = 0;
   time last_timestamp_ = time::min();
   int64_t pseudo_realtime_;
   size_t snaplen_;
   bool community_id_;
   type packet_type_;
   double drop_rate_threshold_;
+  size_t num_shards_;
+  std::vector<std::unique_ptr<shard>> shards_;
+  std::unique_ptr<shard_output> shard_output_;
+  /// The table slices of the shards that exceeded `max_events` of a read.
+  std::deque<table_slice> pending_slices_;
   mutable pcap_stat last_stats_;
   mutable size_t discard_count_;
+  mutable size_t last_evicted_inactive_ = 0;
+  mutable size_t last_evicted_lru_ = 0;
+  mutable reader_clock::time_point last_status_ = reader_clock::now();
 };
 
 /// A PCAP writer.
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "vast/community_id_enricher.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/fwd.hpp"
@@ -25,7 +26,10 @@
 
 #include <chrono>
 #include <cstddef>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace vast::format {
 
@@ -76,15 +80,20 @@ public:
     struct consumer_impl : consumer {
       void operator()(table_slice x) override {
         produced += x.rows();
+        if (enrich_)
+          x = (*enrich_)(std::move(x));
         f_(std::move(x));
       }
-      consumer_impl(F& fun) : f_(fun), produced(0) {
+      consumer_impl(F& fun, community_id_enricher* enrich)
+        : f_(fun), enrich_(enrich), produced(0) {
         // nop
       }
       F& f_;
+      community_id_enricher* enrich_;
       size_t produced;
     };
-    consumer_impl g{f};
+    consumer_impl g{f, community_id_enricher_ ? &*community_id_enricher_
+                                              : nullptr};
     if (auto err = read_impl(max_events, max_slice_size, g))
       return {err, g.produced};
     return {caf::none, g.produced};
@@ -107,10 +116,26 @@ public:
   /// @returns A report for the accountant.
   virtual vast::system::report status() const;
 
+  /// @returns Whether the reader selects the encoding per layout.
+  bool adaptive_encoding() const noexcept;
+
+  /// @returns Whether the source adapts the batch size to the input rate.
+  bool adaptive_batch_size() const noexcept;
+
+  /// @returns The encodings selected per layout name if the encoding is
+  ///          `auto`.
+  const std::unordered_map<std::string, table_slice_encoding>&
+  layout_encodings() const noexcept;
+
 protected:
   virtual caf::error read_impl(size_t max_events, size_t max_slice_size,
                                consumer& f) = 0;
 
+  /// @returns The encoding for table slices of *layout*, which is the
+  ///          preferred encoding of the layout if the encoding is `auto`, and
+  ///          the configured encoding otherwise.
+  table_slice_encoding encoding(const record_type& layout);
+
 public:
   table_slice_encoding table_slice_type_
     = vast::defaults::import::table_slice_type;
@@ -120,6 +145,15 @@ public:
 protected:
   size_t batch_events_ = 0;
   reader_clock::time_point last_batch_sent_;
+  bool adaptive_encoding_ = false;
+  bool adaptive_batch_size_ = false;
+
+  /// The encodings selected per layout name if the encoding is `auto`.
+  std::unordered_map<std::string, table_slice_encoding> layout_encodings_;
+
+private:
+  /// Adds Community IDs to flow events that lack them, if enabled.
+  std::optional<community_id_enricher> community_id_enricher_;
 };
 
 } // namespace vast::format
@@ -75,6 +75,7 @@ class data;
 class ewah_bitstream;
 class expression;
 class json;
+class layout_interner;
 class meta_index;
 class msgpack_table_slice_builder;
 class path;
@@ -111,6 +112,7 @@ struct enumeration_type;
 struct field_extractor;
 struct flow;
 struct integer_type;
+struct interned_layout;
 struct invocation;
 struct list_type;
 struct map_type;
@@ -235,6 +237,7 @@ class application;
 class configuration;
 class default_application;
 class export_command;
+class id_allocator;
 class node_command;
 class pcap_writer_command;
 class remote_command;
@@ -257,7 +260,9 @@ struct node_state;
 struct performance_sample;
 struct query_status;
 struct query_status;
+struct query_trace;
 struct spawn_arguments;
+struct value_counts;
 
 enum class status_verbosity;
 
@@ -309,14 +314,17 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_types, caf::first_custom_type_id)
 
   VAST_ADD_TYPE_ID((vast::system::performance_report))
   VAST_ADD_TYPE_ID((vast::system::query_status))
+  VAST_ADD_TYPE_ID((vast::system::query_trace))
   VAST_ADD_TYPE_ID((vast::system::report))
   VAST_ADD_TYPE_ID((vast::system::status_verbosity))
+  VAST_ADD_TYPE_ID((vast::system::value_counts))
 
   VAST_ADD_TYPE_ID((std::pair<std::string, vast::data>) )
   VAST_ADD_TYPE_ID((std::vector<uint32_t>) )
   VAST_ADD_TYPE_ID((std::vector<std::string>) )
   VAST_ADD_TYPE_ID((std::vector<vast::table_slice>) )
   VAST_ADD_TYPE_ID((std::vector<vast::table_slice_column>) )
+  VAST_ADD_TYPE_ID((std::vector<vast::uuid>) )
 
   VAST_ADD_TYPE_ID((caf::stream<vast::table_slice>) )
   VAST_ADD_TYPE_ID((caf::stream<vast::table_slice_column>) )
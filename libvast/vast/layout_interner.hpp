@@ -0,0 +1,177 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/span.hpp"
+#include "vast/type.hpp"
+
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vast {
+
+/// A small integer that uniquely identifies an interned layout within the
+/// process. IDs are assigned densely starting from 0, which always refers to
+/// the empty layout.
+using layout_id = uint32_t;
+
+/// A layout that is registered with the layout interner, together with forms
+/// derived from it that are too expensive to compute per table slice.
+struct interned_layout {
+  /// The process-wide unique ID of the layout.
+  layout_id id;
+
+  /// The layout.
+  record_type layout;
+
+  /// The flattened layout, whose fields correspond to the columns of a table
+  /// slice.
+  record_type flat_layout;
+
+  /// The layout wrapped in a type, e.g., for tailoring expressions.
+  type layout_type;
+};
+
+/// Assigns stable IDs to layouts. Table slices intern their layout on
+/// construction, which replaces deserializing the layout for every table
+/// slice with a hash table lookup of its serialized form, and allows for
+/// keying per-layout state by a small integer instead of hashing and comparing
+/// deep record types.
+///
+/// Table slices refer to interned layouts by pointer, so the interner never
+/// evicts a layout: it grows by one entry per distinct layout and stays alive
+/// until the process exits. Nodes that see a bounded set of schemas therefore
+/// use a bounded amount of memory, but a node that keeps receiving new schema
+/// revisions grows with every revision.
+/// @note All member functions are thread-safe.
+class layout_interner {
+public:
+  /// @returns The process-wide layout interner.
+  static layout_interner& instance();
+
+  /// Interns a layout from its serialized form, deserializing it only if the
+  /// interner did not see the serialized form before.
+  /// @param serialized The layout serialized with the `caf::binary_serializer`.
+  /// @returns The interned layout, or an error if deserialization fails.
+  caf::expected<const interned_layout*>
+  intern(span<const std::byte> serialized);
+
+  /// Interns a layout from its serialized form, using the given layout instead
+  /// of deserializing if the interner did not see the serialized form before.
+  /// Unlike interning the layout directly, this hashes only the serialized
+  /// bytes, so it is cheap enough to call for every table slice.
+  /// @param serialized The layout serialized with the `caf::binary_serializer`.
+  /// @param layout The deserialized form of *serialized*.
+  /// @returns The interned layout.
+  const interned_layout&
+  intern(span<const std::byte> serialized, const record_type& layout);
+
+  /// Interns a layout.
+  /// @param layout The layout to intern.
+  /// @returns The interned layout.
+  const interned_layout& intern(const record_type& layout);
+
+  /// Retrieves an interned layout by its ID.
+  /// @param id The ID of the layout.
+  /// @returns The interned layout.
+  /// @pre `id < size()`
+  const interned_layout& at(layout_id id) const;
+
+  /// @returns The number of interned layouts.
+  size_t size() const;
+
+private:
+  layout_interner();
+
+  /// Adds a layout unless it exists already.
+  /// @pre The caller holds an exclusive lock.
+  const interned_layout& insert(record_type layout);
+
+  /// Adds a layout and associates it with its serialized form.
+  /// @pre The caller holds an exclusive lock.
+  const interned_layout&
+  insert(std::string_view serialized, record_type layout);
+
+  mutable std::shared_mutex mutex_;
+  std::vector<std::unique_ptr<interned_layout>> layouts_;
+  std::unordered_map<record_type, const interned_layout*> by_layout_;
+
+  /// Owns the serialized forms that the keys of `by_serialized_` refer to.
+  std::deque<std::string> serialized_;
+  std::unordered_map<std::string_view, const interned_layout*> by_serialized_;
+};
+
+/// A flat table that associates values with interned layouts, indexed by
+/// their IDs. Lookups are a bounds check and an array access.
+template <class T>
+class layout_table {
+public:
+  /// @returns A pointer to the value for *id*, or `nullptr` if not found.
+  T* find(layout_id id) {
+    if (id >= slots_.size() || !slots_[id])
+      return nullptr;
+    return &*slots_[id];
+  }
+
+  /// @returns A pointer to the value for *id*, or `nullptr` if not found.
+  const T* find(layout_id id) const {
+    if (id >= slots_.size() || !slots_[id])
+      return nullptr;
+    return &*slots_[id];
+  }
+
+  /// Associates a value with a layout, replacing the existing value.
+  /// @returns A reference to the inserted value.
+  T& insert(layout_id id, T x) {
+    if (id >= slots_.size())
+      slots_.resize(id + 1);
+    if (!slots_[id])
+      ++size_;
+    slots_[id] = std::move(x);
+    return *slots_[id];
+  }
+
+  /// Removes all values.
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+  /// @returns The number of values.
+  size_t size() const {
+    return size_;
+  }
+
+  /// @returns Whether the table has no values.
+  bool empty() const {
+    return size_ == 0;
+  }
+
+private:
+  std::vector<std::optional<T>> slots_;
+  size_t size_ = 0;
+};
+
+} // namespace vast
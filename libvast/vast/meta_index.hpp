@@ -16,6 +16,7 @@
 #include "vast/fwd.hpp"
 
 #include "vast/fbs/index.hpp"
+#include "vast/detail/interval_tree.hpp"
 #include "vast/fbs/partition.hpp"
 #include "vast/ids.hpp"
 #include "vast/partition_synopsis.hpp"
@@ -26,12 +27,14 @@
 #include "vast/uuid.hpp"
 
 #include <caf/fwd.hpp>
+#include <caf/optional.hpp>
 #include <caf/settings.hpp>
 
 #include <flatbuffers/flatbuffers.h>
 
 #include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -58,6 +61,8 @@ public:
 
   /// Returns the partition synopsis for a specific partition.
   /// Note that most callers will prefer to use `lookup()` instead.
+  /// Modifications of the returned synopsis are not reflected in the time
+  /// index; use `merge()` to replace a partition synopsis instead.
   /// @pre `partition` must be a valid key for this meta index.
   partition_synopsis& at(const uuid& partition);
 
@@ -69,6 +74,30 @@ public:
   /// @returns A vector of UUIDs representing candidate partitions.
   std::vector<uuid> lookup(const expression& expr) const;
 
+  /// Computes an upper bound for the number of persisted events that match an
+  /// expression from the partition synopses alone. The bound includes all
+  /// events of every layout that may match the expression in every candidate
+  /// partition, and it does not include events in partitions that are not
+  /// yet persisted.
+  /// @param expr The expression to bound the number of matches for.
+  /// @returns An upper bound for the number of persisted events matching
+  ///          *expr*.
+  uint64_t count_upper_bound(const expression& expr) const;
+
+  /// Estimates an upper bound for the number of distinct values of a field in
+  /// the persisted events that match an expression from the cardinality
+  /// sketches of the candidate partitions. The sketches cover all events of a
+  /// partition regardless of the expression, so the result estimates the
+  /// distinct values of all events in the candidate partitions with a
+  /// relative standard error of `1.04 / sqrt(2^p)` for sketches of precision
+  /// *p*.
+  /// @param expr The expression to select the events.
+  /// @param field The (suffix of the) name of the field.
+  /// @returns The estimated number of distinct values, or `caf::none` if no
+  ///          candidate partition has a sketch for *field*.
+  caf::optional<double>
+  distinct_upper_bound(const expression& expr, std::string_view field) const;
+
   /// @returns A best-effort estimate of the amount of memory used for this meta
   /// index (in bytes).
   size_t memusage() const;
@@ -87,8 +116,35 @@ public:
                      const system::active_partition_state& x);
 
 private:
+  using synopsis_map = std::unordered_map<uuid, partition_synopsis>;
+
+  /// A subset of the partitions to consider for a lookup.
+  using candidate_list = std::vector<const synopsis_map::value_type*>;
+
+  /// Retrieves the candidate partitions for an expression from a given set of
+  /// partitions.
+  std::vector<uuid>
+  lookup_impl(const expression& expr, const candidate_list& candidates) const;
+
+  /// Adds a partition to the time index.
+  void index_time_range(const uuid& partition, const partition_synopsis& ps);
+
+  /// Removes a partition from the time index.
+  void unindex_time_range(const uuid& partition);
+
   /// Maps a partition ID to the synopses for that partition.
-  std::unordered_map<uuid, partition_synopsis> synopses_;
+  synopsis_map synopses_;
+
+  /// The time range of all fields with the `#timestamp` attribute for every
+  /// partition that has bounds for all of them.
+  std::unordered_map<uuid, std::pair<time, time>> time_ranges_;
+
+  /// Partitions that have a field with the `#timestamp` attribute but no
+  /// bounds for it, and thus qualify for every time range.
+  std::unordered_set<uuid> unbounded_time_ranges_;
+
+  /// An interval tree over `time_ranges_`.
+  detail::interval_tree<time, uuid> time_index_;
 };
 
 } // namespace vast
@@ -44,10 +44,23 @@ public:
 
   caf::optional<bool> lookup(relational_operator op,
                              data_view rhs) const override {
-    auto do_lookup = [this](relational_operator op,
+    return lookup(min_, max_, op, rhs);
+  }
+
+  /// Tests whether a predicate matches for a closed interval `[min, max]`.
+  /// This allows for evaluating lookups without materializing a synopsis,
+  /// e.g., directly on its FlatBuffer representation.
+  /// @param min The lower bound of the interval.
+  /// @param max The upper bound of the interval.
+  /// @param op The operator of the predicate.
+  /// @param rhs The RHS of the predicate.
+  /// @returns The evaluation result of `[min, max] op rhs`.
+  static caf::optional<bool>
+  lookup(T min, T max, relational_operator op, data_view rhs) {
+    auto do_lookup = [&](relational_operator op,
                          data_view xv) -> caf::optional<bool> {
       if (auto x = caf::get_if<view<T>>(&xv))
-        return {lookup_impl(op, *x)};
+        return {lookup_impl(min, max, op, *x)};
       else
         return caf::none;
     };
@@ -103,7 +116,8 @@ public:
   }
 
 private:
-  bool lookup_impl(relational_operator op, const T x) const {
+  static bool
+  lookup_impl(const T min, const T max, relational_operator op, const T x) {
     // Let *min* and *max* constitute the LHS of the lookup operation and *rhs*
     // be the value to compare with on the RHS. Then, there are 5 possible
     // scenarios to differentiate for the inputs:
@@ -129,17 +143,17 @@ private:
         VAST_ASSERT(!"unsupported operator");
         return false;
       case relational_operator::equal:
-        return min_ <= x && x <= max_;
+        return min <= x && x <= max;
       case relational_operator::not_equal:
-        return !(min_ <= x && x <= max_);
+        return !(min <= x && x <= max);
       case relational_operator::less:
-        return min_ < x;
+        return min < x;
       case relational_operator::less_equal:
-        return min_ <= x;
+        return min <= x;
       case relational_operator::greater:
-        return max_ > x;
+        return max > x;
       case relational_operator::greater_equal:
-        return max_ >= x;
+        return max >= x;
     }
   }
 
@@ -14,6 +14,8 @@
 #pragma once
 
 #include "vast/fwd.hpp"
+
+#include "vast/config.hpp"
 #include "vast/table_slice.hpp"
 
 #include <caf/meta/type_name.hpp>
@@ -28,8 +30,8 @@ struct msgpack_table_slice_state;
 
 template <>
 struct msgpack_table_slice_state<fbs::table_slice::msgpack::v0> {
-  /// The deserialized table layout.
-  record_type layout;
+  /// The interned table layout.
+  const interned_layout* layout;
   size_t columns;
 };
 
@@ -67,6 +69,9 @@ public:
   /// @returns The table layout.
   const record_type& layout() const noexcept;
 
+  /// @returns The interned table layout.
+  const interned_layout& interned() const noexcept;
+
   /// @returns The number of rows in the slice.
   table_slice::size_type rows() const noexcept;
 
@@ -96,6 +101,20 @@ public:
   data_view at(table_slice::size_type row, table_slice::size_type column,
                const type& t) const;
 
+  /// Decodes all values of the slice at once.
+  /// @param result The decoded values in column-major order.
+  void decode_columns(std::vector<std::vector<data_view>>& result) const;
+
+#if VAST_ENABLE_ARROW
+
+  /// Transcodes the slice into an Arrow Record Batch. Decodes every row once
+  /// and appends its values to typed column builders, as opposed to accessing
+  /// every cell individually.
+  /// @returns The Record Batch, or `nullptr` on failure.
+  std::shared_ptr<arrow::RecordBatch> to_record_batch() const;
+
+#endif // VAST_ENABLE_ARROW
+
 private:
   // -- implementation details -------------------------------------------------
 
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "vast/detail/hyperloglog.hpp"
 #include "vast/qualified_record_field.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/table_slice.hpp"
@@ -22,6 +23,10 @@ namespace vast {
 /// Contains one synopsis per partition column.
 struct partition_synopsis {
   /// Add data to the synopsis.
+  /// @param slice The events to add.
+  /// @param synopsis_options The options for creating synopses. A non-zero
+  ///        `cardinality-sketch-precision` additionally enables cardinality
+  ///        sketches with the given precision for all columns.
   void add(const table_slice& slice, const caf::settings& synopsis_options);
 
   /// Optimizes the partition synopsis contents for size.
@@ -38,6 +43,17 @@ struct partition_synopsis {
 
   /// Synopsis data structures for individual columns.
   std::unordered_map<qualified_record_field, synopsis_ptr> field_synopses_;
+
+  /// The number of events per layout.
+  std::unordered_map<std::string, uint64_t> layout_counts_;
+
+  /// Sketches of the number of distinct values for individual columns.
+  std::unordered_map<qualified_record_field, detail::hyperloglog>
+    field_sketches_;
+
+  /// Whether `pack` writes Bloom filter synopses in their native layout,
+  /// which older VAST versions cannot read.
+  bool native_bloom_filters_ = false;
 };
 
 // -- flatbuffer ---------------------------------------------------------------
@@ -47,4 +63,11 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis&);
 
 caf::error unpack(const fbs::partition_synopsis::v0&, partition_synopsis&);
 
+/// Unpacks a partition synopsis without copying the synopses that support
+/// lookups directly on their FlatBuffer representation.
+/// @param chunk The chunk containing a `fbs::PartitionSynopsis`. The unpacked
+///        synopses keep a reference to it.
+/// @param ps The partition synopsis to unpack into.
+caf::error unpack_lazily(chunk_ptr chunk, partition_synopsis& ps);
+
 } // namespace vast
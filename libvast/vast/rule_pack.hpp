@@ -0,0 +1,97 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
+
+#include <caf/expected.hpp>
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vast {
+
+/// A set of named rules compiled into a shared evaluation plan. The
+/// disjunction of all rules selects the candidates for the entire set in a
+/// single query, and every distinct predicate gets evaluated at most once per
+/// table slice before the results are attributed to the individual rules.
+class rule_pack {
+public:
+  /// A named rule.
+  using rule = std::pair<std::string, expression>;
+
+  /// Compiles a set of rules into a shared evaluation plan.
+  /// @param rules The names and expressions of the rules.
+  /// @returns The rule pack or an error if a rule is invalid or its name is
+  ///          not unique.
+  static caf::expected<rule_pack> make(std::vector<rule> rules);
+
+  /// @returns The disjunction of all rules.
+  const expression& combined() const;
+
+  /// @returns The number of rules.
+  size_t size() const;
+
+  /// @returns The name of the rule at *index*.
+  const std::string& name(size_t index) const;
+
+  /// @returns The number of distinct predicates over all rules.
+  size_t num_predicates() const;
+
+  /// @returns The number of predicates over all rules, including duplicates.
+  size_t num_predicate_occurrences() const;
+
+  /// Evaluates all rules on a table slice.
+  /// @param slice The table slice to evaluate.
+  /// @returns The IDs of the matching events for every rule.
+  std::vector<ids> evaluate(const table_slice& slice);
+
+  /// Evaluates all rules on the selected rows of a table slice.
+  /// @param slice The table slice to evaluate.
+  /// @param selection The IDs of the rows to consider.
+  /// @returns The IDs in *selection* of the matching events for every rule.
+  std::vector<ids> evaluate(const table_slice& slice, const ids& selection);
+
+private:
+  /// The distinct predicates tailored to a layout, or `std::nullopt` for the
+  /// predicates that do not apply to the layout.
+  using layout_plan = std::vector<std::optional<expression>>;
+
+  /// The normalized expressions of the rules.
+  std::vector<rule> rules_;
+
+  /// The disjunction of all rules.
+  expression combined_;
+
+  /// The distinct predicates of all rules.
+  std::vector<predicate> predicates_;
+
+  /// Maps a predicate to its index in `predicates_`.
+  std::unordered_map<predicate, size_t> predicate_index_;
+
+  /// The number of predicates over all rules, including duplicates.
+  size_t num_predicate_occurrences_ = 0;
+
+  /// Caches the tailored predicates per layout.
+  layout_table<layout_plan> plans_;
+};
+
+} // namespace vast
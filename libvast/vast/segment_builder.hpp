@@ -36,9 +36,10 @@ public:
 
   /// Adds a table slice to the segment.
   /// @returns An error if adding the table slice failed.
-  /// @pre The table slice offset (`x.offset()`) must be greater than the
-  ///      offset of the previously added table slice. This requirement enables
-  ///      efficient lookup of table slices from a sequence of IDs.
+  /// @pre The IDs of the table slice must not overlap with the IDs of a
+  ///      previously added table slice. The offsets need not increase, because
+  ///      multiple IMPORTERs assign IDs from interleaved ranges; the builder
+  ///      keeps the table slices sorted for efficient lookup instead.
   caf::error add(table_slice x);
 
   /// Constructs a segment from previously added table slices.
@@ -67,7 +68,6 @@ public:
 
 private:
   uuid id_;
-  vast::id min_table_slice_offset_;
   uint64_t num_events_;
   flatbuffers::FlatBufferBuilder builder_;
   std::vector<flatbuffers::Offset<fbs::FlatTableSlice>> flat_slices_;
@@ -99,9 +99,12 @@ caf::error inspect(caf::serializer& sink, synopsis_ptr& ptr);
 caf::error inspect(caf::deserializer& source, synopsis_ptr& ptr);
 
 /// Flatbuffer support.
+/// @param native_bloom_filters Whether to write address and string synopses
+///        as `fbs::bloom_filter_synopsis` instead of an opaque synopsis. VAST
+///        versions that predate the native layout cannot read them.
 caf::expected<flatbuffers::Offset<fbs::synopsis::v0>>
 pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr&,
-     const qualified_record_field&);
+     const qualified_record_field&, bool native_bloom_filters = false);
 
 caf::error unpack(const fbs::synopsis::v0&, synopsis_ptr&);
 
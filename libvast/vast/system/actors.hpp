@@ -73,7 +73,10 @@ using partition_client_actor = typed_actor_fwd<
   // of ids followed by a final `atom::done` which as sent as response to the
   // expression. This interface provides the callback for the middle part of
   // this sequence.
-  caf::reacts_to<ids>>::unwrap;
+  caf::reacts_to<ids>,
+  // Receives the latencies of the query stages that the INDEX, the
+  // partitions, and the evaluators measured for the query.
+  caf::reacts_to<atom::trace, query_trace>>::unwrap;
 
 /// The INDEX CLIENT actor interface.
 using index_client_actor = typed_actor_fwd<
@@ -117,6 +120,8 @@ using evaluator_actor = typed_actor_fwd<
 using indexer_actor = typed_actor_fwd<
   // Returns the ids for the given predicate.
   caf::replies_to<curried_predicate>::with<ids>,
+  // Returns the ids for the given predicate, restricted to the given ids.
+  caf::replies_to<curried_predicate, ids>::with<ids>,
   // Requests the INDEXER to shut down.
   caf::reacts_to<atom::shutdown>>::unwrap;
 
@@ -176,7 +181,21 @@ using index_actor = typed_actor_fwd<
   // Queries PARTITION actors for a given query id.
   caf::reacts_to<uuid, uint32_t>,
   // Erases the given events from the INDEX, and returns their ids.
-  caf::replies_to<atom::erase, uuid>::with<ids>>
+  caf::replies_to<atom::erase, uuid>::with<ids>,
+  // INTERNAL: Loads the next batch of pending partition synopses.
+  caf::reacts_to<atom::internal, atom::load>,
+  // Lists all persisted partitions.
+  caf::replies_to<atom::list>::with<std::vector<uuid>>,
+  // Computes an upper bound for the number of persisted events matching an
+  // expression from the META INDEX alone.
+  caf::replies_to<atom::estimate, expression>::with<uint64_t>,
+  // Estimates an upper bound for the number of distinct values of a field in
+  // the persisted events matching an expression from the META INDEX alone.
+  caf::replies_to<atom::estimate, expression, std::string>::with<double>,
+  // Replaces the given persisted partitions with a single new partition that
+  // holds the given table slices.
+  caf::replies_to<atom::replace, std::vector<uuid>,
+                  std::vector<table_slice>>::with<atom::done>>
   // Conform to the protocol of the STREAM SINK actor for table slices.
   ::extend_with<stream_sink_actor<table_slice>>
   // Conform to the protocol of the QUERY SUPERVISOR MASTER actor.
@@ -243,6 +262,13 @@ using disk_monitor_actor = typed_actor_fwd<
   // Conform to the protocol of the STATUS CLIENT actor.
   ::extend_with<status_client_actor>::unwrap;
 
+/// The COMPACTOR actor interface.
+using compactor_actor = typed_actor_fwd<
+  // Checks for small partitions that can be merged.
+  caf::reacts_to<atom::ping>>
+  // Conform to the protocol of the STATUS CLIENT actor.
+  ::extend_with<status_client_actor>::unwrap;
+
 /// The interface for file system I/O. The filesystem actor implementation
 /// must interpret all operations that contain paths *relative* to its own
 /// root directory.
@@ -289,7 +315,10 @@ using exporter_actor = typed_actor_fwd<
   // Execute previously registered query.
   caf::reacts_to<atom::run>,
   // Register a STATISTICS SUBSCRIBER actor.
-  caf::reacts_to<atom::statistics, caf::actor>>
+  caf::reacts_to<atom::statistics, caf::actor>,
+  // Receive the matching events of a continuous query, along with the number
+  // of events that were evaluated since the previous matches.
+  caf::reacts_to<table_slice, uint64_t>>
   // Conform to the protocol of the STREAM SINK actor for table slices.
   ::extend_with<stream_sink_actor<table_slice>>
   // Conform to the protocol of the STATUS CLIENT actor.
@@ -299,6 +328,16 @@ using exporter_actor = typed_actor_fwd<
   // Conform to the protocol of the INDEX CLIENT actor.
   ::extend_with<index_client_actor>::unwrap;
 
+/// The interface of the CONTINUOUS QUERY MATCHER actor.
+using continuous_query_matcher_actor = typed_actor_fwd<
+  // Register a continuous query of an EXPORTER actor.
+  caf::replies_to<atom::subscribe, expression, exporter_actor>::with< //
+    atom::ok>>
+  // Conform to the protocol of the STREAM SINK actor for table slices.
+  ::extend_with<stream_sink_actor<table_slice>>
+  // Conform to the protocol of the STATUS CLIENT actor.
+  ::extend_with<status_client_actor>::unwrap;
+
 /// The interface of an ANALYZER PLUGIN actors.
 using analyzer_plugin_actor = typed_actor_fwd<>
   // Conform to the protocol of the STREAM SINK actor for table slices.
@@ -315,6 +354,9 @@ using importer_actor = typed_actor_fwd<
     caf::outbound_stream_slot<table_slice>>,
   // Register a FLUSH LISTENER actor.
   caf::reacts_to<atom::subscribe, atom::flush, flush_listener_actor>,
+  // Register a continuous query of an EXPORTER actor.
+  caf::replies_to<atom::subscribe, expression, exporter_actor>::with< //
+    atom::ok>,
   // The internal telemetry loop of the IMPORTER.
   caf::reacts_to<atom::telemetry>>
   // Conform to the protocol of the STREAM SINK actor for table slices.
@@ -364,6 +406,8 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_actors, caf::id_block::vast_atoms::end)
   VAST_ADD_TYPE_ID((vast::system::analyzer_plugin_actor))
   VAST_ADD_TYPE_ID((vast::system::archive_actor))
   VAST_ADD_TYPE_ID((vast::system::archive_client_actor))
+  VAST_ADD_TYPE_ID((vast::system::compactor_actor))
+  VAST_ADD_TYPE_ID((vast::system::continuous_query_matcher_actor))
   VAST_ADD_TYPE_ID((vast::system::disk_monitor_actor))
   VAST_ADD_TYPE_ID((vast::system::evaluator_actor))
   VAST_ADD_TYPE_ID((vast::system::exporter_actor))
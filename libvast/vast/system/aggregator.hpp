@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/system/value_counts.hpp"
+#include "vast/system/worker_query_processor.hpp"
+#include "vast/type.hpp"
+
+#include <caf/optional.hpp>
+
+#include <string>
+
+namespace vast::system {
+
+/// Computes the partial aggregate for a single batch of INDEX hits. The
+/// worker fetches the candidates from the ARCHIVE, checks the hits among them
+/// against the query, and counts the values of a single column.
+struct aggregation_worker_state {
+  // -- member types -----------------------------------------------------------
+
+  /// Describes how to aggregate the slices of one layout.
+  struct layout_plan {
+    /// The query tailored to the layout.
+    expression checker;
+
+    /// The flat index of the aggregated column, if the layout has one.
+    caf::optional<size_t> column;
+
+    /// The type of the aggregated column.
+    type column_type;
+  };
+
+  // -- constants --------------------------------------------------------------
+
+  static inline constexpr const char* name = "aggregation-worker";
+
+  // -- member functions -------------------------------------------------------
+
+  /// Adds all events of `slice` that are in `hits` and match the query to the
+  /// result.
+  void add(const table_slice& slice);
+
+  // -- member variables -------------------------------------------------------
+
+  /// Stores the user-defined query.
+  expression expr;
+
+  /// Stores the (suffix of the) name of the field to group by.
+  std::string field;
+
+  /// Stores the INDEX hits that this worker aggregates.
+  ids hits;
+
+  /// Caches the aggregation plans for different layouts.
+  layout_table<layout_plan> plans;
+
+  /// Accumulates the counts for this batch.
+  value_counts result;
+
+  /// Points to the parent actor.
+  caf::event_based_actor* self = nullptr;
+};
+
+caf::behavior aggregation_worker(
+  caf::stateful_actor<aggregation_worker_state>* self, expression expr,
+  std::string field, ids hits, archive_actor archive, caf::actor parent);
+
+/// Counts the events for a query by the values of a single field. The INDEX
+/// hits go to a bounded number of workers, such that candidate checks and
+/// column extraction run in parallel while the AGGREGATOR only merges the
+/// partial results.
+class aggregator_state : public worker_query_processor {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using super = worker_query_processor;
+
+  // -- constants --------------------------------------------------------------
+
+  static inline constexpr const char* name = "aggregator";
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  aggregator_state(caf::event_based_actor* self);
+
+  void init(expression expr, std::string field, index_actor index,
+            archive_actor archive);
+
+protected:
+  // -- implementation hooks ---------------------------------------------------
+
+  void spawn_worker(ids hits) override;
+
+private:
+  // -- member variables -------------------------------------------------------
+
+  /// Stores the user-defined query.
+  expression expr_;
+
+  /// Stores the (suffix of the) name of the field to group by.
+  std::string field_;
+};
+
+caf::behavior
+aggregator(caf::stateful_actor<aggregator_state>* self, expression expr,
+           std::string field, index_actor index, archive_actor archive);
+
+} // namespace vast::system
@@ -0,0 +1,87 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/path.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+namespace vast::system {
+
+struct compactor_state {
+  /// The path to the index directory that contains the partitions.
+  path index_dir;
+
+  /// Partitions with fewer events are candidates for compaction, and merged
+  /// partitions hold at most this many events.
+  size_t target_size;
+
+  /// The maximum number of compactions that run at the same time.
+  size_t max_concurrency;
+
+  /// The timespan between scans.
+  std::chrono::seconds scan_interval;
+
+  /// Node handle of the filesystem actor that memory-maps partitions.
+  filesystem_actor filesystem;
+
+  /// Node handle of the ARCHIVE.
+  archive_actor archive;
+
+  /// Node handle of the INDEX.
+  index_actor index;
+
+  /// Whether a scan waits for partitions from the filesystem actor.
+  bool scanning = false;
+
+  /// Maps running compaction workers to the partitions they replace.
+  std::unordered_map<caf::actor_addr, std::vector<uuid>> running;
+
+  /// The number of partitions that were replaced successfully.
+  size_t num_compacted_partitions = 0;
+
+  /// The number of failed compactions.
+  size_t num_failed_compactions = 0;
+
+  constexpr static const char* name = "compactor";
+};
+
+/// Periodically merges adjacent small partitions into larger ones. The
+/// events of the merged partitions are re-read from the ARCHIVE and indexed
+/// into a fresh partition, which then replaces the small partitions in the
+/// INDEX.
+/// @param self The actor handle.
+/// @param target_size The number of events a merged partition should hold.
+/// @param max_concurrency The maximum number of concurrent compactions.
+/// @param scan_interval The timespan between scans.
+/// @param index_dir The path to the index directory.
+/// @param filesystem The actor handle of the filesystem actor.
+/// @param archive The actor handle of the ARCHIVE.
+/// @param index The actor handle of the INDEX.
+compactor_actor::behavior_type
+compactor(compactor_actor::stateful_pointer<compactor_state> self,
+          size_t target_size, size_t max_concurrency,
+          std::chrono::seconds scan_interval, const path& index_dir,
+          filesystem_actor filesystem, archive_actor archive,
+          index_actor index);
+
+} // namespace vast::system
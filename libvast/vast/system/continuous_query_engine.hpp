@@ -0,0 +1,128 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
+#include "vast/type.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vast::system {
+
+/// Evaluates many standing queries on a stream of table slices in a single
+/// pass per slice. For every layout, the engine compiles all queries into a
+/// plan that indexes them by the equality predicates they require, e.g., the
+/// addresses of an IoC list. Evaluating a slice then scans each indexed column
+/// once and probes a hash table per cell, so the cost grows with the number of
+/// distinct indexed columns rather than with the number of queries. Only
+/// queries without such a predicate fall back to row-wise evaluation.
+class continuous_query_engine {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// Identifies the subscriber of a query.
+  using subscriber_id = uint64_t;
+
+  /// The rows of a table slice that match the query of a subscriber.
+  struct match {
+    subscriber_id subscriber;
+    ids selection;
+  };
+
+  /// Counters that describe the work of the engine.
+  struct statistics {
+    /// The number of evaluated table slices.
+    uint64_t slices = 0;
+
+    /// The number of evaluated rows.
+    uint64_t rows = 0;
+
+    /// The number of hash table probes for indexed columns.
+    uint64_t probes = 0;
+
+    /// The number of rows that matched an indexed value of a query.
+    uint64_t candidates = 0;
+
+    /// The number of row-wise evaluations of unindexed queries.
+    uint64_t fallbacks = 0;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  continuous_query_engine();
+
+  ~continuous_query_engine() noexcept;
+
+  continuous_query_engine(continuous_query_engine&&) noexcept;
+
+  continuous_query_engine& operator=(continuous_query_engine&&) noexcept;
+
+  // -- query management -------------------------------------------------------
+
+  /// Registers a standing query, replacing the previous query of the same
+  /// subscriber.
+  /// @param subscriber The subscriber of the query.
+  /// @param expr The query expression.
+  void add(subscriber_id subscriber, expression expr);
+
+  /// Removes the query of a subscriber.
+  /// @param subscriber The subscriber of the query.
+  /// @returns Whether a query was removed.
+  bool erase(subscriber_id subscriber);
+
+  /// @returns The number of standing queries.
+  size_t size() const;
+
+  /// @returns Whether there are no standing queries.
+  bool empty() const;
+
+  // -- evaluation -------------------------------------------------------------
+
+  /// Evaluates all standing queries on a table slice.
+  /// @param slice The table slice to evaluate.
+  /// @returns The matching rows for every subscriber with at least one match.
+  /// @pre `slice.encoding() != table_slice_encoding::none`
+  std::vector<match> evaluate(const table_slice& slice);
+
+  /// @returns The counters of the engine.
+  const statistics& stats() const;
+
+  /// @returns The number of queries that the plan for *layout* indexes by
+  ///          value, compiling the plan if necessary.
+  size_t indexed(const record_type& layout);
+
+private:
+  struct query {
+    subscriber_id subscriber;
+    expression expr;
+  };
+
+  /// The evaluation plan of all queries for a single layout.
+  struct plan;
+
+  /// @returns The plan for *layout*, compiling it on first use.
+  plan& plan_for(const interned_layout& layout);
+
+  std::vector<query> queries_;
+  layout_table<std::unique_ptr<plan>> plans_;
+  statistics stats_;
+};
+
+} // namespace vast::system
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+#include "vast/system/continuous_query_engine.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace vast::system {
+
+struct continuous_query_matcher_state {
+  /// An EXPORTER with a continuous query.
+  struct subscriber {
+    /// The EXPORTER actor.
+    exporter_actor exporter;
+
+    /// The number of evaluated rows when we last sent matches to the
+    /// EXPORTER, which lets us report the rows evaluated in between.
+    uint64_t reported_rows = 0;
+  };
+
+  /// Evaluates all continuous queries on a table slice and sends the matching
+  /// rows to their EXPORTER actors.
+  void evaluate(const table_slice& slice);
+
+  /// Summarizes the actor state.
+  caf::settings status(status_verbosity v) const;
+
+  /// Pointer to the owning actor.
+  continuous_query_matcher_actor::pointer self = {};
+
+  /// Evaluates the queries of all EXPORTER actors once per table slice.
+  continuous_query_engine engine = {};
+
+  /// The EXPORTER actors of the continuous queries.
+  std::unordered_map<continuous_query_engine::subscriber_id, subscriber>
+    subscribers = {};
+
+  /// Name of this actor in log events.
+  static inline const char* name = "continuous-query-matcher";
+};
+
+/// Evaluates the continuous queries of all EXPORTER actors on the stream of
+/// imported table slices, and sends only the matching rows to the EXPORTER
+/// actors. The IMPORTER spawns this actor on the first continuous query, such
+/// that the query evaluation does not run in the IMPORTER stream stage.
+/// @param self The actor handle.
+continuous_query_matcher_actor::behavior_type continuous_query_matcher(
+  continuous_query_matcher_actor::stateful_pointer<
+    continuous_query_matcher_state>
+    self);
+
+} // namespace vast::system
@@ -17,11 +17,10 @@
 
 #include "vast/expression.hpp"
 #include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/query_processor.hpp"
 
-#include <unordered_map>
-
 namespace vast::system {
 
 class counter_state : public query_processor {
@@ -70,7 +69,7 @@ private:
   ids hits_;
 
   /// Caches expr_ tailored to different layouts.
-  std::unordered_map<type, expression> checkers_;
+  layout_table<expression> checkers_;
 };
 
 caf::behavior
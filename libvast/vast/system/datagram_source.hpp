@@ -136,6 +136,7 @@ datagram_source(datagram_source_actor<Reader>* self,
         events, self->state.table_slice_size, push_slice);
       t.stop(produced);
       self->state.count += produced;
+      self->state.observe_produced(produced);
       if (self->state.requested && self->state.count >= *self->state.requested)
         self->state.done = true;
       if (err != caf::none && err != ec::end_of_input)
@@ -186,6 +187,7 @@ datagram_source(datagram_source_actor<Reader>* self,
         if (self->state.reader_initialized)
           put(src, "format", self->state.reader.name());
         put(src, "produced", self->state.count);
+        self->state.put_batching_status(src);
         auto& xs = put_list(result, "sources");
         xs.emplace_back(std::move(src));
       }
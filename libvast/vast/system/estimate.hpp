@@ -0,0 +1,55 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+
+#include <caf/expected.hpp>
+#include <caf/fwd.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace vast::system {
+
+/// Asks the INDEX of a node for an upper bound of the number of persisted
+/// events that match a query. The INDEX answers from the META INDEX alone,
+/// i.e., without loading any partitions.
+/// @param self The actor that sends the request.
+/// @param node The node that hosts the INDEX.
+/// @param query The query to estimate the number of results for.
+/// @param resolve_taxonomies Whether to substitute taxonomy identifiers.
+/// @returns The upper bound for the number of persisted events.
+caf::expected<uint64_t>
+count_upper_bound(caf::scoped_actor& self, const node_actor& node,
+                  const std::string& query, bool resolve_taxonomies);
+
+/// Asks the INDEX of a node for an upper bound of the number of distinct
+/// values of a field in the persisted events that match a query. The INDEX
+/// answers from the cardinality sketches of the META INDEX alone, i.e.,
+/// without loading any partitions.
+/// @param self The actor that sends the request.
+/// @param node The node that hosts the INDEX.
+/// @param query The query to select the events.
+/// @param field The (suffix of the) name of the field.
+/// @param resolve_taxonomies Whether to substitute taxonomy identifiers.
+/// @returns The estimated upper bound for the number of distinct values.
+caf::expected<double>
+distinct_upper_bound(caf::scoped_actor& self, const node_actor& node,
+                     const std::string& query, const std::string& field,
+                     bool resolve_taxonomies);
+
+} // namespace vast::system
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/operator.hpp"
+
+#include <functional>
+
+namespace vast::system {
+
+/// An estimate of the work that looking up a predicate in a partition
+/// requires, and of the fraction of events in the partition that satisfy it.
+struct lookup_estimate {
+  /// The cost of the lookup in arbitrary units. Only relative differences
+  /// between estimates for the same partition are meaningful.
+  double cost = 0.0;
+
+  /// The estimated fraction of events that satisfy the predicate, in the
+  /// interval `[0, 1]`.
+  double selectivity = 1.0;
+};
+
+/// A function that estimates the lookup of a resolved predicate.
+using lookup_estimator = std::function<lookup_estimate(const predicate&)>;
+
+/// Estimates the lookup of a predicate in a value index.
+/// @param index_type The type of the value index.
+/// @param op The relational operator of the predicate.
+/// @param rhs The data operand of the predicate.
+/// @returns The estimate for the lookup, based on the kind of value index that
+///          VAST builds for *index_type* and on the operator.
+lookup_estimate estimate_lookup(const type& index_type, relational_operator op,
+                                const data& rhs);
+
+/// Orders the operands of all conjunctions in an expression such that the
+/// EVALUATOR looks up cheap and selective operands first. Since the EVALUATOR
+/// restricts the lookups of later operands to the hits of earlier ones and
+/// skips them entirely once a conjunction cannot have hits anymore, this
+/// minimizes the expected cost of evaluating the expression.
+/// @param expr The expression to order.
+/// @param estimator The function that estimates the lookups of the predicates
+///        in *expr*.
+/// @returns The reordered expression, which is equivalent to *expr*.
+expression order_by_cost(const expression& expr,
+                         const lookup_estimator& estimator);
+
+} // namespace vast::system
@@ -19,18 +19,29 @@
 #include "vast/ids.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/evaluation_triple.hpp"
+#include "vast/system/query_trace.hpp"
 
 #include <caf/typed_event_based_actor.hpp>
 
+#include <functional>
+#include <map>
+#include <optional>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 namespace vast::system {
 
+/// A function to invoke with the complete result of an evaluation.
+using evaluator_callback = std::function<void(const ids&)>;
+
 /// @relates evaluator
 struct evaluator_state {
   using predicate_hits_map = std::map<offset, std::pair<size_t, ids>>;
 
+  /// A function to invoke with the hits of a subtree of the expression.
+  using continuation = std::function<void(ids)>;
+
   evaluator_state(evaluator_actor::stateful_pointer<evaluator_state> self);
 
   /// Updates `predicate_hits` and may trigger re-evaluation of the expression
@@ -44,9 +55,34 @@ struct evaluator_state {
   /// Evaluates the predicate-tree and may produces new deltas.
   void evaluate();
 
-  /// Decrements the `pending_responses` and sends 'done' to the client when it
-  /// reaches 0.
-  void decrement_pending();
+  /// Looks up all predicates in a subtree of the expression. Operands of
+  /// conjunctions are looked up one after another, restricted to the hits of
+  /// the previous operands, and remaining operands are skipped as soon as the
+  /// conjunction cannot have any hits.
+  /// @param x The subtree of the expression.
+  /// @param position The position of *x* in the expression.
+  /// @param restriction The IDs to restrict the lookups to, if any.
+  /// @param then The function to invoke with the hits of *x* after all
+  ///        lookups in *x* completed.
+  void schedule(const expression& x, const offset& position,
+                const std::optional<ids>& restriction, continuation then);
+
+  /// Looks up the operands of a conjunction starting at *index*, unless the
+  /// hits of the previous operands are empty.
+  /// @param xs The conjunction.
+  /// @param position The position of *xs* in the expression.
+  /// @param index The index of the next operand to look up.
+  /// @param running The hits of all operands before *index*.
+  /// @param then The function to invoke with the hits of *xs*.
+  void schedule_operand(const conjunction& xs, const offset& position,
+                        size_t index, ids running, continuation then);
+
+  /// Invokes the continuation for a predicate after all its lookups
+  /// completed.
+  void resume(const offset& position);
+
+  /// Sends 'done' to the client after all lookups completed.
+  void finish();
 
   /// Returns the `predicate_hits` entry for `pred` or `nullptr`.
   predicate_hits_map::mapped_type* hits_for(const offset& position);
@@ -54,9 +90,27 @@ struct evaluator_state {
   /// Stores the number of requests that did not receive a response yet.
   size_t pending_responses = 0;
 
+  /// Stores the number of lookups that were skipped because the enclosing
+  /// conjunction had no hits.
+  size_t skipped_lookups = 0;
+
+  /// Stores the number of lookups that shared the request of an identical
+  /// lookup for another position.
+  size_t shared_lookups = 0;
+
   /// Stores hits per predicate in the expression.
   predicate_hits_map predicate_hits;
 
+  /// Stores the positions that wait for the result of an unrestricted lookup,
+  /// such that identical predicates in different subtrees of the expression
+  /// share a single request to their INDEXER.
+  std::map<std::tuple<indexer_actor, relational_operator, data>,
+           std::vector<offset>>
+    pending_lookups;
+
+  /// Stores what to do after all lookups for a predicate completed.
+  std::map<offset, continuation> continuations;
+
   /// Stores hits for the expression.
   ids hits;
 
@@ -72,18 +126,36 @@ struct evaluator_state {
   /// Stores the original evaluation triples.
   std::vector<evaluation_triple> eval;
 
+  /// Receives the hits for the expression after all INDEXER actors responded
+  /// successfully.
+  evaluator_callback on_complete;
+
+  /// Indicates whether an INDEXER failed to deliver its hits, in which case
+  /// the hits for the expression are incomplete.
+  bool incomplete = false;
+
   /// Allows us to respond to the COLLECTOR after finishing a lookup.
   caf::typed_response_promise<atom::done> promise;
 
+  /// Stores the latencies of the lookups, which we send to the client after
+  /// finishing.
+  query_trace trace;
+
   /// Gives this actor a recognizable name in logging output.
   static inline const char* name = "evaluator";
 };
 
 /// Wraps a query expression in an actor. Upon receiving hits from INDEXER
 /// actors, re-evaluates the expression and relays new hits to the INDEX CLIENT.
+/// The operands of conjunctions are evaluated in order, so callers should
+/// order them by cost first, e.g., with `order_by_cost`.
+/// @param expr The query expression.
+/// @param eval The predicates and the INDEXER actors to evaluate them.
+/// @param on_complete An optional function to invoke with the complete hits.
 /// @pre `!eval.empty()`
 evaluator_actor::behavior_type
 evaluator(evaluator_actor::stateful_pointer<evaluator_state> self,
-          expression expr, std::vector<evaluation_triple> eval);
+          expression expr, std::vector<evaluation_triple> eval,
+          evaluator_callback on_complete);
 
 } // namespace vast::system
@@ -18,9 +18,11 @@
 #include "vast/aliases.hpp"
 #include "vast/expression.hpp"
 #include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/query_options.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/query_status.hpp"
+#include "vast/system/query_trace.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
 
@@ -28,6 +30,8 @@
 #include <caf/scheduled_actor.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <deque>
+
 namespace vast::system {
 
 struct exporter_state {
@@ -56,8 +60,8 @@ struct exporter_state {
   /// Stores hits from the INDEX.
   ids hits;
 
-  /// Caches tailored candidate checkers.
-  std::unordered_map<type, expression> checkers;
+  /// Caches tailored candidate checkers by layout.
+  layout_table<expression> checkers;
 
   /// Caches results for the SINK.
   std::vector<table_slice> results;
@@ -68,6 +72,12 @@ struct exporter_state {
   /// Stores various meta information about the progress we made on the query.
   query_status query;
 
+  /// Stores the per-stage latencies of the query.
+  query_trace trace;
+
+  /// Stores the send times of the pending lookups at the ARCHIVE.
+  std::deque<stopwatch::time_point> archive_lookups;
+
   /// Stores flags for the query for distinguishing historic and continuous
   /// queries.
   query_options options;
@@ -15,24 +15,55 @@
 
 #include "vast/fwd.hpp"
 
+#include <caf/fwd.hpp>
 #include <caf/meta/type_name.hpp>
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 
 namespace vast::system {
 
+/// A histogram of operation latencies with exponentially growing buckets.
+struct latency_histogram {
+  /// The number of buckets. Bucket *i* counts the operations that took less
+  /// than 2^i microseconds, and the last bucket counts all slower operations.
+  static constexpr size_t num_buckets = 24;
+
+  /// Records the latency of a single operation.
+  template <class Rep, class Period>
+  void add(std::chrono::duration<Rep, Period> latency) {
+    auto us
+      = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t i = 0;
+    while (i < num_buckets - 1 && (int64_t{1} << i) <= us)
+      ++i;
+    ++buckets[i];
+  }
+
+  std::array<uint64_t, num_buckets> buckets = {};
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, latency_histogram& x) ->
+    typename Inspector::result_type {
+    return f(caf::meta::type_name("vast.system.latency_histogram"),
+             x.buckets);
+  }
+};
+
 /// Statistics about filesystem operations.
 struct filesystem_statistics {
   struct ops {
     uint64_t successful = 0;
     uint64_t failed = 0;
     uint64_t bytes = 0;
+    latency_histogram latency;
 
     template <class Inspector>
     friend auto inspect(Inspector& f, ops& x) ->
       typename Inspector::result_type {
       return f(caf::meta::type_name("vast.system.filesystem_statistics.ops"),
-               x.successful, x.failed, x.bytes);
+               x.successful, x.failed, x.bytes, x.latency);
     }
   };
 
@@ -48,4 +79,9 @@ struct filesystem_statistics {
   }
 };
 
+/// Adds the operation statistics to a status dictionary.
+/// @param xs The status dictionary.
+/// @param stats The filesystem statistics.
+void fill_status_map(caf::settings& xs, const filesystem_statistics& stats);
+
 } // namespace vast::system
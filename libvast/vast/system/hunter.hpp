@@ -0,0 +1,85 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/ids.hpp"
+#include "vast/rule_pack.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/system/value_counts.hpp"
+#include "vast/system/worker_query_processor.hpp"
+
+namespace vast::system {
+
+/// Attributes the events of a single batch of INDEX hits to the rules of a
+/// rule pack. The worker fetches the candidates from the ARCHIVE and counts
+/// the hits among them that match each rule.
+struct hunt_worker_state {
+  // -- constants --------------------------------------------------------------
+
+  static inline constexpr const char* name = "hunt-worker";
+
+  // -- member variables -------------------------------------------------------
+
+  /// Stores the rules to attribute the candidates to.
+  rule_pack rules;
+
+  /// Stores the INDEX hits that this worker attributes.
+  ids hits;
+
+  /// Accumulates the number of matching events per rule name.
+  value_counts result;
+};
+
+caf::behavior hunt_worker(caf::stateful_actor<hunt_worker_state>* self,
+                          rule_pack rules, ids hits, archive_actor archive,
+                          caf::actor parent);
+
+/// Runs all rules of a rule pack as a single query. The disjunction of all
+/// rules goes through the META INDEX and the partitions only once, and a
+/// bounded number of workers attributes the INDEX hits to the individual
+/// rules.
+class hunter_state : public worker_query_processor {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using super = worker_query_processor;
+
+  // -- constants --------------------------------------------------------------
+
+  static inline constexpr const char* name = "hunter";
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  hunter_state(caf::event_based_actor* self);
+
+  void init(rule_pack rules, index_actor index, archive_actor archive);
+
+protected:
+  // -- implementation hooks ---------------------------------------------------
+
+  void spawn_worker(ids hits) override;
+
+private:
+  // -- member variables -------------------------------------------------------
+
+  /// Stores the rules to run.
+  rule_pack rules_;
+};
+
+caf::behavior hunter(caf::stateful_actor<hunter_state>* self, rule_pack rules,
+                     index_actor index, archive_actor archive);
+
+} // namespace vast::system
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/aliases.hpp"
+#include "vast/ids.hpp"
+#include "vast/path.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace vast::system {
+
+/// Hands out disjoint ranges of IDs to any number of concurrently running
+/// IMPORTER actors. A reservation only advances an atomic counter; a
+/// background thread persists a watermark above all reserved IDs, writing
+/// once for all reservations that accumulated in the meantime. Reservations
+/// block on the disk only if they overtake the persisted watermark.
+///
+/// The allocator hands out IDs in blocks that are aligned to `block_size`, so
+/// that every block belongs to exactly one IMPORTER. Consumers such as the
+/// INDEX rely on this to tell apart interleaved streams of events.
+class id_allocator {
+public:
+  /// The number of IDs in a block.
+  static constexpr id block_size = id{1} << 23; // 8_Mi
+
+  /// @returns The block that contains an ID.
+  static constexpr id block_of(id x) noexcept {
+    return x / block_size;
+  }
+
+  /// Creates an allocator that continues where a previous allocator with the
+  /// same state directory left off.
+  /// @param dir The directory for persistent state.
+  /// @param headroom The number of IDs beyond the highest reserved ID to
+  ///        persist ahead of time.
+  static caf::expected<std::shared_ptr<id_allocator>>
+  make(path dir, id headroom);
+
+  id_allocator(const id_allocator&) = delete;
+  id_allocator& operator=(const id_allocator&) = delete;
+
+  /// Stops the background thread and persists the next available ID.
+  ~id_allocator();
+
+  /// Reserves a range of IDs that spans whole blocks.
+  /// @param n The minimum number of IDs in the range.
+  /// @returns The reserved range, or an error if the allocator failed to
+  ///          persist a watermark above the range. The IDs of a failed
+  ///          reservation are never handed out.
+  /// @note This function is safe to call from multiple threads.
+  caf::expected<id_range> reserve(uint64_t n);
+
+  /// @returns The next ID that has not been reserved yet.
+  id next() const noexcept;
+
+  /// @returns The persisted watermark below which all reserved IDs lie.
+  id durable() const noexcept;
+
+  /// @returns The number of times the allocator wrote its state to disk.
+  size_t writes() const noexcept;
+
+private:
+  id_allocator(path file, id next, id headroom);
+
+  /// Persists a watermark of at least `target` unless it is persisted already.
+  caf::error persist(id target);
+
+  /// Writes the state file.
+  caf::error write(id end, std::optional<id> next = std::nullopt);
+
+  /// Asks the background thread to persist a watermark of at least `target`.
+  void request(id target);
+
+  /// The main loop of the background thread.
+  void run();
+
+  path file_;
+  id headroom_;
+  std::atomic<id> next_;
+  std::atomic<id> durable_;
+  std::atomic<id> requested_;
+  std::atomic<size_t> writes_ = 0;
+  std::mutex write_mutex_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+} // namespace vast::system
@@ -24,6 +24,7 @@
 #include "vast/system/make_source.hpp"
 #include "vast/system/node_control.hpp"
 #include "vast/system/signal_monitor.hpp"
+#include "vast/system/slice_transport.hpp"
 #include "vast/system/spawn_or_connect_to_node.hpp"
 
 #include <caf/make_message.hpp>
@@ -49,25 +50,51 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
   VAST_DEBUG("{} got node", detail::pretty_type_name(inv.full_name));
   // Get node components.
   auto components = get_node_components< //
-    accountant_actor, type_registry_actor, importer_actor>(self, node);
+    accountant_actor, type_registry_actor>(self, node);
   if (!components)
     return caf::make_message(std::move(components.error()));
-  auto& [accountant, type_registry, importer] = *components;
+  auto& [accountant, type_registry] = *components;
   if (!type_registry)
     return caf::make_message(caf::make_error( //
       ec::missing_component, "type-registry"));
+  // Multiple IMPORTERs may run in the node, which we tell apart by label.
+  auto label = caf::get_or(inv.options, "vast.import.importer",
+                           defaults::import::importer);
+  auto importer_opt = get_node_component<importer_actor>(self, node, label);
+  if (!importer_opt)
+    return caf::make_message(std::move(importer_opt.error()));
+  auto importer = std::move(*importer_opt);
   if (!importer)
     return caf::make_message(caf::make_error( //
-      ec::missing_component, "importer"));
+      ec::missing_component, "importer", label));
   // Start signal monitor.
   std::thread sig_mon_thread;
   auto guard = system::signal_monitor::run_guarded(
     sig_mon_thread, sys, defaults::system::signal_monitoring_interval, self);
+  // Ship table slices through shared memory if requested. The SLICE RECEIVER
+  // terminates after it forwarded all table slices to the IMPORTER.
+  auto sink = stream_sink_actor<table_slice, std::string>{importer};
+  auto receiver = caf::actor{};
+  if (caf::get_or(inv.options, "vast.import.shared-memory", false)) {
+    auto transport = make_slice_transport(self, node, label,
+                                          std::string{inv.name()});
+    if (transport) {
+      sink = std::move(transport->sender);
+      receiver = std::move(transport->receiver);
+    } else {
+      VAST_WARN("{} falls back to sending table slices over the network: {}",
+                detail::pretty_type_name(inv.full_name),
+                render(transport.error()));
+    }
+  }
   // Start the source.
   auto src_result
-    = make_source<Reader>(self, sys, inv, accountant, type_registry, importer);
-  if (!src_result)
+    = make_source<Reader>(self, sys, inv, accountant, type_registry, sink);
+  if (!src_result) {
+    if (receiver)
+      self->send_exit(sink, caf::exit_reason::user_shutdown);
     return caf::make_message(std::move(src_result.error()));
+  }
   auto src = std::move(src_result->src);
   auto name = std::move(src_result->name);
   bool stop = false;
@@ -85,10 +112,19 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
   }
   self->monitor(src);
   self->monitor(importer);
+  if (receiver)
+    self->monitor(receiver);
+  // Called once all events arrived at the IMPORTER.
+  auto input_done = [&] {
+    if (caf::get_or(inv.options, "vast.import.blocking", false))
+      self->send(importer, atom::subscribe_v, atom::flush::value,
+                 caf::actor_cast<flush_listener_actor>(self));
+    else
+      stop = true;
+  };
   self
     ->do_receive(
-      // C++20: remove explicit 'importer' parameter passing.
-      [&, importer = importer](const caf::down_msg& msg) {
+      [&](const caf::down_msg& msg) {
         if (msg.source == importer) {
           VAST_DEBUG("{} received DOWN from node importer",
                      detail::pretty_type_name(name));
@@ -98,11 +134,19 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
         } else if (msg.source == src) {
           VAST_DEBUG("{} received DOWN from source",
                      detail::pretty_type_name(name));
-          if (caf::get_or(inv.options, "vast.import.blocking", false))
-            self->send(importer, atom::subscribe_v, atom::flush::value,
-                       caf::actor_cast<flush_listener_actor>(self));
-          else
+          // Table slices may still be on their way through the receiver.
+          if (!receiver)
+            input_done();
+        } else if (msg.source == receiver) {
+          VAST_DEBUG("{} received DOWN from slice receiver",
+                     detail::pretty_type_name(name));
+          if (msg.reason && msg.reason != caf::exit_reason::user_shutdown) {
+            self->send_exit(src, caf::exit_reason::user_shutdown);
+            err = msg.reason;
             stop = true;
+          } else {
+            input_done();
+          }
         } else {
           VAST_DEBUG("{} received unexpected DOWN from {}",
                      detail::pretty_type_name(name), msg.source);
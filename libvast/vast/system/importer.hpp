@@ -17,32 +17,25 @@
 
 #include "vast/aliases.hpp"
 #include "vast/data.hpp"
-#include "vast/path.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/instrumentation.hpp"
 
+#include <caf/expected.hpp>
 #include <caf/typed_event_based_actor.hpp>
 #include <caf/typed_response_promise.hpp>
 
 #include <chrono>
+#include <memory>
 #include <vector>
 
 namespace vast::system {
 
 /// Receives chunks from SOURCEs, imbues them with an ID, and relays them to
-/// ARCHIVE, INDEX and continuous queries.
+/// ARCHIVE, INDEX and continuous queries. Multiple IMPORTERs may run side by
+/// side, each assigning IDs from blocks that it reserved exclusively.
 struct importer_state {
   // -- member types -----------------------------------------------------------
 
-  /// Used to signal how much information should be persisted in write_state().
-  enum class write_mode : bool {
-    /// Persist the next assignable id, used during a regular shutdown.
-    with_next,
-    /// Persist only the end of the block, used during regular operation to
-    /// prevent state corruption if an irregular shutdown occurs.
-    without_next
-  };
-
   /// A helper structure to partition the id space into blocks.
   /// An importer uses one currently active block.
   struct id_block {
@@ -55,22 +48,11 @@ struct importer_state {
 
   explicit importer_state(importer_actor::pointer self);
 
-  ~importer_state();
-
-  caf::error read_state();
-
-  caf::error write_state(write_mode mode);
-
   void send_report();
 
-  /// Extends the available ids by block size
-  /// @param required The minimum increment of ids so that available ids are
-  /// not depleted after calling this function and assigning this amount
-  /// subsequently.
-  caf::error get_next_block(uint64_t required = 0u);
-
-  /// @returns the next unused id and increments the position by its argument.
-  id next_id(uint64_t advance);
+  /// @returns the next unused id and increments the position by its argument,
+  ///          or an error if no durable IDs are available.
+  caf::expected<id> next_id(uint64_t advance);
 
   /// @returns the number of currently available IDs.
   id available_ids() const noexcept;
@@ -79,10 +61,10 @@ struct importer_state {
   caf::typed_response_promise<caf::settings> status(status_verbosity v) const;
 
   /// The active id block.
-  id_block current;
+  id_block current = {};
 
-  /// State directory.
-  path dir;
+  /// Reserves the blocks of IDs that this IMPORTER assigns.
+  std::shared_ptr<id_allocator> ids;
 
   /// All available ANALYZER PLUGIN actors and their names.
   std::vector<std::pair<std::string, analyzer_plugin_actor>> analyzers;
@@ -105,6 +87,11 @@ struct importer_state {
   /// The index actor.
   index_actor index;
 
+  /// Evaluates the queries of continuous EXPORTER actors once per table slice
+  /// instead of streaming all table slices to every EXPORTER. Spawned on the
+  /// first continuous query.
+  continuous_query_matcher_actor continuous_queries;
+
   accountant_actor accountant;
 
   /// Name of this actor in log events.
@@ -113,16 +100,15 @@ struct importer_state {
 
 /// Spawns an IMPORTER.
 /// @param self The actor handle.
-/// @param dir The directory for persistent state.
-/// @param max_table_slice_size The suggested maximum size for table slices.
+/// @param ids The allocator for the IDs of imported events.
 /// @param node A pointer to the to the NODE actor handle.
 /// @param archive A handle to the ARCHIVE.
 /// @param index A handle to the INDEX.
-/// @param batch_size The initial number of IDs to request when replenishing.
 /// @param type_registry A handle to the type-registry module.
 importer_actor::behavior_type
-importer(importer_actor::stateful_pointer<importer_state> self, path dir,
-         node_actor::pointer node, const archive_actor& archive,
-         index_actor index, const type_registry_actor& type_registry);
+importer(importer_actor::stateful_pointer<importer_state> self,
+         std::shared_ptr<id_allocator> ids, node_actor::pointer node,
+         const archive_actor& archive, index_actor index,
+         const type_registry_actor& type_registry);
 
 } // namespace vast::system
@@ -15,6 +15,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/aliases.hpp"
 #include "vast/detail/lru_cache.hpp"
 #include "vast/detail/stable_map.hpp"
 #include "vast/expression.hpp"
@@ -23,9 +24,11 @@
 #include "vast/system/accountant.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/partition.hpp"
+#include "vast/system/query_result_cache.hpp"
 #include "vast/uuid.hpp"
 
 #include <caf/actor.hpp>
+#include <caf/actor_addr.hpp>
 #include <caf/behavior.hpp>
 #include <caf/event_based_actor.hpp>
 #include <caf/meta/omittable_if_empty.hpp>
@@ -33,6 +36,9 @@
 #include <caf/response_promise.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <functional>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -52,13 +58,23 @@ struct active_partition_info {
   /// The UUID of the partition.
   uuid id;
 
+  /// The upstream actor that streamed the most recent table slice into the
+  /// partition.
+  caf::actor_addr upstream;
+
   template <class Inspector>
   friend auto inspect(Inspector& f, active_partition_info& x) {
     return f(caf::meta::type_name("active_partition_info"), x.actor,
-             x.stream_slot, x.capacity, x.id);
+             x.stream_slot, x.capacity, x.id, x.upstream);
   }
 };
 
+/// Routes table slices to the ACTIVE PARTITION for the ID block of their
+/// offset.
+struct id_block_selector {
+  bool operator()(const id& block, const table_slice& slice) const;
+};
+
 /// Accumulates statistics for a given layout.
 struct layout_statistics {
   uint64_t count; ///< Number of events indexed.
@@ -107,6 +123,9 @@ struct query_state {
   /// Unscheduled partitions.
   std::vector<uuid> partitions;
 
+  /// The key of the query expression in the result cache.
+  std::string cache_key;
+
   template <class Inspector>
   friend auto inspect(Inspector& f, query_state& x) {
     return f(caf::meta::type_name("query_state"), x.id, x.expression,
@@ -114,13 +133,28 @@ struct query_state {
   }
 };
 
+/// A replacement of persisted partitions that waits for pending queries.
+struct deferred_replacement {
+  /// The partitions to replace.
+  std::vector<uuid> old_ids;
+
+  /// The partition that replaces *old_ids*.
+  uuid new_id;
+
+  /// The synopsis of the new partition.
+  partition_synopsis synopsis;
+
+  /// The promise to the requesting COMPACTOR.
+  caf::typed_response_promise<atom::done> rp;
+};
+
 /// The state of the index actor.
 struct index_state {
   // -- type aliases -----------------------------------------------------------
 
-  using index_stream_stage_ptr
-    = caf::stream_stage_ptr<table_slice,
-                            caf::broadcast_downstream_manager<table_slice>>;
+  using index_stream_stage_ptr = caf::stream_stage_ptr<
+    table_slice,
+    caf::broadcast_downstream_manager<table_slice, id, id_block_selector>>;
 
   // -- constructor ------------------------------------------------------------
 
@@ -130,10 +164,20 @@ struct index_state {
 
   caf::error load_from_disk();
 
+  /// Reads the synopsis of a persisted partition from disk and merges it into
+  /// the meta index, extracting it from the partition first if necessary.
+  caf::error load_partition_synopsis(const uuid& id);
+
+  /// Loads up to `n` pending partition synopses into the meta index. Moves
+  /// the partitions whose synopses fail to load to `unreadable_synopses`.
+  void load_pending_synopses(size_t n);
+
   /// @returns various status metrics.
   caf::typed_response_promise<caf::settings> status(status_verbosity v) const;
 
-  void flush_to_disk();
+  /// Writes the index state to disk.
+  /// @param on_success A function to invoke after the state was written.
+  void flush_to_disk(std::function<void()> on_success = {});
 
   path index_filename(path basename = {}) const;
 
@@ -150,9 +194,13 @@ struct index_state {
   std::optional<query_supervisor_actor> next_worker();
 
   /// Get the actor handles for up to `num_partitions` PARTITION actors,
-  /// spawning them if needed.
+  /// spawning them if needed. Passive partitions with a cached result count
+  /// towards `num_partitions`, but contribute their hits to `cached_hits`
+  /// instead of an actor handle. Counts in *trace* whether the passive
+  /// partitions were already in memory.
   std::vector<std::pair<uuid, partition_actor>>
-  collect_query_actors(query_state& lookup, uint32_t num_partitions);
+  collect_query_actors(query_state& lookup, uint32_t num_partitions,
+                       ids& cached_hits, query_trace& trace);
 
   // -- flush handling ---------------------------------------------------------
 
@@ -165,10 +213,39 @@ struct index_state {
   // -- partition handling -----------------------------------------------------
 
   /// Creates a new active partition.
-  void create_active_partition();
-
-  /// Decommissions the active partition.
-  void decomission_active_partition();
+  /// @param block The ID block of the events in the partition.
+  void create_active_partition(id block);
+
+  /// Decommissions an active partition.
+  /// @param block The ID block of the events in the partition.
+  void decomission_active_partition(id block);
+
+  /// @returns The active partition with the given UUID, if any.
+  active_partition_actor find_active_partition(const uuid& id) const;
+
+  /// Spawns an ACTIVE PARTITION actor.
+  /// @param id The UUID of the new partition.
+  /// @param capacity The maximum number of events in the partition.
+  active_partition_actor spawn_active_partition(const uuid& id,
+                                                size_t capacity);
+
+  /// Atomically replaces persisted partitions with a new persisted partition
+  /// that contains the same events, and removes the replaced partitions from
+  /// disk once the new index state is written.
+  /// @param old_ids The partitions to replace.
+  /// @param new_id The partition that replaces *old_ids*.
+  /// @param ps The synopsis of the new partition.
+  /// @pre `!is_referenced_by_pending_query(old_ids)`
+  caf::error replace_partitions(const std::vector<uuid>& old_ids,
+                                const uuid& new_id, partition_synopsis&& ps);
+
+  /// Checks whether a pending query has yet to schedule any of the given
+  /// partitions. The clients of such a query expect a fixed number of
+  /// partitions, so replacing them must wait until the query is done.
+  bool is_referenced_by_pending_query(const std::vector<uuid>& ids) const;
+
+  /// Performs all deferred replacements that no pending query blocks anymore.
+  void complete_deferred_replacements();
 
   // -- data members -----------------------------------------------------------
 
@@ -178,8 +255,11 @@ struct index_state {
   /// The streaming stage.
   index_stream_stage_ptr stage;
 
-  /// The single active (read/write) partition.
-  active_partition_info active_partition = {};
+  /// The active (read/write) partitions by the ID block of their events.
+  /// Every IMPORTER assigns IDs from blocks that it reserved exclusively, so
+  /// the events of a block arrive in order even if multiple IMPORTERs stream
+  /// interleaved ID ranges.
+  std::unordered_map<id, active_partition_info> active_partitions;
 
   /// Partitions that are currently in the process of persisting.
   // TODO: An alternative to keeping an explicit set of unpersisted partitions
@@ -210,6 +290,9 @@ struct index_state {
   /// Maps query IDs to pending lookup state.
   std::unordered_map<uuid, query_state> pending;
 
+  /// Partition replacements that wait for pending queries to finish.
+  std::vector<deferred_replacement> deferred_replacements;
+
   /// Caches idle workers.
   std::vector<query_supervisor_actor> idle_workers;
 
@@ -237,6 +320,32 @@ struct index_state {
   // The false positive rate for the meta index.
   double meta_index_fp_rate;
 
+  /// The precision of the cardinality sketches in the partition synopses, or
+  /// 0 if they are disabled.
+  size_t cardinality_sketch_precision = 0;
+
+  /// Whether to load partition synopses in the background and evaluate them
+  /// directly on their FlatBuffer representation.
+  bool lazy_meta_index = false;
+
+  /// Whether new partitions write Bloom filter synopses in their native
+  /// FlatBuffer layout instead of the opaque layout that older VAST versions
+  /// can read.
+  bool native_bloom_filters = false;
+
+  /// Persisted partitions whose synopses are not yet part of the meta index.
+  /// Queries treat them as candidates unconditionally.
+  std::vector<uuid> pending_synopses;
+
+  /// Persisted partitions whose synopses could not be loaded lazily. Queries
+  /// treat them as candidates unconditionally.
+  std::vector<uuid> unreadable_synopses;
+
+  /// The results of previous queries on passive partitions, or `nullptr` if
+  /// result caching is disabled. Shared with the PASSIVE PARTITION actors,
+  /// which fill the cache after evaluating a query.
+  std::shared_ptr<query_result_cache> result_cache;
+
   static inline const char* name = "index";
 };
 
@@ -255,11 +364,20 @@ pack(flatbuffers::FlatBufferBuilder& builder, const index_state& x);
 /// @param taste_partitions How many lookup partitions to schedule immediately.
 /// @param num_workers The maximum amount of concurrent lookups.
 /// @param meta_index_fp_rate The false positive rate for the meta index.
+/// @param lazy_meta_index Whether to load the meta index in the background.
+/// @param result_cache_size The maximum memory usage of cached query results
+///        in bytes, or 0 to disable the result cache.
+/// @param cardinality_sketch_precision The precision of the cardinality
+///        sketches in the partition synopses, or 0 to disable them.
+/// @param native_bloom_filters Whether to write Bloom filter synopses in
+///        their native FlatBuffer layout.
 /// @pre `partition_capacity > 0
 index_actor::behavior_type
 index(index_actor::stateful_pointer<index_state> self,
       filesystem_actor filesystem, path dir, size_t partition_capacity,
       size_t in_mem_partitions, size_t taste_partitions, size_t num_workers,
-      path meta_index_dir, double meta_index_fp_rate);
+      path meta_index_dir, double meta_index_fp_rate, bool lazy_meta_index,
+      size_t result_cache_size, size_t cardinality_sketch_precision,
+      bool native_bloom_filters);
 
 } // namespace vast::system
@@ -36,6 +36,7 @@
 #include "vast/system/datagram_source.hpp"
 #include "vast/system/signal_monitor.hpp"
 #include "vast/system/source.hpp"
+#include "vast/system/udp_source.hpp"
 
 #include <caf/io/middleman.hpp>
 #include <caf/settings.hpp>
@@ -69,7 +70,8 @@ struct make_source_result {
 /// @param inv The invocation that prompted the actor to be spawned.
 /// @param accountant A handle to the accountant component.
 /// @param type_registry A handle to the type registry component.
-/// @param importer A handle to the importer component.
+/// @param importer A handle to the importer component, or any other sink that
+///        forwards table slices to it.
 /// @returns a handle to the spawned actor and the name of the reader on
 ///          success, an error otherwise.
 template <class Reader,
@@ -78,7 +80,7 @@ template <class Reader,
 caf::expected<make_source_result>
 make_source(const Actor& self, caf::actor_system& sys, const invocation& inv,
             accountant_actor accountant, type_registry_actor type_registry,
-            importer_actor importer) {
+            stream_sink_actor<table_slice, std::string> importer) {
   if (!importer)
     return caf::make_error(ec::missing_component, "importer");
   // Placeholder thingies.
@@ -91,7 +93,10 @@ make_source(const Actor& self, caf::actor_system& sys, const invocation& inv,
   auto file = caf::get_if<std::string>(&options, "vast.import.read");
   auto type = caf::get_if<std::string>(&options, "vast.import.type");
   auto encoding = defaults::import::table_slice_type;
-  if (!extract_settings(encoding, options, "vast.import.batch-encoding"))
+  auto adaptive_encoding
+    = caf::get_or(options, "vast.import.batch-encoding", "") == "auto";
+  if (!adaptive_encoding
+      && !extract_settings(encoding, options, "vast.import.batch-encoding"))
     return caf::make_error(ec::invalid_configuration, "failed to extract "
                                                       "batch-encoding option");
   VAST_ASSERT(encoding != table_slice_encoding::none);
@@ -99,6 +104,8 @@ make_source(const Actor& self, caf::actor_system& sys, const invocation& inv,
                            defaults::import::table_slice_size);
   if (slice_size == 0)
     slice_size = std::numeric_limits<decltype(slice_size)>::max();
+  auto listen_buffer = get_or(options, "vast.import.listen-buffer",
+                              defaults::import::listen_buffer);
   // Parse schema local to the import command.
   auto schema = get_schema(options);
   if (!schema)
@@ -158,17 +165,29 @@ make_source(const Actor& self, caf::actor_system& sys, const invocation& inv,
   }
   if (!reader)
     return caf::make_error(ec::invalid_result, "failed to spawn reader");
-  if (slice_size == std::numeric_limits<decltype(slice_size)>::max())
-    VAST_VERBOSE("{} produces {} table slices", reader->name(), encoding);
+  auto encoding_name
+    = adaptive_encoding ? "per-layout encoded" : to_string(encoding);
+  if (reader->adaptive_batch_size())
+    VAST_VERBOSE("{} produces {} table slices of {} to {} events depending on "
+                 "the input rate",
+                 reader->name(), encoding_name,
+                 defaults::import::min_table_slice_size,
+                 defaults::import::max_table_slice_size);
+  else if (slice_size == std::numeric_limits<decltype(slice_size)>::max())
+    VAST_VERBOSE("{} produces {} table slices", reader->name(), encoding_name);
   else
     VAST_VERBOSE("{} produces {} table slices of at most {} events",
-                 reader->name(), encoding, slice_size);
+                 reader->name(), encoding_name, slice_size);
   // Spawn the source, falling back to the default spawn function.
   auto local_schema = schema ? std::move(*schema) : vast::schema{};
   auto type_filter = type ? std::move(*type) : std::string{};
   auto src =
     [&](auto&&... args) {
-      if (udp_port)
+      if (udp_port && listen_buffer > 0)
+        return sys.spawn<SpawnOptions>(udp_source<Reader>, *udp_port,
+                                       listen_buffer,
+                                       std::forward<decltype(args)>(args)...);
+      else if (udp_port)
         return sys.middleman().spawn_broker<SpawnOptions>(
           datagram_source<Reader>, *udp_port,
           std::forward<decltype(args)>(args)...);
@@ -187,8 +206,7 @@ make_source(const Actor& self, caf::actor_system& sys, const invocation& inv,
   }
   // Connect source to importer.
   VAST_DEBUG("{} connects to {}", inv.full_name, VAST_ARG(importer));
-  self->anon_send(
-    src, static_cast<stream_sink_actor<table_slice, std::string>>(importer));
+  self->anon_send(src, std::move(importer));
   return make_source_result{src, reader->name()};
 }
 
@@ -0,0 +1,172 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+/// A monotonically increasing counter. Every thread increments one of a
+/// fixed number of cache-line aligned stripes, so that concurrent updates
+/// from different threads rarely contend.
+class metrics_counter {
+public:
+  /// The number of stripes per counter.
+  static constexpr size_t num_stripes = 16;
+
+  /// Increments the counter.
+  /// @param n The value to add.
+  void add(uint64_t n = 1) noexcept;
+
+  /// @returns The sum over all stripes.
+  uint64_t value() const noexcept;
+
+private:
+  struct alignas(64) stripe {
+    std::atomic<uint64_t> value{0};
+  };
+
+  std::array<stripe, num_stripes> stripes_ = {};
+};
+
+/// A value that can go up and down.
+class metrics_gauge {
+public:
+  /// Sets the gauge to a value.
+  void set(int64_t x) noexcept {
+    value_.store(x, std::memory_order_relaxed);
+  }
+
+  /// Adds a (possibly negative) value to the gauge.
+  void add(int64_t x) noexcept {
+    value_.fetch_add(x, std::memory_order_relaxed);
+  }
+
+  /// @returns The current value.
+  int64_t value() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> value_{0};
+};
+
+/// A histogram with log-linear buckets in the style of HDR histograms: every
+/// power of two is split into `2^sub_bucket_bits` linear sub-buckets, which
+/// bounds the relative error of a recorded value by `2^-sub_bucket_bits`.
+class metrics_histogram {
+public:
+  /// The number of bits of precision below the most significant bit.
+  static constexpr size_t sub_bucket_bits = 3;
+
+  /// The number of sub-buckets per power of two.
+  static constexpr size_t sub_buckets = size_t{1} << sub_bucket_bits;
+
+  /// The total number of buckets to cover all 64-bit values.
+  static constexpr size_t num_buckets = (64 - sub_bucket_bits + 1)
+                                        << sub_bucket_bits;
+
+  /// A consistent view of a histogram at a point in time.
+  struct snapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    /// @returns An upper bound of the value at quantile *q*.
+    /// @pre `0 <= q && q <= 1`
+    uint64_t quantile(double q) const;
+  };
+
+  /// Records a value.
+  void record(uint64_t x) noexcept;
+
+  /// @returns The bucket index for a value.
+  static size_t bucket(uint64_t x) noexcept;
+
+  /// @returns The largest value that falls into a bucket.
+  static uint64_t upper_bound(size_t bucket) noexcept;
+
+  /// @returns A snapshot of the histogram.
+  snapshot sample() const;
+
+private:
+  std::array<std::atomic<uint64_t>, num_buckets> buckets_ = {};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+/// The values of all metrics in a registry at a point in time.
+struct metrics_snapshot {
+  std::vector<std::pair<std::string, uint64_t>> counters;
+  std::vector<std::pair<std::string, int64_t>> gauges;
+  std::vector<std::pair<std::string, metrics_histogram::snapshot>> histograms;
+};
+
+/// A process-wide registry of metrics. Components look up a metric once and
+/// then update it directly from any thread without sending messages; the
+/// ACCOUNTANT periodically samples the registry and emits all values in one
+/// batch. Updates of a metric are lock-free, but looking up a metric and
+/// sampling the registry acquire a lock that guards the set of metrics.
+class metrics_registry {
+public:
+  /// @returns The process-wide registry.
+  static metrics_registry& instance();
+
+  /// Returns the counter with the given name, creating it if needed.
+  /// @param name The name of the counter.
+  /// @returns A reference that remains valid for the lifetime of the registry.
+  metrics_counter& counter(std::string_view name);
+
+  /// Returns the gauge with the given name, creating it if needed.
+  /// @param name The name of the gauge.
+  /// @returns A reference that remains valid for the lifetime of the registry.
+  metrics_gauge& gauge(std::string_view name);
+
+  /// Returns the histogram with the given name, creating it if needed.
+  /// @param name The name of the histogram.
+  /// @returns A reference that remains valid for the lifetime of the registry.
+  metrics_histogram& histogram(std::string_view name);
+
+  /// @returns The current values of all metrics.
+  metrics_snapshot sample() const;
+
+private:
+  template <class T>
+  using map_type = std::map<std::string, std::unique_ptr<T>, std::less<>>;
+
+  mutable std::mutex mutex_;
+  map_type<metrics_counter> counters_;
+  map_type<metrics_gauge> gauges_;
+  map_type<metrics_histogram> histograms_;
+};
+
+/// Renders a snapshot in the Prometheus text exposition format.
+/// @param snapshot The metrics to render.
+/// @param prefix The prefix for all metric names.
+/// @returns The exposition text.
+std::string to_prometheus(const metrics_snapshot& snapshot,
+                          std::string_view prefix = "vast");
+
+} // namespace vast::system
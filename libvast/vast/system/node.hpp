@@ -27,6 +27,7 @@
 
 #include <chrono>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace vast::system {
@@ -71,6 +72,9 @@ struct node_state {
 
   /// Counters for multi-instance components.
   std::unordered_map<std::string, uint64_t> label_counters = {};
+
+  /// The allocator that all IMPORTERs of the node reserve IDs from.
+  std::shared_ptr<id_allocator> ids = {};
 };
 
 /// Spawns a node.
@@ -78,8 +82,12 @@ struct node_state {
 /// @param name The unique name of the node.
 /// @param dir The directory where to store persistent state.
 /// @param shutdown_grace_period Time to give components to shutdown cleanly.
+/// @param filesystem_workers The number of threads that read and memory-map
+///        files. A value of 0 performs all filesystem operations on a single
+///        thread.
 node_actor::behavior_type
 node(node_actor::stateful_pointer<node_state> self, std::string name, path dir,
-     std::chrono::milliseconds shutdown_grace_period);
+     std::chrono::milliseconds shutdown_grace_period,
+     size_t filesystem_workers);
 
 } // namespace vast::system
@@ -66,4 +66,23 @@ get_node_components(caf::scoped_actor& self, const node_actor& node) {
   return result;
 }
 
+/// Look up a component by its label.
+template <class Actor>
+caf::expected<Actor> get_node_component(caf::scoped_actor& self,
+                                        const node_actor& node,
+                                        std::string label) {
+  auto result = caf::expected{Actor{}};
+  self
+    ->request(node, caf::infinite, atom::get_v, atom::label_v,
+              std::move(label))
+    .receive(
+      [&](caf::actor component) {
+        result = caf::actor_cast<Actor>(std::move(component));
+      },
+      [&](caf::error e) { //
+        result = std::move(e);
+      });
+  return result;
+}
+
 } // namespace vast::system
@@ -19,6 +19,7 @@
 #include "vast/expression.hpp"
 #include "vast/fbs/partition.hpp"
 #include "vast/ids.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/partition_synopsis.hpp"
 #include "vast/path.hpp"
 #include "vast/qualified_record_field.hpp"
@@ -26,6 +27,7 @@
 #include "vast/system/evaluator.hpp"
 #include "vast/system/indexer.hpp"
 #include "vast/system/instrumentation.hpp"
+#include "vast/system/query_result_cache.hpp"
 #include "vast/table_slice_column.hpp"
 #include "vast/type.hpp"
 #include "vast/uuid.hpp"
@@ -35,6 +37,7 @@
 #include <caf/stream_slot.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -56,6 +59,17 @@ struct active_partition_state {
     caf::broadcast_downstream_manager<
       table_slice_column, vast::qualified_record_field, partition_selector>>;
 
+  /// State derived from a layout when the partition receives its first table
+  /// slice of that layout.
+  struct layout_state {
+    /// Points to the entry for the layout name in `type_ids`.
+    ids* type_ids;
+
+    /// The qualified fields of the flattened layout, all of which have an
+    /// indexer.
+    std::vector<qualified_record_field> fields;
+  };
+
   // -- utility functions ------------------------------------------------------
 
   active_indexer_actor indexer_at(size_t position) const;
@@ -84,6 +98,9 @@ struct active_partition_state {
   /// Maps type names to IDs. Used the answer #type queries.
   std::unordered_map<std::string, ids> type_ids;
 
+  /// Caches per-layout state for the layouts of incoming table slices.
+  layout_table<layout_state> layouts;
+
   /// Partition synopsis for this partition. This is built up in parallel
   /// to the one in the index, so it can be shrinked and serialized into
   /// a `Partition` flatbuffer upon completion of this partition. Will be
@@ -108,6 +125,9 @@ struct active_partition_state {
   /// Actor handle of the filesystem actor.
   filesystem_actor filesystem;
 
+  /// Actor handle of the accountant, if any.
+  accountant_actor accountant;
+
   /// Promise that gets satisfied after the partition state was serialized
   /// and written to disk.
   caf::typed_response_promise<std::shared_ptr<partition_synopsis>>
@@ -123,6 +143,9 @@ struct active_partition_state {
   /// with a serialized chunk.
   size_t persisted_indexers;
 
+  /// The point in time when the INDEX requested to persist the partition.
+  stopwatch::time_point persist_start;
+
   /// Temporary storage for the serialized indexers of this partition, before
   /// they get written into the flatbuffer.
   std::map<caf::actor_id, vast::chunk_ptr> chunks;
@@ -176,6 +199,12 @@ struct passive_partition_state {
                          caf::typed_response_promise<atom::done>>>
     deferred_evaluations;
 
+  /// The time when the partition started loading from disk.
+  stopwatch::time_point load_start;
+
+  /// The result cache of the INDEX, or `nullptr` if disabled.
+  std::shared_ptr<query_result_cache> result_cache;
+
   /// A typed view into the `partition_chunk`.
   const fbs::partition::v0* flatbuffer;
 
@@ -201,18 +230,23 @@ caf::error unpack(const fbs::partition::v0& x, partition_synopsis& y);
 /// @param filesystem The actor handle of the filesystem actor.
 /// @param index_opts Settings that are forwarded when creating indexers.
 /// @param synopsis_opts Settings that are forwarded when creating synopses.
+/// @param accountant The actor handle of the accountant that receives the
+///        persistence metrics, if any.
 active_partition_actor::behavior_type active_partition(
   active_partition_actor::stateful_pointer<active_partition_state> self,
   uuid id, filesystem_actor filesystem, caf::settings index_opts,
-  caf::settings synopsis_opts);
+  caf::settings synopsis_opts, accountant_actor accountant);
 
 /// Spawns a read-only partition.
 /// @param self The partition actor.
 /// @param id The UUID of this partition.
 /// @param filesystem The actor handle of the filesystem actor.
 /// @param path The path where the partition flatbuffer can be found.
+/// @param result_cache The cache for the results of completed evaluations, or
+///        `nullptr` to disable caching.
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
-  filesystem_actor filesystem, vast::path path);
+  filesystem_actor filesystem, vast::path path,
+  std::shared_ptr<query_result_cache> result_cache);
 
 } // namespace vast::system
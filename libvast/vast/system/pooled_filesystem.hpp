@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/path.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/system/filesystem_statistics.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <vector>
+
+namespace vast::system {
+
+/// The state for the pooled filesystem.
+/// @relates pooled_filesystem
+struct pooled_filesystem_state {
+  /// A worker that performs blocking I/O on its own thread.
+  struct worker {
+    filesystem_actor handle;
+    size_t pending = 0;
+  };
+
+  /// Statistics about filesystem operations, including the time requests
+  /// spend waiting for a worker.
+  filesystem_statistics stats;
+
+  /// The workers for reads and memory mappings.
+  std::vector<worker> readers;
+
+  /// The worker for writes.
+  worker writer;
+
+  /// The actor name.
+  static inline const char* name = "pooled-filesystem";
+};
+
+/// A filesystem that dispatches operations to a pool of POSIX filesystem
+/// workers, each of which runs on a dedicated thread. Reads and memory
+/// mappings go to the least busy of the reader workers, so that loading
+/// partitions for queries neither waits for other reads nor for background
+/// writes. Writes go to a single writer worker, which retains their order.
+/// @param self The actor handle.
+/// @param root The filesystem root. The workers prepend this path to all
+///             operations that include a path parameter.
+/// @param num_readers The number of reader workers.
+/// @pre `num_readers > 0`
+/// @returns The actor behavior.
+filesystem_actor::behavior_type pooled_filesystem(
+  filesystem_actor::stateful_pointer<pooled_filesystem_state> self, path root,
+  size_t num_readers);
+
+} // namespace vast::system
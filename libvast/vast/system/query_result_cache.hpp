@@ -0,0 +1,110 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/detail/lru_map.hpp"
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/uuid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vast::system {
+
+/// A bounded cache for the results of evaluating a query on a passive
+/// partition. Passive partitions are immutable, so the result of an
+/// expression on a partition remains valid until the partition is erased or
+/// replaced by compaction. The INDEX answers cached partitions directly
+/// instead of loading and evaluating them again, while the PASSIVE PARTITION
+/// actors fill the cache after completing an evaluation. Hence, all member
+/// functions are thread-safe.
+class query_result_cache {
+public:
+  /// Aggregate statistics for the status output.
+  struct statistics {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    size_t memory_usage = 0;
+    size_t capacity = 0;
+  };
+
+  /// Constructs a result cache.
+  /// @param capacity The maximum memory usage of all cached results in bytes.
+  explicit query_result_cache(size_t capacity);
+
+  /// @returns The cache key of an expression, which is the string
+  ///          representation of the normalized expression.
+  static std::string key(const expression& expr);
+
+  /// Looks up the result of an expression on a partition, marking it as
+  /// recently used on success.
+  /// @param expr The key of the expression.
+  /// @param partition The ID of the partition.
+  /// @returns The cached hits, or `std::nullopt` if the result is unknown.
+  std::optional<ids> lookup(const std::string& expr, const uuid& partition);
+
+  /// Stores the result of an expression on a partition, evicting the least
+  /// recently used results when exceeding the capacity.
+  /// @param expr The key of the expression.
+  /// @param partition The ID of the partition.
+  /// @param hits The complete result of evaluating *expr* on *partition*.
+  void insert(std::string expr, const uuid& partition, ids hits);
+
+  /// Removes all results for a partition.
+  /// @param partition The ID of the partition.
+  void erase(const uuid& partition);
+
+  /// Removes all results.
+  void clear();
+
+  /// @returns The statistics of the cache.
+  statistics stats() const;
+
+private:
+  struct entry_key {
+    std::string expr;
+    uuid partition;
+
+    friend bool operator==(const entry_key& x, const entry_key& y) {
+      return x.partition == y.partition && x.expr == y.expr;
+    }
+  };
+
+  struct entry_key_hash {
+    size_t operator()(const entry_key& x) const noexcept;
+  };
+
+  /// Removes a single entry and adjusts the memory usage accordingly.
+  void erase_entry(const entry_key& key);
+
+  /// @returns The estimated memory usage of a single entry.
+  static size_t entry_size(const entry_key& key, const ids& hits);
+
+  mutable std::mutex mutex_;
+  detail::lru_map<entry_key, ids, entry_key_hash> entries_;
+  std::unordered_map<uuid, std::vector<std::string>> keys_by_partition_;
+  size_t capacity_;
+  size_t memory_usage_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+} // namespace vast::system
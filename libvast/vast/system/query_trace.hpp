@@ -0,0 +1,131 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/instrumentation.hpp"
+#include "vast/system/report.hpp"
+#include "vast/time.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/meta/type_name.hpp>
+#include <caf/settings.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vast::system {
+
+/// The stages of a query that a trace distinguishes.
+enum class query_stage : uint8_t {
+  meta_index_lookup, ///< Selecting candidate partitions in the INDEX.
+  partition_load,    ///< Loading a passive partition from disk.
+  indexer_lookup,    ///< A round trip from an EVALUATOR to an INDEXER.
+  evaluator_combine, ///< Combining the predicate hits in an EVALUATOR.
+  archive_load,      ///< Waiting for the ARCHIVE to extract a set of hits.
+  candidate_check,   ///< Evaluating the expression on a slice in the EXPORTER.
+  select,            ///< Selecting the matching rows in the EXPORTER.
+  sink_write,        ///< Writing a slice in the SINK.
+};
+
+/// The number of distinct query stages.
+inline constexpr size_t num_query_stages = 8;
+
+/// @returns The name of a query stage.
+const char* query_stage_name(query_stage x);
+
+/// The aggregated latencies of a single query stage.
+struct query_stage_stats {
+  uint64_t count = 0;
+  duration total = duration::zero();
+  duration max = duration::zero();
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, query_stage_stats& x) {
+    return f(caf::meta::type_name("query_stage_stats"), x.count, x.total,
+             x.max);
+  }
+};
+
+/// The per-stage latency breakdown of a single query. The EXPORTER owns the
+/// trace of its query; the other actors on the query path measure their
+/// stages in a trace of their own and send it to the query client as
+/// `(atom::trace, query_trace)`, which the EXPORTER merges into its trace.
+struct query_trace {
+  /// The query ID that the INDEX assigned, if any.
+  uuid id = uuid::nil();
+
+  /// The time when the query started.
+  time start = {};
+
+  /// The latencies of all stages, indexed by `query_stage`.
+  std::vector<query_stage_stats> stages
+    = std::vector<query_stage_stats>(num_query_stages);
+
+  /// The number of candidate partitions that were already in memory.
+  uint64_t partition_cache_hits = 0;
+
+  /// The number of candidate partitions that had to be loaded from disk.
+  uint64_t partition_cache_misses = 0;
+
+  /// Adds a measurement of a stage.
+  void record(query_stage stage, duration elapsed);
+
+  /// Counts a candidate partition that was (or was not) in memory.
+  void record_partition(bool cache_hit);
+
+  /// Adds the measurements of another trace of the same query.
+  void merge(const query_trace& other);
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, query_trace& x) {
+    return f(caf::meta::type_name("query_trace"), x.id, x.start, x.stages,
+             x.partition_cache_hits, x.partition_cache_misses);
+  }
+};
+
+/// Converts a trace into metrics for the ACCOUNTANT.
+/// @param x The trace to convert.
+/// @param prefix The prefix of all keys.
+/// @relates query_trace
+report to_report(const query_trace& x, const std::string& prefix);
+
+/// Converts a trace into a status dictionary.
+/// @relates query_trace
+caf::settings to_status(const query_trace& x);
+
+/// Records the lifetime of the timer as a stage in a trace.
+class query_stage_timer {
+public:
+  query_stage_timer(query_trace& trace, query_stage stage)
+    : trace_{trace}, stage_{stage} {
+    // nop
+  }
+
+  query_stage_timer(const query_stage_timer&) = delete;
+  query_stage_timer& operator=(const query_stage_timer&) = delete;
+
+  ~query_stage_timer() {
+    trace_.record(stage_, stopwatch::now() - start_);
+  }
+
+private:
+  query_trace& trace_;
+  query_stage stage_;
+  stopwatch::time_point start_ = stopwatch::now();
+};
+
+} // namespace vast::system
@@ -0,0 +1,145 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/broadcast_downstream_manager.hpp>
+#include <caf/expected.hpp>
+#include <caf/fwd.hpp>
+#include <caf/stream_source.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <chrono>
+#include <string>
+
+/// A local transport for table slices between a client and a node on the same
+/// host. Every table slice travels as a sealed memory file descriptor over a
+/// UNIX domain socket, such that the node maps the slice as a chunk instead of
+/// deserializing a copy of it.
+///
+///      client           |             node
+///   SOURCE -> SLICE SENDER ---> SLICE RECEIVER -> IMPORTER
+///                         memfd
+///
+/// The transport requires `memfd_create(2)` and is only available on Linux.
+
+namespace vast::system {
+
+/// Sends a table slice over a local transport socket. Blocks while the socket
+/// buffer is full.
+/// @param socket The connected socket.
+/// @param slice The table slice to send.
+/// @returns An error if sending failed.
+caf::error send_slice(int socket, const table_slice& slice);
+
+/// Receives a table slice from a local transport socket without blocking.
+/// @param socket The connected socket.
+/// @returns The table slice, `ec::stalled` if no table slice is available, or
+///          `ec::end_of_input` if the peer closed the connection.
+caf::expected<table_slice> receive_slice(int socket);
+
+/// Connects to the listening socket of a client and authenticates with the
+/// token that the client passed to the node out of band.
+/// @param name The name of the socket in the abstract namespace.
+/// @param token The token that identifies the node to the client.
+/// @returns The connected socket or an error.
+caf::expected<int>
+connect_slice_socket(const std::string& name, const std::string& token);
+
+/// The state of the SLICE SENDER actor.
+struct slice_sender_state {
+  ~slice_sender_state();
+
+  /// The connected socket.
+  int socket = -1;
+
+  /// The number of sent table slices.
+  size_t slices = 0;
+
+  static inline const char* name = "slice-sender";
+};
+
+/// Ships the table slices of a stream to a SLICE RECEIVER in the node.
+/// @param self The actor handle.
+/// @param socket The connected socket; the actor takes ownership.
+stream_sink_actor<table_slice, std::string>::behavior_type slice_sender(
+  stream_sink_actor<table_slice, std::string>::stateful_pointer<
+    slice_sender_state>
+    self,
+  int socket);
+
+/// The state of the SLICE RECEIVER actor.
+struct slice_receiver_state {
+  using downstream_manager = caf::broadcast_downstream_manager<table_slice>;
+
+  ~slice_receiver_state();
+
+  /// The connected socket.
+  int socket = -1;
+
+  /// A description of the data for the IMPORTER.
+  std::string description;
+
+  /// Takes care of transmitting batches.
+  caf::stream_source_ptr<downstream_manager> mgr;
+
+  /// The number of received table slices and events.
+  measurement metrics;
+
+  /// The amount of time to wait until the next wakeup.
+  std::chrono::milliseconds wakeup_delay = std::chrono::milliseconds::zero();
+
+  /// Indicates whether the stream source is waiting for input.
+  bool waiting_for_input = false;
+
+  /// Indicates whether the client closed the connection.
+  bool done = false;
+
+  static inline const char* name = "slice-receiver";
+};
+
+/// Receives table slices from a SLICE SENDER and streams them to an IMPORTER.
+/// @param self The actor handle.
+/// @param socket The connected socket; the actor takes ownership.
+/// @param description A description of the data for the IMPORTER.
+caf::behavior
+slice_receiver(caf::stateful_actor<slice_receiver_state>* self, int socket,
+               std::string description);
+
+/// The two ends of a local transport.
+struct slice_transport {
+  /// The sink for the source in the client.
+  stream_sink_actor<table_slice, std::string> sender;
+
+  /// The SLICE RECEIVER in the node, which terminates after forwarding all
+  /// table slices to the IMPORTER.
+  caf::actor receiver;
+};
+
+/// Establishes a local transport to an IMPORTER in a node on the same host.
+/// @param self The actor that talks to the node.
+/// @param node The node.
+/// @param importer The label of the IMPORTER.
+/// @param description A description of the data for the IMPORTER.
+/// @returns The two ends of the transport or an error.
+caf::expected<slice_transport>
+make_slice_transport(caf::scoped_actor& self, const node_actor& node,
+                     const std::string& importer, std::string description);
+
+} // namespace vast::system
@@ -24,9 +24,11 @@
 #include "vast/data.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
+#include "vast/detail/slice_size_estimator.hpp"
 #include "vast/error.hpp"
 #include "vast/expression.hpp"
 #include "vast/expression_visitors.hpp"
+#include "vast/layout_interner.hpp"
 #include "vast/logger.hpp"
 #include "vast/schema.hpp"
 #include "vast/system/actors.hpp"
@@ -46,6 +48,8 @@
 #include <caf/stream_source.hpp>
 
 #include <chrono>
+#include <limits>
+#include <optional>
 #include <unordered_map>
 
 namespace vast::detail {
@@ -87,8 +91,8 @@ struct source_state {
   /// Filters events, i.e., causes the source to drop all matching events.
   expression filter;
 
-  /// Maps types to the tailored filter.
-  std::unordered_map<type, expression> checkers;
+  /// Maps layouts to the tailored filter.
+  layout_table<expression> checkers;
 
   /// Actor for collecting statistics.
   accountant_actor accountant;
@@ -125,6 +129,9 @@ struct source_state {
   /// The maximum size for a table slice.
   size_t table_slice_size;
 
+  /// Adapts `table_slice_size` to the input rate, if enabled.
+  std::optional<detail::slice_size_estimator> slice_size_estimator;
+
   /// Current metrics for the accountant.
   measurement metrics;
 
@@ -153,6 +160,17 @@ struct source_state {
     local_schema = std::move(sch);
     accountant = std::move(acc);
     table_slice_size = tss;
+    if (reader.adaptive_batch_size()) {
+      // Table slices should fill up before the reader flushes them due to the
+      // batch timeout.
+      auto timeout = reader.batch_timeout_ > Reader::reader_clock::duration{}
+                       ? reader.batch_timeout_
+                       : defaults::import::batch_timeout;
+      slice_size_estimator.emplace(tss, defaults::import::min_table_slice_size,
+                                   defaults::import::max_table_slice_size,
+                                   timeout / 2);
+      table_slice_size = slice_size_estimator->size();
+    }
     sink = nullptr;
     done = false;
     // Register with the accountant.
@@ -193,6 +211,40 @@ struct source_state {
     }
   }
 
+  /// Updates the table slice size from the number of produced events, if the
+  /// source adapts it to the input rate.
+  void observe_produced(size_t produced) {
+    if (!slice_size_estimator)
+      return;
+    auto size = slice_size_estimator->observe(produced);
+    if (size != table_slice_size) {
+      VAST_DEBUG("{} changes its table slice size from {} to {} at {} "
+                 "events/sec",
+                 self, table_slice_size, size,
+                 static_cast<uint64_t>(slice_size_estimator->rate()));
+      table_slice_size = size;
+    }
+  }
+
+  /// Adds the table slice size and the selected encodings to a status.
+  void put_batching_status(caf::settings& src) const {
+    if (table_slice_size != std::numeric_limits<size_t>::max())
+      put(src, "batch-size", table_slice_size);
+    if (slice_size_estimator)
+      put(src, "input-rate",
+          static_cast<uint64_t>(slice_size_estimator->rate()));
+    if (!reader_initialized)
+      return;
+    if (reader.adaptive_encoding()) {
+      // Layout names contain dots, which `put` would interpret as a path.
+      auto& encodings = put_dictionary(src, "batch-encodings");
+      for (const auto& [layout, encoding] : reader.layout_encodings())
+        encodings[layout] = to_string(encoding);
+    } else {
+      put(src, "batch-encoding", to_string(reader.table_slice_type_));
+    }
+  }
+
   void send_report() {
     // Send the reader-specific status report to the accountant.
     if (auto status = reader.status(); !status.empty())
@@ -269,6 +321,7 @@ source(caf::stateful_actor<source_state<Reader>>* self, Reader reader,
       VAST_DEBUG("{} read {} events", self, produced);
       t.stop(produced);
       st.count += produced;
+      st.observe_produced(produced);
       auto finish = [&] {
         st.done = true;
         st.send_report();
@@ -358,6 +411,7 @@ source(caf::stateful_actor<source_state<Reader>>* self, Reader reader,
         if (self->state.reader_initialized)
           put(src, "format", self->state.reader.name());
         put(src, "produced", self->state.count);
+        self->state.put_batching_status(src);
         auto& xs = put_list(result, "sources");
         xs.emplace_back(std::move(src));
       }
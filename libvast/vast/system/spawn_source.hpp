@@ -15,6 +15,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/defaults.hpp"
 #include "vast/logger.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/make_source.hpp"
@@ -42,11 +43,14 @@ spawn_source(node_actor::stateful_pointer<node_state> self,
                            "unable to spawn a remote source when spawning a "
                            "node locally instead of connecting to one; please "
                            "unset the option vast.node");
-  auto [accountant, importer, type_registry]
-    = self->state.registry
-        .find<accountant_actor, importer_actor, type_registry_actor>();
+  auto [accountant, type_registry]
+    = self->state.registry.find<accountant_actor, type_registry_actor>();
+  auto label = caf::get_or(options, "vast.import.importer",
+                           defaults::import::importer);
+  auto importer = caf::actor_cast<importer_actor>(
+    self->state.registry.find_by_label(label));
   if (!importer)
-    return caf::make_error(ec::missing_component, "importer");
+    return caf::make_error(ec::missing_component, "importer", label);
   if (!type_registry)
     return caf::make_error(ec::missing_component, "type-registry");
   auto src_result = make_source<Reader, caf::detached>(
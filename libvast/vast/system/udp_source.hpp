@@ -0,0 +1,236 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/datagram_receiver.hpp"
+#include "vast/error.hpp"
+#include "vast/expression.hpp"
+#include "vast/logger.hpp"
+#include "vast/schema.hpp"
+#include "vast/system/source.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/actor_cast.hpp>
+#include <caf/downstream.hpp>
+#include <caf/send.hpp>
+#include <caf/settings.hpp>
+#include <caf/stateful_actor.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace vast::system {
+
+/// The state of a UDP source.
+template <class Reader>
+struct udp_source_state : source_state<Reader> {
+  // -- member types -----------------------------------------------------------
+
+  using super = source_state<Reader>;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  using super::super;
+
+  // -- member variables -------------------------------------------------------
+
+  /// Receives datagrams on a dedicated thread.
+  std::unique_ptr<detail::datagram_receiver> receiver;
+
+  /// The receiver counters at the last telemetry report.
+  detail::datagram_receiver::statistics reported = {};
+
+  // -- utility functions ------------------------------------------------------
+
+  /// Reports the receiver counters since the last report to the accountant.
+  void send_datagram_report() {
+    auto stats = receiver->stats();
+    auto prefix = std::string{this->name} + ".datagrams";
+    auto dropped = stats.dropped - reported.dropped;
+    if (dropped > 0)
+      VAST_WARN("{} dropped {} datagrams because the socket receive buffer "
+                "was full",
+                this->self, dropped);
+    this->self->send(this->accountant,
+                     report{{prefix + ".received",
+                             stats.received - reported.received},
+                            {prefix + ".dropped", dropped},
+                            {prefix + ".truncated",
+                             stats.truncated - reported.truncated}});
+    reported = stats;
+  }
+};
+
+template <class Reader>
+using udp_source_actor = caf::stateful_actor<udp_source_state<Reader>>;
+
+/// An event producer that listens on a UDP port. In contrast to the
+/// `datagram_source`, which handles one datagram per message, a dedicated
+/// thread receives datagrams in batches and the source parses all datagrams
+/// that arrived since its last run at once.
+/// @tparam Reader The concrete source implementation.
+/// @param self The actor handle.
+/// @param udp_listening_port The requested port.
+/// @param listen_buffer The number of datagrams to buffer.
+/// @param reader The reader instance.
+/// @param table_slice_size The maximum size for a table slice.
+/// @param max_events The optional maximum amount of events to import.
+/// @param type_registry The actor handle for the type-registry component.
+/// @oaram local_schema Additional local schemas to consider.
+/// @param type_filter Restriction for considered types.
+/// @param accountant_actor The actor handle for the accountant component.
+template <class Reader>
+caf::behavior
+udp_source(udp_source_actor<Reader>* self, uint16_t udp_listening_port,
+           size_t listen_buffer, Reader reader, size_t table_slice_size,
+           caf::optional<size_t> max_events, type_registry_actor type_registry,
+           vast::schema local_schema, std::string type_filter,
+           accountant_actor accountant) {
+  // The receiver thread wakes up the source when new datagrams arrive.
+  auto notify = [hdl = caf::actor_cast<caf::weak_actor_ptr>(self)] {
+    if (auto ptr = hdl.lock())
+      caf::anon_send(caf::actor_cast<caf::actor>(ptr), atom::wakeup_v);
+  };
+  auto receiver = detail::datagram_receiver::make(
+    udp_listening_port, listen_buffer, defaults::import::max_datagram_size,
+    defaults::import::socket_receive_buffer, std::move(notify));
+  if (!receiver) {
+    VAST_ERROR("{} could not open port {}: {}", self, udp_listening_port,
+               render(receiver.error()));
+    self->quit(std::move(receiver.error()));
+    return {};
+  }
+  VAST_DEBUG("{} starts listening at port {}", self, (*receiver)->port());
+  // Initialize state.
+  auto& st = self->state;
+  st.receiver = std::move(*receiver);
+  st.init(self, std::move(reader), std::move(max_events),
+          std::move(type_registry), std::move(local_schema),
+          std::move(type_filter), std::move(accountant), table_slice_size);
+  self->set_exit_handler([=](const caf::exit_msg& msg) {
+    VAST_VERBOSE("{} received EXIT from {}", self, msg.source);
+    self->state.done = true;
+    self->quit(msg.reason);
+  });
+  // Spin up the stream manager for the source.
+  st.mgr = self->make_continuous_source(
+    // init
+    [self](caf::unit_t&) {
+      caf::timestamp now = std::chrono::system_clock::now();
+      self->send(self->state.accountant, "source.start", now);
+    },
+    // get next element
+    [self](caf::unit_t&, caf::downstream<table_slice>& out, size_t num) {
+      auto& st = self->state;
+      // Datagrams that arrive from here on trigger another wakeup.
+      st.receiver->rearm();
+      if (st.receiver->available() == 0)
+        return;
+      auto push_slice = [&](table_slice slice) { out.push(std::move(slice)); };
+      auto events = num * st.table_slice_size;
+      if (st.requested)
+        events = std::min(events, *st.requested - st.count);
+      // The reader parses the datagrams directly from the receive buffers,
+      // and reaches the end of its input once it consumed all of them.
+      st.reader.reset(std::make_unique<std::istream>(st.receiver.get()));
+      auto t = timer::start(st.metrics);
+      auto [err, produced]
+        = st.reader.read(events, st.table_slice_size, push_slice);
+      VAST_DEBUG("{} read {} events", self, produced);
+      t.stop(produced);
+      st.count += produced;
+      st.observe_produced(produced);
+      if (st.requested && st.count >= *st.requested) {
+        VAST_DEBUG("{} finished with {} events", self, st.count);
+        st.done = true;
+        st.send_report();
+        self->quit();
+        return;
+      }
+      if (err != caf::none && err != ec::end_of_input && err != ec::timeout)
+        VAST_WARN("{} failed to parse datagrams: {}", self, render(err));
+    },
+    // done?
+    [self](const caf::unit_t&) { return self->state.done; });
+  return {
+    [self](atom::get, atom::schema) { //
+      return self->state.reader.schema();
+    },
+    [self](atom::put, schema sch) -> caf::result<void> {
+      if (auto err = self->state.reader.schema(std::move(sch));
+          err && err != caf::no_error)
+        return err;
+      return caf::unit;
+    },
+    [self]([[maybe_unused]] expression& expr) {
+      // FIXME: Allow for filtering import data.
+      VAST_WARN("{} does not currently implement filter expressions", self);
+    },
+    [self](stream_sink_actor<table_slice, std::string> sink) {
+      VAST_ASSERT(sink);
+      VAST_DEBUG("{} registers {}", self, VAST_ARG(sink));
+      if (self->state.sink) {
+        self->quit(caf::make_error(ec::logic_error,
+                                   "source does not support "
+                                   "multiple sinks; sender =",
+                                   self->current_sender()));
+        return;
+      }
+      self->state.sink = sink;
+      self->delayed_send(self, defaults::system::telemetry_rate,
+                         atom::telemetry_v);
+      // Start streaming.
+      auto name = std::string{self->state.reader.name()};
+      self->state.mgr->add_outbound_path(self->state.sink,
+                                         std::make_tuple(std::move(name)));
+    },
+    [self](atom::status, status_verbosity v) {
+      caf::settings result;
+      if (v >= status_verbosity::detailed) {
+        caf::settings src;
+        if (self->state.reader_initialized)
+          put(src, "format", self->state.reader.name());
+        put(src, "produced", self->state.count);
+        self->state.put_batching_status(src);
+        auto stats = self->state.receiver->stats();
+        put(src, "datagrams.received", stats.received);
+        put(src, "datagrams.dropped", stats.dropped);
+        put(src, "datagrams.truncated", stats.truncated);
+        put(src, "datagrams.buffered", self->state.receiver->available());
+        auto& xs = put_list(result, "sources");
+        xs.emplace_back(std::move(src));
+      }
+      return result;
+    },
+    [self](atom::wakeup) {
+      if (self->state.mgr->generate_messages())
+        self->state.mgr->push();
+    },
+    [self](atom::telemetry) {
+      self->state.send_report();
+      self->state.send_datagram_report();
+      if (!self->state.mgr->done())
+        self->delayed_send(self, defaults::system::telemetry_rate,
+                           atom::telemetry_v);
+    },
+  };
+}
+
+} // namespace vast::system
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/data.hpp"
+
+#include <caf/meta/type_name.hpp>
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+/// A partial or final result of an aggregation that counts the occurrences of
+/// the distinct values of a single field. Partial results of disjoint sets of
+/// events combine with `merge`.
+struct value_counts {
+  /// Counts one or more occurrences of a value.
+  /// @param x The value to count.
+  /// @param n The number of occurrences.
+  void add(const data& x, count n = 1);
+
+  /// Adds the counts of another (disjoint) aggregate.
+  /// @param other The aggregate to merge into this one.
+  void merge(const value_counts& other);
+
+  /// @returns The number of distinct values.
+  size_t distinct() const;
+
+  /// @returns The number of counted occurrences over all values.
+  count total() const;
+
+  /// Selects the most frequent values, ordered by descending count. Ties are
+  /// ordered by ascending value to keep the result deterministic.
+  /// @param k The maximum number of values to return, or 0 for all values.
+  /// @returns The *k* most frequent values and their counts.
+  std::vector<std::pair<data, count>> top(size_t k) const;
+
+  /// The number of occurrences per distinct value.
+  std::unordered_map<data, count> counts;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, value_counts& x) {
+    return f(caf::meta::type_name("vast.system.value_counts"), x.counts);
+  }
+};
+
+} // namespace vast::system
@@ -0,0 +1,96 @@
+/******************************************************************************
+ *                    _   _____   __________                                  *
+ *                   | | / / _ | / __/_  __/     Visibility                   *
+ *                   | |/ / __ |_\ \  / /          Across                     *
+ *                   |___/_/ |_/___/ /_/       Space and Time                 *
+ *                                                                            *
+ * This file is part of VAST. It is subject to the license terms in the       *
+ * LICENSE file found in the top-level directory of this distribution and at  *
+ * http://vast.io/license. No part of VAST, including this file, may be       *
+ * copied, modified, propagated, or distributed except according to the terms *
+ * contained in the LICENSE file.                                             *
+ ******************************************************************************/
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/system/query_processor.hpp"
+#include "vast/system/value_counts.hpp"
+
+#include <caf/actor.hpp>
+
+#include <cstddef>
+
+namespace vast::system {
+
+/// A query processor that hands the INDEX hits to worker actors, which fetch
+/// the candidates from the ARCHIVE and compute partial value counts. The
+/// processor merges the partial results and ships them to its client.
+///
+/// The processor runs at most `max_workers` workers at a time. Hits that
+/// arrive while all workers are busy accumulate until the next worker
+/// finishes, and hits that the processor has already seen are dropped, such
+/// that every event goes to exactly one worker.
+class worker_query_processor : public query_processor {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using super = query_processor;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  worker_query_processor(caf::event_based_actor* self);
+
+  /// Prepares the processor for running `expr` upon receiving 'run' and a
+  /// client handle.
+  void init(expression expr, index_actor index, archive_actor archive,
+            size_t max_workers);
+
+protected:
+  // -- implementation hooks ---------------------------------------------------
+
+  /// Spawns a worker that fetches the candidates for `hits` from the ARCHIVE
+  /// and sends its partial result as `value_counts` to this actor. Workers
+  /// must be linked to this actor, such that a failing worker aborts the
+  /// query instead of leaving us waiting for its partial result forever.
+  virtual void spawn_worker(ids hits) = 0;
+
+  void process_hits(const ids& hits) override;
+
+  void process_end_of_hits() override;
+
+  // -- member variables -------------------------------------------------------
+
+  /// Points to the ARCHIVE for fetching candidates.
+  archive_actor archive_;
+
+private:
+  // -- member variables -------------------------------------------------------
+
+  /// Stores the user-defined query.
+  expression expr_;
+
+  /// Points to the client actor that launched the query.
+  caf::actor client_;
+
+  /// Stores the maximum number of concurrently running workers.
+  size_t max_workers_ = 1;
+
+  /// Stores how many workers have yet to deliver their partial results.
+  size_t pending_workers_ = 0;
+
+  /// Stores all hits that the processor received from the INDEX.
+  ids seen_;
+
+  /// Stores the hits that wait for a worker.
+  ids unassigned_;
+
+  /// Accumulates the merged partial results.
+  value_counts result_;
+};
+
+} // namespace vast::system
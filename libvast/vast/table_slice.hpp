@@ -115,6 +115,10 @@ public:
   /// @returns The table layout.
   const record_type& layout() const noexcept;
 
+  /// @returns The table layout as registered with the process-wide layout
+  /// interner, which provides a stable numeric ID and the flattened layout.
+  const interned_layout& interned() const noexcept;
+
   /// @returns The number of rows in the slice.
   size_type rows() const noexcept;
 
@@ -154,6 +158,13 @@ public:
   /// @pre `t == *layout().at(*layout:).offset_from_index(column)) == t`
   data_view at(size_type row, size_type column, const type& t) const;
 
+  /// Decodes all values of the table slice at once. Unlike repeated calls to
+  /// `at`, this decodes every value exactly once.
+  /// @param result The decoded values in column-major order, i.e., the value
+  ///        at row `r` and column `c` is `result[c][r]`.
+  /// @note The views remain valid only as long as the table slice does.
+  void decode_columns(std::vector<std::vector<data_view>>& result) const;
+
 #if VAST_ENABLE_ARROW
 
   /// Converts a table slice to an Apache Arrow Record Batch.
@@ -280,4 +291,12 @@ uint64_t rows(const std::vector<table_slice>& slices);
 /// @returns The set of row IDs in *slice* for which *expr* yields true.
 ids evaluate(const expression& expr, const table_slice& slice);
 
+/// Evaluates an expression over the selected rows of a table slice.
+/// @param expr The expression to evaluate.
+/// @param slice The table slice to apply *expr* on.
+/// @param selection The IDs of the rows to consider.
+/// @returns The subset of *selection* in *slice* for which *expr* yields true.
+ids evaluate(const expression& expr, const table_slice& slice,
+             const ids& selection);
+
 } // namespace vast
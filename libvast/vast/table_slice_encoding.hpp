@@ -32,4 +32,13 @@ enum class table_slice_encoding : uint8_t {
 /// @relates table_slice_encoding
 std::string to_string(table_slice_encoding encoding) noexcept;
 
+/// Selects the encoding that suits a layout best: Apache Arrow for wide
+/// layouts and layouts that consist mostly of fixed-width types, which benefit
+/// from columnar access, and MessagePack for narrow layouts that consist
+/// mostly of strings and containers, which it encodes more compactly.
+/// @param layout The layout of the table slices to encode.
+/// @returns The preferred encoding for *layout*.
+/// @relates table_slice_encoding
+table_slice_encoding preferred_encoding(const record_type& layout);
+
 } // namespace vast
@@ -33,8 +33,10 @@ node::node() {
   // procedure to abort too early, before the to-be-terminated components had a
   // chance to deliver their DOWN message.
   auto infinte_grace_period = std::chrono::milliseconds::zero();
+  // A single filesystem actor keeps the message flow simple for the
+  // deterministic scheduler.
   test_node = self->spawn(system::node, "test", directory / "node",
-                          infinte_grace_period);
+                          infinte_grace_period, size_t{0});
   run();
   MESSAGE("spawning components");
   spawn_component("type-registry");